@@ -266,7 +266,8 @@ create table hm_messages (
 	messageflags tinyint not null,
 	messagecreatetime datetime not null,
 	messagelocked tinyint not null,
-   messageuid bigint not null
+   messageuid bigint not null,
+   messagemodseq bigint not null default 1
 ) 
 
 ALTER TABLE hm_messages ADD CONSTRAINT hm_messages_pk PRIMARY KEY NONCLUSTERED (messageid) 
@@ -358,7 +359,8 @@ create table hm_imapfolders
 	foldername nvarchar(255) NOT NULL,
 	folderissubscribed tinyint NOT NULL,
    foldercreationtime datetime NOT NULL,
-   foldercurrentuid bigint NOT NULL
+   foldercurrentuid bigint NOT NULL,
+   folderhighestmodseq bigint NOT NULL default 1
 ) 
 
 ALTER TABLE hm_imapfolders ADD CONSTRAINT hm_imapfolders_pk PRIMARY KEY NONCLUSTERED (folderid) 
@@ -943,7 +945,7 @@ insert into hm_tcpipports (portprotocol, portnumber, portaddress1, portaddress2,
 
 insert into hm_tcpipports (portprotocol, portnumber, portaddress1, portaddress2, portconnectionsecurity, portsslcertificateid) values (5, 143, 0, NULL, 0, 0) 
 
-insert into hm_dbversion values (5601) 
+insert into hm_dbversion values (5602) 
 
 
 
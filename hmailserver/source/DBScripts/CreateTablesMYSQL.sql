@@ -158,7 +158,8 @@ create table hm_messages
 	messageflags tinyint not null,
 	messagecreatetime datetime not null,
 	messagelocked tinyint not null,
-   messageuid bigint not null
+   messageuid bigint not null,
+   messagemodseq bigint not null default 1
 ) DEFAULT CHARSET=utf8;
 
 CREATE INDEX idx_hm_messages ON hm_messages (messageaccountid, messagefolderid);
@@ -236,7 +237,8 @@ create table hm_imapfolders
   foldername varchar(255) NOT NULL,
   folderissubscribed tinyint unsigned NOT NULL,
   foldercreationtime datetime NOT NULL,
-  foldercurrentuid bigint NOT NULL
+  foldercurrentuid bigint NOT NULL,
+  folderhighestmodseq bigint NOT NULL default 1
 ) DEFAULT CHARSET=utf8;
 
 CREATE INDEX idx_hm_imapfolders ON hm_imapfolders (folderaccountid);
@@ -768,4 +770,4 @@ insert into hm_tcpipports (portprotocol, portnumber, portaddress1, portaddress2,
 
 insert into hm_tcpipports (portprotocol, portnumber, portaddress1, portaddress2, portconnectionsecurity, portsslcertificateid) values (5, 143, 0, NULL, 0, 0);
 
-insert into hm_dbversion values (5601);
\ No newline at end of file
+insert into hm_dbversion values (5602);
\ No newline at end of file
@@ -172,7 +172,8 @@ create table hm_messages
 	messageflags smallint not null,
 	messagecreatetime timestamp not null,
 	messagelocked smallint not null,
-   messageuid bigint not null
+   messageuid bigint not null,
+   messagemodseq bigint not null default 1
 );
 
 CREATE INDEX idx_hm_messages ON hm_messages (messageaccountid, messagefolderid);
@@ -250,7 +251,8 @@ create table hm_imapfolders
   foldername varchar(255) NOT NULL,
   folderissubscribed smallint NOT NULL,
   foldercreationtime timestamp NOT NULL,
-  foldercurrentuid bigint NOT NULL
+  foldercurrentuid bigint NOT NULL,
+  folderhighestmodseq bigint NOT NULL default 1
 );
 
 CREATE INDEX idx_hm_imapfolders ON hm_imapfolders (folderaccountid);
@@ -784,4 +786,4 @@ insert into hm_tcpipports (portprotocol, portnumber, portaddress1, portaddress2,
 
 insert into hm_tcpipports (portprotocol, portnumber, portaddress1, portaddress2, portconnectionsecurity, portsslcertificateid) values (5, 143, 0, NULL, 0, 0);
 
-insert into hm_dbversion values (5601);
+insert into hm_dbversion values (5602);
@@ -0,0 +1,6 @@
+ALTER TABLE hm_messages ADD messagemodseq bigint NOT NULL DEFAULT 1
+
+ALTER TABLE hm_imapfolders ADD folderhighestmodseq bigint NOT NULL DEFAULT 1
+
+update hm_dbversion set value = 5602
+
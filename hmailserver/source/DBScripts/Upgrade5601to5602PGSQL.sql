@@ -0,0 +1,5 @@
+ALTER TABLE hm_messages ADD COLUMN messagemodseq bigint NOT NULL DEFAULT 1;
+
+ALTER TABLE hm_imapfolders ADD COLUMN folderhighestmodseq bigint NOT NULL DEFAULT 1;
+
+update hm_dbversion set value = 5602;
@@ -8,6 +8,9 @@
 #include "..\Common\Cache\Cache.h"
 #include "..\Common\Cache\CacheConfiguration.h"
 #include "..\Common\Cache\CacheContainer.h"
+#include "..\Common\Cache\CredentialCache.h"
+#include "..\SMTP\RecipientExpansionIndex.h"
+#include "..\IMAP\MessagesContainer.h"
 
 #include "..\Common\BO\Domain.h"   
 #include "..\Common\BO\Account.h"
@@ -502,6 +505,26 @@ InterfaceCache::get_DistributionListCacheMaxSizeKb(long *pVal)
    }
 }
 
+STDMETHODIMP 
+InterfaceCache::get_CredentialHitRate(long *pVal)
+{
+   try
+   {
+      if (!cache_config_)
+         return GetAccessDenied();
+
+      if (!GetIsServerAdmin())
+         return false;
+   
+      *pVal = HM::CredentialCache::Instance()->GetHitRate();
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
+
 STDMETHODIMP 
 InterfaceCache::Clear()
 {
@@ -517,6 +540,9 @@ InterfaceCache::Clear()
       HM::Cache<HM::Domain>::Instance()->Clear();
       HM::Cache<HM::Alias>::Instance()->Clear();
       HM::Cache<HM::DistributionList>::Instance()->Clear();
+      HM::CredentialCache::Instance()->Clear();
+      HM::RecipientExpansionIndex::Instance()->Clear();
+      HM::MessagesContainer::Instance()->Clear();
    
       return S_OK;
    }
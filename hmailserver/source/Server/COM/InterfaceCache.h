@@ -73,6 +73,8 @@ public:
    STDMETHOD(get_DistributionListCacheMaxSizeKb)(/*[out, retval]*/ long *pVal);
    STDMETHOD(put_DistributionListCacheMaxSizeKb)(/*[out, retval]*/ long pVal);
 
+   STDMETHOD(get_CredentialHitRate)(/*[out, retval]*/ long *pVal);
+
    STDMETHOD(Clear)();
 
 private:
@@ -497,6 +497,9 @@ STDMETHODIMP InterfaceMessage::Save()
             // All we need to do is to update it in the database.
             if (!HM::PersistentMessage::SaveObject(object_))
                return S_FALSE;
+
+            // The flags may have been changed on a message in the message cache.
+            HM::MessagesContainer::Instance()->SetFolderSnapshotOutdated(object_->GetFolderID());
    
             break;
          }
@@ -773,7 +776,7 @@ InterfaceMessage::GetMessageData_()
       }
 
       msg_data_ = std::shared_ptr<HM::MessageData>(new HM::MessageData());
-      msg_data_->LoadFromMessage(account, object_);
+      msg_data_->LoadHeaderFromMessage(account, object_);
    }
 
    return msg_data_;
@@ -130,4 +130,53 @@ STDMETHODIMP InterfaceMessageIndexing::Index()
    }
 }
 
+STDMETHODIMP InterfaceMessageIndexing::get_IndexingRate(long *pVal)
+{
+   try
+   {
+      if (!GetIsServerAdmin())
+         return false;
+   
+      *pVal = HM::MessageIndexer::Instance()->GetIndexingRate();
+   
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
 
+STDMETHODIMP InterfaceMessageIndexing::get_Backlog(long *pVal)
+{
+   try
+   {
+      if (!GetIsServerAdmin())
+         return false;
+   
+      *pVal = HM::MessageIndexer::Instance()->GetBacklog();
+   
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
+
+STDMETHODIMP InterfaceMessageIndexing::get_EstimatedSecondsRemaining(long *pVal)
+{
+   try
+   {
+      if (!GetIsServerAdmin())
+         return false;
+   
+      *pVal = HM::MessageIndexer::Instance()->GetEstimatedSecondsRemaining();
+   
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
@@ -57,6 +57,10 @@ public:
    STDMETHOD(get_TotalMessageCount)(/*[out, retval]*/ long *pVal);
    STDMETHOD(get_TotalIndexedCount)(/*[out, retval]*/ long *pVal);
 
+   STDMETHOD(get_IndexingRate)(/*[out, retval]*/ long *pVal);
+   STDMETHOD(get_Backlog)(/*[out, retval]*/ long *pVal);
+   STDMETHOD(get_EstimatedSecondsRemaining)(/*[out, retval]*/ long *pVal);
+
    STDMETHOD(Clear)();
    STDMETHOD(Index)();
 private:
@@ -6,6 +6,7 @@
 #include "InterfaceStatus.h"
 
 #include "../Common/Util/ServerStatus.h"
+#include "../Common/TCPIP/ConnectionLimiter.h"
 
 bool 
 InterfaceStatus::LoadSettings()
@@ -125,4 +126,53 @@ InterfaceStatus::get_SessionCount(eSessionType iType, long *pVal)
    }
 }
 
+STDMETHODIMP 
+InterfaceStatus::get_ConcurrencyLimitedConnections(long *pVal)
+{
+   try
+   {
+      if (!status_)
+         return GetAccessDenied();
+
+      *pVal = HM::ConnectionLimiter::Instance()->GetConcurrencyLimitedCount();
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
 
+STDMETHODIMP 
+InterfaceStatus::get_RateLimitedConnections(long *pVal)
+{
+   try
+   {
+      if (!status_)
+         return GetAccessDenied();
+
+      *pVal = HM::ConnectionLimiter::Instance()->GetRateLimitedCount();
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
+
+STDMETHODIMP 
+InterfaceStatus::get_HeldConnections(long *pVal)
+{
+   try
+   {
+      if (!status_)
+         return GetAccessDenied();
+
+      *pVal = HM::ConnectionLimiter::Instance()->GetHeldConnections();
+      return S_OK;
+   }
+   catch (...)
+   {
+      return COMError::GenerateGenericMessage();
+   }
+}
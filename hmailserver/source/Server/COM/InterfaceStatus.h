@@ -51,6 +51,9 @@ public:
    STDMETHOD(get_RemovedViruses)(/*[out, retval]*/ long *pVal);
    STDMETHOD(get_RemovedSpamMessages)(/*[out, retval]*/ long *pVal);
    STDMETHOD(get_SessionCount)(eSessionType iType, long *pVal);
+   STDMETHOD(get_ConcurrencyLimitedConnections)(/*[out, retval]*/ long *pVal);
+   STDMETHOD(get_RateLimitedConnections)(/*[out, retval]*/ long *pVal);
+   STDMETHOD(get_HeldConnections)(/*[out, retval]*/ long *pVal);
 
 private:
 
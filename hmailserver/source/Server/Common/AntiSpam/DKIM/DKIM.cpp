@@ -5,6 +5,7 @@
 
 #include "DKIM.h"
 #include "DKIMParameters.h"
+#include "DKIMPublicKeyCache.h"
 
 #include "../../Util/Hashing/HashCreator.h"
 #include "../../Util/Encoding/Base64.h"
@@ -12,7 +13,6 @@
 #include "../../BO/Message.h"
 #include "../../MIME/MimeCode.h"
 #include "../../MIME/Mime.h"
-#include "../../TCPIP/DNSResolver.h"
 #include "../../Util/TraceHeaderWriter.h"
 #include "../../Util/FileUtilities.h"
 #include "../../Persistence/PersistentMessage.h"
@@ -79,19 +79,6 @@ namespace HM
       recommendedHeaderFields_.push_back("List-Archive");
    }
 
-   // helper.
-   EVP_PKEY* 
-   _GetPublicKey(const AnsiString &keyData)
-   {
-      // base64 decode the public key.
-      AnsiString publicKeyData = Base64::Decode(keyData, keyData.GetLength());
-      const unsigned char * publicKeyDataPointer = (const unsigned char*) publicKeyData.GetBuffer();
-
-      EVP_PKEY *publicKey = d2i_PUBKEY(NULL, &publicKeyDataPointer, publicKeyData.GetLength());
-
-      return publicKey;
-   }
-
    bool 
    DKIM::Sign(std::shared_ptr<Message> message,
               const AnsiString &domain,
@@ -327,9 +314,9 @@ namespace HM
       else
          bodyCanonicalization = std::shared_ptr<RelaxedCanonicalization>(new RelaxedCanonicalization) ;
 
-      AnsiString publicKeyString;
+      std::shared_ptr<DKIMPublicKey> publicKey;
       AnsiString flags;
-      Result res = RetrievePublicKey_(signatureParams, publicKeyString, flags);
+      Result res = RetrievePublicKey_(signatureParams, publicKey, flags);
       if (res != Pass)
       {
          LOG_DEBUG("DKIM: Retrieval of public key failed.");
@@ -369,22 +356,22 @@ namespace HM
       AnsiString tagB = signatureParams.GetValue("b");
       
 
-      Result result = VerifyHeaderHash_(canonicalizedHeader, tagA, tagB, publicKeyString);
+      Result result = VerifyHeaderHash_(canonicalizedHeader, tagA, tagB, publicKey);
 
       return testMode ? Pass : result;
    }
 
    DKIM::Result
-   DKIM::VerifyHeaderHash_(AnsiString canonicalizedHeader, const AnsiString &tagA, AnsiString &tagB, const AnsiString &publicKeyString)
+   DKIM::VerifyHeaderHash_(AnsiString canonicalizedHeader, const AnsiString &tagA, AnsiString &tagB, std::shared_ptr<DKIMPublicKey> publicKeyRecord)
    {
       Result result = PermFail;
 
-      // base64 decode the public key.
-      EVP_PKEY *publicKey = _GetPublicKey(publicKeyString);
+      // The key was base64 decoded when the record was cached.
+      EVP_PKEY *publicKey = publicKeyRecord->GetKey();
       if (!publicKey)
       {
          // unable to extract public key from record. broken?
-         LOG_DEBUG("DKIM: Unable to base64 decode public key found in DNS record. Key: " + publicKeyString);
+         LOG_DEBUG("DKIM: Unable to base64 decode public key found in DNS record. Key: " + publicKeyRecord->GetParameters().GetValue("p"));
          return result;
       }
 
@@ -418,7 +405,6 @@ namespace HM
       }
 
       EVP_MD_CTX_cleanup( &hdr__ctx );
-      EVP_PKEY_free(publicKey);
 
       return result;
    }
@@ -554,22 +540,21 @@ namespace HM
    }
 
    DKIM::Result
-   DKIM::RetrievePublicKey_(const DKIMParameters &signatureParams, AnsiString &publicKey, AnsiString &flags)
+   DKIM::RetrievePublicKey_(const DKIMParameters &signatureParams, std::shared_ptr<DKIMPublicKey> &publicKey, AnsiString &flags)
    {
       // 6.1.2.  Get the Public Key
       AnsiString tagDomain = signatureParams.GetValue("d");
       AnsiString tagSelector = signatureParams.GetValue("s");
       AnsiString keyName = tagSelector + "._domainkey." + tagDomain;
 
-      std::vector<String> results;
-      DNSResolver resolver;
-      if (!resolver.GetTXTRecords(keyName, results))
+      DKIMPublicKeyCache::LookupResult lookupResult = DKIMPublicKeyCache::Instance()->GetPublicKey(keyName, publicKey);
+      if (lookupResult == DKIMPublicKeyCache::LookupFailed)
       {
          LOG_DEBUG("DKIM: Error when retrieving public key. Failed to do DNS/TXT lookup.");
          return TempFail;
       }
 
-      if (results.size() == 0)
+      if (lookupResult == DKIMPublicKeyCache::NoRecord)
       {
          /*
             3.  If the query for the public key fails because the corresponding
@@ -588,10 +573,7 @@ namespace HM
                        JyM2IRZ8qSOCeQscnre5iVjwIDAQAB;
       */
       
-      AnsiString result = results[0];
-
-      DKIMParameters dnsKeyParams;
-      dnsKeyParams.Load(result);
+      const DKIMParameters &dnsKeyParams = publicKey->GetParameters();
 
       if (!ValidateDNSEntry_(dnsKeyParams, signatureParams))
       {
@@ -599,10 +581,8 @@ namespace HM
          return PermFail;
       }
 
-      publicKey = dnsKeyParams.GetValue("p");
-
       // An empty value means that this public key has been revoked. 
-      if (publicKey.IsEmpty())
+      if (dnsKeyParams.GetValue("p").IsEmpty())
       {
          LOG_DEBUG("DKIM: Error when retrieving public key. Public key has been revoked.");
          return PermFail;
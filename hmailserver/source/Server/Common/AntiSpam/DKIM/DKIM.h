@@ -13,6 +13,7 @@ namespace HM
    class MimeHeader;
    class DKIMParameters;
    class MimeField;
+   class DKIMPublicKey;
 
    class DKIM
    {
@@ -49,9 +50,9 @@ namespace HM
       bool ValidateHeaderContents_(const DKIMParameters &signatureParams);
       bool ValidateBodyHash_(const String &fileName, const DKIMParameters &signatureParams, std::shared_ptr<Canonicalization> canonicalization);
       bool ValidateDNSEntry_(const DKIMParameters &entryParams, const DKIMParameters &headerParams);
-      Result VerifyHeaderHash_(AnsiString canonicalizedHeader, const AnsiString &tagA, AnsiString &tagB, const AnsiString &publicKeyString);
+      Result VerifyHeaderHash_(AnsiString canonicalizedHeader, const AnsiString &tagA, AnsiString &tagB, std::shared_ptr<DKIMPublicKey> publicKey);
       Result VerifySignature_(const String &fileName, const AnsiString &messageHeader, std::pair<AnsiString, AnsiString> signatureField);
-      Result RetrievePublicKey_(const DKIMParameters &signatureParams, AnsiString &publicKey, AnsiString &flags);
+      Result RetrievePublicKey_(const DKIMParameters &signatureParams, std::shared_ptr<DKIMPublicKey> &publicKey, AnsiString &flags);
       AnsiString GetDKIMWithoutSignature_(AnsiString value);
      
       String BuildSignatureHeader_(const String &tagA, const String &tagD, const String &tagS, const String &tagC, const String &tagQ, const String &fieldList, const String &bodyHash, const String &signatureString);
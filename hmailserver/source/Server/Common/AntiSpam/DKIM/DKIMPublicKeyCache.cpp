@@ -0,0 +1,124 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "StdAfx.h"
+
+#include "DKIMPublicKeyCache.h"
+
+#include "../../Util/Encoding/Base64.h"
+#include "../../TCPIP/DNSResolver.h"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   DKIMPublicKey::DKIMPublicKey(const AnsiString &record) :
+      key_(NULL)
+   {
+      parameters_.Load(record);
+
+      AnsiString keyData = parameters_.GetValue("p");
+      if (keyData.IsEmpty())
+         return;
+
+      // base64 decode the public key. Doing this once per record rather than once
+      // per signature is the main point of caching the parsed key.
+      AnsiString publicKeyData = Base64::Decode(keyData, keyData.GetLength());
+      const unsigned char * publicKeyDataPointer = (const unsigned char*) publicKeyData.GetBuffer();
+
+      key_ = d2i_PUBKEY(NULL, &publicKeyDataPointer, publicKeyData.GetLength());
+   }
+
+   DKIMPublicKey::~DKIMPublicKey()
+   {
+      if (key_ != NULL)
+         EVP_PKEY_free(key_);
+   }
+
+   DKIMPublicKeyCache::DKIMPublicKeyCache()
+   {
+
+   }
+
+   DKIMPublicKeyCache::LookupResult
+   DKIMPublicKeyCache::GetPublicKey(const AnsiString &keyName, std::shared_ptr<DKIMPublicKey> &publicKey)
+   {
+      AnsiString lowerKeyName = keyName;
+      lowerKeyName.ToLower();
+
+      if (GetCached_(lowerKeyName, publicKey))
+         return publicKey ? Found : NoRecord;
+
+      std::vector<String> results;
+      int recordTTL = 0;
+      DNSResolver resolver;
+      if (!resolver.GetTXTRecords(keyName, results, recordTTL))
+         return LookupFailed;
+
+      if (results.size() == 0)
+      {
+         Add_(lowerKeyName, nullptr, NegativeTTLSeconds);
+         return NoRecord;
+      }
+
+      publicKey = std::shared_ptr<DKIMPublicKey>(new DKIMPublicKey(results[0]));
+      Add_(lowerKeyName, publicKey, min(recordTTL, (int) PositiveTTLSeconds));
+
+      return Found;
+   }
+
+   bool
+   DKIMPublicKeyCache::GetCached_(const std::string &keyName, std::shared_ptr<DKIMPublicKey> &publicKey)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+
+      auto &items = keys_.get<by_name>();
+      auto iter = items.find(keyName);
+      if (iter == items.end())
+         return false;
+
+      // The steady clock doesn't wrap or jump when the system time is changed.
+      boost::chrono::steady_clock::duration age = boost::chrono::steady_clock::now() - (*iter).creation_time_;
+      if (age >= boost::chrono::seconds((*iter).ttl_))
+      {
+         items.erase(iter);
+         return false;
+      }
+
+      publicKey = (*iter).public_key_;
+      return true;
+   }
+
+   void
+   DKIMPublicKeyCache::Add_(const std::string &keyName, std::shared_ptr<DKIMPublicKey> publicKey, int ttl)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+
+      auto &items = keys_.get<by_name>();
+      items.erase(keyName);
+
+      if (keys_.size() >= (size_t) MaxEntries)
+      {
+         // Drop the oldest tenth in one go so that we don't have to evict on every insert.
+         auto &itemsByAge = keys_.get<by_age>();
+         size_t itemsToRemove = MaxEntries / 10;
+
+         while (itemsToRemove-- > 0 && !itemsByAge.empty())
+            itemsByAge.erase(itemsByAge.begin());
+      }
+
+      CachedKey cachedKey;
+      cachedKey.key_name_ = keyName;
+      cachedKey.creation_time_ = boost::chrono::steady_clock::now();
+      cachedKey.ttl_ = ttl;
+      cachedKey.public_key_ = publicKey;
+
+      items.insert(cachedKey);
+   }
+}
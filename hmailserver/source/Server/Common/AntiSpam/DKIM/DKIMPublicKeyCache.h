@@ -0,0 +1,91 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+#include "DKIMParameters.h"
+
+typedef struct evp_pkey_st EVP_PKEY;
+
+namespace HM
+{
+   class DKIMPublicKey
+   {
+   public:
+      DKIMPublicKey(const AnsiString &record);
+      ~DKIMPublicKey();
+
+      const DKIMParameters &GetParameters() const { return parameters_; }
+
+      EVP_PKEY *GetKey() const { return key_; }
+      // The decoded key, or NULL if the p= tag could not be decoded.
+
+   private:
+
+      DKIMPublicKey(const DKIMPublicKey &);
+      DKIMPublicKey &operator=(const DKIMPublicKey &);
+
+      DKIMParameters parameters_;
+      EVP_PKEY *key_;
+   };
+
+   class DKIMPublicKeyCache : public Singleton<DKIMPublicKeyCache>
+   {
+   public:
+      DKIMPublicKeyCache();
+
+      enum Settings
+      {
+         MaxEntries = 10000,
+         PositiveTTLSeconds = 3600,
+         NegativeTTLSeconds = 300
+      };
+
+      enum LookupResult
+      {
+         Found = 0,
+         NoRecord = 1,
+         LookupFailed = 2
+      };
+
+      LookupResult GetPublicKey(const AnsiString &keyName, std::shared_ptr<DKIMPublicKey> &publicKey);
+      // Returns the key published under selector._domainkey.domain. Parsed keys
+      // and missing records are cached. Keys are kept no longer than the TTL of
+      // the DNS record. Failed DNS lookups are never cached.
+
+   private:
+
+      struct CachedKey
+      {
+         std::string key_name_;
+         boost::chrono::steady_clock::time_point creation_time_;
+         int ttl_;
+
+         std::shared_ptr<DKIMPublicKey> public_key_;
+         // Empty for negatively cached entries.
+      };
+
+      struct by_name {};
+      struct by_age {};
+
+      typedef boost::multi_index::multi_index_container<
+         CachedKey,
+         boost::multi_index::indexed_by<
+            boost::multi_index::hashed_unique<
+               boost::multi_index::tag<by_name>, BOOST_MULTI_INDEX_MEMBER(CachedKey, std::string, key_name_)>,
+            boost::multi_index::ordered_non_unique<
+               boost::multi_index::tag<by_age>, BOOST_MULTI_INDEX_MEMBER(CachedKey, boost::chrono::steady_clock::time_point, creation_time_)> >
+      > container_type;
+
+      bool GetCached_(const std::string &keyName, std::shared_ptr<DKIMPublicKey> &publicKey);
+      void Add_(const std::string &keyName, std::shared_ptr<DKIMPublicKey> publicKey, int ttl);
+
+      boost::recursive_mutex mutex_;
+      container_type keys_;
+   };
+}
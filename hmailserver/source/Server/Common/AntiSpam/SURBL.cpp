@@ -3,16 +3,14 @@
 
 #include "StdAfx.h"
 #include ".\surbl.h"
+#include "SURBLLookupPool.h"
 
 #include "../../Common/BO/MessageData.h"
 #include "../../Common/BO/SURBLServer.h"
-#include "../../Common/TCPIP/DNSResolver.h"
 #include "../../Common/Util/FileUtilities.h"
 
 #include "../../Common/Util/TLD.h"
 
-#include <boost/timer/timer.hpp>
-
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
@@ -22,182 +20,169 @@ namespace HM
 {
    SURBL::SURBL(void)
    {
-      
+
    }
 
    SURBL::~SURBL(void)
    {
    }
 
-   
-
-   bool 
-   SURBL::Run(std::shared_ptr<SURBLServer> pSURBLServer, std::shared_ptr<MessageData> pMessageData)
+   std::set<std::shared_ptr<SURBLServer> >
+   SURBL::Run(const std::vector<std::shared_ptr<SURBLServer> > &servers, std::shared_ptr<MessageData> pMessageData)
    {
       LOG_DEBUG("SURBL: Execute");
 
-      // Extract body
-      String sBody = pMessageData->GetBody() + pMessageData->GetHTMLBody(); 
-
-      int iCurPos = -1;
-	  
-      std::set<String> addresses;
-
-      while (true)
-      {
-         iCurPos = GetURLStart_(sBody, iCurPos);
-
-         if (iCurPos < 0 )
-            break;
+      std::set<String> uniqueHosts;
+      std::vector<String> hosts;
 
-         // Start of URL
-         int iURLEnd = GetURLEndPos_(sBody, iCurPos);
-         int iURLLength = iURLEnd - iCurPos ;
+      ExtractHosts_(pMessageData->GetBody(), uniqueHosts, hosts);
+      ExtractHosts_(pMessageData->GetHTMLBody(), uniqueHosts, hosts);
 
-         String sURL = sBody.Mid(iCurPos, iURLLength);
+      std::set<std::shared_ptr<SURBLServer> > listedBy;
 
-         // Clean the URL from linefeeds
-         CleanURL_(sURL);
+      if (hosts.empty() || servers.empty())
+      {
+         LOG_DEBUG("SURBL: Match not found");
+         return listedBy;
+      }
 
-         // Trim away top domain
-         if (!CleanHost_(sURL))
-            continue;
+      LOG_DEBUG(Formatter::Format("SURBL: {0} unique addresses found.", hosts.size()));
 
-			if (addresses.find(sURL) == addresses.end())
-			{
-				String logMessage;
-            logMessage.Format(_T("SURBL: Found URL: %s"), sURL.c_str());
-				LOG_DEBUG(logMessage);
+      if (hosts.size() > (size_t) MaxHostsToProcess)
+      {
+         LOG_DEBUG(Formatter::Format("SURBL: Only the first {0} addresses will be looked up.", MaxHostsToProcess));
+         hosts.resize(MaxHostsToProcess);
+      }
 
-				addresses.insert(sURL);
-			}
+      // Interleave the servers so that every server gets its first hosts
+      // looked up early, should the deadline be reached.
+      std::vector<std::pair<String, std::shared_ptr<SURBLServer> > > lookups;
+      for (String host : hosts)
+      {
+         for (std::shared_ptr<SURBLServer> server : servers)
+            lookups.push_back(std::make_pair(host, server));
       }
 
-		if (addresses.size() > 0)
-		{
-			String logMessage = Formatter::Format("SURBL: {0} unique addresses found.", addresses.size());
-			LOG_DEBUG(logMessage);
-		}
+      listedBy = SURBLLookupPool::Instance()->Run(lookups, MaxSecondsPerMessage);
 
-      // We stop processing URL's if:
-      // - 15 or more URLss have been processed.
-      // - More than 10 seconds have passed.
-      //
-     	// NEED FOR IMPROVEMENT: max URL's & time should be user-adjustable even if just by INI
+      if (listedBy.empty())
+         LOG_DEBUG("SURBL: Match not found");
 
-	   const int maxURLsToProcess = 15;
+      return listedBy;
+   }
 
-      boost::chrono::system_clock::time_point start_time = boost::chrono::system_clock::now();
+   void
+   SURBL::ExtractHosts_(const String &text, std::set<String> &uniqueHosts, std::vector<String> &hosts) const
+   {
+      // Single pass over the text using a small automaton which recognizes the
+      // schemes http:// and https:// (case-insensitive). The only symbol which
+      // can restart a match is 'h', so the failure transition of every state is
+      // either 'h' -> 1 or back to 0.
+      enum ScanState
+      {
+         Start = 0, H, HT, HTT, HTTP, HTTPS, Colon, Slash
+      };
+
+      ScanState state = Start;
+      size_t length = text.size();
 
-      int processedAddresses = 0;
-      for(String sURL : addresses)
+      for (size_t i = 0; i < length; i++)
       {
-         boost::chrono::duration<double> elapsed_seconds = boost::chrono::system_clock::now() - start_time;
+         wchar_t c = towlower(text[i]);
 
-         if (elapsed_seconds.count() > 10)
+         switch (state)
          {
-				LOG_DEBUG("SURBL: Aborting. Too long time elapsed.");
-            return true;
-         }
+         case H:
+            state = c == 't' ? HT : Start;
+            break;
+         case HT:
+            state = c == 't' ? HTT : Start;
+            break;
+         case HTT:
+            state = c == 'p' ? HTTP : Start;
+            break;
+         case HTTP:
+            state = c == 's' ? HTTPS : (c == ':' ? Colon : Start);
+            break;
+         case HTTPS:
+            state = c == ':' ? Colon : Start;
+            break;
+         case Colon:
+            state = c == '/' ? Slash : Start;
+            break;
+         case Slash:
+            if (c == '/')
+            {
+               String host;
+               i = ReadHost_(text, i + 1, host);
+               state = Start;
 
-         if (processedAddresses > maxURLsToProcess)
-         {
-				LOG_DEBUG("SURBL: Aborting. Too many urls.");
-            return true;
-         }
+               if (host.IsEmpty() || !CleanHost_(host))
+                  continue;
 
-         String sHostToLookup = sURL + "." + pSURBLServer->GetDNSHost();
+               if (uniqueHosts.find(host) == uniqueHosts.end())
+               {
+                  LOG_DEBUG(Formatter::Format(_T("SURBL: Found URL: {0}"), host));
 
-         LOG_DEBUG(Formatter::Format(_T("SURBL: Lookup: {0}"), sHostToLookup));
+                  uniqueHosts.insert(host);
+                  hosts.push_back(host);
+               }
 
-         std::vector<String> saFoundNames;
-         DNSResolver resolver;
-         if (!resolver.GetARecords(sHostToLookup, saFoundNames))
-         {
-				LOG_DEBUG("SURBL: DNS query failed.");
-            return true;
-         }
+               continue;
+            }
 
-         if (saFoundNames.size() > 0)
-         {
-				LOG_DEBUG("SURBL: Match found");
-            return false;
+            state = Start;
+            break;
+         default:
+            break;
          }
 
-         processedAddresses++;
+         if (state == Start && c == 'h')
+            state = H;
       }
-
-		LOG_DEBUG("SURBL: Match not found");
-      return true;
-
    }
 
-   int 
-   SURBL::GetURLEndPos_(const String &sBody, int iURLStart)
+   size_t
+   SURBL::ReadHost_(const String &text, size_t start, String &host) const
    {
-      for (int i = iURLStart; i < sBody.GetLength(); i++)
+      // Reads the host part of the URL starting at start, lower-casing it as we go.
+      // Quoted-printable soft line breaks (=CRLF) are skipped, since a URL may
+      // be wrapped over multiple lines. Please see test case TestSURBLWithWrappedURL.
+      // Returns the position of the last character consumed.
+      size_t length = text.size();
+      size_t i = start;
+
+      for (; i < length; i++)
       {
-         // Space added as fix to no test on plain-text emails without end slash
-         // Bill: cr and lf added as well for same reason
-         // Martin: Removed newline characters again. A URL may span multiple lines
-         //         If we stop searching for end of URL at end of newline, we'll
-         //         miss certain tests. Please see test case TestSURBLWithWrappedURL.
-         // Might be best to look for 1st non-allowed domain char instead..
-         wchar_t c = sBody[i];
-         if (c == '<' || c == '/' ||  c == '\\' ||  c == '>' ||c == ' ' || c == '"' || c == '\'')
-            return i;
-
-         if (c == '\r')
-         {
-            // if previous char was a =, which indicates that the url
-            // continues on the next line, keep on looking for end of link
-            if (i > 0)
-            {
-               if (sBody[i-1] != '=')
-                  return i;
-            }
-         }
-      }
-
-      return -1;
-   }
+         wchar_t c = text[i];
 
-   int 
-   SURBL::GetURLStart_(const String &sBody, int iCurrentPos)
-   {
-      int iHttpStart = sBody.Find(_T("http://"), iCurrentPos+1);
-      int iHttpsStart = sBody.Find(_T("https://"), iCurrentPos+1);
+         if (c == '=' && i + 1 < length && (text[i+1] == '\r' || text[i+1] == '\n'))
+         {
+            i++;
 
-		const int HttpPrefixLength = 7;
-		const int HttpsPrefixLength = 8;
+            if (text[i] == '\r' && i + 1 < length && text[i+1] == '\n')
+               i++;
 
-		// If neither http nor https is found, return
-		if (iHttpStart == -1 && iHttpsStart == -1)
-			return -1;
+            continue;
+         }
 
-		// If only https is found, return thatt
-      if (iHttpStart == -1)
-         return iHttpsStart + HttpsPrefixLength;
+         if (c == '<' || c == '>' || c == '/' || c == '\\' || c == ' ' || c == '\t' ||
+             c == '"' || c == '\'' || c == '\r' || c == '\n' ||
+             c == '?' || c == '#' || c == ':' || c == ')')
+         {
+            break;
+         }
 
-		// If only http is found, return that
-      if (iHttpsStart == -1)
-         return iHttpStart + HttpPrefixLength;
+         if (host.GetLength() >= MaxHostLength)
+         {
+            host.Empty();
+            break;
+         }
 
-		// If both are found, return closest.
-      if (iHttpStart < iHttpsStart)
-         return iHttpStart + HttpPrefixLength;
-      else
-         return iHttpsStart + HttpsPrefixLength;
-   }
+         host += (wchar_t) towlower(c);
+      }
 
-   void
-   SURBL::CleanURL_(String &url) const
-   {
-      url.Replace(_T("=\r\n"), _T(""));
-      // We need to replace them individually as well just in case..
-      url.Replace(_T("=\r"), _T(""));
-      url.Replace(_T("=\n"), _T(""));
-      url.MakeLower();
+      return i > start ? i - 1 : start;
    }
 
    bool
@@ -207,4 +192,4 @@ namespace HM
       return TLD::Instance()->GetDomainNameFromHost(sDomain, bIsIPAddress);
 
    }
-}
\ No newline at end of file
+}
@@ -14,15 +14,20 @@ namespace HM
       SURBL(void);
       ~SURBL(void);
 
-      bool Run(std::shared_ptr<SURBLServer> pSURBLServer, std::shared_ptr<MessageData> pMessageData);
+      std::set<std::shared_ptr<SURBLServer> > Run(const std::vector<std::shared_ptr<SURBLServer> > &servers, std::shared_ptr<MessageData> pMessageData);
+      // Returns the servers which list one or more of the hosts linked from the message.
 
    private:
 
-      void CleanURL_(String &sURL) const;
-      bool CleanHost_(String &sDomain) const;
-      int GetURLStart_(const String &sBody, int iCurrentPos);
-      int GetURLEndPos_(const String &sBody, int iURLStart);
+      enum Settings
+      {
+         MaxHostsToProcess = 50,
+         MaxSecondsPerMessage = 10,
+         MaxHostLength = 255
+      };
 
-      
+      void ExtractHosts_(const String &text, std::set<String> &uniqueHosts, std::vector<String> &hosts) const;
+      size_t ReadHost_(const String &text, size_t start, String &host) const;
+      bool CleanHost_(String &sDomain) const;
    };
-}
\ No newline at end of file
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "StdAfx.h"
+#include "SURBLLookupPool.h"
+
+#include "../../Common/BO/SURBLServer.h"
+#include "../../Common/TCPIP/DNSResolver.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   SURBLLookupPool::SURBLLookupPool() :
+      stopping_(false)
+   {
+
+   }
+
+   std::set<std::shared_ptr<SURBLServer> >
+   SURBLLookupPool::Run(const std::vector<std::pair<String, std::shared_ptr<SURBLServer> > > &lookups, int maxSeconds)
+   {
+      std::shared_ptr<Batch> batch = std::shared_ptr<Batch>(new Batch);
+      batch->lookups_ = lookups;
+      batch->next_lookup_ = 0;
+      batch->lookups_in_flight_ = 0;
+      batch->abandoned_ = false;
+
+      boost::chrono::steady_clock::time_point deadline = boost::chrono::steady_clock::now() + boost::chrono::seconds(maxSeconds);
+
+      boost::unique_lock<boost::mutex> lock(mutex_);
+
+      if (stopping_)
+         return batch->listed_by_;
+
+      // The threads are started the first time they are needed.
+      while (threads_.size() < (size_t) MaxLookupsInFlight)
+         threads_.push_back(std::shared_ptr<boost::thread>(new boost::thread(std::bind(&SURBLLookupPool::Worker_, this))));
+
+      batches_.push_back(batch);
+      work_available_.notify_all();
+
+      while (batch->lookups_in_flight_ > 0 || HasMoreLookups_(*batch))
+      {
+         if (batch->completed_.wait_until(lock, deadline) == boost::cv_status::timeout)
+         {
+            // Lookups which are in flight finish on their own, the others are skipped.
+            LOG_DEBUG("SURBL: Aborting. Too long time elapsed.");
+            batch->abandoned_ = true;
+            break;
+         }
+      }
+
+      return batch->listed_by_;
+   }
+
+   void
+   SURBLLookupPool::Stop()
+   {
+      std::vector<std::shared_ptr<boost::thread> > threads;
+
+      {
+         boost::lock_guard<boost::mutex> guard(mutex_);
+
+         stopping_ = true;
+
+         // Release the messages waiting in Run once their lookups in flight have finished.
+         for (std::shared_ptr<Batch> batch : batches_)
+         {
+            batch->abandoned_ = true;
+
+            if (batch->lookups_in_flight_ == 0)
+               batch->completed_.notify_all();
+         }
+
+         batches_.clear();
+         threads.swap(threads_);
+
+         work_available_.notify_all();
+      }
+
+      // A thread finishes the DNS query it is running before it exits.
+      for (std::shared_ptr<boost::thread> thread : threads)
+         thread->join();
+
+      boost::lock_guard<boost::mutex> guard(mutex_);
+      stopping_ = false;
+   }
+
+   bool
+   SURBLLookupPool::HasMoreLookups_(Batch &batch)
+   {
+      if (batch.abandoned_)
+         return false;
+
+      // Skip lookups against servers which have already listed another host.
+      while (batch.next_lookup_ < batch.lookups_.size() &&
+             batch.listed_by_.find(batch.lookups_[batch.next_lookup_].second) != batch.listed_by_.end())
+      {
+         batch.next_lookup_++;
+      }
+
+      return batch.next_lookup_ < batch.lookups_.size();
+   }
+
+   void
+   SURBLLookupPool::Worker_()
+   {
+      for (;;)
+      {
+         std::shared_ptr<Batch> batch;
+         String host;
+         std::shared_ptr<SURBLServer> server;
+
+         {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+
+            for (;;)
+            {
+               while (!batches_.empty() && !HasMoreLookups_(*batches_.front()))
+               {
+                  std::shared_ptr<Batch> completedBatch = batches_.front();
+                  batches_.pop_front();
+
+                  if (completedBatch->lookups_in_flight_ == 0)
+                     completedBatch->completed_.notify_all();
+               }
+
+               if (stopping_)
+                  return;
+
+               if (!batches_.empty())
+                  break;
+
+               work_available_.wait(lock);
+            }
+
+            batch = batches_.front();
+            host = batch->lookups_[batch->next_lookup_].first;
+            server = batch->lookups_[batch->next_lookup_].second;
+            batch->next_lookup_++;
+            batch->lookups_in_flight_++;
+
+            // Let the next message have the next lookup.
+            batches_.pop_front();
+            batches_.push_back(batch);
+         }
+
+         String sHostToLookup = host + "." + server->GetDNSHost();
+
+         LOG_DEBUG(Formatter::Format(_T("SURBL: Lookup: {0}"), sHostToLookup));
+
+         std::vector<String> saFoundNames;
+         DNSResolver resolver;
+         bool lookupSucceeded = resolver.GetARecords(sHostToLookup, saFoundNames);
+
+         if (!lookupSucceeded)
+            LOG_DEBUG("SURBL: DNS query failed.");
+         else if (saFoundNames.size() > 0)
+            LOG_DEBUG(Formatter::Format(_T("SURBL: Match found: {0}"), sHostToLookup));
+
+         {
+            boost::lock_guard<boost::mutex> guard(mutex_);
+
+            if (lookupSucceeded && saFoundNames.size() > 0)
+               batch->listed_by_.insert(server);
+
+            batch->lookups_in_flight_--;
+
+            if (batch->lookups_in_flight_ == 0 && !HasMoreLookups_(*batch))
+               batch->completed_.notify_all();
+         }
+      }
+   }
+}
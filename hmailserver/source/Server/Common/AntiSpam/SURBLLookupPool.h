@@ -0,0 +1,58 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include <boost/thread.hpp>
+
+namespace HM
+{
+   class SURBLServer;
+
+   // Runs the SURBL DNS lookups of all messages on a fixed number of threads,
+   // so that the number of lookups in flight is bounded however slow the DNS
+   // servers are. The messages take turns, one lookup at a time.
+   class SURBLLookupPool : public Singleton<SURBLLookupPool>
+   {
+   public:
+
+      SURBLLookupPool();
+
+      std::set<std::shared_ptr<SURBLServer> > Run(const std::vector<std::pair<String, std::shared_ptr<SURBLServer> > > &lookups, int maxSeconds);
+      // Looks up each host in the server it is paired with, and returns the servers which
+      // list one of them. After maxSeconds, the lookups which have not started are skipped.
+
+      void Stop();
+      // Abandons the queued lookups and waits for the threads to exit. The threads are
+      // started again by the next Run.
+
+   private:
+
+      enum Settings
+      {
+         MaxLookupsInFlight = 16
+      };
+
+      struct Batch
+      {
+         std::vector<std::pair<String, std::shared_ptr<SURBLServer> > > lookups_;
+         size_t next_lookup_;
+         int lookups_in_flight_;
+         bool abandoned_;
+
+         std::set<std::shared_ptr<SURBLServer> > listed_by_;
+
+         boost::condition_variable completed_;
+      };
+
+      static bool HasMoreLookups_(Batch &batch);
+      void Worker_();
+
+      boost::mutex mutex_;
+      boost::condition_variable work_available_;
+      bool stopping_;
+
+      std::deque<std::shared_ptr<Batch> > batches_;
+      std::vector<std::shared_ptr<boost::thread> > threads_;
+   };
+}
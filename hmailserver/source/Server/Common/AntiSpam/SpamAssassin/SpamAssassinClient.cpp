@@ -96,7 +96,7 @@ namespace HM
       const int maxIterations = 100000;
       for (int i = 0; i < maxIterations; i++)
       {
-         std::shared_ptr<ByteBuffer> pBuf = oFile.ReadChunk(20000);
+         std::shared_ptr<ByteBuffer> pBuf = oFile.ReadChunk(65536);
 
          if (pBuf->GetSize() == 0)
             break;
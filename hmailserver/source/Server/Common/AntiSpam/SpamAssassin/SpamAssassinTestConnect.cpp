@@ -32,11 +32,16 @@ namespace HM
       FileUtilities::WriteToFile(tempFile, bodyText, false);
 
       std::shared_ptr<IOService> pIOService = Application::Instance()->GetIOService();
+      std::shared_ptr<IOServiceShard> shard = pIOService->GetIOServiceShard();
+      boost::asio::io_service &connectionIOService = shard ? shard->GetIOService() : pIOService->GetIOService();
 
       bool testCompleted;
 
       std::shared_ptr<Event> disconnectEvent = std::shared_ptr<Event>(new Event());
-      std::shared_ptr<SpamAssassinClient> pSAClient = std::shared_ptr<SpamAssassinClient>(new SpamAssassinClient(tempFile, pIOService->GetIOService(), pIOService->GetClientContext(), disconnectEvent, testCompleted));
+      std::shared_ptr<SpamAssassinClient> pSAClient = std::shared_ptr<SpamAssassinClient>(new SpamAssassinClient(tempFile, connectionIOService, pIOService->GetClientContext(), disconnectEvent, testCompleted));
+
+      if (shard)
+         pSAClient->SetIOServiceShard(shard);
 
       DNSResolver resolver;
 
@@ -118,7 +118,7 @@ namespace HM
       std::shared_ptr<SpamTestData> pTestData = std::shared_ptr<SpamTestData>(new SpamTestData);      
       std::shared_ptr<MessageData> pMessageData = std::shared_ptr<MessageData>(new MessageData);
       
-      pMessageData->LoadFromMessage(fileName, pMessage);
+      pMessageData->LoadHeaderFromMessage(fileName, pMessage);
 
       pTestData->SetEnvelopeFrom(sFromAddress);
       pTestData->SetOriginatingIP(iOriginatingIP);
@@ -227,7 +227,7 @@ namespace HM
          return pMessageData;
 
       pMessageData = std::shared_ptr<MessageData>(new MessageData);
-      if (!pMessageData->LoadFromMessage(PersistentMessage::GetFileName(pMessage), pMessage))
+      if (!pMessageData->LoadHeaderFromMessage(PersistentMessage::GetFileName(pMessage), pMessage))
          return pMessageData;
 
       if (config.GetAddHeaderSpam())
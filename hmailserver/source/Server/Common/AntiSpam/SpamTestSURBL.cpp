@@ -57,22 +57,27 @@ namespace HM
       std::shared_ptr<MessageData> pMessageData = pTestData->GetMessageData();
       std::shared_ptr<SURBLServers> pSURBLServers = Configuration::Instance()->GetAntiSpamConfiguration().GetSURBLServers();
 
-      SURBL surblTester;
-
+      std::vector<std::shared_ptr<SURBLServer> > activeServers;
       for(std::shared_ptr<SURBLServer> pSURBLServer : pSURBLServers->GetVector())
       {
          if (pSURBLServer->GetIsActive()) 
+            activeServers.push_back(pSURBLServer);
+      }
+
+      // The URLs are extracted once and looked up against all servers at the same time.
+      SURBL surblTester;
+      std::set<std::shared_ptr<SURBLServer> > listedBy = surblTester.Run(activeServers, pMessageData);
+
+      for(std::shared_ptr<SURBLServer> pSURBLServer : activeServers)
+      {
+         if (listedBy.find(pSURBLServer) != listedBy.end())
          {
-            if (!surblTester.Run(pSURBLServer, pMessageData))
-            {
-               // Blocked
-               int iSomeScore = pSURBLServer->GetScore();
-               std::shared_ptr<SpamTestResult> pResult = std::shared_ptr<SpamTestResult>(new SpamTestResult(GetName(), SpamTestResult::Fail, iSomeScore, pSURBLServer->GetRejectMessage()));
-
-               setSpamTestResults.insert(pResult);
-            }
-         }
+            // Blocked
+            int iSomeScore = pSURBLServer->GetScore();
+            std::shared_ptr<SpamTestResult> pResult = std::shared_ptr<SpamTestResult>(new SpamTestResult(GetName(), SpamTestResult::Fail, iSomeScore, pSURBLServer->GetRejectMessage()));
 
+            setSpamTestResults.insert(pResult);
+         }
       }      
 
 
@@ -57,11 +57,16 @@ namespace HM
       const String sFilename = PersistentMessage::GetFileName(pMessage);
       
       std::shared_ptr<IOService> pIOService = Application::Instance()->GetIOService();
+      std::shared_ptr<IOServiceShard> shard = pIOService->GetIOServiceShard();
+      boost::asio::io_service &connectionIOService = shard ? shard->GetIOService() : pIOService->GetIOService();
 
       bool testCompleted;
 
       std::shared_ptr<Event> disconnectEvent = std::shared_ptr<Event>(new Event());
-      std::shared_ptr<SpamAssassinClient> pSAClient = std::shared_ptr<SpamAssassinClient>(new SpamAssassinClient(sFilename, pIOService->GetIOService(), pIOService->GetClientContext(), disconnectEvent, testCompleted));
+      std::shared_ptr<SpamAssassinClient> pSAClient = std::shared_ptr<SpamAssassinClient>(new SpamAssassinClient(sFilename, connectionIOService, pIOService->GetClientContext(), disconnectEvent, testCompleted));
+
+      if (shard)
+         pSAClient->SetIOServiceShard(shard);
       
       String sHost = config.GetSpamAssassinHost();
       int iPort = config.GetSpamAssassinPort();
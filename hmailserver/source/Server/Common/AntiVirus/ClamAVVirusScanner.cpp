@@ -22,6 +22,9 @@ using namespace boost;
 
 namespace HM
 {
+   boost::recursive_mutex ClamAVVirusScanner::sessions_mutex_;
+   std::vector<ClamAVVirusScanner::ClamAVSession> ClamAVVirusScanner::idle_sessions_;
+
    ClamAVVirusScanner::ClamAVVirusScanner(void)
    {
    }
@@ -31,7 +34,7 @@ namespace HM
 
    }
 
-   VirusScanningResult 
+   VirusScanningResult
    ClamAVVirusScanner::Scan(const String &sFilename)
    //---------------------------------------------------------------------------()
    // DESCRIPTION:
@@ -50,41 +53,86 @@ namespace HM
    {
       LOG_DEBUG("Connecting to ClamAV virus scanner...");
 
-      int streamPort = 0;
+      bool connectionFailed = false;
+      bool reusable = false;
+
+      std::shared_ptr<SynchronousConnection> idleConnection = GetIdleSession_(hostName, primaryPort);
+      if (idleConnection)
+      {
+         LOG_DEBUG("Reusing idle ClamAV session.");
+
+         VirusScanningResult result = ScanInSession_(idleConnection, sFilename, connectionFailed, reusable);
+
+         if (reusable)
+            ReturnSession_(hostName, primaryPort, idleConnection);
+
+         // If clamd has dropped the session while it was idle, retry on a new connection.
+         if (!connectionFailed)
+            return result;
+
+         LOG_DEBUG("Idle ClamAV session was no longer usable. Opening a new session...");
+      }
 
       TimeoutCalculator calculator;
 
-      SynchronousConnection commandConnection(calculator.Calculate(IniFileSettings::Instance()->GetClamMinTimeout(), IniFileSettings::Instance()->GetClamMaxTimeout()));
-      if (!commandConnection.Connect(hostName, primaryPort))
+      std::shared_ptr<SynchronousConnection> connection =
+         std::shared_ptr<SynchronousConnection>(new SynchronousConnection(calculator.Calculate(IniFileSettings::Instance()->GetClamMinTimeout(), IniFileSettings::Instance()->GetClamMaxTimeout())));
+
+      if (!connection->Connect(hostName, primaryPort))
       {
-         return VirusScanningResult(_T("ClamAVVirusScanner::Scan"), 
+         return VirusScanningResult(_T("ClamAVVirusScanner::Scan"),
             Formatter::Format("Unable to connect to ClamAV server at {0}:{1}.", hostName, primaryPort));
       }
 
-      if (!commandConnection.Write("STREAM\r\n"))
-         return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to write STREAM command.");
-
       AnsiString readData;
-      if (!commandConnection.ReadUntil("\n", readData))
-         return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to read STREAM command response.");
+      if (!OpenSession_(*connection, readData))
+      {
+         if (readData.IsEmpty())
+            return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to start ClamAV session.");
 
-      if (!readData.StartsWith("PORT"))
          return VirusScanningResult("ClamAVVirusScanner::Scan", Formatter::Format("Protocol error. Unexpected response: {0}.", readData));
-      
-      readData.TrimRight("\n");
+      }
+
+      VirusScanningResult result = ScanInSession_(connection, sFilename, connectionFailed, reusable);
+
+      if (reusable)
+         ReturnSession_(hostName, primaryPort, connection);
+
+      return result;
+   }
+
+   bool
+   ClamAVVirusScanner::OpenSession_(SynchronousConnection &connection, AnsiString &response)
+   {
+      // Start a session so that the connection can be reused for subsequent scans, and
+      // ping clamd to verify that we're actually talking to a ClamAV server. Inside a
+      // session, every reply is prefixed with the id of the command it belongs to.
+      if (!connection.Write("nIDSESSION\nnPING\n"))
+         return false;
 
-      // Determine port.
-      std::string portString = readData.Mid(5);
-      
-      if (!StringParser::TryParseInt(portString, streamPort))
-         return VirusScanningResult("ClamAVVirusScanner::Scan", Formatter::Format("Protocol error. Unexpected response: {0} (Unable to parse port).", readData));
+      if (!connection.ReadUntil("\n", response))
+         return false;
 
-      LOG_DEBUG("Connecting to ClamAV stream port...");
-      SynchronousConnection streamConnection(15);
-      if (!streamConnection.Connect(hostName, streamPort))
-         return VirusScanningResult("ClamAVVirusScanner::Scan", Formatter::Format("Unable to connect to ClamAV stream port at {0}:{1}.", hostName, streamPort));
+      response.TrimRight("\n");
+
+      try
+      {
+         const regex expression("^\\d+: PONG$");
+         cmatch what;
+         return regex_match(response.c_str(), what, expression);
+      }
+      catch (std::runtime_error &) // regex_match will throw runtime_error if regexp is too complex.
+      {
+         return false;
+      }
+   }
+
+   VirusScanningResult
+   ClamAVVirusScanner::ScanInSession_(std::shared_ptr<SynchronousConnection> connection, const String &sFilename, bool &connectionFailed, bool &reusable)
+   {
+      connectionFailed = false;
+      reusable = false;
 
-      // Send the file on the stream socket.
       File oFile;
 
       try
@@ -93,43 +141,80 @@ namespace HM
       }
       catch (...)
       {
+         // Nothing has been sent, so the session is still in a clean state.
+         reusable = true;
+
          String sErrorMsg = Formatter::Format("Could not send file {0} via socket since it could not be opened.", sFilename);
          return VirusScanningResult("ClamAVVirusScanner::Scan", sErrorMsg);
       }
 
-      const int STREAM_BLOCK_SIZE = 4096;
+      if (!connection->Write("nINSTREAM\n"))
+      {
+         connectionFailed = true;
+         return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to write INSTREAM command.");
+      }
+
+      // The file is sent as a sequence of chunks, each prefixed with its length as a
+      // 4 byte unsigned integer in network byte order. A zero length chunk ends the stream.
       const int maxIterations = 100000;
       for (int i = 0; i < maxIterations; i++)
       {
-         std::shared_ptr<ByteBuffer> pBuf = oFile.ReadChunk(STREAM_BLOCK_SIZE);
+         std::shared_ptr<ByteBuffer> pBuf = oFile.ReadChunk(StreamChunkSize);
 
-         if (pBuf->GetSize() == 0)
-            break;
+         size_t chunkSize = pBuf->GetSize();
 
-         // Send the request.
-         if (!streamConnection.Write(*pBuf))
-            return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to write data to stream port.");
-      }
+         BYTE chunkHeader[4];
+         chunkHeader[0] = (BYTE)((chunkSize >> 24) & 0xFF);
+         chunkHeader[1] = (BYTE)((chunkSize >> 16) & 0xFF);
+         chunkHeader[2] = (BYTE)((chunkSize >> 8) & 0xFF);
+         chunkHeader[3] = (BYTE)(chunkSize & 0xFF);
 
-      streamConnection.Close();
+         ByteBuffer chunk;
+         chunk.Add(chunkHeader, sizeof(chunkHeader));
+         chunk.Add(pBuf);
+
+         if (!connection->Write(chunk))
+         {
+            connectionFailed = true;
+            return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to write data to ClamAV.");
+         }
+
+         if (chunkSize == 0)
+            break;
+      }
 
-      if (!commandConnection.ReadUntil("\n", readData))
+      AnsiString readData;
+      if (!connection->ReadUntil("\n", readData))
+      {
+         connectionFailed = true;
          return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to read response (after streaming).");
+      }
 
       readData.TrimRight("\n");
 
       // Parse the response and see if a virus was reported.
       try
       {
-         const regex expression("^stream.*: (.*) FOUND$"); 
-         cmatch what; 
-         if(regex_match(readData.c_str(), what, expression)) 
+         const regex virusExpression("^(\\d+: )?stream.*: (.*) FOUND$");
+         const regex errorExpression("^(\\d+: )?(.*) ERROR$");
+         cmatch what;
+         if (regex_match(readData.c_str(), what, virusExpression))
+         {
+            reusable = true;
+
+            LOG_DEBUG("Virus detected: " + what[2]);
+            return VirusScanningResult(VirusScanningResult::VirusFound, String(what[2]));
+         }
+         else if (regex_match(readData.c_str(), what, errorExpression))
          {
-            LOG_DEBUG("Virus detected: " + what[1]);
-            return VirusScanningResult(VirusScanningResult::VirusFound, String(what[1]));
+            // clamd ends the session after an INSTREAM error, for example
+            // if StreamMaxLength has been exceeded.
+            return VirusScanningResult("ClamAVVirusScanner::Scan", Formatter::Format("ClamAV reported an error: {0}", readData));
          }
          else
          {
+            reusable = true;
+
             LOG_DEBUG("No virus detected: " + readData);
             return VirusScanningResult(VirusScanningResult::NoVirusFound, Formatter::Format("Result: {0}", readData));
          }
@@ -138,7 +223,52 @@ namespace HM
       {
          return VirusScanningResult("ClamAVVirusScanner::Scan", "Unable to parse regular expression.");
       }
+   }
+
+   std::shared_ptr<SynchronousConnection>
+   ClamAVVirusScanner::GetIdleSession_(const String &hostName, int port)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(sessions_mutex_);
+
+      int currentTime = GetTickCount();
+
+      // Most recently used sessions are at the back.
+      while (!idle_sessions_.empty())
+      {
+         ClamAVSession session = idle_sessions_.back();
+         idle_sessions_.pop_back();
+
+         int idleSeconds = (currentTime - session.last_used_) / 1000;
+         if (idleSeconds < 0 || idleSeconds >= MaxSessionIdleSeconds)
+            continue;
+
+         if (session.port_ != port || session.host_name_.CompareNoCase(hostName) != 0)
+            continue;
+
+         return session.connection_;
+      }
+
+      return nullptr;
+   }
+
+   void
+   ClamAVVirusScanner::ReturnSession_(const String &hostName, int port, std::shared_ptr<SynchronousConnection> connection)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(sessions_mutex_);
+
+      if (idle_sessions_.size() >= (size_t) MaxIdleSessions)
+      {
+         // Keep the pool bounded. The dropped session is closed when the last
+         // reference to it goes away.
+         return;
+      }
+
+      ClamAVSession session;
+      session.host_name_ = hostName;
+      session.port_ = port;
+      session.last_used_ = GetTickCount();
+      session.connection_ = connection;
 
-      
+      idle_sessions_.push_back(session);
    }
 }
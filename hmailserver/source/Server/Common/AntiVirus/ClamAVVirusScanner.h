@@ -9,6 +9,8 @@ using boost::asio::ip::tcp;
 
 namespace HM
 {
+   class SynchronousConnection;
+
    class ClamAVVirusScanner
    {
    public:
@@ -17,6 +19,35 @@ namespace HM
 
       static VirusScanningResult Scan(const String &sFilename);
       static VirusScanningResult Scan(const String &hostName, int primaryPort, const String &sFilename);
+
+   private:
+
+      enum Settings
+      {
+         StreamChunkSize = 64 * 1024,
+         MaxIdleSessions = 16,
+
+         // clamd closes idle sessions after IdleTimeout (30 seconds by default). Don't
+         // hand out sessions which are close to that, since the scan would fail anyway.
+         MaxSessionIdleSeconds = 20
+      };
+
+      struct ClamAVSession
+      {
+         String host_name_;
+         int port_;
+         int last_used_;
+         std::shared_ptr<SynchronousConnection> connection_;
+      };
+
+      static VirusScanningResult ScanInSession_(std::shared_ptr<SynchronousConnection> connection, const String &sFilename, bool &connectionFailed, bool &reusable);
+      static bool OpenSession_(SynchronousConnection &connection, AnsiString &response);
+
+      static std::shared_ptr<SynchronousConnection> GetIdleSession_(const String &hostName, int port);
+      static void ReturnSession_(const String &hostName, int port, std::shared_ptr<SynchronousConnection> connection);
+
+      static boost::recursive_mutex sessions_mutex_;
+      static std::vector<ClamAVSession> idle_sessions_;
    };
 
-}
\ No newline at end of file
+}
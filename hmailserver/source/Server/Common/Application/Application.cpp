@@ -13,11 +13,13 @@
 #include <winerror.h>
 
 #include "MessageIndexer.h"
+#include "LastLogonTimeWriter.h"
 
 #include "FolderManager.h"
 #include "../Cache/CacheContainer.h"
 
 #include "../AntiSpam/SpamProtection.h"
+#include "../AntiSpam/SURBLLookupPool.h"
 #include "../AntiVirus/VirusScanner.h"
 
 #include "../SQL/DALConnection.h"
@@ -325,6 +327,8 @@ namespace HM
 
       CreateScheduledTasks_();
 
+      LastLogonTimeWriter::Instance()->Start();
+
       if (Configuration::Instance()->GetMessageIndexing())
       {
          MessageIndexer::Instance()->Start();
@@ -426,6 +430,12 @@ namespace HM
       if (folder_manager_) folder_manager_.reset();
 
       MessageIndexer::Instance()->Stop();
+
+      // The connections have been closed, so no more messages will be spam tested.
+      SURBLLookupPool::Instance()->Stop();
+
+      // The connections have been closed, so no more logons will be recorded.
+      LastLogonTimeWriter::Instance()->Stop();
       
       ServerStatus::Instance()->SetState(ServerStatus::StateStopped);
 
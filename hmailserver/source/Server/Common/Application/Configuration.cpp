@@ -29,7 +29,7 @@
 #include "..\BO\SSLCertificates.h"
 
 #include "..\Persistence\PersistentServerMessage.h"
-#include "..\Persistence\PersistentLogonFailure.h"
+#include "..\Util\LogonFailureTracker.h"
 
 #include "../Application/MessageIndexer.h"
 
@@ -571,8 +571,8 @@ namespace HM
    bool 
    Configuration::ClearOldLogonFailures()
    {
-      HM::PersistentLogonFailure failure;
-      return failure.ClearOldFailures(-1);
+      LogonFailureTracker::Instance()->Clear();
+      return true;
    }
 
    int
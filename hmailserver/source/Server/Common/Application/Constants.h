@@ -129,4 +129,4 @@
 #define PROPERTY_CLAMAV_PORT                 _T("ClamAVPort")
 
 
-#define REQUIRED_DB_VERSION            5601
+#define REQUIRED_DB_VERSION            5602
@@ -7,6 +7,7 @@
 #include "../BO/Account.h"
 #include "../BO/IMAPFolders.h"
 #include "../BO/IMAPFolder.h"
+#include "../Persistence/PersistentIMAPFolder.h"
 
 #include "../../IMAP/IMAPFolderContainer.h"
 #include "../../IMAP/MessagesContainer.h"
@@ -106,8 +107,15 @@ namespace HM
       return true;
    }
 
-   bool 
-   FolderManager::UpdateMessageFlags(int accountID, int folderID, __int64 messageID, int flags)
+   bool
+   FolderManager::UpdateMessageFlags(int accountID, int folderID, const std::map<__int64, short> &messageFlags, __int64 &modSeq)
+   {
+      std::set<__int64> modifiedMessageIDs;
+      return UpdateMessageFlags(accountID, folderID, messageFlags, -1, modSeq, modifiedMessageIDs);
+   }
+
+   bool
+   FolderManager::UpdateMessageFlags(int accountID, int folderID, const std::map<__int64, short> &messageFlags, __int64 unchangedSince, __int64 &modSeq, std::set<__int64> &modifiedMessageIDs)
    {
       std::shared_ptr<IMAPFolders> folders;
       if (accountID > 0)
@@ -122,13 +130,26 @@ namespace HM
       if (!folder)
          return false;
 
-      std::shared_ptr<Message> message = folder->GetMessages()->GetItemByDBID(messageID);
+      modSeq = PersistentIMAPFolder::GetNextModSeq(accountID, folderID);
+      if (modSeq == 0)
+         return false;
 
-      if (!message)
+      // Save first, so that the cached messages aren't changed if the update fails.
+      if (!PersistentMessage::SaveFlags(messageFlags, modSeq, unchangedSince, modifiedMessageIDs))
          return false;
 
-      message->SetFlags(flags);
-      return PersistentMessage::SaveFlags(message);
+      if (modifiedMessageIDs.empty())
+      {
+         folder->GetMessages()->SetMessageFlags(messageFlags, modSeq);
+         return true;
+      }
+
+      std::map<__int64, short> savedFlags = messageFlags;
+      for (__int64 messageID : modifiedMessageIDs)
+         savedFlags.erase(messageID);
+
+      folder->GetMessages()->SetMessageFlags(savedFlags, modSeq);
+      return true;
    }
 
 
@@ -18,7 +18,11 @@ namespace HM
       bool GetInboxMessages(int accountID, std::vector<std::shared_ptr<Message> > &result);
       bool DeleteInboxMessages(int accountID, std::set<int> uids, const std::function<void()> &callbackEvery1000Message);
 
-      bool UpdateMessageFlags(int accountID, int folderID, __int64 messageID, int flags);
+      bool UpdateMessageFlags(int accountID, int folderID, const std::map<__int64, short> &messageFlags, __int64 &modSeq);
+      bool UpdateMessageFlags(int accountID, int folderID, const std::map<__int64, short> &messageFlags, __int64 unchangedSince, __int64 &modSeq, std::set<__int64> &modifiedMessageIDs);
+      // All messages changed in one call get the same new modification sequence. If
+      // unchangedSince is zero or above, messages with a higher mod-sequence in the
+      // database are left alone and returned in modifiedMessageIDs.
 
 	private:
 
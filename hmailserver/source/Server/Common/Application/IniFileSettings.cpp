@@ -53,12 +53,20 @@ namespace HM
       indexer_full_minutes_(0),
       indexer_full_limit_(0),
       indexer_quick_limit_(0),
+      indexer_threads_(0),
+      indexer_batch_size_(0),
       load_header_read_size_(0),
       load_body_read_size_(0),
       blocked_iphold_seconds_(0),
       smtpdmax_size_drop_(0),
       backup_messages_dbonly_(false),
-      add_xauth_user_ip_(false)
+      add_xauth_user_ip_(false),
+      ioservice_per_thread_(false),
+      ioservice_shard_policy_(0),
+      max_connections_per_ip_(0),
+      max_connections_per_network_(0),
+      max_connections_per_ip_per_minute_(0),
+      credential_cache_seconds_(0)
       
    {
 
@@ -176,12 +184,20 @@ namespace HM
       indexer_full_minutes_ =  ReadIniSettingInteger_("Settings", "IndexerFullMinutes",720);
       indexer_full_limit_ =  ReadIniSettingInteger_("Settings", "IndexerFullLimit",25000);
       indexer_quick_limit_ =  ReadIniSettingInteger_("Settings", "IndexerQuickLimit",1000);
+      indexer_threads_ =  ReadIniSettingInteger_("Settings", "IndexerThreads",4);
+      indexer_batch_size_ =  ReadIniSettingInteger_("Settings", "IndexerBatchSize",500);
       load_header_read_size_ =  ReadIniSettingInteger_("Settings", "LoadHeaderReadSize",4000);
       load_body_read_size_ =  ReadIniSettingInteger_("Settings", "LoadBodyReadSize",4000);
       blocked_iphold_seconds_ =  ReadIniSettingInteger_("Settings", "BlockedIPHoldSeconds",0);
       smtpdmax_size_drop_ =  ReadIniSettingInteger_("Settings", "SMTPDMaxSizeDrop",0);
       backup_messages_dbonly_ =  ReadIniSettingInteger_("Settings", "BackupMessagesDBOnly",0) == 1;
       add_xauth_user_ip_ =  ReadIniSettingInteger_("Settings", "AddXAuthUserIP",1) == 1;
+      ioservice_per_thread_ =  ReadIniSettingInteger_("Settings", "IOServicePerThread",0) == 1;
+      ioservice_shard_policy_ =  ReadIniSettingInteger_("Settings", "IOServiceShardPolicy",0);
+      max_connections_per_ip_ =  ReadIniSettingInteger_("Settings", "MaxConnectionsPerIP",0);
+      max_connections_per_network_ =  ReadIniSettingInteger_("Settings", "MaxConnectionsPerNetwork",0);
+      max_connections_per_ip_per_minute_ =  ReadIniSettingInteger_("Settings", "MaxConnectionsPerIPPerMinute",0);
+      credential_cache_seconds_ =  ReadIniSettingInteger_("Settings", "CredentialCacheSeconds",0);
    }
 
    bool 
@@ -101,12 +101,20 @@ namespace HM
       int GetIndexerFullMinutes () {return indexer_full_minutes_; }
       int GetIndexerFullLimit () {return indexer_full_limit_; }
       int GetIndexerQuickLimit () {return indexer_quick_limit_; }
+      int GetIndexerThreads () {return indexer_threads_; }
+      int GetIndexerBatchSize () {return indexer_batch_size_; }
       int GetLoadHeaderReadSize () {return load_header_read_size_; }
       int GetLoadBodyReadSize () {return load_body_read_size_; }
       int GetBlockedIPHoldSeconds () {return blocked_iphold_seconds_; }
       int GetSMTPDMaxSizeDrop () {return smtpdmax_size_drop_; }
       bool GetBackupMessagesDBOnly () const { return backup_messages_dbonly_; }
       bool GetAddXAuthUserIP () const { return add_xauth_user_ip_; }
+      bool GetIOServicePerThread () const { return ioservice_per_thread_; }
+      int GetIOServiceShardPolicy () const { return ioservice_shard_policy_; }
+      int GetMaxConnectionsPerIP () const { return max_connections_per_ip_; }
+      int GetMaxConnectionsPerNetwork () const { return max_connections_per_network_; }
+      int GetMaxConnectionsPerIPPerMinute () const { return max_connections_per_ip_per_minute_; }
+      int GetCredentialCacheSeconds () const { return credential_cache_seconds_; }
 
    private:   
 
@@ -176,12 +184,20 @@ namespace HM
       int indexer_full_minutes_;
       int indexer_full_limit_;
       int indexer_quick_limit_;
+      int indexer_threads_;
+      int indexer_batch_size_;
       int load_header_read_size_;
       int load_body_read_size_;
       int blocked_iphold_seconds_;
       int smtpdmax_size_drop_;
       bool backup_messages_dbonly_;
       bool add_xauth_user_ip_;
+      bool ioservice_per_thread_;
+      int ioservice_shard_policy_;
+      int max_connections_per_ip_;
+      int max_connections_per_network_;
+      int max_connections_per_ip_per_minute_;
+      int credential_cache_seconds_;
 
    };
 }
@@ -0,0 +1,103 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "LastLogonTimeWriter.h"
+
+#include "ExceptionHandler.h"
+#include "../Persistence/PersistentAccount.h"
+#include "../Util/Time.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   LastLogonTimeWriter::LastLogonTimeWriter()
+   {
+
+   }
+
+   void
+   LastLogonTimeWriter::Start()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(starter_mutex_);
+
+      if (worker_thread_.joinable())
+      {
+         if (!worker_thread_.timed_join(boost::posix_time::milliseconds(1)))
+         {
+            // already started.
+            return;
+         }
+      }
+
+      std::function<void ()> func = std::bind( &LastLogonTimeWriter::WorkerFunc, this );
+      worker_thread_ = boost::thread(func);
+   }
+
+   void
+   LastLogonTimeWriter::Stop()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(starter_mutex_);
+
+      if (worker_thread_.joinable())
+      {
+         worker_thread_.interrupt();
+         worker_thread_.join();
+      }
+
+      Write_();
+   }
+
+   void
+   LastLogonTimeWriter::WorkerFunc()
+   {
+      boost::function<void()> func = boost::bind( &LastLogonTimeWriter::WorkerFuncInternal, this );
+      ExceptionHandler::Run("LastLogonTimeWriter", func);
+   }
+
+   void
+   LastLogonTimeWriter::WorkerFuncInternal()
+   {
+      while (true)
+      {
+         boost::this_thread::sleep_for(boost::chrono::seconds(WriteIntervalSeconds));
+
+         Write_();
+      }
+   }
+
+   void
+   LastLogonTimeWriter::SetLastLogonTime(__int64 accountID)
+   {
+      String currentTime = Time::GetCurrentDateTime();
+
+      boost::lock_guard<boost::mutex> guard(mutex_);
+      pending_[accountID] = currentTime;
+   }
+
+   void
+   LastLogonTimeWriter::Write_()
+   {
+      std::map<__int64, String> pending;
+
+      {
+         boost::lock_guard<boost::mutex> guard(mutex_);
+         pending.swap(pending_);
+      }
+
+      if (pending.empty())
+         return;
+
+      // Accounts which logged on in the same second are updated together.
+      std::map<String, std::vector<__int64> > accountsByTime;
+      for (auto iter = pending.begin(); iter != pending.end(); iter++)
+         accountsByTime[(*iter).second].push_back((*iter).first);
+
+      for (auto iter = accountsByTime.begin(); iter != accountsByTime.end(); iter++)
+         PersistentAccount::UpdateLastLogonTime((*iter).second, (*iter).first);
+   }
+}
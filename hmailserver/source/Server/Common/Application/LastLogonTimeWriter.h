@@ -0,0 +1,42 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include <boost/thread.hpp>
+
+namespace HM
+{
+   // Collects the last logon times of accounts and writes them to the database
+   // every few seconds, instead of updating the account on every logon. An account
+   // which logs on many times between two writes is only updated once.
+   class LastLogonTimeWriter : public Singleton<LastLogonTimeWriter>
+   {
+   public:
+      LastLogonTimeWriter();
+
+      void Start();
+      void Stop();
+      // Stops the writer thread and writes the times which have not been written yet.
+
+      void SetLastLogonTime(__int64 accountID);
+
+   private:
+
+      enum Settings
+      {
+         WriteIntervalSeconds = 5
+      };
+
+      void WorkerFunc();
+      void WorkerFuncInternal();
+
+      void Write_();
+
+      boost::thread worker_thread_;
+      boost::recursive_mutex starter_mutex_;
+
+      boost::mutex mutex_;
+      std::map<__int64, String> pending_;
+   };
+}
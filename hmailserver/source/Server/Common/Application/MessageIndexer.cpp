@@ -20,8 +20,26 @@
 
 namespace HM
 {
+   // Shared between the writer, which runs on the indexer thread, and the
+   // reader threads which load and parse the message headers.
+   struct MessageIndexer::IndexingState
+   {
+      boost::mutex mutex_;
+      boost::condition_variable changed_;
+
+      std::vector<std::shared_ptr<PersistentMessageMetaData::MessageInfo> > messages_;
+      size_t next_message_;
+
+      std::deque<std::shared_ptr<MessageMetaData> > parsed_;
+      size_t max_parsed_;
+
+      int active_readers_;
+      bool stop_;
+   };
+
    MessageIndexer::MessageIndexer() :
-      iIndexRunCount(0)
+      iIndexRunCount(0),
+      indexing_rate_(0)
    {
       
    }
@@ -111,6 +129,9 @@ namespace HM
         iIndexRunCount = 1;
       }
 
+      int runStartTime = GetTickCount();
+      int messagesIndexed = 0;
+
       while (true)
       {
          
@@ -124,44 +145,207 @@ namespace HM
             return;
          }
 
-         for(std::shared_ptr<PersistentMessageMetaData::MessageInfo> messageToIndex : messagesToIndex)
+         if (!IndexBatch_(messagesToIndex, persistentMetaData))
          {
-            boost::this_thread::interruption_point();
-
-            AnsiString headerText = PersistentMessage::LoadHeader(messageToIndex->FileName, false);
+            LOG_DEBUG("Error saving the index.")
+            // Error saving. Abort now...
+            return;
+         }
 
-            MimeHeader header;
-            header.Load(headerText, headerText.GetLength(), true);
+         messagesIndexed += (int) messagesToIndex.size();
+         UpdateIndexingRate_(messagesIndexed, runStartTime);
+      }
+      iIndexRunCount++;
+   }
 
+   bool
+   MessageIndexer::IndexBatch_(const std::set<std::shared_ptr<PersistentMessageMetaData::MessageInfo> > &messagesToIndex, PersistentMessageMetaData &persistentMetaData)
+   {
+      // Reading and parsing the message files is done by a pool of reader threads,
+      // while this thread writes the parsed meta data to the database, many rows
+      // per transaction.
+      int transactionSize = max(1, IniFileSettings::Instance()->GetIndexerBatchSize());
+      int readerCount = max(1, IniFileSettings::Instance()->GetIndexerThreads());
+
+      std::shared_ptr<IndexingState> state = std::shared_ptr<IndexingState>(new IndexingState);
+      state->messages_.assign(messagesToIndex.begin(), messagesToIndex.end());
+      state->next_message_ = 0;
+      state->max_parsed_ = transactionSize * MaxQueuedBatches;
+      state->active_readers_ = readerCount;
+      state->stop_ = false;
+
+      boost::thread_group readers;
+      for (int i = 0; i < readerCount; i++)
+         readers.create_thread(boost::bind(&MessageIndexer::ReaderFunc_, state));
+
+      bool result = true;
+
+      try
+      {
+         while (true)
+         {
+            std::vector<std::shared_ptr<MessageMetaData> > transaction;
 
-            String dateString = header.GetUnicodeFieldValue("Date");
-            DateTime date = Time::GetDateTimeFromMimeHeader(dateString);
+            {
+               boost::unique_lock<boost::mutex> lock(state->mutex_);
 
-            String from = header.GetUnicodeFieldValue("From");
-            String subject = header.GetUnicodeFieldValue("Subject");
-            String cc = header.GetUnicodeFieldValue("CC");
-            String to = header.GetUnicodeFieldValue("TO");
+               while ((int) state->parsed_.size() < transactionSize && state->active_readers_ > 0)
+                  state->changed_.wait(lock);
 
-            std::shared_ptr<MessageMetaData> metaData = std::shared_ptr<MessageMetaData>(new MessageMetaData);
+               while (!state->parsed_.empty() && (int) transaction.size() < transactionSize)
+               {
+                  transaction.push_back(state->parsed_.front());
+                  state->parsed_.pop_front();
+               }
 
-            metaData->SetAccountID(messageToIndex->AccountID);
-            metaData->SetFolderID(messageToIndex->FolderID);
-            metaData->SetMessageID(messageToIndex->MessageID);
+               state->changed_.notify_all();
+            }
 
-            metaData->SetDate(date);
-            metaData->SetFrom(from);
-            metaData->SetSubject(subject);
-            metaData->SetCC(cc);
-            metaData->SetTo(to);
+            if (transaction.empty())
+               break;
 
-            if (!persistentMetaData.SaveObject(metaData))
+            if (!persistentMetaData.SaveObjects(transaction))
             {
-               LOG_DEBUG("Error saving the index.")
-               // Error saving. Abort now...
-               return;
+               result = false;
+               break;
             }
          }
       }
-      iIndexRunCount++;
+      catch (...)
+      {
+         // Most likely the indexer is being stopped. Make sure the readers are
+         // gone before leaving.
+         {
+            boost::lock_guard<boost::mutex> guard(state->mutex_);
+            state->stop_ = true;
+            state->changed_.notify_all();
+         }
+
+         readers.join_all();
+         throw;
+      }
+
+      {
+         boost::lock_guard<boost::mutex> guard(state->mutex_);
+         state->stop_ = true;
+         state->changed_.notify_all();
+      }
+
+      readers.join_all();
+
+      return result;
+   }
+
+   void
+   MessageIndexer::ReaderFunc_(std::shared_ptr<IndexingState> state)
+   {
+      boost::function<void()> func = boost::bind(&MessageIndexer::ReadMessages_, state);
+      ExceptionHandler::Run("MessageIndexer", func);
+
+      boost::lock_guard<boost::mutex> guard(state->mutex_);
+      state->active_readers_--;
+      state->changed_.notify_all();
+   }
+
+   void
+   MessageIndexer::ReadMessages_(std::shared_ptr<IndexingState> state)
+   {
+      while (true)
+      {
+         std::shared_ptr<PersistentMessageMetaData::MessageInfo> messageToIndex;
+
+         {
+            boost::unique_lock<boost::mutex> lock(state->mutex_);
+
+            // Don't parse too far ahead of the writer.
+            while (!state->stop_ && state->parsed_.size() >= state->max_parsed_)
+               state->changed_.wait(lock);
+
+            if (state->stop_ || state->next_message_ >= state->messages_.size())
+               return;
+
+            messageToIndex = state->messages_[state->next_message_];
+            state->next_message_++;
+         }
+
+         std::shared_ptr<MessageMetaData> metaData = ParseMetaData_(messageToIndex);
+
+         boost::lock_guard<boost::mutex> guard(state->mutex_);
+         state->parsed_.push_back(metaData);
+         state->changed_.notify_all();
+      }
+   }
+
+   std::shared_ptr<MessageMetaData>
+   MessageIndexer::ParseMetaData_(std::shared_ptr<PersistentMessageMetaData::MessageInfo> messageToIndex)
+   {
+      AnsiString headerText = PersistentMessage::LoadHeader(messageToIndex->FileName, false);
+
+      MimeHeader header;
+      header.Load(headerText, headerText.GetLength(), true);
+
+      String dateString = header.GetUnicodeFieldValue("Date");
+      DateTime date = Time::GetDateTimeFromMimeHeader(dateString);
+
+      String from = header.GetUnicodeFieldValue("From");
+      String subject = header.GetUnicodeFieldValue("Subject");
+      String cc = header.GetUnicodeFieldValue("CC");
+      String to = header.GetUnicodeFieldValue("TO");
+
+      std::shared_ptr<MessageMetaData> metaData = std::shared_ptr<MessageMetaData>(new MessageMetaData);
+
+      metaData->SetAccountID(messageToIndex->AccountID);
+      metaData->SetFolderID(messageToIndex->FolderID);
+      metaData->SetMessageID(messageToIndex->MessageID);
+
+      metaData->SetDate(date);
+      metaData->SetFrom(from);
+      metaData->SetSubject(subject);
+      metaData->SetCC(cc);
+      metaData->SetTo(to);
+
+      return metaData;
+   }
+
+   void
+   MessageIndexer::UpdateIndexingRate_(int messagesIndexed, int runStartTime)
+   {
+      int elapsedMilliseconds = (int) GetTickCount() - runStartTime;
+      if (elapsedMilliseconds <= 0)
+         return;
+
+      boost::lock_guard<boost::recursive_mutex> guard(statistics_mutex_);
+      indexing_rate_ = (int) (((__int64) messagesIndexed * 1000) / elapsedMilliseconds);
+   }
+
+   int
+   MessageIndexer::GetIndexingRate()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(statistics_mutex_);
+      return indexing_rate_;
+   }
+
+   int
+   MessageIndexer::GetBacklog()
+   {
+      PersistentMessageMetaData persistentMetaData;
+
+      int backlog = PersistentMessage::GetTotalMessageCountDelivered() - persistentMetaData.GetTotalMessageCount();
+
+      return max(0, backlog);
+   }
+
+   int
+   MessageIndexer::GetEstimatedSecondsRemaining()
+   {
+      int backlog = GetBacklog();
+      if (backlog == 0)
+         return 0;
+
+      int rate = GetIndexingRate();
+      if (rate == 0)
+         return -1;
+
+      return backlog / rate;
    }
 }
@@ -5,6 +5,8 @@
 
 #include <boost/thread.hpp>
 
+#include "../Persistence/PersistentMessageMetaData.h"
+
 namespace HM
 {
 
@@ -19,13 +21,36 @@ namespace HM
 
       void IndexNow();
 
+      int GetIndexingRate();
+      // Number of messages indexed per second during the latest indexing run.
+
+      int GetBacklog();
+      // Number of delivered messages which have not been indexed yet.
+
+      int GetEstimatedSecondsRemaining();
+      // Estimated time until the backlog has been indexed, or -1 if unknown.
+
    private:
    
+      enum Settings
+      {
+         // Number of batches which the readers may parse ahead of the writer.
+         MaxQueuedBatches = 2
+      };
+
+      struct IndexingState;
 
       void WorkerFunc();
       void WorkerFuncInternal();
 
       void IndexMessages_();
+      bool IndexBatch_(const std::set<std::shared_ptr<PersistentMessageMetaData::MessageInfo> > &messagesToIndex, PersistentMessageMetaData &persistentMetaData);
+
+      static void ReaderFunc_(std::shared_ptr<IndexingState> state);
+      static void ReadMessages_(std::shared_ptr<IndexingState> state);
+      static std::shared_ptr<MessageMetaData> ParseMetaData_(std::shared_ptr<PersistentMessageMetaData::MessageInfo> messageToIndex);
+
+      void UpdateIndexingRate_(int messagesIndexed, int runStartTime);
 
       boost::thread workerThread_;
 	   int iIndexRunCount;
@@ -33,5 +58,8 @@ namespace HM
       boost::recursive_mutex starterMutex_;
 
       Event index_now_;
+
+      boost::recursive_mutex statistics_mutex_;
+      int indexing_rate_;
    };
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include "RemoveExpiredRecords.h"
 
 #include "../Persistence/PersistentSecurityRange.h"
-#include "../Persistence/PersistentLogonFailure.h"
+#include "../Util/LogonFailureTracker.h"
 
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
@@ -36,8 +36,7 @@ namespace HM
       {
          int logonFailureMinutes = Configuration::Instance()->GetMaxLogonAttemptsWithin();
          
-         PersistentLogonFailure persistentLogonFailure;
-         persistentLogonFailure.ClearOldFailures(logonFailureMinutes);
+         LogonFailureTracker::Instance()->RemoveExpired(logonFailureMinutes);
       }
    }
 
@@ -38,6 +38,12 @@ namespace HM
          sSQL.Format(_T("select * from hm_domain_aliases order by daid asc"), domain_id_);
 
       DBLoad_(sSQL);
+
+      domain_ids_.clear();
+
+      // If the same alias has been added twice, the first one wins.
+      for (std::shared_ptr<DomainAlias> pFA : vecObjects)
+         domain_ids_.insert(std::make_pair(pFA->GetAlias().ToLower(), pFA->GetDomainID()));
    }
 
    String 
@@ -46,28 +52,21 @@ namespace HM
       const String sDomainName = StringParser::ExtractDomain(sAddress);
       const String sMailbox = StringParser::ExtractAddress(sAddress);
 
-      // Iterate over the domains to find a match.
-      auto iterAccount = vecObjects.begin();
+      String sLowerDomainName = sDomainName;
+      sLowerDomainName.ToLower();
+
+      auto iter = domain_ids_.find(sLowerDomainName);
+      if (iter == domain_ids_.end())
+         return sAddress;
+
+      std::shared_ptr<const Domain> pDomain = CacheContainer::Instance()->GetDomain((*iter).second);
       
-      for(std::shared_ptr<DomainAlias> pFA : vecObjects)
-      {
-         if (pFA->GetAlias().CompareNoCase(sDomainName) == 0)
-         {
-            // We found the domain ID
-            __int64 iDomainID = pFA->GetDomainID();
-         
-            std::shared_ptr<const Domain> pDomain = CacheContainer::Instance()->GetDomain(iDomainID);
-            
-            if (!pDomain)
-               return sAddress;
-
-            String sRetVal = sMailbox + "@" + pDomain->GetName();
-         
-            return sRetVal; 
-         }
-      }
-
-      return sAddress;
+      if (!pDomain)
+         return sAddress;
+
+      String sRetVal = sMailbox + "@" + pDomain->GetName();
+   
+      return sRetVal;
    }
 
    bool
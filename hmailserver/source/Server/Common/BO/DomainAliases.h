@@ -27,5 +27,8 @@ namespace HM
    private:
 
       __int64 domain_id_;
+
+      // Lower-cased alias name -> domain ID, built when the aliases are loaded.
+      std::map<String, __int64> domain_ids_;
    };
 }
\ No newline at end of file
@@ -0,0 +1,249 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "FolderSnapshot.h"
+#include "Message.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   FolderSnapshot::FolderSnapshot() :
+      uids_ascending_(true),
+      seen_count_(0),
+      first_unseen_uid_(0)
+   {
+
+   }
+
+   std::shared_ptr<const FolderSnapshot>
+   FolderSnapshot::Create(const std::vector<std::shared_ptr<Message> > &messages)
+   {
+      std::shared_ptr<std::vector<unsigned int> > uids = std::shared_ptr<std::vector<unsigned int> >(new std::vector<unsigned int>());
+      std::shared_ptr<std::vector<__int64> > messageIDs = std::shared_ptr<std::vector<__int64> >(new std::vector<__int64>());
+      std::shared_ptr<std::vector<short> > flags = std::shared_ptr<std::vector<short> >(new std::vector<short>());
+      std::shared_ptr<std::vector<int> > sizes = std::shared_ptr<std::vector<int> >(new std::vector<int>());
+      std::shared_ptr<std::vector<__int64> > modSeqs = std::shared_ptr<std::vector<__int64> >(new std::vector<__int64>());
+      std::shared_ptr<std::vector<unsigned int> > createTimes = std::shared_ptr<std::vector<unsigned int> >(new std::vector<unsigned int>());
+      std::shared_ptr<std::vector<char> > arena = std::shared_ptr<std::vector<char> >(new std::vector<char>());
+
+      AddMessages_(messages, 0, *uids, *messageIDs, *flags, *sizes, *modSeqs, *createTimes, *arena);
+
+      std::shared_ptr<FolderSnapshot> snapshot = std::shared_ptr<FolderSnapshot>(new FolderSnapshot());
+      snapshot->uids_ = uids;
+      snapshot->message_ids_ = messageIDs;
+      snapshot->flags_ = flags;
+      snapshot->sizes_ = sizes;
+      snapshot->modseqs_ = modSeqs;
+      snapshot->create_times_ = createTimes;
+      snapshot->arena_ = arena;
+
+      for (size_t i = 1; i < uids->size(); i++)
+      {
+         if ((*uids)[i] <= (*uids)[i - 1])
+         {
+            snapshot->uids_ascending_ = false;
+            break;
+         }
+      }
+
+      snapshot->UpdateFlagSummary_();
+
+      return snapshot;
+   }
+
+   std::shared_ptr<const FolderSnapshot>
+   FolderSnapshot::Append(const std::vector<std::shared_ptr<Message> > &messages, size_t firstNewMessage) const
+   {
+      if (firstNewMessage >= messages.size())
+         return shared_from_this();
+
+      std::shared_ptr<std::vector<unsigned int> > uids = std::shared_ptr<std::vector<unsigned int> >(new std::vector<unsigned int>(*uids_));
+      std::shared_ptr<std::vector<__int64> > messageIDs = std::shared_ptr<std::vector<__int64> >(new std::vector<__int64>(*message_ids_));
+      std::shared_ptr<std::vector<short> > flags = std::shared_ptr<std::vector<short> >(new std::vector<short>(*flags_));
+      std::shared_ptr<std::vector<int> > sizes = std::shared_ptr<std::vector<int> >(new std::vector<int>(*sizes_));
+      std::shared_ptr<std::vector<__int64> > modSeqs = std::shared_ptr<std::vector<__int64> >(new std::vector<__int64>(*modseqs_));
+      std::shared_ptr<std::vector<unsigned int> > createTimes = std::shared_ptr<std::vector<unsigned int> >(new std::vector<unsigned int>(*create_times_));
+      std::shared_ptr<std::vector<char> > arena = std::shared_ptr<std::vector<char> >(new std::vector<char>(*arena_));
+
+      size_t previousCount = uids->size();
+
+      AddMessages_(messages, firstNewMessage, *uids, *messageIDs, *flags, *sizes, *modSeqs, *createTimes, *arena);
+
+      std::shared_ptr<FolderSnapshot> snapshot = std::shared_ptr<FolderSnapshot>(new FolderSnapshot(*this));
+      snapshot->uids_ = uids;
+      snapshot->message_ids_ = messageIDs;
+      snapshot->flags_ = flags;
+      snapshot->sizes_ = sizes;
+      snapshot->modseqs_ = modSeqs;
+      snapshot->create_times_ = createTimes;
+      snapshot->arena_ = arena;
+
+      for (size_t i = max(previousCount, (size_t) 1); i < uids->size() && snapshot->uids_ascending_; i++)
+      {
+         if ((*uids)[i] <= (*uids)[i - 1])
+            snapshot->uids_ascending_ = false;
+      }
+
+      snapshot->UpdateFlagSummary_();
+
+      return snapshot;
+   }
+
+   std::shared_ptr<const FolderSnapshot>
+   FolderSnapshot::SetFlags(const std::vector<std::pair<size_t, short> > &changes, __int64 modSeq) const
+   {
+      if (changes.empty())
+         return shared_from_this();
+
+      std::shared_ptr<std::vector<short> > newFlags = std::shared_ptr<std::vector<short> >(new std::vector<short>(*flags_));
+      std::shared_ptr<std::vector<__int64> > newModSeqs = std::shared_ptr<std::vector<__int64> >(new std::vector<__int64>(*modseqs_));
+
+      for (auto change : changes)
+      {
+         if (change.first < newFlags->size())
+         {
+            (*newFlags)[change.first] = change.second;
+            (*newModSeqs)[change.first] = modSeq;
+         }
+      }
+
+      // All other columns are shared with this snapshot.
+      std::shared_ptr<FolderSnapshot> snapshot = std::shared_ptr<FolderSnapshot>(new FolderSnapshot(*this));
+      snapshot->flags_ = newFlags;
+      snapshot->modseqs_ = newModSeqs;
+      snapshot->UpdateFlagSummary_();
+
+      return snapshot;
+   }
+
+   std::shared_ptr<const FolderSnapshot>
+   FolderSnapshot::ClearFlag(short flag) const
+   {
+      std::shared_ptr<std::vector<short> > newFlags = std::shared_ptr<std::vector<short> >(new std::vector<short>(*flags_));
+
+      for (short &messageFlags : *newFlags)
+         messageFlags &= ~flag;
+
+      std::shared_ptr<FolderSnapshot> snapshot = std::shared_ptr<FolderSnapshot>(new FolderSnapshot(*this));
+      snapshot->flags_ = newFlags;
+      snapshot->UpdateFlagSummary_();
+
+      return snapshot;
+   }
+
+   void
+   FolderSnapshot::AddMessages_(const std::vector<std::shared_ptr<Message> > &messages, size_t firstNewMessage, std::vector<unsigned int> &uids, std::vector<__int64> &messageIDs, std::vector<short> &flags, std::vector<int> &sizes, std::vector<__int64> &modSeqs, std::vector<unsigned int> &createTimes, std::vector<char> &arena)
+   {
+      size_t newCount = uids.size() + messages.size() - firstNewMessage;
+
+      uids.reserve(newCount);
+      messageIDs.reserve(newCount);
+      flags.reserve(newCount);
+      sizes.reserve(newCount);
+      modSeqs.reserve(newCount);
+      createTimes.reserve(newCount);
+
+      // Messages which arrive in the same second share the create time.
+      std::map<std::string, unsigned int> internedStrings;
+
+      for (size_t i = firstNewMessage; i < messages.size(); i++)
+      {
+         std::shared_ptr<Message> message = messages[i];
+
+         uids.push_back(message->GetUID());
+         messageIDs.push_back(message->GetID());
+         flags.push_back(message->GetFlags());
+         sizes.push_back(message->GetSize());
+         modSeqs.push_back(message->GetModSeq());
+
+         AnsiString createTime = message->GetCreateTime();
+
+         auto iter = internedStrings.find(createTime);
+         if (iter != internedStrings.end())
+         {
+            createTimes.push_back(iter->second);
+            continue;
+         }
+
+         unsigned int offset = (unsigned int) arena.size();
+         arena.insert(arena.end(), createTime.begin(), createTime.end());
+         arena.push_back(0);
+
+         internedStrings[createTime] = offset;
+         createTimes.push_back(offset);
+      }
+   }
+
+   void
+   FolderSnapshot::UpdateFlagSummary_()
+   {
+      seen_count_ = 0;
+      first_unseen_uid_ = 0;
+
+      size_t count = flags_->size();
+      for (size_t i = 0; i < count; i++)
+      {
+         if ((*flags_)[i] & Message::FlagSeen)
+            seen_count_++;
+         else if (first_unseen_uid_ == 0)
+            first_unseen_uid_ = (*uids_)[i];
+      }
+   }
+
+   const char *
+   FolderSnapshot::GetCreateTime(size_t index) const
+   {
+      return &(*arena_)[(*create_times_)[index]];
+   }
+
+   bool
+   FolderSnapshot::FindUID(unsigned int uid, size_t &index) const
+   {
+      if (uids_ascending_)
+      {
+         index = GetFirstIndexWithUID(uid);
+         return index < uids_->size() && (*uids_)[index] == uid;
+      }
+
+      for (index = 0; index < uids_->size(); index++)
+      {
+         if ((*uids_)[index] == uid)
+            return true;
+      }
+
+      return false;
+   }
+
+   size_t
+   FolderSnapshot::GetFirstIndexWithUID(unsigned int uid) const
+   {
+      if (uids_ascending_)
+         return std::lower_bound(uids_->begin(), uids_->end(), uid) - uids_->begin();
+
+      return 0;
+   }
+
+   void
+   FolderSnapshot::GetMessageIDsWithFlag(short flag, std::set<__int64> &messageIDs) const
+   {
+      size_t count = flags_->size();
+      for (size_t i = 0; i < count; i++)
+      {
+         if ((*flags_)[i] & flag)
+            messageIDs.insert((*message_ids_)[i]);
+      }
+   }
+
+   size_t
+   FolderSnapshot::GetEstimatedMemoryUsage() const
+   {
+      size_t perMessage = sizeof(unsigned int) + sizeof(__int64) + sizeof(short) + sizeof(int) + sizeof(__int64) + sizeof(unsigned int);
+
+      return sizeof(FolderSnapshot) + uids_->size() * perMessage + arena_->size();
+   }
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   class Message;
+
+   // An immutable, column-oriented copy of the message list of a folder. The
+   // values of the messages are stored in parallel arrays, so commands which only
+   // look at flags, UIDs or sizes don't have to touch the Message objects.
+   //
+   // A snapshot is never modified. Changes create a new snapshot which shares the
+   // columns which were not affected, so a flag change only copies the flags.
+   class FolderSnapshot : public std::enable_shared_from_this<FolderSnapshot>
+   {
+   public:
+
+      static std::shared_ptr<const FolderSnapshot> Create(const std::vector<std::shared_ptr<Message> > &messages);
+
+      std::shared_ptr<const FolderSnapshot> Append(const std::vector<std::shared_ptr<Message> > &messages, size_t firstNewMessage) const;
+      // Returns a snapshot which also contains the messages from firstNewMessage and onwards.
+
+      std::shared_ptr<const FolderSnapshot> SetFlags(const std::vector<std::pair<size_t, short> > &changes, __int64 modSeq) const;
+      std::shared_ptr<const FolderSnapshot> ClearFlag(short flag) const;
+      // Returns a snapshot with updated flags. Each call copies the flag columns, so
+      // the changes of a whole command should be applied at once. Clearing a flag is not a change
+      // which clients can see, so the modification sequences are kept.
+
+      size_t GetCount() const { return uids_->size(); }
+
+      unsigned int GetUID(size_t index) const { return (*uids_)[index]; }
+      __int64 GetMessageID(size_t index) const { return (*message_ids_)[index]; }
+      short GetFlags(size_t index) const { return (*flags_)[index]; }
+      int GetSize(size_t index) const { return (*sizes_)[index]; }
+      __int64 GetModSeq(size_t index) const { return (*modseqs_)[index]; }
+      const char *GetCreateTime(size_t index) const;
+
+      bool GetFlag(size_t index, short flag) const { return ((*flags_)[index] & flag) != 0; }
+
+      bool FindUID(unsigned int uid, size_t &index) const;
+      // Locates the message with the given UID.
+
+      size_t GetFirstIndexWithUID(unsigned int uid) const;
+      // Returns the index of the first message with a UID equal to or above uid. If
+      // the UIDs aren't ascending, 0 is returned and all messages need to be checked.
+
+      bool GetUIDsAscending() const { return uids_ascending_; }
+
+      long GetNoOfSeen() const { return seen_count_; }
+      unsigned int GetFirstUnseenUID() const { return first_unseen_uid_; }
+
+      void GetMessageIDsWithFlag(short flag, std::set<__int64> &messageIDs) const;
+
+      size_t GetEstimatedMemoryUsage() const;
+
+   private:
+
+      FolderSnapshot();
+
+      static void AddMessages_(const std::vector<std::shared_ptr<Message> > &messages, size_t firstNewMessage, std::vector<unsigned int> &uids, std::vector<__int64> &messageIDs, std::vector<short> &flags, std::vector<int> &sizes, std::vector<__int64> &modSeqs, std::vector<unsigned int> &createTimes, std::vector<char> &arena);
+      void UpdateFlagSummary_();
+
+      std::shared_ptr<const std::vector<unsigned int> > uids_;
+      std::shared_ptr<const std::vector<__int64> > message_ids_;
+      std::shared_ptr<const std::vector<short> > flags_;
+      std::shared_ptr<const std::vector<int> > sizes_;
+      std::shared_ptr<const std::vector<__int64> > modseqs_;
+
+      // Offsets into the string arena. The strings are stored null-terminated
+      // after each other, and equal strings added at the same time are stored once.
+      std::shared_ptr<const std::vector<unsigned int> > create_times_;
+      std::shared_ptr<const std::vector<char> > arena_;
+
+      // UIDs are normally ascending, which allows binary searches.
+      bool uids_ascending_;
+
+      long seen_count_;
+      unsigned int first_unseen_uid_;
+   };
+}
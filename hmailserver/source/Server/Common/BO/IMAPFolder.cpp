@@ -25,6 +25,7 @@ namespace HM
       account_id_(iAccountID), 
       dbid_(0),
       current_uid_(0),
+      highest_modseq_(1),
       folder_is_subscribed_(false),
       parent_folder_id_(iParentFolderID)
    {
@@ -35,6 +36,7 @@ namespace HM
       account_id_(0), 
       dbid_(0),
       current_uid_(0),
+      highest_modseq_(1),
       folder_is_subscribed_(false),
       parent_folder_id_(-1)
    {
@@ -39,6 +39,9 @@ namespace HM
       unsigned int GetCurrentUID() const { return current_uid_;} 
       void SetCurrentUID(unsigned int currentUID) {current_uid_ = currentUID;}
 
+      __int64 GetHighestModSeq() const { return highest_modseq_;} 
+      void SetHighestModSeq(__int64 highestModSeq) {highest_modseq_ = highestModSeq;}
+
       const DateTime &GetCreationTime() const { return create_time_;} 
       void SetCreationTime(const DateTime &currentUID) {create_time_ = currentUID;}
 
@@ -75,6 +78,7 @@ namespace HM
       __int64 account_id_;
       __int64 parent_folder_id_;
       unsigned int current_uid_;
+      __int64 highest_modseq_;
 
       bool folder_is_subscribed_;
       AnsiString folder_name_;
@@ -45,7 +45,7 @@ namespace HM
 
       vecObjects.clear();
 
-      SQLCommand command("select folderid, folderparentid, foldername, folderissubscribed, foldercurrentuid, foldercreationtime from hm_imapfolders "
+      SQLCommand command("select folderid, folderparentid, foldername, folderissubscribed, foldercurrentuid, folderhighestmodseq, foldercreationtime from hm_imapfolders "
                          " where folderaccountid = @FOLDERACCOUNTID order by folderid asc");
 
       command.AddParameter("@FOLDERACCOUNTID", account_id_);
@@ -64,6 +64,7 @@ namespace HM
          bool bIsSubscribed = false;   
          bool bShared = false;
          unsigned int currentUID = 0;
+         __int64 highestModSeq = 0;
          DateTime creationTime;
 
          while (!pRS->IsEOF())
@@ -73,6 +74,7 @@ namespace HM
             sFolderName = pRS->GetStringValue("foldername");
             bIsSubscribed = (pRS->GetLongValue("folderissubscribed") == 1) ? true : false;
             currentUID = (unsigned int) pRS->GetInt64Value("foldercurrentuid");
+            highestModSeq = pRS->GetInt64Value("folderhighestmodseq");
             creationTime = Time::GetDateFromSystemDate(pRS->GetStringValue("foldercreationtime"));
 
             // Initialize with dummy parent folder. We can't set it here since it may not
@@ -83,6 +85,7 @@ namespace HM
             pFolder->SetFolderName(sFolderName);
             pFolder->SetIsSubscribed(bIsSubscribed);
             pFolder->SetCurrentUID(currentUID);
+            pFolder->SetHighestModSeq(highestModSeq);
             pFolder->SetCreationTime(creationTime);
 
             vecIMAPFolders.push_back(std::make_pair(iParentID, pFolder));
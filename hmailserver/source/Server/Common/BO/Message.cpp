@@ -53,6 +53,7 @@ namespace HM
       flags_ = other.flags_;
 
       uid_ = other.uid_;
+      modseq_ = other.modseq_;
    }
 
 
@@ -65,6 +66,7 @@ namespace HM
       message_size_ = 0;
       no_of_retries_ = 0;
       uid_ = 0;
+      modseq_ = 0;
 
       if (generateFileName)
       {
@@ -50,6 +50,11 @@ namespace HM
       unsigned int GetUID() const { return uid_; }
       void SetUID(unsigned int  uid) { uid_ = uid; }
 
+      // The modification sequence of the last change of the flags, or of the
+      // placement of the message in its folder.
+      __int64 GetModSeq() const { return modseq_; }
+      void SetModSeq(__int64 modSeq) { modseq_ = modSeq; }
+
       __int64 GetAccountID() const { return message_account_id_; }
       void SetAccountID(__int64 MsgAccountID) { message_account_id_ = (int) MsgAccountID; }
    
@@ -110,6 +115,7 @@ namespace HM
       short flags_;
 
       unsigned int uid_;
+      __int64 modseq_;
       
    private:
 
@@ -9,6 +9,7 @@
 #include "../BO/Message.h"
 #include "../BO/Attachments.h"
 #include "../Util/Time.h"
+#include "../Util/File.h"
 #include "../Util/GUIDCreator.h"
 #include "../Util/Utilities.h"
 
@@ -34,6 +35,10 @@ namespace HM
    {
       encode_fields_ = true;
       unfold_with_space_ = true;
+      body_on_demand_ = false;
+      body_pending_ = false;
+      body_start_ = 0;
+      body_missing_ = false;
 
       mime_mail_ = std::shared_ptr<MimeBody>(new MimeBody);
    }
@@ -49,9 +54,33 @@ namespace HM
 
    bool
    MessageData::LoadFromMessage(const String &fileName, std::shared_ptr<Message> pMessage)
+   {
+      return Load_(fileName, pMessage, false);
+   }
+
+   bool
+   MessageData::LoadHeaderFromMessage(std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage)
+   {
+      String fileName = PersistentMessage::GetFileName(account, pMessage);
+
+      return LoadHeaderFromMessage(fileName, pMessage);
+   }
+
+   bool
+   MessageData::LoadHeaderFromMessage(const String &fileName, std::shared_ptr<Message> pMessage)
+   {
+      return Load_(fileName, pMessage, true);
+   }
+
+   bool
+   MessageData::Load_(const String &fileName, std::shared_ptr<Message> pMessage, bool bodyOnDemand)
    {
       message_ = pMessage;
       message_file_name_ = fileName;
+      body_on_demand_ = bodyOnDemand;
+      body_pending_ = false;
+      body_start_ = 0;
+      body_missing_ = false;
 
       mime_mail_ = std::shared_ptr<MimeBody>(new MimeBody);
 
@@ -59,13 +88,84 @@ namespace HM
       if (FileUtilities::FileSize(message_file_name_) > MaxSize)
          return false;
 
+      if (bodyOnDemand && LoadHeader_())
+      {
+         body_pending_ = true;
+         return true;
+      }
+
       bool bNewMessage = false;
-      try
+      if (!LoadFile_(mime_mail_, bNewMessage))
+         return false;
+
+      if (bNewMessage)
+      {
+         // For new messages, we default to UTF-8. This way client
+         // can put any values into headers without having to care
+         // about setting the correct character set first.
+         SetCharset("utf-8");
+         SetFieldValue(CMimeConst::MimeVersion(), "1.0");
+      }
+
+      return true;
+   }
+
+   bool
+   MessageData::LoadHeader_()
+   {
+      if (!FileUtilities::Exists(message_file_name_))
+         return false;
+
+      AnsiString header = PersistentMessage::LoadHeader(message_file_name_, false);
+
+      // If the end of the header can't be found, the message is loaded as usual.
+      if (header.IsEmpty() || header.Right(2) != "\r\n")
+         return false;
+
+      std::shared_ptr<MimeBody> mimeMail = std::shared_ptr<MimeBody>(new MimeBody);
+
+      // The header is parsed the same way as when the complete message is
+      // loaded, so the body starts where MimeBody would have started it.
+      size_t bodyStart = mimeMail->MimeHeader::Load(header.c_str(), header.GetLength());
+      if (bodyStart == 0)
+         return false;
+
+      mime_mail_ = mimeMail;
+      body_start_ = min((int) bodyStart, (int) FileUtilities::FileSize(message_file_name_));
+
+      return true;
+   }
+
+   void
+   MessageData::LoadBody_() const
+   {
+      if (!body_pending_)
+         return;
+
+      body_pending_ = false;
+
+      std::shared_ptr<MimeBody> mimeMail = std::shared_ptr<MimeBody>(new MimeBody);
+
+      bool newMessage = false;
+      if (!LoadFile_(mimeMail, newMessage) || newMessage)
       {
+         body_missing_ = true;
+         return;
+      }
 
-         if (!mime_mail_->LoadFromFile(message_file_name_))
+      // Keep the changes which have been made to the header since it was loaded.
+      mimeMail->Fields() = mime_mail_->Fields();
+      mime_mail_ = mimeMail;
+   }
+
+   bool
+   MessageData::LoadFile_(std::shared_ptr<MimeBody> mimeMail, bool &newMessage) const
+   {
+      try
+      {
+         if (!mimeMail->LoadFromFile(message_file_name_))
          {
-            bNewMessage = true;
+            newMessage = true;
          }
       }
       catch (...)
@@ -90,15 +190,6 @@ namespace HM
          return false;
       }
 
-      if (bNewMessage)
-      {
-         // For new messages, we default to UTF-8. This way client
-         // can put any values into headers without having to care
-         // about setting the correct character set first.
-         SetCharset("utf-8");
-         SetFieldValue(CMimeConst::MimeVersion(), "1.0");
-      }
-
       return true;
    }
 
@@ -109,7 +200,7 @@ namespace HM
       if (!message_)
          return false;
 
-      return LoadFromMessage(message_file_name_, message_);
+      return Load_(message_file_name_, message_, body_on_demand_);
    }
 
 
@@ -276,6 +367,8 @@ namespace HM
    {
       if (!attachments_)
       {
+         LoadBody_();
+
          attachments_ = std::shared_ptr<Attachments>(new Attachments(mime_mail_, this));
          
          // Load attachments.
@@ -398,6 +491,8 @@ namespace HM
       // Step 3: Create the new type.
       // Step 4: Insert the new type and all others.
 
+      LoadBody_();
+
       // Create a new part by rebuilding the message more or less from scratch.
       AnsiString sMainBodyType = mime_mail_->GetCleanContentType();
       AnsiString sMainBodyCharset = mime_mail_->GetCharset();
@@ -619,6 +714,8 @@ namespace HM
    std::shared_ptr<MimeBody>
    MessageData::GetBodyTextPlainPart() const
    {
+      LoadBody_();
+
       String part_type = mime_mail_->GetCleanContentType();
       if (part_type.IsEmpty())
          return mime_mail_;
@@ -632,6 +729,8 @@ namespace HM
    std::shared_ptr<MimeBody>
    MessageData::GetBodyTextHtmlPart() const
    {
+      LoadBody_();
+
       String part_type = mime_mail_->GetCleanContentType();
 
       if (part_type == _T("text/html"))
@@ -678,6 +777,8 @@ namespace HM
    std::shared_ptr<MimeBody>
    MessageData::FindPart(const String &sType) const
    {
+      LoadBody_();
+
       String sPartType = mime_mail_->GetCleanContentType();
 
       if (sPartType.CompareNoCase(sType) == 0)
@@ -730,7 +831,20 @@ namespace HM
       if (!HM::FileUtilities::Exists(directoryName))
          HM::FileUtilities::CreateDirectory(directoryName);
 
-      bool result = mime_mail_->SaveAllToFile(fileName);
+      if (body_missing_)
+      {
+         String sErrorMessage;
+         sErrorMessage.Format(_T("The message body could not be loaded, so the message was not saved. File: %s"), message_file_name_.c_str());
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 4220, "MessageData::Write", sErrorMessage);
+
+         return false;
+      }
+
+      // If the header can't be written together with the original body, the
+      // file is left as it was rather than re-read and saved in full.
+      bool result = body_pending_ ?
+         WriteWithOriginalBody_(fileName) :
+         mime_mail_->SaveAllToFile(fileName);
 
       if (message_)
       {
@@ -740,6 +854,44 @@ namespace HM
       return result;
    }
 
+   bool
+   MessageData::WriteWithOriginalBody_(const String &fileName)
+   {
+      // The file may be the one the body is copied from, so the message
+      // is written to a new file which then replaces it.
+      String tempFileName = FileUtilities::Combine(FileUtilities::GetFilePath(fileName), GUIDCreator::GetGUID() + _T(".tmp"));
+
+      AnsiString header = mime_mail_->MimeHeader::Store();
+
+      try
+      {
+         File sourceFile;
+         sourceFile.Open(message_file_name_, File::OTReadOnly);
+         sourceFile.SetPosition(body_start_);
+
+         File targetFile;
+         targetFile.Open(tempFileName, File::OTCreate);
+         targetFile.Write(header);
+         targetFile.Write(sourceFile);
+      }
+      catch (...)
+      {
+         FileUtilities::DeleteFile(tempFileName);
+         return false;
+      }
+
+      if (!FileUtilities::Replace(tempFileName, fileName))
+      {
+         FileUtilities::DeleteFile(tempFileName);
+         return false;
+      }
+
+      if (fileName.CompareNoCase(message_file_name_) == 0)
+         body_start_ = header.GetLength();
+
+      return true;
+   }
+
    bool 
    MessageData::GetHasBodyType(const String &sBodyType)
    {
@@ -801,6 +953,8 @@ namespace HM
    std::shared_ptr<MimeBody> 
    MessageData::GetMimeMessage()
    {
+      LoadBody_();
+
       return mime_mail_;
    }
 
@@ -20,6 +20,13 @@ namespace HM
       bool LoadFromMessage(const String &fileName, std::shared_ptr<Message> pMessage);
       bool LoadFromMessage(std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage);
 
+      bool LoadHeaderFromMessage(const String &fileName, std::shared_ptr<Message> pMessage);
+      bool LoadHeaderFromMessage(std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage);
+      // Only the header is parsed. The body is loaded from the file the first time
+      // it's needed, and changes made to the header before that are kept. If the
+      // message is written before the body has been loaded, the body is copied from
+      // the file as it is.
+
       bool RefreshFromMessage();
 
       String GetHeader() const;
@@ -90,6 +97,12 @@ namespace HM
 
    private:
 
+      bool Load_(const String &fileName, std::shared_ptr<Message> pMessage, bool bodyOnDemand);
+      bool LoadHeader_();
+      bool LoadFile_(std::shared_ptr<MimeBody> mimeMail, bool &newMessage) const;
+      void LoadBody_() const;
+      bool WriteWithOriginalBody_(const String &fileName);
+
       std::shared_ptr<MimeBody> GetViewBodyPart_(int recursion_level, std::shared_ptr<MimeBody> source, const String &requested_content_type) const;
 
       bool IsTextType(const String &sContentType);
@@ -99,11 +112,21 @@ namespace HM
       std::shared_ptr<MimeBody> FindPartNoRecurse(std::shared_ptr<MimeBody> parent, const AnsiString &sType) const;
 
       std::shared_ptr<Message> message_;
-      std::shared_ptr<MimeBody> mime_mail_;
+      mutable std::shared_ptr<MimeBody> mime_mail_;
       std::shared_ptr<Attachments> attachments_;
 
       String message_file_name_;
 
+      bool body_on_demand_;
+
+      // Set while only the header of the message file has been loaded.
+      mutable bool body_pending_;
+      int body_start_;
+
+      // Set if the body could not be loaded after the header was, in which
+      // case the message can't be written without losing the body.
+      mutable bool body_missing_;
+
       bool encode_fields_;
       bool unfold_with_space_;
    };
@@ -12,7 +12,8 @@
 
 namespace HM
 {
-   MessageRecipients::MessageRecipients(void)
+   MessageRecipients::MessageRecipients(void) :
+      indexed_count_(0)
    {
    }
 
@@ -24,13 +25,53 @@ namespace HM
    MessageRecipients::Clear()
    {
       recipients_.clear();
+      addresses_.clear();
+      indexed_count_ = 0;
    }
 
 
    void
    MessageRecipients::Add(std::shared_ptr<MessageRecipient> pRecipient)
    {
+      UpdateAddressIndex_();
+
+      recipients_.push_back(pRecipient);
+
+      addresses_.insert(pRecipient->GetAddress().ToLower());
+      indexed_count_ = recipients_.size();
+   }
+
+   bool
+   MessageRecipients::AddUnique(std::shared_ptr<MessageRecipient> pRecipient)
+   {
+      String address = pRecipient->GetAddress().ToLower();
+
+      if (address.IsEmpty())
+         return false;
+
+      UpdateAddressIndex_();
+
+      if (!addresses_.insert(address).second)
+         return false;
+
       recipients_.push_back(pRecipient);
+      indexed_count_ = recipients_.size();
+
+      return true;
+   }
+
+   void
+   MessageRecipients::UpdateAddressIndex_()
+   {
+      if (indexed_count_ == recipients_.size())
+         return;
+
+      addresses_.clear();
+
+      for (std::shared_ptr<MessageRecipient> recipient : recipients_)
+         addresses_.insert(recipient->GetAddress().ToLower());
+
+      indexed_count_ = recipients_.size();
    }
 
    String 
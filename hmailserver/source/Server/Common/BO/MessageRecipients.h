@@ -15,6 +15,10 @@ namespace HM
 
       void Clear();
       void Add(std::shared_ptr<MessageRecipient> pRecipient);
+      bool AddUnique(std::shared_ptr<MessageRecipient> pRecipient);
+      // Adds the recipient unless the list already contains its address. Returns
+      // false if the address was empty or already in the list.
+
       std::vector<std::shared_ptr<MessageRecipient> > & GetVector() {return recipients_; }
       int GetCount() {return (int) recipients_.size(); }
       String GetCommaSeperatedRecipientList();
@@ -24,7 +28,15 @@ namespace HM
 
    private:
 
+      void UpdateAddressIndex_();
+
       std::vector<std::shared_ptr<MessageRecipient> > recipients_;
 
+      // The lower-cased addresses in the list, so that it doesn't have to be searched
+      // every time a recipient is added. The vector can be changed through GetVector,
+      // so the index is rebuilt when the recipient count no longer matches.
+      std::set<String> addresses_;
+      size_t indexed_count_;
+
    };
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "stdafx.h"
 #include "Messages.h"
+#include "FolderSnapshot.h"
 
 using namespace std;
 
@@ -45,11 +46,87 @@ namespace HM
 
    }
 
+   std::vector<std::shared_ptr<Message>>
+   Messages::GetCopy(std::shared_ptr<const FolderSnapshot> snapshot, const std::vector<size_t> &indexes)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      std::vector<std::shared_ptr<Message>> result;
+      result.reserve(indexes.size());
+
+      // Only built if messages have been added or removed since the snapshot was taken.
+      std::map<__int64, size_t> positions;
+
+      for (size_t index : indexes)
+      {
+         __int64 messageID = snapshot->GetMessageID(index);
+
+         std::shared_ptr<Message> message;
+
+         if (index < vecObjects.size() && vecObjects[index]->GetID() == messageID)
+            message = vecObjects[index];
+         else
+         {
+            if (positions.empty())
+            {
+               for (size_t i = 0; i < vecObjects.size(); i++)
+                  positions[vecObjects[i]->GetID()] = i;
+            }
+
+            auto iter = positions.find(messageID);
+            if (iter != positions.end())
+               message = vecObjects[iter->second];
+         }
+
+         if (message)
+            result.push_back(std::shared_ptr<Message>(new Message(*message.get())));
+         else
+            result.push_back(message);
+      }
+
+      return result;
+   }
+
+   std::shared_ptr<const FolderSnapshot>
+   Messages::GetSnapshot()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      // Items may have been added or removed through the base class, which
+      // doesn't know about the snapshot.
+      if (!snapshot_ || snapshot_->GetCount() != vecObjects.size())
+         snapshot_ = FolderSnapshot::Create(vecObjects);
+
+      return snapshot_;
+   }
+
+   void
+   Messages::InvalidateSnapshot()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      snapshot_.reset();
+   }
+
+   size_t
+   Messages::GetSnapshotMemoryUsage() const
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      if (!snapshot_)
+         return 0;
+
+      return snapshot_->GetEstimatedMemoryUsage();
+   }
+
    long
    Messages::GetNoOfSeen() const
    {
       boost::lock_guard<boost::recursive_mutex> guard(_mutex);
 
+      if (snapshot_ && snapshot_->GetCount() == vecObjects.size())
+         return snapshot_->GetNoOfSeen();
+
       long lNoOfSeen = 0;
 
       for(std::shared_ptr<Message> oMessage : vecObjects)
@@ -81,6 +158,9 @@ namespace HM
    {
       boost::lock_guard<boost::recursive_mutex> guard(_mutex);
 
+      if (snapshot_ && snapshot_->GetCount() == vecObjects.size())
+         return snapshot_->GetFirstUnseenUID();
+
       for(std::shared_ptr<Message> message : vecObjects)
       {
          if (!message->GetFlagSeen())
@@ -117,26 +197,34 @@ namespace HM
    {
       boost::lock_guard<boost::recursive_mutex> guard(_mutex);
 
-      std::vector<int> vecExpungedMessages;
-      auto iterMessage = vecObjects.begin();
+      std::vector<std::shared_ptr<Message> > deletedMessages;
+      std::vector<std::shared_ptr<Message> > remainingMessages;
+      remainingMessages.reserve(vecObjects.size());
 
+      // The index passed to the filter is the sequence number the message
+      // will have once the preceding messages have been removed.
       int index = 0;
-      while (iterMessage != vecObjects.end())
+      for (std::shared_ptr<Message> message : vecObjects)
       {
          index++;
 
-         std::shared_ptr<Message> message = (*iterMessage);
-
          if (filter(index, message))
          {
-            PersistentMessage::DeleteObject(message);
-            iterMessage = vecObjects.erase(iterMessage);
+            deletedMessages.push_back(message);
             index--;
          }
          else
-            iterMessage++;
+            remainingMessages.push_back(message);
       }
 
+      if (deletedMessages.empty())
+         return;
+
+      vecObjects.swap(remainingMessages);
+      snapshot_.reset();
+
+      PersistentMessage::DeleteObjects(deletedMessages);
+
    }
 
 
@@ -215,6 +303,8 @@ namespace HM
 
       if (!pRS->IsEOF())
       {
+         size_t previousCount = vecObjects.size();
+
          long lRecCount = pRS->RecordCount();
          if (lRecCount < 0)
             lRecCount = 0;
@@ -237,6 +327,12 @@ namespace HM
 
          std::shared_ptr<Message> pLastMessage = vecObjects[vecObjects.size() -1];
          last_refreshed_uid_ = pLastMessage->GetUID();
+
+         // Only the new messages need to be added to an existing snapshot.
+         if (snapshot_ && snapshot_->GetCount() == previousCount)
+            snapshot_ = snapshot_->Append(vecObjects, previousCount);
+         else
+            snapshot_.reset();
       }
    }
 
@@ -249,11 +345,18 @@ namespace HM
    {
       boost::lock_guard<boost::recursive_mutex> guard(_mutex);
 
-      for(std::shared_ptr<Message> pCurMsg : vecObjects)
+      for (size_t i = 0; i < vecObjects.size(); i++)
       {
+         std::shared_ptr<Message> pCurMsg = vecObjects[i];
+
          if (pCurMsg->GetID() == ID)
          {
             pCurMsg->SetFlagDeleted(true);
+
+            // Rebuilt on the next read, so that deleting many messages through the
+            // API doesn't copy the flag columns once per message.
+            snapshot_.reset();
+
             return true;
          }
       }
@@ -261,6 +364,30 @@ namespace HM
       return false;
    }
 
+   void
+   Messages::SetMessageFlags(const std::map<__int64, short> &messageFlags, __int64 modSeq)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      std::vector<std::pair<size_t, short> > changes;
+
+      for (size_t i = 0; i < vecObjects.size(); i++)
+      {
+         std::shared_ptr<Message> message = vecObjects[i];
+
+         auto iter = messageFlags.find(message->GetID());
+         if (iter == messageFlags.end())
+            continue;
+
+         message->SetFlags(iter->second);
+         message->SetModSeq(modSeq);
+         changes.push_back(std::make_pair(i, iter->second));
+      }
+
+      if (snapshot_)
+         snapshot_ = snapshot_->SetFlags(changes, modSeq);
+   }
+
    void  
    Messages::RemoveRecentFlags()
    {
@@ -271,6 +398,9 @@ namespace HM
          message->SetFlagRecent(false);
       }
 
+      if (snapshot_)
+         snapshot_ = snapshot_->ClearFlag(Message::FlagRecent);
+
       // When a message is added to the database, the \Recent flag is set. When this message loads the message
       // list from the database, the \Recent flag will be set to the message in memory. Future sessions should
       // not see the message \Recent flag, so we remove the flag from all messages in the account folder now.
@@ -320,7 +450,10 @@ namespace HM
 
       // If the message is found, remove it from the list now
       if (iterMessage != vecObjects.end())
+      {
          vecObjects.erase(iterMessage);
+         snapshot_.reset();
+      }
    }
 
    std::shared_ptr<Message>
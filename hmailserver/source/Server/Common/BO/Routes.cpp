@@ -11,6 +11,13 @@
 
 namespace HM
 {
+   Routes::Node::Node() :
+      exact_index_(-1),
+      wildcard_index_(-1)
+   {
+
+   }
+
    Routes::Routes()
    {
       
@@ -30,26 +37,187 @@ namespace HM
    {
       String sSQL = "select * from hm_routes order by routedomainname asc";
       DBLoad_(sSQL);
+
+      ResetMatchTable();
+   }
+
+   void
+   Routes::AddItem(std::shared_ptr<Route> pObject)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      vecObjects.push_back(pObject);
+
+      ResetMatchTable();
+   }
+
+   void
+   Routes::ResetMatchTable()
+   {
+      // The table is compiled while holding the lock, so that a table compiled 
+      // from the old routes can't be stored after this.
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      std::atomic_store(&match_table_, std::shared_ptr<const MatchTable>());
    }
 
    std::shared_ptr<Route> 
    Routes::GetItemByNameWithWildcardMatch(const String &domainName)
    {
-      auto iter = vecObjects.begin();
-      auto iterEnd = vecObjects.end();
+      std::shared_ptr<const MatchTable> table = GetMatchTable_();
+
+      String sLowerDomainName = domainName;
+      sLowerDomainName.ToLower();
+
+      std::vector<String> labels;
+      GetLabels_(sLowerDomainName, labels);
+
+      int routeIndex = -1;
 
-      for (; iter != iterEnd; iter++)
+      // Follow the labels of the domain name, starting with the top-level domain. 
+      int nodeIndex = 0;
+      for (size_t i = 0; i < labels.size(); i++)
       {
-         std::shared_ptr<Route> pRoute = (*iter);
+         const Node &node = table->nodes_[nodeIndex];
 
-         if (StringParser::WildcardMatchNoCase(pRoute->DomainName(), domainName))
+         auto iter = node.children_.find(labels[i]);
+         if (iter == node.children_.end())
+            break;
+
+         nodeIndex = (*iter).second;
+
+         const Node &child = table->nodes_[nodeIndex];
+
+         if (i == labels.size() - 1)
+            routeIndex = GetFirst_(routeIndex, child.exact_index_);
+         else
+            routeIndex = GetFirst_(routeIndex, child.wildcard_index_);
+      }
+
+      // A route with another kind of pattern is only used if it's listed before
+      // the one found in the tree.
+      for (auto otherPattern : table->other_patterns_)
+      {
+         if (routeIndex >= 0 && otherPattern.first > routeIndex)
+            break;
+
+         if (StringParser::WildcardMatch(otherPattern.second, sLowerDomainName))
          {
-            return pRoute;
+            routeIndex = otherPattern.first;
+            break;
          }
       }
 
-      std::shared_ptr<Route> empty;
-      return empty;
+      if (routeIndex < 0)
+         return std::shared_ptr<Route>();
+
+      return table->routes_[routeIndex];
+   }
+
+   std::shared_ptr<const Routes::MatchTable>
+   Routes::GetMatchTable_()
+   {
+      std::shared_ptr<const MatchTable> table = std::atomic_load(&match_table_);
+      if (table)
+         return table;
+
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      // Another thread may have compiled it while we waited.
+      table = std::atomic_load(&match_table_);
+      if (table)
+         return table;
+
+      std::shared_ptr<MatchTable> newTable = std::shared_ptr<MatchTable>(new MatchTable());
+      newTable->routes_ = vecObjects;
+      newTable->nodes_.push_back(Node());
+
+      for (size_t i = 0; i < newTable->routes_.size(); i++)
+         AddPattern_(*newTable, newTable->routes_[i]->DomainName(), (int) i);
+
+      table = newTable;
+      std::atomic_store(&match_table_, table);
+
+      return table;
+   }
+
+   void
+   Routes::AddPattern_(MatchTable &table, const String &pattern, int routeIndex)
+   {
+      String sLowerPattern = pattern;
+      sLowerPattern.ToLower();
+
+      bool wildcard = sLowerPattern.Left(2) == _T("*.");
+      String sDomainName = wildcard ? sLowerPattern.Mid(2) : sLowerPattern;
+
+      if (sDomainName.FindOneOf(_T("*?")) >= 0)
+      {
+         table.other_patterns_.push_back(std::make_pair(routeIndex, sLowerPattern));
+         return;
+      }
+
+      std::vector<String> labels;
+      GetLabels_(sDomainName, labels);
+
+      int nodeIndex = 0;
+      for (const String &label : labels)
+      {
+         auto iter = table.nodes_[nodeIndex].children_.find(label);
+         if (iter != table.nodes_[nodeIndex].children_.end())
+         {
+            nodeIndex = (*iter).second;
+            continue;
+         }
+
+         int childIndex = (int) table.nodes_.size();
+         table.nodes_.push_back(Node());
+         table.nodes_[nodeIndex].children_[label] = childIndex;
+
+         nodeIndex = childIndex;
+      }
+
+      Node &node = table.nodes_[nodeIndex];
+
+      // The routes are added in order, so the first one is kept.
+      if (wildcard)
+         node.wildcard_index_ = GetFirst_(node.wildcard_index_, routeIndex);
+      else
+         node.exact_index_ = GetFirst_(node.exact_index_, routeIndex);
+   }
+
+   void
+   Routes::GetLabels_(const String &domainName, std::vector<String> &labels)
+   {
+      // Empty labels are kept, so that the labels can't match another domain name.
+      int start = 0;
+
+      for (;;)
+      {
+         int dot = domainName.Find('.', start);
+
+         if (dot < 0)
+         {
+            labels.push_back(domainName.Mid(start));
+            break;
+         }
+
+         labels.push_back(domainName.Mid(start, dot - start));
+         start = dot + 1;
+      }
+
+      std::reverse(labels.begin(), labels.end());
+   }
+
+   int
+   Routes::GetFirst_(int routeIndex, int otherRouteIndex)
+   {
+      if (routeIndex < 0)
+         return otherRouteIndex;
+
+      if (otherRouteIndex < 0)
+         return routeIndex;
+
+      return min(routeIndex, otherRouteIndex);
    }
 
 }
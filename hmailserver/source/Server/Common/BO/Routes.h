@@ -10,6 +10,11 @@
 
 namespace HM
 {
+   // Domain names are matched against the routes using a table compiled from them.
+   // Domain names and patterns of the form *.example.com are put in a tree of domain 
+   // labels, starting with the top-level domain. Other patterns are tested one by one.
+   // When a route is added, changed or removed, the table is thrown away and a new one
+   // is compiled the next time a route is looked up.
    class Routes : public Collection<Route, PersistentRoute>
    {
    public:
@@ -19,11 +24,52 @@ namespace HM
       // Refreshes this collection from the database.
       void Refresh();
 
+      virtual void AddItem(std::shared_ptr<Route> pObject);
+
       std::shared_ptr<Route>  GetItemByNameWithWildcardMatch(const String &domainName);
+      // Returns the first route in the collection which matches the domain name.
+
+      void ResetMatchTable();
+      // Called when a route has been saved or deleted.
+
    protected:
 
       virtual String GetCollectionName() const {return "Routes"; }
 
+   private:
+
+      struct Node
+      {
+         Node();
+
+         std::map<String, int> children_;
+
+         // The first route with this domain name, or -1.
+         int exact_index_;
+
+         // The first route matching *. followed by this domain name, or -1.
+         int wildcard_index_;
+      };
+
+      struct MatchTable
+      {
+         std::vector<std::shared_ptr<Route> > routes_;
+
+         // The first node is the root.
+         std::vector<Node> nodes_;
+
+         // Route index and lower-cased pattern of the routes which are not in
+         // the tree, in the order of the routes.
+         std::vector<std::pair<int, String> > other_patterns_;
+      };
+
+      std::shared_ptr<const MatchTable> GetMatchTable_();
+      static void AddPattern_(MatchTable &table, const String &pattern, int routeIndex);
+      static void GetLabels_(const String &domainName, std::vector<String> &labels);
+      static int GetFirst_(int routeIndex, int otherRouteIndex);
+
+      // Read and replaced using atomic_load and atomic_store.
+      std::shared_ptr<const MatchTable> match_table_;
    };
 
 }
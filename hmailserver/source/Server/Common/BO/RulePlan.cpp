@@ -0,0 +1,64 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "StdAfx.h"
+
+#include "RulePlan.h"
+#include "Rule.h"
+#include "RuleCriterias.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   RulePlan::RulePlan(const std::vector<std::shared_ptr<Rule> > &rules)
+   {
+      for (std::shared_ptr<Rule> rule : rules)
+      {
+         if (!rule->GetActive())
+            continue;
+
+         PlannedRule plannedRule;
+         plannedRule.rule_ = rule;
+
+         for (std::shared_ptr<RuleCriteria> criteria : rule->GetCriterias()->GetConstVector())
+         {
+            PlannedCriteria plannedCriteria;
+            plannedCriteria.criteria_ = criteria;
+            plannedCriteria.source_ = GetDataSource(criteria);
+
+            plannedRule.criterias_.push_back(plannedCriteria);
+         }
+
+         // Whether all or any of the criteria must match, the order doesn't change the outcome.
+         std::stable_sort(plannedRule.criterias_.begin(), plannedRule.criterias_.end(), 
+            [](const PlannedCriteria &first, const PlannedCriteria &second) { return first.source_ < second.source_; });
+
+         rules_.push_back(plannedRule);
+      }
+   }
+
+   RulePlan::DataSource
+   RulePlan::GetDataSource(std::shared_ptr<const RuleCriteria> criteria)
+   {
+      if (!criteria->GetUsePredefined())
+         return SourceHeader;
+
+      switch (criteria->GetPredefinedField())
+      {
+      case RuleCriteria::FTFrom:
+      case RuleCriteria::FTTo:
+      case RuleCriteria::FTCC:
+      case RuleCriteria::FTSubject:
+         return SourceHeader;
+      case RuleCriteria::FTBody:
+         return SourceBody;
+      default:
+         // The message size, the recipients and the delivery attempts are kept in the database.
+         return SourceEnvelope;
+      }
+   }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include "RuleCriteria.h"
+
+namespace HM
+{
+   class Rule;
+
+   // The active rules of a rule set, prepared for being tested against messages.
+   // The criteria of each rule are sorted so that the ones which only need the
+   // message envelope are tested first, then the ones which need the header and
+   // the ones which need the body last. Since a rule stops being tested as soon
+   // as its outcome is known, the message often doesn't have to be loaded at all.
+   // A plan is never modified. When the rules are reloaded, a new one is built.
+   class RulePlan
+   {
+   public:
+
+      enum DataSource
+      {
+         SourceEnvelope = 0,
+         SourceHeader = 1,
+         SourceBody = 2
+      };
+
+      struct PlannedCriteria
+      {
+         std::shared_ptr<RuleCriteria> criteria_;
+         DataSource source_;
+      };
+
+      struct PlannedRule
+      {
+         std::shared_ptr<Rule> rule_;
+         std::vector<PlannedCriteria> criterias_;
+      };
+
+      RulePlan(const std::vector<std::shared_ptr<Rule> > &rules);
+
+      const std::vector<PlannedRule> &GetRules() const {return rules_; }
+
+      static DataSource GetDataSource(std::shared_ptr<const RuleCriteria> criteria);
+
+   private:
+
+      std::vector<PlannedRule> rules_;
+   };
+}
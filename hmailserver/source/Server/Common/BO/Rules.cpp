@@ -4,6 +4,7 @@
 #include "StdAfx.h"
 
 #include "Rules.h"
+#include "RulePlan.h"
 
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
@@ -31,7 +32,22 @@ namespace HM
    {
       String sSQL;
       sSQL.Format(_T("select * from hm_rules where ruleaccountid = %I64d order by rulesortorder asc"), account_id_);
+
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
       DBLoad_(sSQL);
+      plan_.reset();
+   }
+
+   std::shared_ptr<const RulePlan>
+   Rules::GetPlan()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(_mutex);
+
+      if (!plan_)
+         plan_ = std::shared_ptr<const RulePlan>(new RulePlan(vecObjects));
+
+      return plan_;
    }
 
    std::vector<std::shared_ptr<Rule> >::iterator 
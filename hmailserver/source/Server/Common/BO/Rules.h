@@ -10,6 +10,8 @@
 
 namespace HM
 {
+   class RulePlan;
+
    class Rules : public Collection<Rule, PersistentRule>
    {
    public:
@@ -19,6 +21,9 @@ namespace HM
       void Refresh();
 
       __int64 GetAccountID() const {return account_id_; }
+
+      std::shared_ptr<const RulePlan> GetPlan();
+      // Returns the plan used to test messages against the rules as they were loaded.
  
       void MoveUp(__int64 iRuleID);
       void MoveDown(__int64 iRuleID);
@@ -32,5 +37,7 @@ namespace HM
       void UpdateSortOrder_();
 
       __int64 account_id_;
+
+      std::shared_ptr<const RulePlan> plan_;
    };
 }
\ No newline at end of file
@@ -35,7 +35,7 @@ namespace HM
 
       size_t GetEstimatedCachingSize()
       {
-         return 1024 * messages_->GetCount();
+         return 1024 * messages_->GetCount() + messages_->GetSnapshotMemoryUsage();
       }
 
       std::shared_ptr<Messages> GetMessages(bool update_recent_flags) 
@@ -55,6 +55,11 @@ namespace HM
          refresh_needed_ = true;
       }
 
+      void InvalidateSnapshot()
+      {
+         messages_->InvalidateSnapshot();
+      }
+
    private:
 
       std::shared_ptr<Messages> messages_;
@@ -0,0 +1,74 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include "../Mime/MessagePartMap.h"
+
+namespace HM
+{
+   // The IMAP structure strings of a message. Since message files normally never
+   // change once delivered, the strings can be reused until the message is deleted.
+   // The size and last write time of the file are stored as well, so that messages
+   // which have been re-saved are detected.
+   class CachedMimeStructure
+   {
+   public:
+
+      CachedMimeStructure(__int64 message_id, long file_size, __int64 file_time) :
+         message_id_(message_id),
+         file_size_(file_size),
+         file_time_(file_time)
+      {
+
+      }
+
+      __int64 GetID()
+      {
+         return message_id_;
+      }
+
+      String GetName()
+      {
+         return Formatter::Format("{0}", message_id_);
+      }
+
+      size_t GetEstimatedCachingSize()
+      {
+         size_t size = sizeof(CachedMimeStructure) + 
+            (envelope_.GetLength() + body_structure_.GetLength() + body_.GetLength()) * sizeof(wchar_t);
+
+         if (part_map_)
+            size += part_map_->GetEstimatedMemoryUsage();
+
+         return size;
+      }
+
+      long GetFileSize() const { return file_size_; }
+      __int64 GetFileTime() const { return file_time_; }
+
+      const String &GetEnvelope() const { return envelope_; }
+      void SetEnvelope(const String &envelope) { envelope_ = envelope; }
+
+      const String &GetBodyStructure(bool include_extension_data) const { return include_extension_data ? body_structure_ : body_; }
+      void SetBodyStructure(bool include_extension_data, const String &body_structure) { (include_extension_data ? body_structure_ : body_) = body_structure; }
+
+      std::shared_ptr<const MessagePartMap> GetPartMap() const { return part_map_; }
+      void SetPartMap(std::shared_ptr<const MessagePartMap> part_map) { part_map_ = part_map; }
+
+   private:
+
+      __int64 message_id_;
+      long file_size_;
+      __int64 file_time_;
+
+      String envelope_;
+
+      // BODYSTRUCTURE and BODY, which is BODYSTRUCTURE without extension data.
+      String body_structure_;
+      String body_;
+
+      // Where the parts are located in the message file.
+      std::shared_ptr<const MessagePartMap> part_map_;
+   };
+}
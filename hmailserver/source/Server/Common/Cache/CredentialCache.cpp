@@ -0,0 +1,146 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "CredentialCache.h"
+
+#include "../BO/Account.h"
+#include "../Util/Crypt.h"
+
+#include <openssl/crypto.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   CredentialCache::CredentialCache() :
+      no_of_hits_(0),
+      no_of_misses_(0),
+      has_secret_(false)
+   {
+      has_secret_ = RAND_bytes(secret_, SecretLength) == 1;
+
+      // Without a secret, nothing can be cached safely.
+      if (!has_secret_)
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5531, "CredentialCache::CredentialCache", "Unable to generate a secret for the credential cache. Verified passwords will not be cached.");
+   }
+
+   bool
+   CredentialCache::GetIsVerified(std::shared_ptr<const Account> account, const String &password)
+   {
+      if (!GetIsCacheable_(account))
+         return false;
+
+      unsigned char digest[DigestLength];
+      GetDigest_(account, password, digest);
+
+      unsigned int maxAge = (unsigned int) IniFileSettings::Instance()->GetCredentialCacheSeconds() * 1000;
+
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      auto iter = entries_.find(account->GetID());
+      if (iter != entries_.end())
+      {
+         Entry &entry = (*iter).second;
+
+         // The tick count wraps after 49 days, which the unsigned subtraction takes care of.
+         if (GetTickCount() - entry.verified_time_ < maxAge &&
+             CRYPTO_memcmp(entry.digest_, digest, DigestLength) == 0)
+         {
+            no_of_hits_++;
+            return true;
+         }
+      }
+
+      no_of_misses_++;
+      return false;
+   }
+
+   void
+   CredentialCache::AddVerified(std::shared_ptr<const Account> account, const String &password)
+   {
+      if (!GetIsCacheable_(account))
+         return;
+
+      Entry entry;
+      GetDigest_(account, password, entry.digest_);
+      entry.verified_time_ = GetTickCount();
+
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      // Entries are only removed when they are replaced, so start over if the cache grows too large.
+      if (entries_.size() >= MaxAccounts)
+         entries_.clear();
+
+      entries_[account->GetID()] = entry;
+   }
+
+   void
+   CredentialCache::RemoveAccount(__int64 accountID)
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+      entries_.erase(accountID);
+   }
+
+   void
+   CredentialCache::Clear()
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      entries_.clear();
+      no_of_hits_ = 0;
+      no_of_misses_ = 0;
+   }
+
+   int
+   CredentialCache::GetHitRate()
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      if (no_of_hits_ == 0)
+         return 0;
+
+      return (int) (((float) no_of_hits_ / (float) (no_of_hits_ + no_of_misses_)) * 100);
+   }
+
+   bool
+   CredentialCache::GetIsCacheable_(std::shared_ptr<const Account> account)
+   {
+      if (!has_secret_ || IniFileSettings::Instance()->GetCredentialCacheSeconds() <= 0)
+         return false;
+
+      // Active Directory passwords can change without hMailServer knowing, and
+      // the other password types are cheap to verify.
+      if (account->GetIsAD())
+         return false;
+
+      int encryption = account->GetPasswordEncryption();
+
+      return encryption == Crypt::ETMD5 || encryption == Crypt::ETSHA256;
+   }
+
+   void
+   CredentialCache::GetDigest_(std::shared_ptr<const Account> account, const String &password, unsigned char *digest)
+   {
+      AnsiString storedPassword = account->GetPassword();
+
+      HMAC_CTX context;
+      HMAC_CTX_init(&context);
+      HMAC_Init_ex(&context, secret_, SecretLength, EVP_sha256(), nullptr);
+      HMAC_Update(&context, (const unsigned char*) password.c_str(), password.GetLength() * sizeof(wchar_t));
+
+      // The separator keeps the password and the stored hash apart.
+      const unsigned char separator = 0;
+      HMAC_Update(&context, &separator, 1);
+      HMAC_Update(&context, (const unsigned char*) storedPassword.c_str(), storedPassword.GetLength());
+
+      unsigned int length = DigestLength;
+      HMAC_Final(&context, digest, &length);
+      HMAC_CTX_cleanup(&context);
+   }
+}
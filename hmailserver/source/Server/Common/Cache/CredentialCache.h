@@ -0,0 +1,59 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   class Account;
+
+   // Remembers passwords which have recently been verified, so that clients which
+   // reconnect often don't cause the password hash to be calculated every time. 
+   // Passwords are not stored. Instead, a HMAC of the password and the stored 
+   // password hash is kept, using a secret which is generated when the server 
+   // starts. Since the stored hash is part of the HMAC, an entry stops matching 
+   // as soon as the password is changed.
+   class CredentialCache : public Singleton<CredentialCache>
+   {
+   public:
+
+      CredentialCache();
+
+      bool GetIsVerified(std::shared_ptr<const Account> account, const String &password);
+      // Returns true if the password has been verified for the account within the
+      // last CredentialCacheSeconds seconds.
+
+      void AddVerified(std::shared_ptr<const Account> account, const String &password);
+
+      void RemoveAccount(__int64 accountID);
+      void Clear();
+      int GetHitRate();
+
+   private:
+
+      enum Settings
+      {
+         DigestLength = 32,
+         SecretLength = 32,
+         MaxAccounts = 100000
+      };
+
+      struct Entry
+      {
+         unsigned char digest_[DigestLength];
+         unsigned int verified_time_;
+      };
+
+      bool GetIsCacheable_(std::shared_ptr<const Account> account);
+      void GetDigest_(std::shared_ptr<const Account> account, const String &password, unsigned char *digest);
+
+      boost::mutex mutex_;
+      std::map<__int64, Entry> entries_;
+
+      unsigned char secret_[SecretLength];
+      bool has_secret_;
+
+      int no_of_hits_;
+      int no_of_misses_;
+   };
+}
@@ -0,0 +1,189 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "SecurityRangeCache.h"
+
+#include "../BO/SecurityRange.h"
+#include "../Persistence/PersistentSecurityRange.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   SecurityRangeCache::SecurityRangeCache()
+   {
+
+   }
+
+   std::shared_ptr<SecurityRange>
+   SecurityRangeCache::GetMatchingRange(const IPAddress &address)
+   {
+      std::shared_ptr<const Table> table = std::atomic_load(&table_);
+
+      if (!table)
+      {
+         Refresh();
+
+         table = std::atomic_load(&table_);
+
+         // If the ranges could not be loaded, fall back to asking the database.
+         if (!table)
+            return PersistentSecurityRange::ReadMatchingIP(address);
+      }
+
+      const std::vector<Interval> &intervals = address.GetType() == IPAddress::IPV4 ? table->ipv4_ : table->ipv6_;
+
+      Key key = GetKey_(address);
+
+      // Locate the last interval starting at or before the address.
+      auto iter = std::upper_bound(intervals.begin(), intervals.end(), key, 
+         [](const Key &value, const Interval &interval) { return value < interval.start_; });
+
+      if (iter == intervals.begin())
+         return std::shared_ptr<SecurityRange>();
+
+      int rangeIndex = (*(iter - 1)).range_index_;
+
+      if (rangeIndex < 0)
+         return std::shared_ptr<SecurityRange>();
+
+      return table->ranges_[rangeIndex];
+   }
+
+   void
+   SecurityRangeCache::Refresh()
+   {
+      boost::lock_guard<boost::mutex> guard(refresh_mutex_);
+
+      std::shared_ptr<Table> table = std::shared_ptr<Table>(new Table());
+
+      if (!PersistentSecurityRange::ReadAll(table->ranges_))
+      {
+         // Keep using the previous ranges rather than blocking everyone.
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5530, "SecurityRangeCache::Refresh", "The IP ranges could not be loaded from the database.");
+         return;
+      }
+
+      Compile_(table->ranges_, false, table->ipv4_);
+      Compile_(table->ranges_, true, table->ipv6_);
+
+      std::atomic_store(&table_, std::shared_ptr<const Table>(table));
+   }
+
+   void
+   SecurityRangeCache::AddRange(std::shared_ptr<SecurityRange> range)
+   {
+      boost::lock_guard<boost::mutex> guard(refresh_mutex_);
+
+      std::shared_ptr<const Table> current = std::atomic_load(&table_);
+
+      // The range will be included when the ranges are loaded for the first time.
+      if (!current)
+         return;
+
+      std::shared_ptr<Table> table = std::shared_ptr<Table>(new Table());
+      table->ranges_ = current->ranges_;
+
+      // Keep the ranges in the order they are read from the database. The new range has 
+      // the highest ID, so it goes after the other ranges with the same priority.
+      auto position = std::find_if(table->ranges_.begin(), table->ranges_.end(), 
+         [range](std::shared_ptr<SecurityRange> existing) { return existing->GetPriority() < range->GetPriority(); });
+
+      // A copy is stored, so that changes made to the range later on don't take effect before it has been saved.
+      table->ranges_.insert(position, std::shared_ptr<SecurityRange>(new SecurityRange(*range)));
+
+      Compile_(table->ranges_, false, table->ipv4_);
+      Compile_(table->ranges_, true, table->ipv6_);
+
+      std::atomic_store(&table_, std::shared_ptr<const Table>(table));
+   }
+
+   void
+   SecurityRangeCache::Compile_(const std::vector<std::shared_ptr<SecurityRange> > &ranges, bool ipv6, std::vector<Interval> &intervals)
+   {
+      struct Bound
+      {
+         Key lower_;
+         Key upper_;
+         int index_;
+      };
+
+      std::vector<Bound> bounds;
+      std::vector<Key> starts;
+
+      for (size_t i = 0; i < ranges.size(); i++)
+      {
+         std::shared_ptr<SecurityRange> range = ranges[i];
+
+         // Ranges are IPv4 if both bounds are IPv4 addresses, as when they are read from the database.
+         bool rangeIsIPv4 = range->GetLowerIP().GetType() == IPAddress::IPV4 && range->GetUpperIP().GetType() == IPAddress::IPV4;
+         if (rangeIsIPv4 == ipv6)
+            continue;
+
+         Bound bound;
+         bound.lower_ = GetKey_(range->GetLowerIP());
+         bound.upper_ = GetKey_(range->GetUpperIP());
+         bound.index_ = (int) i;
+
+         if (bound.upper_ < bound.lower_)
+            continue;
+
+         bounds.push_back(bound);
+
+         // A new interval starts where a range starts, and right after it ends.
+         starts.push_back(bound.lower_);
+
+         Key afterUpper = bound.upper_;
+         if (++afterUpper.second == 0)
+            afterUpper.first++;
+
+         if (afterUpper > bound.upper_)
+            starts.push_back(afterUpper);
+      }
+
+      std::sort(starts.begin(), starts.end());
+      starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+      std::sort(bounds.begin(), bounds.end(), [](const Bound &a, const Bound &b) { return a.lower_ < b.lower_; });
+
+      // The ranges are read in priority order, so among the ranges covering an interval
+      // the one read first wins. This is the same range the database query returned.
+      auto lowerWins = [](const Bound &a, const Bound &b) { return a.index_ > b.index_; };
+      std::priority_queue<Bound, std::vector<Bound>, decltype(lowerWins)> active(lowerWins);
+
+      size_t nextBound = 0;
+
+      for (const Key &start : starts)
+      {
+         while (nextBound < bounds.size() && bounds[nextBound].lower_ <= start)
+            active.push(bounds[nextBound++]);
+
+         // Ranges which ended before this interval are removed once they reach the top.
+         while (!active.empty() && active.top().upper_ < start)
+            active.pop();
+
+         int rangeIndex = active.empty() ? -1 : active.top().index_;
+
+         if (!intervals.empty() && intervals.back().range_index_ == rangeIndex)
+            continue;
+
+         Interval interval;
+         interval.start_ = start;
+         interval.range_index_ = rangeIndex;
+         intervals.push_back(interval);
+      }
+   }
+
+   SecurityRangeCache::Key
+   SecurityRangeCache::GetKey_(const IPAddress &address)
+   {
+      if (address.GetType() == IPAddress::IPV4)
+         return std::make_pair((unsigned __int64) 0, address.GetAddress1());
+
+      return std::make_pair(address.GetAddress1(), address.GetAddress2());
+   }
+}
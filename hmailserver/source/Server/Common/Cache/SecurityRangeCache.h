@@ -0,0 +1,61 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include "../TCPIP/IPAddress.h"
+
+namespace HM
+{
+   class SecurityRange;
+
+   // Keeps the IP ranges in memory, so that the range of a connecting client can be
+   // found without asking the database. The ranges are compiled into a sorted list of
+   // non-overlapping intervals, each one pointing at the range with the highest priority
+   // covering it. The list is never modified. When ranges are added, changed or removed,
+   // a new list is compiled and replaces the old one.
+   class SecurityRangeCache : public Singleton<SecurityRangeCache>
+   {
+   public:
+
+      SecurityRangeCache();
+
+      std::shared_ptr<SecurityRange> GetMatchingRange(const IPAddress &address);
+      // Returns the range with the highest priority which contains the address.
+
+      void Refresh();
+      // Reloads the ranges from the database.
+
+      void AddRange(std::shared_ptr<SecurityRange> range);
+      // Adds a range which has just been created, without reloading the others.
+
+   private:
+
+      typedef std::pair<unsigned __int64, unsigned __int64> Key;
+
+      struct Interval
+      {
+         Key start_;
+
+         // The matching range, or -1 if no range covers the interval.
+         int range_index_;
+      };
+
+      struct Table
+      {
+         std::vector<std::shared_ptr<SecurityRange> > ranges_;
+         std::vector<Interval> ipv4_;
+         std::vector<Interval> ipv6_;
+      };
+
+      static void Compile_(const std::vector<std::shared_ptr<SecurityRange> > &ranges, bool ipv6, std::vector<Interval> &intervals);
+      static Key GetKey_(const IPAddress &address);
+
+      // Held while a new table is being built, so that the last one stored is built
+      // from the latest ranges.
+      boost::mutex refresh_mutex_;
+
+      // Read and replaced using atomic_load and atomic_store.
+      std::shared_ptr<const Table> table_;
+   };
+}
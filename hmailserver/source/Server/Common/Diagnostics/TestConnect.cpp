@@ -22,6 +22,8 @@ namespace HM
    TestConnect::PerformTest(ConnectionSecurity connection_security, const String  &localAddressStr, const String &server, int port, String &result)
    {
       std::shared_ptr<IOService> io_service_wrapper = Application::Instance()->GetIOService();
+      std::shared_ptr<IOServiceShard> shard = io_service_wrapper->GetIOServiceShard();
+      boost::asio::io_service &connectionIOService = shard ? shard->GetIOService() : io_service_wrapper->GetIOService();
 
       IPAddress localAddress;
       if (!localAddressStr.IsEmpty())
@@ -73,7 +75,10 @@ namespace HM
          
          std::shared_ptr<TestConnectionResult> connection_result = std::make_shared<TestConnectionResult>();
 
-         std::shared_ptr<TestConnection> connection = std::make_shared<TestConnection>(connection_security, io_service_wrapper->GetIOService(), io_service_wrapper->GetClientContext(), disconnectEvent, server, connection_result);
+         std::shared_ptr<TestConnection> connection = std::make_shared<TestConnection>(connection_security, connectionIOService, io_service_wrapper->GetClientContext(), disconnectEvent, server, connection_result);
+         if (shard)
+            connection->SetIOServiceShard(shard);
+
          if (connection->Connect(ipAddressString, port, localAddress))
          {
             connection.reset();
@@ -0,0 +1,297 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+
+#include "MessagePartMap.h"
+#include "Mime.h"
+
+#include "../Util/File.h"
+#include "../Util/ByteBuffer.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   MessagePartMap::MessagePartMap() :
+      reading_header_(true),
+      current_header_start_(0),
+      has_open_leaf_(false),
+      previous_line_break_length_(0)
+   {
+
+   }
+
+   bool
+   MessagePartMap::Load(const String &fileName)
+   {
+      parts_.clear();
+      multiparts_.clear();
+      reading_header_ = true;
+      current_name_ = "";
+      current_header_start_ = 0;
+      current_header_ = "";
+      has_open_leaf_ = false;
+      previous_line_break_length_ = 0;
+
+      try
+      {
+         File file;
+         file.Open(fileName, File::OTReadOnly);
+
+         AnsiString line;
+         __int64 lineStart = 0;
+         __int64 position = 0;
+         char previousCharacter = 0;
+
+         for (;;)
+         {
+            std::shared_ptr<ByteBuffer> chunk = file.ReadChunk(ReadChunkSize);
+            size_t chunkSize = chunk->GetSize();
+
+            if (chunkSize == 0)
+               break;
+
+            const char *data = chunk->GetCharBuffer();
+            size_t index = 0;
+
+            while (index < chunkSize)
+            {
+               const char *lineFeed = (const char*) memchr(data + index, '\n', chunkSize - index);
+               size_t end = lineFeed ? (size_t) (lineFeed - data) + 1 : chunkSize;
+
+               if (line.GetLength() < MaxLineLength)
+                  line.append(data + index, min(end - index, (size_t) (MaxLineLength - line.GetLength())));
+
+               position += (__int64) (end - index);
+
+               if (lineFeed)
+               {
+                  // The carriage return may have been the last character of the previous chunk.
+                  char beforeLineFeed = end - index >= 2 ? data[end - 2] : previousCharacter;
+                  int lineBreakLength = beforeLineFeed == '\r' ? 2 : 1;
+
+                  ParseLine_(line, lineStart, position, lineBreakLength);
+
+                  line = "";
+                  lineStart = position;
+               }
+
+               previousCharacter = data[end - 1];
+               index = end;
+            }
+         }
+
+         if (position > lineStart)
+            ParseLine_(line, lineStart, position, 0);
+
+         EndOfFile_(position);
+      }
+      catch (...)
+      {
+         parts_.clear();
+         return false;
+      }
+
+      return true;
+   }
+
+   void
+   MessagePartMap::ParseLine_(AnsiString line, __int64 lineStart, __int64 lineEnd, int lineBreakLength)
+   {
+      // Lines which were cut at MaxLineLength have lost their line break already.
+      if (line.GetLength() > 0 && line[line.GetLength() - 1] == '\n')
+         line = line.Left(line.GetLength() - 1);
+      if (line.GetLength() > 0 && line[line.GetLength() - 1] == '\r')
+         line = line.Left(line.GetLength() - 1);
+
+      if (reading_header_)
+      {
+         if (line.IsEmpty())
+            EndHeader_(lineEnd);
+         else if (current_header_.GetLength() < MaxHeaderSize)
+            current_header_ += line + "\r\n";
+      }
+      else if (!multiparts_.empty() && line.Left(2) == "--")
+      {
+         ParseBoundary_(line, lineStart, lineEnd);
+      }
+
+      previous_line_break_length_ = lineBreakLength;
+   }
+
+   bool
+   MessagePartMap::ParseBoundary_(const AnsiString &line, __int64 lineStart, __int64 lineEnd)
+   {
+      // Start with the innermost multipart, since that's where the boundary normally belongs.
+      for (int level = (int) multiparts_.size() - 1; level >= 0; level--)
+      {
+         if (multiparts_[level].ended_)
+            continue;
+
+         const AnsiString &boundary = multiparts_[level].boundary_;
+
+         if (line.GetLength() < boundary.GetLength() + 2 ||
+             line.compare(2, boundary.GetLength(), boundary) != 0)
+            continue;
+
+         // The boundary may be followed by transport padding (RFC 2046, 5.1.1).
+         AnsiString rest = line.Mid(boundary.GetLength() + 2);
+         rest.TrimRight(" \t");
+
+         bool closing = rest.Left(2) == "--";
+
+         if (!rest.IsEmpty() && !closing)
+            continue;
+
+         // The line break before the boundary belongs to the boundary.
+         __int64 bodyEnd = lineStart - previous_line_break_length_;
+
+         if (has_open_leaf_)
+         {
+            EndPart_(open_leaf_name_, bodyEnd);
+            has_open_leaf_ = false;
+         }
+
+         // Multiparts inside this one which were never closed end here as well.
+         while ((int) multiparts_.size() > level + 1)
+         {
+            EndPart_(multiparts_.back().name_, bodyEnd);
+            multiparts_.pop_back();
+         }
+
+         Multipart &multipart = multiparts_.back();
+
+         if (closing)
+         {
+            // The rest of the multipart is the epilogue, which is ignored.
+            multipart.ended_ = true;
+            return true;
+         }
+
+         multipart.child_count_++;
+
+         AnsiString number;
+         number.Format("%d", multipart.child_count_);
+
+         current_name_ = multipart.name_.IsEmpty() ? number : multipart.name_ + "." + number;
+         current_header_start_ = lineEnd;
+         current_header_ = "";
+         reading_header_ = true;
+
+         return true;
+      }
+
+      return false;
+   }
+
+   void
+   MessagePartMap::EndHeader_(__int64 bodyStart)
+   {
+      reading_header_ = false;
+
+      MimeHeader header;
+      header.Load(current_header_.c_str(), current_header_.GetLength(), true);
+      current_header_ = "";
+
+      AnsiString mainType = header.GetMainType();
+      mainType.MakeLower();
+      mainType.Trim();
+
+      AnsiString boundary = header.GetBoundary();
+
+      const char *transferEncodingValue = header.GetTransferEncoding();
+      AnsiString transferEncoding = transferEncodingValue != nullptr ? transferEncodingValue : "";
+      transferEncoding.MakeLower();
+      transferEncoding.Trim();
+
+      Part part;
+      part.header_start_ = current_header_start_;
+      part.body_start_ = bodyStart;
+      part.body_end_ = bodyStart;
+      part.multipart_ = mainType == "multipart" && !boundary.IsEmpty();
+      part.encapsulated_ = mainType == "message";
+      part.identity_encoding_ = transferEncoding.IsEmpty() ||
+                                transferEncoding == "7bit" ||
+                                transferEncoding == "8bit" ||
+                                transferEncoding == "binary";
+
+      parts_[current_name_] = part;
+
+      if (part.multipart_ && (int) multiparts_.size() < MaxDepth)
+      {
+         Multipart multipart;
+         multipart.boundary_ = boundary;
+         multipart.name_ = current_name_;
+         multipart.child_count_ = 0;
+         multipart.ended_ = false;
+
+         multiparts_.push_back(multipart);
+      }
+      else
+      {
+         has_open_leaf_ = true;
+         open_leaf_name_ = current_name_;
+      }
+   }
+
+   void
+   MessagePartMap::EndPart_(const AnsiString &name, __int64 bodyEnd)
+   {
+      auto iter = parts_.find(name);
+      if (iter == parts_.end())
+         return;
+
+      (*iter).second.body_end_ = max(bodyEnd, (*iter).second.body_start_);
+   }
+
+   void
+   MessagePartMap::EndOfFile_(__int64 fileSize)
+   {
+      // A header which is never terminated by an empty line has no body.
+      if (reading_header_)
+         EndHeader_(fileSize);
+
+      if (has_open_leaf_)
+      {
+         EndPart_(open_leaf_name_, fileSize);
+         has_open_leaf_ = false;
+      }
+
+      while (!multiparts_.empty())
+      {
+         EndPart_(multiparts_.back().name_, fileSize);
+         multiparts_.pop_back();
+      }
+
+      // In a message which is not a multipart, the body is also part 1.
+      auto message = parts_.find("");
+      if (message != parts_.end() && !(*message).second.multipart_)
+         parts_["1"] = (*message).second;
+   }
+
+   bool
+   MessagePartMap::GetPart(const AnsiString &name, Part &part) const
+   {
+      auto iter = parts_.find(name);
+      if (iter == parts_.end())
+         return false;
+
+      part = (*iter).second;
+      return true;
+   }
+
+   size_t
+   MessagePartMap::GetEstimatedMemoryUsage() const
+   {
+      size_t size = sizeof(MessagePartMap);
+
+      for (auto iter = parts_.begin(); iter != parts_.end(); iter++)
+         size += sizeof(Part) + (*iter).first.GetLength() + 32;
+
+      return size;
+   }
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   // Records where the parts of a message file start and end. The file is scanned
+   // line by line, and only the headers of the parts are kept in memory while doing
+   // so, which makes it possible to read a part of a large message directly from
+   // the file without loading the message. The offsets are 64-bit, since message
+   // files may be larger than 2 GB.
+   class MessagePartMap
+   {
+   public:
+
+      struct Part
+      {
+         Part() :
+            header_start_(0),
+            body_start_(0),
+            body_end_(0),
+            multipart_(false),
+            encapsulated_(false),
+            identity_encoding_(true)
+         {
+
+         }
+
+         __int64 header_start_;
+         __int64 body_start_;
+
+         // The line break before the boundary which ends the part belongs to the
+         // boundary, and is not included.
+         __int64 body_end_;
+
+         bool multipart_;
+         bool encapsulated_;
+
+         // True if the content transfer encoding is 7bit, 8bit or binary.
+         bool identity_encoding_;
+      };
+
+      MessagePartMap();
+
+      bool Load(const String &fileName);
+
+      bool GetPart(const AnsiString &name, Part &part) const;
+      // The message itself has an empty name. The parts are named the way IMAP
+      // names them: 1, 2, 2.1 and so on. Parts inside encapsulated messages
+      // are not included.
+
+      size_t GetEstimatedMemoryUsage() const;
+
+   private:
+
+      enum Settings
+      {
+         ReadChunkSize = 64 * 1024,
+
+         // Boundary lines are short, so longer lines only need to be kept
+         // in full while reading a header.
+         MaxLineLength = 4096,
+         MaxHeaderSize = 256 * 1024,
+         MaxDepth = 32
+      };
+
+      struct Multipart
+      {
+         AnsiString boundary_;
+         AnsiString name_;
+         int child_count_;
+         bool ended_;
+      };
+
+      void ParseLine_(AnsiString line, __int64 lineStart, __int64 lineEnd, int lineBreakLength);
+      bool ParseBoundary_(const AnsiString &line, __int64 lineStart, __int64 lineEnd);
+      void EndHeader_(__int64 bodyStart);
+      void EndPart_(const AnsiString &name, __int64 bodyEnd);
+      void EndOfFile_(__int64 fileSize);
+
+      std::map<AnsiString, Part> parts_;
+
+      // The parsing state.
+      std::vector<Multipart> multiparts_;
+      bool reading_header_;
+      AnsiString current_name_;
+      __int64 current_header_start_;
+      AnsiString current_header_;
+      bool has_open_leaf_;
+      AnsiString open_leaf_name_;
+      int previous_line_break_length_;
+   };
+}
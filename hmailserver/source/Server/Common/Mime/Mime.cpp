@@ -60,17 +60,23 @@ namespace HM
    // search for string2 in string1 (strstr)
    static const char* FindString(const char* pszStr1, const char* pszStr2, const char* pszEnd)
    {
-      pszEnd -= ::strlen(pszStr2);
-      const char *s1, *s2;
+      size_t nLength = ::strlen(pszStr2);
+      if (nLength == 0)
+         return pszStr1 <= pszEnd ? pszStr1 : NULL;
+
+      // memchr in the runtime library compares many bytes at a time, so it's used to
+      // skip to the next possible match. Only those positions are compared in full.
+      pszEnd -= nLength;
       while (pszStr1 <= pszEnd)
       {
-         s1 = pszStr1;
-         s2 = pszStr2;
-         while (*s1 == *s2 && *s2)
-            s1++, s2++;
-         if (!*s2)
-            return pszStr1;
-         pszStr1++;
+         const char *pszFound = (const char*) memchr(pszStr1, pszStr2[0], pszEnd - pszStr1 + 1);
+         if (!pszFound)
+            return NULL;
+
+         if (memcmp(pszFound, pszStr2, nLength) == 0)
+            return pszFound;
+
+         pszStr1 = pszFound + 1;
       }
       return NULL;
    }
@@ -1404,7 +1410,7 @@ namespace HM
    }
 
    const char *
-      GetBoundaryEnd(const char *startSearch, const char *endSearch, string boundary)
+      GetBoundaryEnd(const char *startSearch, const char *endSearch, const string &boundary)
    {
       if (endSearch <= startSearch ||
          endSearch == 0 || 
@@ -1437,6 +1443,17 @@ namespace HM
             return possibleEnding;
          }
 
+         // The boundary may also be followed by transport padding (RFC 2046, 5.1.1).
+         const char *afterPadding = possibleEnding + boundary.size();
+         while (afterPadding < endSearch && (*afterPadding == ' ' || *afterPadding == '\t'))
+            afterPadding++;
+
+         if (afterPadding > possibleEnding + boundary.size() &&
+             afterPadding + 1 < endSearch && afterPadding[0] == '\r' && afterPadding[1] == '\n')
+         {
+            return possibleEnding;
+         }
+
          // false. try again.
          possibleEnding = FindString(possibleEnding+1, boundary.c_str(), endSearch);
       }
@@ -1474,8 +1491,8 @@ namespace HM
          string strBoundary = GetBoundary();
          if (!strBoundary.empty())
          {
-            strBoundary = "\r\n--" + strBoundary + "\r\n";
-            pszEnd = FindString(pszData-2, strBoundary.c_str(), pszEnd);
+            strBoundary = "\r\n--" + strBoundary;
+            pszEnd = GetBoundaryEnd(pszData-2, pszEnd, strBoundary);
             if (!pszEnd)
                pszEnd = pszData + nDataSize;
             else
@@ -1513,7 +1530,7 @@ namespace HM
       nDataSize += 2;
       pszEnd = pszData + nDataSize;
 
-      const char* pszBound1 = GetBoundaryEnd(pszData, pszEnd, strBoundary.c_str());
+      const char* pszBound1 = GetBoundaryEnd(pszData, pszEnd, strBoundary);
 
       int counter = 10000;
       while (pszBound1 != NULL && pszBound1 < pszEnd && counter > 0)
@@ -1527,9 +1544,7 @@ namespace HM
             return (int)(pszStart - pszDataBegin);	// reach the closing boundary
 
          // look for the next boundary
-         string strBoundaryLine = strBoundary + "\r\n";
-
-         const char* pszBound2 = GetBoundaryEnd(pszStart, pszEnd, strBoundary.c_str());
+         const char* pszBound2 = GetBoundaryEnd(pszStart, pszEnd, strBoundary);
 
          if (!pszBound2)				// overflow, boundary may be truncated
             pszBound2 = pszEnd;
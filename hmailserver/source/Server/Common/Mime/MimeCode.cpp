@@ -218,6 +218,8 @@ namespace HM
 	   unsigned char* pbSpace = NULL;
 	   int nLineLen = 0;
       int lastSpacePos = -1;
+
+      output.reserve(output.size() + input_size_ + input_size_ / 32);
 	   
       while (pbData < pbEnd)
 	   {
@@ -260,8 +262,8 @@ namespace HM
 	   const unsigned char* pbData = input_;
 	   const unsigned char* pbEnd = input_ + input_size_;
 	   int nLineLen = 0;
-   
-      int lastSpacePos = -1;
+
+      output.reserve(output.size() + input_size_ + input_size_ / 8);
 
 	   while (pbData < pbEnd)
 	   {
@@ -276,17 +278,11 @@ namespace HM
 				   bQuote = true;		// quote the SPACE/TAB
 			   else
 				   bCopy = true;		// copy the SPACE/TAB
-			   
-            if (nLineLen > 0)
-            {
-               lastSpacePos = (int) output.size();
-            }
 		   }
 		   else if (!quote_line_break_ && (ch == '\r' || ch == '\n'))
 		   {
 			   bCopy = true;			// keep 'hard' line break
 			   nLineLen = -1;
-			   lastSpacePos = -1;
 		   }
 		   else if (!quote_line_break_ && ch == '.')
 		   {
@@ -302,32 +298,12 @@ namespace HM
 		   else
 			   bCopy = true;			// copy this character
 
-         if (add_line_break_)
+         // Soft line break, so that no line is longer than MAX_MIME_LINE_LEN
+         // including the trailing =. A quoted character is never split.
+         if (add_line_break_ && nLineLen+(bQuote ? 3 : 1) >= MAX_MIME_LINE_LEN)
          {
-            if (nLineLen+(bQuote ? 3 : 1) >= MAX_MIME_LINE_LEN)
-		      {
-			      if (lastSpacePos != -1)
-			      {
-                  // TODO: Implement?!
-                  ASSERT(0);
-                  /*lastSpacePos++;
-				      int nSize = output.size() - lastSpacePos;
-                  
-                  output = output.Mid(0, lastSpacePos+2) + output.Mid(;
-                  
-
-				      ::memmove(pbSpace+3, pbSpace, nSize);
-				      nLineLen = nSize;*/
-			      }
-			      else
-			      {
-                  lastSpacePos = (int) output.size();
-				      //pbSpace = pbOutput;
-				      nLineLen = 0;
-			      }
-
-               output.append("=\r\n");
-		      }
+            output.append("=\r\n");
+            nLineLen = 0;
          }
 
 		   if (bQuote)
@@ -353,34 +329,38 @@ namespace HM
 	   const unsigned char* pbData = input_;
 	   const unsigned char* pbEnd = input_ + input_size_;
 
+      output.reserve(output.size() + input_size_);
+
 	   while (pbData < pbEnd)
 	   {
-		   unsigned char ch = *pbData++;
-		   if (ch == '=')
-		   {
-			   if (pbData+2 > pbEnd)
-				   break;				// invalid endcoding
-			   ch = *pbData++;
-			   if (CMimeChar::IsHexDigit(ch))
-			   {
-				   ch -= ch > '9' ? 0x37 : '0';
-               unsigned char charToAdd = ch << 4;
-				   ch = *pbData++;
-				   ch -= ch > '9' ? 0x37 : '0';
-               charToAdd |= ch & 0x0f;
+         // Copy the text up to the next escape in one go.
+         const unsigned char* pbEscape = (const unsigned char*) memchr(pbData, '=', pbEnd - pbData);
+         if (pbEscape == NULL)
+         {
+            output.append((const char*) pbData, pbEnd - pbData);
+            break;
+         }
 
-               output.append(1, charToAdd);
-			   }
-			   else if (ch == '\r' && *pbData == '\n')
-				   pbData++;			// Soft Line Break, eat it
-			   else					// invalid endcoding, let it go
-				   output.append(1, ch);
-		   }
-         else
+         output.append((const char*) pbData, pbEscape - pbData);
+         pbData = pbEscape + 1;
+
+         if (pbData+2 > pbEnd)
+            break;				// invalid endcoding
+         unsigned char ch = *pbData++;
+         if (CMimeChar::IsHexDigit(ch))
          {
-            output.append(1, ch);
+            ch -= ch > '9' ? 0x37 : '0';
+            unsigned char charToAdd = ch << 4;
+            ch = *pbData++;
+            ch -= ch > '9' ? 0x37 : '0';
+            charToAdd |= ch & 0x0f;
+
+            output.append(1, charToAdd);
          }
-			   
+         else if (ch == '\r' && *pbData == '\n')
+            pbData++;			// Soft Line Break, eat it
+         else					// invalid endcoding, let it go
+            output.append(1, ch);
 	   }
    }
 
@@ -431,64 +411,87 @@ namespace HM
    //////////////////////////////////////////////////////////////////////
    // MimeCodeBase64 - for base64 encoding mechanism
    //////////////////////////////////////////////////////////////////////
+   // Maps a base64 character to its 6-bit value. Other characters map to 64.
+   static const unsigned char s_Base64DecodeTable[256] =
+   {
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 62, 64, 64, 64, 63,
+      52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 64, 64, 64, 64, 64, 64,
+      64,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+      15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 64, 64, 64, 64, 64,
+      64, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+      41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+      64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64
+   };
+
    void MimeCodeBase64::Encode(AnsiString &result) const
    {
 	   static const char* s_Base64Table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-	   size_t nFrom, nLineLen = 0;
-	   unsigned char chHigh4bits = 0;
+      const unsigned char* pbData = input_;
+      const unsigned char* pbEnd = input_ + input_size_;
 
-	   for (nFrom=0; nFrom<input_size_; nFrom++)
-	   {
-		   unsigned char ch = input_[nFrom];
-		   switch (nFrom % 3)
-		   {
-		   case 0:
-            {
-               char c = s_Base64Table[ch >> 2];
-               result.append(1, c);
+      size_t nGroups = (input_size_ + 2) / 3;
+      size_t nLines = nGroups / (MAX_MIME_LINE_LEN / 4) + 1;
+      result.reserve(result.size() + nGroups * 4 + (add_line_break_ ? nLines * 2 : 0));
 
-			      chHigh4bits = (ch << 4) & 0x30;
-			      break;
-            }
+      // Whole groups of 3 bytes are encoded a line at a time. 76 = 19 * 4, so a
+      // line always ends on a group boundary.
+      char line[MAX_MIME_LINE_LEN + 2];
+      size_t nLineLen = 0;
 
-         case 1:
-            {
-               char c = s_Base64Table[chHigh4bits | (ch >> 4)];
-               result.append(1, c);
-			      chHigh4bits = (ch << 2) & 0x3c;
-			      break;
-            }
+      while (pbEnd - pbData >= 3)
+      {
+         size_t nLineGroups = min((size_t) (pbEnd - pbData) / 3, (size_t) (MAX_MIME_LINE_LEN / 4));
+         const unsigned char* pbLineEnd = pbData + nLineGroups * 3;
 
-		   default:
-            {
-               char c = s_Base64Table[chHigh4bits | (ch >> 6)];
-               result.append(1, c);
+         char* pbOutput = line;
+         while (pbData < pbLineEnd)
+         {
+            unsigned int n = (pbData[0] << 16) | (pbData[1] << 8) | pbData[2];
 
-               c = s_Base64Table[ch & 0x3f];
-               result.append(1, c);
+            pbOutput[0] = s_Base64Table[n >> 18];
+            pbOutput[1] = s_Base64Table[(n >> 12) & 0x3f];
+            pbOutput[2] = s_Base64Table[(n >> 6) & 0x3f];
+            pbOutput[3] = s_Base64Table[n & 0x3f];
 
-			      nLineLen++;
-            }
-		   }
+            pbOutput += 4;
+            pbData += 3;
+         }
 
-		   nLineLen++;
+         nLineLen = pbOutput - line;
 
-		   if (add_line_break_ && nLineLen >= MAX_MIME_LINE_LEN)
-		   {
-            result.append("\r\n");
-			   nLineLen = 0;
-		   }
-	   }
+         if (add_line_break_ && nLineLen >= MAX_MIME_LINE_LEN)
+         {
+            *pbOutput++ = '\r';
+            *pbOutput++ = '\n';
+            nLineLen = 0;
+         }
 
-	   if (nFrom % 3 != 0)	// 76 = 19 * 4, so the padding wouldn't exceed 76
-	   {
-         char c1 = s_Base64Table[chHigh4bits];
+         result.append(line, pbOutput - line);
+      }
 
-         result.append(1, c1);
-		   int nPad = 4 - (nFrom % 3) - 1;
-         result.append(nPad, '=');
-	   }
+      size_t nRemaining = pbEnd - pbData;
+      if (nRemaining > 0)	// the padding wouldn't exceed 76, since the line above was not full
+      {
+         unsigned int n = (pbData[0] << 16) | (nRemaining > 1 ? pbData[1] << 8 : 0);
+
+         line[0] = s_Base64Table[n >> 18];
+         line[1] = s_Base64Table[(n >> 12) & 0x3f];
+         line[2] = nRemaining > 1 ? s_Base64Table[(n >> 6) & 0x3f] : '=';
+         line[3] = '=';
+
+         result.append(line, 4);
+         nLineLen += 4;
+      }
 
 	   if (add_line_break_ && nLineLen != 0)	// add CRLF
          result.append("\r\n");
@@ -499,15 +502,50 @@ namespace HM
 	   const unsigned char* pbData = input_;
 	   const unsigned char* pbEnd = input_ + input_size_;
 
+      // Every 4 characters give at most 3 bytes.
+      size_t nStart = result.size();
+      result.resize(nStart + input_size_ / 4 * 3 + 3);
+
+      char* pbStart = &result[nStart];
+      char* pbOutput = pbStart;
+
 	   int nFrom = 0;
 	   unsigned char chHighBits = 0;
 
 	   while (pbData < pbEnd)
 	   {
+         // Decode whole groups directly, as long as they don't span a line break or
+         // contain the trailing pad.
+         if (nFrom % 4 == 0)
+         {
+            while (pbEnd - pbData >= 4)
+            {
+               unsigned int c0 = s_Base64DecodeTable[pbData[0]];
+               unsigned int c1 = s_Base64DecodeTable[pbData[1]];
+               unsigned int c2 = s_Base64DecodeTable[pbData[2]];
+               unsigned int c3 = s_Base64DecodeTable[pbData[3]];
+
+               if ((c0 | c1 | c2 | c3) >= 64)
+                  break;
+
+               unsigned int n = (c0 << 18) | (c1 << 12) | (c2 << 6) | c3;
+
+               pbOutput[0] = (char) (n >> 16);
+               pbOutput[1] = (char) (n >> 8);
+               pbOutput[2] = (char) n;
+
+               pbOutput += 3;
+               pbData += 4;
+            }
+
+            if (pbData >= pbEnd)
+               break;
+         }
+
 		   unsigned char ch = *pbData++;
 		   if (ch == '\r' || ch == '\n')
 			   continue;
-		   ch = (unsigned char) DecodeBase64Char(ch);
+		   ch = s_Base64DecodeTable[ch];
 		   if (ch >= 64)				// invalid encoding, or trailing pad '='
 			   break;
 
@@ -518,28 +556,22 @@ namespace HM
 			   break;
 
 		   case 1:
-            {
-               char charToAdd = (chHighBits | (ch >> 4));
-               result.append(1, charToAdd);
-               chHighBits = ch << 4;
-               break;
-            }
+			   *pbOutput++ = (char) (chHighBits | (ch >> 4));
+			   chHighBits = ch << 4;
+			   break;
+
 		   case 2:
-            {
-               char charToAdd = (chHighBits | (ch >> 2));
-               result.append(1, charToAdd);
-               chHighBits = ch << 6;
-               break;
-            }
+			   *pbOutput++ = (char) (chHighBits | (ch >> 2));
+			   chHighBits = ch << 6;
+			   break;
+
 		   default:
-            {
-               char charToAdd = (chHighBits | ch);
-               result.append(1, charToAdd);
-               break;
-            }
-            
+			   *pbOutput++ = (char) (chHighBits | ch);
+			   break;
 		   }
 	   }
+
+      result.resize(nStart + (pbOutput - pbStart));
    }
 
    //////////////////////////////////////////////////////////////////////
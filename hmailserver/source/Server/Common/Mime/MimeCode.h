@@ -225,22 +225,6 @@ namespace HM
 
    private:
 	   bool add_line_break_;
-
-   private:
-	   static inline int DecodeBase64Char(unsigned int nCode)
-	   {
-		   if (nCode >= 'A' && nCode <= 'Z')
-			   return nCode - 'A';
-		   if (nCode >= 'a' && nCode <= 'z')
-			   return nCode - 'a' + 26;
-		   if (nCode >= '0' && nCode <= '9')
-			   return nCode - '0' + 52;
-		   if (nCode == '+')
-			   return 62;
-		   if (nCode == '/')
-			   return 63;
-		   return 64;
-	   }
    };
 
    //////////////////////////////////////////////////////////////////////
@@ -23,9 +23,11 @@
 
 #include "../Cache/Cache.h"
 #include "../Cache/AccountSizeCache.h"
+#include "../Cache/CredentialCache.h"
 
 #include "../../IMAP/IMAPFolderContainer.h"
 #include "../../IMAP/MessagesContainer.h"
+#include "../../SMTP/RecipientExpansionIndex.h"
 
 #include "PreSaveLimitationsCheck.h"
 
@@ -84,6 +86,8 @@ namespace HM
 	  
       // Refresh caches.
       Cache<Account>::Instance()->RemoveObject(pAccount);
+      CredentialCache::Instance()->RemoveAccount(iID);
+      RecipientExpansionIndex::Instance()->Clear();
 
       return bRet;
    }
@@ -316,8 +320,14 @@ namespace HM
          }
       }
 
-	   if (!bNewObject)
-		  Cache<Account>::Instance()->RemoveObject(pAccount);
+      if (!bNewObject)
+      {
+         Cache<Account>::Instance()->RemoveObject(pAccount);
+         CredentialCache::Instance()->RemoveAccount(pAccount->GetID());
+      }
+
+      // Accounts take precedence over lists with the same address.
+      RecipientExpansionIndex::Instance()->Clear();
 
       return bRetVal;
    }
@@ -366,19 +376,35 @@ namespace HM
    }
 
    bool 
-   PersistentAccount::UpdateLastLogonTime(std::shared_ptr<const Account> pAccount)
+   PersistentAccount::UpdateLastLogonTime(const std::vector<__int64> &accountIDs, const String &lastLogonTime)
    {
-      if (!pAccount)
-         return false; 
+      bool result = true;
+
+      for (size_t start = 0; start < accountIDs.size(); start += MaxIDsPerStatement)
+      {
+         size_t end = min(start + MaxIDsPerStatement, accountIDs.size());
 
+         // The identifiers are numbers, so they are safe to put in the statement.
+         String idList;
+         for (size_t i = start; i < end; i++)
+         {
+            if (i > start)
+               idList += ", ";
 
-      AnsiString sCurrentTime = Time::GetCurrentDateTime();
+            idList.AppendFormat(_T("%I64d"), accountIDs[i]);
+         }
 
-      SQLCommand command("update hm_accounts set accountlastlogontime = @LASTLOGONTIME where accountid = @ACCOUNTID");
-      command.AddParameter("@LASTLOGONTIME", sCurrentTime);
-      command.AddParameter("@ACCOUNTID", pAccount->GetID());
+         String sql;
+         sql.Format(_T("update hm_accounts set accountlastlogontime = @LASTLOGONTIME where accountid in (%s)"), idList.c_str());
 
-      return Application::Instance()->GetDBManager()->Execute(command);
+         SQLCommand command(sql);
+         command.AddParameter("@LASTLOGONTIME", lastLogonTime);
+
+         if (!Application::Instance()->GetDBManager()->Execute(command))
+            result = false;
+      }
+
+      return result;
    }
 
    bool
@@ -28,7 +28,7 @@ namespace HM
       static bool ReadObject(std::shared_ptr<Account> pAccount,const String & sAddress);
       static bool ReadObject(std::shared_ptr<Account> pAccount,__int64 ObjectID);
 
-      static bool UpdateLastLogonTime(std::shared_ptr<const Account> pAccount);
+      static bool UpdateLastLogonTime(const std::vector<__int64> &accountIDs, const String &lastLogonTime);
 
       static bool GetIsVacationMessageOn(std::shared_ptr<const Account> pAccount);
       static bool CreateInbox(const Account &account);
@@ -38,6 +38,11 @@ namespace HM
    private:
 
       static bool ReadObject(std::shared_ptr<Account> pAccount,const SQLCommand &command);
+
+      enum Settings
+      {
+         MaxIDsPerStatement = 500
+      };
       
    };
 
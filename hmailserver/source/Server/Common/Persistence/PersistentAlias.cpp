@@ -11,6 +11,8 @@
 #include "../BO/Alias.h"
 #include "../Cache/Cache.h"
 
+#include "../../SMTP/RecipientExpansionIndex.h"
+
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
@@ -41,6 +43,7 @@ namespace HM
          bResult = Application::Instance()->GetDBManager()->Execute(command);
 
          Cache<Alias>::Instance()->RemoveObject(pAlias);
+         RecipientExpansionIndex::Instance()->Clear();
       }
 
       return bResult;
@@ -93,6 +96,9 @@ namespace HM
 
       Cache<Alias>::Instance()->RemoveObject(pAlias);
 
+      // Aliases take precedence over lists with the same address.
+      RecipientExpansionIndex::Instance()->Clear();
+
       return bRetVal;
    }
 
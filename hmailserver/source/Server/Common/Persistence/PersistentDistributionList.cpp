@@ -13,6 +13,8 @@
 
 #include "../Cache/Cache.h"
 
+#include "../../SMTP/RecipientExpansionIndex.h"
+
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
@@ -47,6 +49,7 @@ namespace HM
       bool bResult = Application::Instance()->GetDBManager()->Execute(deleteCommand);
    
       Cache<DistributionList>::Instance()->RemoveObject(pDistList);
+      RecipientExpansionIndex::Instance()->Clear();
 
       return bResult;
    }
@@ -152,6 +155,10 @@ namespace HM
 
       Cache<DistributionList>::Instance()->RemoveObject(pDistList);
 
+      // The address or the state of the list may have changed, which affects
+      // other lists which have it as a member.
+      RecipientExpansionIndex::Instance()->Clear();
+
       return bRetVal;
    }
    
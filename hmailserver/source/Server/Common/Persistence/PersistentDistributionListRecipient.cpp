@@ -10,6 +10,8 @@
 #include "../BO/DistributionList.h"
 #include "../Cache/Cache.h"
 
+#include "../../SMTP/RecipientExpansionIndex.h"
+
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
@@ -40,6 +42,7 @@ namespace HM
       bool bResult = Application::Instance()->GetDBManager()->Execute(command);
 
       Cache<DistributionList>::Instance()->RemoveObject(pRecipient->GetListID());
+      RecipientExpansionIndex::Instance()->OnMembersChanged(pRecipient->GetListID());
 
       return bResult;
    }
@@ -132,6 +135,7 @@ namespace HM
          pRecipient->SetID((int) iDBID);
 
       Cache<DistributionList>::Instance()->RemoveObject(pRecipient->GetListID());
+      RecipientExpansionIndex::Instance()->OnMembersChanged(pRecipient->GetListID());
 
       return bRetVal;
    }
@@ -21,6 +21,8 @@
 #include "../BO/DistributionListRecipient.h"
 #include "../Cache/CacheContainer.h"
 
+#include "../../SMTP/RecipientExpansionIndex.h"
+
 #include "NameChanger.h"
 
 #include "PreSaveLimitationsCheck.h"
@@ -70,6 +72,7 @@ namespace HM
          
          // Refresh the BO cache
          CacheContainer::Instance()->RemoveDomain(pDomain);
+         RecipientExpansionIndex::Instance()->Clear();
 
          // Delete folder from data directory
          String sDomainFolder = IniFileSettings::Instance()->GetDataDirectory() + "\\" + pDomain->GetName();
@@ -258,6 +261,7 @@ namespace HM
 
       // Refresh the BO cache
       CacheContainer::Instance()->RemoveDomain(pDomain);
+      RecipientExpansionIndex::Instance()->Clear();
 
       return bRetVal;
    }
@@ -5,6 +5,7 @@
 #include ".\PersistentDomainAlias.h"
 #include "..\BO\DomainAlias.h"
 #include "..\Application\ObjectCache.h"
+#include "..\..\SMTP\RecipientExpansionIndex.h"
 
 #include "PreSaveLimitationsCheck.h"
 #include "PersistenceMode.h"
@@ -66,6 +67,7 @@ namespace HM
          return false;
 
       ObjectCache::Instance()->SetDomainAliasesNeedsReload();
+      RecipientExpansionIndex::Instance()->Clear();
 
       return true;
    }
@@ -114,6 +116,7 @@ namespace HM
          oDA->SetID((int) iDBID);
 
       ObjectCache::Instance()->SetDomainAliasesNeedsReload();
+      RecipientExpansionIndex::Instance()->Clear();
 
       return true;
    }
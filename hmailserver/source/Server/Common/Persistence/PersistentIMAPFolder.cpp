@@ -23,6 +23,8 @@
 
 namespace HM
 {
+   boost::mutex PersistentIMAPFolder::modseq_mutexes_[ModSeqLockCount];
+
    PersistentIMAPFolder::PersistentIMAPFolder()
    {
 
@@ -245,4 +247,61 @@ namespace HM
 
       return newUID;
    }
+
+   __int64 
+   PersistentIMAPFolder::GetHighestModSeq_(__int64 folderID)
+   {
+      SQLCommand command("SELECT folderhighestmodseq FROM hm_imapfolders WHERE folderid = @FOLDERID");
+      command.AddParameter("@FOLDERID", folderID);
+
+      std::shared_ptr<DALRecordset> pRS = Application::Instance()->GetDBManager()->OpenRecordset(command);
+      if (!pRS || pRS->IsEOF())
+      {
+         String message;
+         message.Format(_T("Highest modification sequence for folder %I64d could not be looked up"), folderID);
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5529, "PersistentIMAPFolder::GetHighestModSeq_", message);
+
+         return 0;
+      }
+
+      return pRS->GetInt64Value("folderhighestmodseq");
+   }
+
+   bool 
+   PersistentIMAPFolder::IncreaseHighestModSeq_(__int64 folderID)
+   {
+      SQLCommand command("UPDATE hm_imapfolders SET folderhighestmodseq = folderhighestmodseq + 1 WHERE folderid = @FOLDERID");
+      command.AddParameter("@FOLDERID", folderID);
+
+      return Application::Instance()->GetDBManager()->Execute(command);
+   }
+
+   __int64 
+   PersistentIMAPFolder::GetNextModSeq(__int64 accountID, __int64 folderID)
+   {
+      if (folderID <= 0)
+         return 0;
+
+      // Two changes in the same folder must never get the same value, so the
+      // increase and the read-back are done as one step within this process.
+      // Only changes to folders sharing the lock wait for each other.
+      boost::lock_guard<boost::mutex> guard(modseq_mutexes_[folderID % ModSeqLockCount]);
+
+      if (!IncreaseHighestModSeq_(folderID))
+      {
+         String message;
+         message.Format(_T("Highest modification sequence for folder %I64d could not be increased"), folderID);
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5532, "PersistentIMAPFolder::GetNextModSeq", message);
+
+         return 0;
+      }
+
+      __int64 modSeq = GetHighestModSeq_(folderID);
+      if (modSeq == 0)
+         return 0;
+
+      IMAPFolderContainer::Instance()->UpdateHighestModSeq(accountID, folderID, modSeq);
+
+      return modSeq;
+   }
 }
\ No newline at end of file
@@ -27,6 +27,10 @@ namespace HM
 
       static unsigned int GetUniqueMessageID(__int64 accountID, __int64 folderID);
 
+      static __int64 GetNextModSeq(__int64 accountID, __int64 folderID);
+      // Increases the highest modification sequence of the folder and returns the new value,
+      // or 0 if it could not be increased.
+
       static __int64 GetUserInboxFolder(__int64 accountID);
 
    private:
@@ -34,6 +38,17 @@ namespace HM
       static bool IncreaseCurrentUID_(__int64 folderID);
       static unsigned int GetCurrentUID_(__int64 folderID);
 
+      static bool IncreaseHighestModSeq_(__int64 folderID);
+      static __int64 GetHighestModSeq_(__int64 folderID);
+
+      enum Settings
+      {
+         // Folders share this many locks when their modification sequences
+         // are increased, so changes in different folders rarely wait for
+         // each other.
+         ModSeqLockCount = 64
+      };
 
+      static boost::mutex modseq_mutexes_[ModSeqLockCount];
    };
 }
@@ -91,6 +91,10 @@ namespace HM
          // Reset the message ID.
          pMessage->SetID(0);
 
+         // Clients which resynchronize using the modification sequence need to see that the folder has changed.
+         if (pMessage->GetFolderID() > 0)
+            PersistentIMAPFolder::GetNextModSeq(pMessage->GetAccountID(), pMessage->GetFolderID());
+
          std::shared_ptr<const Account> account;
          
          if (pMessage->GetAccountID() > 0)
@@ -107,6 +111,159 @@ namespace HM
       return true;
    }
 
+   /*
+      Deletes several messages using one transaction for the database changes. The
+      message files are deleted once the transaction has been committed.
+   */
+   bool
+   PersistentMessage::DeleteObjects(const std::vector<std::shared_ptr<Message> > &messages)
+   {
+      std::vector<__int64> messageIDs;
+      std::vector<__int64> undeliveredMessageIDs;
+      std::vector<__int64> deliveredMessageIDs;
+      std::set<std::pair<__int64, __int64> > folders;
+
+      for (std::shared_ptr<Message> message : messages)
+      {
+         if (message->GetID() <= 0)
+            continue;
+
+         messageIDs.push_back(message->GetID());
+
+         if (message->GetFolderID() > 0)
+            folders.insert(std::make_pair(message->GetAccountID(), message->GetFolderID()));
+
+         // Messages in the queue have recipients, delivered messages may have meta data.
+         if (message->GetState() != Message::Delivered)
+            undeliveredMessageIDs.push_back(message->GetID());
+         else
+            deliveredMessageIDs.push_back(message->GetID());
+      }
+
+      if (messageIDs.empty())
+         return true;
+
+      std::shared_ptr<DatabaseConnectionManager> dbManager = Application::Instance()->GetDBManager();
+
+      String errorMessage;
+      std::shared_ptr<DALConnection> connection = dbManager->BeginTransaction(errorMessage);
+      if (!connection)
+      {
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5525, "PersistentMessage::DeleteObjects", Formatter::Format("Unable to start database transaction: {0}", errorMessage));
+         return false;
+      }
+
+      bool result = ExecuteForIDs_(connection, "delete from hm_messages where messageid in ", messageIDs, errorMessage) &&
+                    ExecuteForIDs_(connection, "delete from hm_messagerecipients where recipientmessageid in ", undeliveredMessageIDs, errorMessage);
+
+      if (result && Configuration::Instance()->GetMessageIndexing())
+         result = ExecuteForIDs_(connection, "delete from hm_message_metadata where metadata_messageid in ", deliveredMessageIDs, errorMessage);
+
+      if (!result)
+      {
+         String rollbackErrorMessage;
+         dbManager->RollbackTransaction(connection, rollbackErrorMessage);
+         return false;
+      }
+
+      if (!dbManager->CommitTransaction(connection, errorMessage))
+      {
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5526, "PersistentMessage::DeleteObjects", Formatter::Format("Unable to commit database transaction: {0}", errorMessage));
+         return false;
+      }
+
+      // One modification sequence per folder covers all messages expunged from it.
+      for (auto folder : folders)
+         PersistentIMAPFolder::GetNextModSeq(folder.first, folder.second);
+
+      bool filesDeleted = true;
+
+      for (std::shared_ptr<Message> message : messages)
+      {
+         if (message->GetID() <= 0)
+            continue;
+
+         std::shared_ptr<const Account> account;
+
+         if (message->GetAccountID() > 0)
+         {
+            AccountSizeCache::Instance()->ModifySize(message->GetAccountID(), message->GetSize(), false);
+            account = CacheContainer::Instance()->GetAccount(message->GetAccountID());
+         }
+
+         // Reset the message ID.
+         message->SetID(0);
+
+         if (!DeleteFile(account, message))
+            filesDeleted = false;
+      }
+
+      return filesDeleted;
+   }
+
+   bool
+   PersistentMessage::ExecuteForIDs_(std::shared_ptr<DALConnection> connection, const String &statement, const std::vector<__int64> &ids, String &errorMessage)
+   {
+      for (size_t start = 0; start < ids.size(); start += MaxIDsPerStatement)
+      {
+         size_t end = min(start + MaxIDsPerStatement, ids.size());
+
+         SQLCommand command(statement + "(" + FormatIDList_(ids, start, end) + ")");
+
+         if (!connection->Execute(command, errorMessage))
+            return false;
+      }
+
+      return true;
+   }
+
+   bool
+   PersistentMessage::SelectForIDs_(std::shared_ptr<DALConnection> connection, const String &statement, const std::vector<__int64> &ids, std::set<__int64> &result, String &errorMessage)
+   //---------------------------------------------------------------------------()
+   // DESCRIPTION:
+   // Runs a statement which selects messageid, ending with "messageid IN ", for
+   // a list of message identifiers, and collects the selected identifiers.
+   //---------------------------------------------------------------------------()
+   {
+      for (size_t start = 0; start < ids.size(); start += MaxIDsPerStatement)
+      {
+         size_t end = min(start + MaxIDsPerStatement, ids.size());
+
+         SQLCommand command(statement + "(" + FormatIDList_(ids, start, end) + ")");
+
+         std::shared_ptr<DALRecordset> recordset = connection->CreateRecordset();
+         if (!recordset->Open(connection, command))
+         {
+            errorMessage = "Unable to read messages: " + command.GetQueryString();
+            return false;
+         }
+
+         while (!recordset->IsEOF())
+         {
+            result.insert(recordset->GetInt64Value("messageid"));
+            recordset->MoveNext();
+         }
+      }
+
+      return true;
+   }
+
+   String
+   PersistentMessage::FormatIDList_(const std::vector<__int64> &ids, size_t start, size_t end)
+   {
+      // The identifiers are numbers, so they are safe to put in the statement.
+      String idList;
+      for (size_t i = start; i < end; i++)
+      {
+         if (i > start)
+            idList += ", ";
+
+         idList.AppendFormat(_T("%I64d"), ids[i]);
+      }
+
+      return idList;
+   }
+
    bool
    PersistentMessage::GetMessageID(const String &fileName, __int64 &messageID, bool &isPartialFilename)
    {
@@ -206,6 +363,7 @@ namespace HM
 
       pMessage->SetFlags((short) pRS->GetLongValue("messageflags"));
       pMessage->SetUID((unsigned int) pRS->GetLongValue("messageuid"));
+      pMessage->SetModSeq(pRS->GetInt64Value("messagemodseq"));
 
       if (bReadRecipients)
       {
@@ -625,6 +783,17 @@ namespace HM
          oStatement.AddColumnInt64("messageuid", pMessage->GetUID());
       }
 
+      if (pMessage->GetFolderID() > 0)
+      {
+         // Delivering, moving or updating a message in a folder is a change to that folder.
+         __int64 modSeq = PersistentIMAPFolder::GetNextModSeq(pMessage->GetAccountID(), pMessage->GetFolderID());
+         if (modSeq == 0)
+            return false;
+
+         pMessage->SetModSeq(modSeq);
+         oStatement.AddColumnInt64("messagemodseq", pMessage->GetModSeq());
+      }
+
 
       if (bNewObject)
       {
@@ -1261,15 +1430,83 @@ namespace HM
    PersistentMessage::SaveFlags(std::shared_ptr<Message> message)
    {
       // Create a statement object.
-      String statement = "UPDATE hm_messages SET messageflags = @FLAGS WHERE messageid = @MESSAGEID";
+      String statement = "UPDATE hm_messages SET messageflags = @FLAGS, messagemodseq = @MODSEQ WHERE messageid = @MESSAGEID";
 
       SQLCommand sqlCommand(statement);
       sqlCommand.AddParameter("@FLAGS", message->GetFlags());
+      sqlCommand.AddParameter("@MODSEQ", message->GetModSeq());
       sqlCommand.AddParameter("@MESSAGEID", message->GetID());
 
       return Application::Instance()->GetDBManager()->Execute(sqlCommand);
    }
 
+   bool
+   PersistentMessage::SaveFlags(const std::map<__int64, short> &messageFlags, __int64 modSeq, __int64 unchangedSince, std::set<__int64> &modifiedMessageIDs)
+   {
+      if (messageFlags.empty())
+         return true;
+
+      // A STORE on a range normally results in a handful of distinct flag values.
+      std::map<short, std::vector<__int64> > messagesByFlags;
+      for (auto iter : messageFlags)
+         messagesByFlags[iter.second].push_back(iter.first);
+
+      std::shared_ptr<DatabaseConnectionManager> dbManager = Application::Instance()->GetDBManager();
+
+      String errorMessage;
+      std::shared_ptr<DALConnection> connection = dbManager->BeginTransaction(errorMessage);
+      if (!connection)
+      {
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5527, "PersistentMessage::SaveFlags", Formatter::Format("Unable to start database transaction: {0}", errorMessage));
+         return false;
+      }
+
+      for (auto iter : messagesByFlags)
+      {
+         String statement;
+         if (unchangedSince >= 0)
+            statement.Format(_T("UPDATE hm_messages SET messageflags = %d, messagemodseq = %I64d WHERE messagemodseq <= %I64d AND messageid IN "), iter.first, modSeq, unchangedSince);
+         else
+            statement.Format(_T("UPDATE hm_messages SET messageflags = %d, messagemodseq = %I64d WHERE messageid IN "), iter.first, modSeq);
+
+         if (!ExecuteForIDs_(connection, statement, iter.second, errorMessage))
+         {
+            String rollbackErrorMessage;
+            dbManager->RollbackTransaction(connection, rollbackErrorMessage);
+            return false;
+         }
+      }
+
+      if (unchangedSince >= 0)
+      {
+         // The mod-sequence was reserved for this call, so a message which doesn't have it
+         // was changed by someone else after unchangedSince and was not updated above.
+         std::vector<__int64> messageIDs;
+         for (auto iter : messageFlags)
+            messageIDs.push_back(iter.first);
+
+         String statement;
+         statement.Format(_T("SELECT messageid FROM hm_messages WHERE messagemodseq <> %I64d AND messageid IN "), modSeq);
+
+         if (!SelectForIDs_(connection, statement, messageIDs, modifiedMessageIDs, errorMessage))
+         {
+            ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5533, "PersistentMessage::SaveFlags", errorMessage);
+
+            String rollbackErrorMessage;
+            dbManager->RollbackTransaction(connection, rollbackErrorMessage);
+            return false;
+         }
+      }
+
+      if (!dbManager->CommitTransaction(connection, errorMessage))
+      {
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5528, "PersistentMessage::SaveFlags", Formatter::Format("Unable to commit database transaction: {0}", errorMessage));
+         return false;
+      }
+
+      return true;
+   }
+
    bool 
    PersistentMessage::IsPartialPath(const String &path)
    {
@@ -9,6 +9,7 @@ namespace HM
    class Domain;
    class Account;
    class IMAPFolder;
+   class DALConnection;
    enum PersistenceMode;
 
    class PersistentMessage 
@@ -30,6 +31,7 @@ namespace HM
       static std::shared_ptr<Message> CopyFromQueueToInbox(std::shared_ptr<Message> sourceMessage, std::shared_ptr<const Account> destinationAccount);
 
       static bool DeleteObject(std::shared_ptr<Message> pMessage);
+      static bool DeleteObjects(const std::vector<std::shared_ptr<Message> > &messages);
       static bool SaveObject(std::shared_ptr<Message> pMessage);
       static bool SaveObject(std::shared_ptr<Message> pMessage, String &errorMessage, PersistenceMode mode);
       static bool AddObject(const std::shared_ptr<Message> pMessage);
@@ -72,11 +74,25 @@ namespace HM
       static bool GetPartialFilename(const String &fullPath, String &partialPath);
 
       static bool SaveFlags(std::shared_ptr<Message> message);
+      static bool SaveFlags(const std::map<__int64, short> &messageFlags, __int64 modSeq, __int64 unchangedSince, std::set<__int64> &modifiedMessageIDs);
+      // Saves the flags of several messages in one transaction. Messages which end up
+      // with the same flags are updated using a single statement. If unchangedSince is
+      // zero or above, only messages whose mod-sequence is not above it are updated.
+      // The others are returned in modifiedMessageIDs.
 
       static bool IsPartialPath(const String &path);
       int GetLatestMessageId();
 
    private:
+
+      enum Settings
+      {
+         MaxIDsPerStatement = 500
+      };
+
+      static bool ExecuteForIDs_(std::shared_ptr<DALConnection> connection, const String &statement, const std::vector<__int64> &ids, String &errorMessage);
+      static bool SelectForIDs_(std::shared_ptr<DALConnection> connection, const String &statement, const std::vector<__int64> &ids, std::set<__int64> &result, String &errorMessage);
+      static String FormatIDList_(const std::vector<__int64> &ids, size_t start, size_t end);
       
       static std::shared_ptr<Message> CreateCopy_(std::shared_ptr<Message> sourceMessage, int destinationAccountID);
 
@@ -8,6 +8,7 @@
 #include "..\BO\Message.h"
 
 #include "..\SQL\SQLStatement.h"
+#include "..\SQL\DatabaseSettings.h"
 #include "..\Util\Time.h"
 
 #ifdef _DEBUG
@@ -191,6 +192,120 @@ namespace HM
       return bRetVal;
    }
 
+   /*
+      Saves the metadata of several messages in one transaction, using
+      statements which insert many rows at a time.
+   */
+   bool
+   PersistentMessageMetaData::SaveObjects(const std::vector<std::shared_ptr<MessageMetaData> > &metaData)
+   {
+      if (metaData.empty())
+         return true;
+
+      std::shared_ptr<DatabaseConnectionManager> dbManager = Application::Instance()->GetDBManager();
+
+      String errorMessage;
+      std::shared_ptr<DALConnection> connection = dbManager->BeginTransaction(errorMessage);
+      if (!connection)
+      {
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5523, "PersistentMessageMetaData::SaveObjects", Formatter::Format("Unable to start database transaction: {0}", errorMessage));
+         return false;
+      }
+
+      // SQL Server Compact Edition does not support inserting several rows in one statement.
+      size_t rowsPerStatement = IniFileSettings::Instance()->GetDatabaseType() == DatabaseSettings::TypeMSSQLCompactEdition ? 1 : MaxRowsPerInsert;
+
+      for (size_t start = 0; start < metaData.size(); start += rowsPerStatement)
+      {
+         size_t end = min(start + rowsPerStatement, metaData.size());
+
+         SQLCommand command = CreateInsertCommand_(metaData, start, end, connection->GetSupportsCommandParameters());
+
+         if (!connection->Execute(command, errorMessage))
+         {
+            String rollbackErrorMessage;
+            dbManager->RollbackTransaction(connection, rollbackErrorMessage);
+            return false;
+         }
+      }
+
+      if (!dbManager->CommitTransaction(connection, errorMessage))
+      {
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5524, "PersistentMessageMetaData::SaveObjects", Formatter::Format("Unable to commit database transaction: {0}", errorMessage));
+         return false;
+      }
+
+      return true;
+   }
+
+   SQLCommand
+   PersistentMessageMetaData::CreateInsertCommand_(const std::vector<std::shared_ptr<MessageMetaData> > &metaData, size_t start, size_t end, bool useParameters)
+   {
+      SQLCommand command;
+
+      DatabaseSettings::SQLDBType dbType = IniFileSettings::Instance()->GetDatabaseType();
+
+      String sql = "INSERT INTO hm_message_metadata (metadata_accountid, metadata_folderid, metadata_messageid, metadata_dateutc, metadata_from, metadata_subject, metadata_to, metadata_cc) ";
+
+      // SQL Server 2000 and 2005 lack multi-row VALUES lists, so rows are combined using UNION ALL.
+      bool useUnion = dbType == DatabaseSettings::TypeMSSQLServer;
+
+      sql += useUnion ? "SELECT " : "VALUES (";
+
+      for (size_t row = start; row < end; row++)
+      {
+         std::shared_ptr<MessageMetaData> rowData = metaData[row];
+
+         if (row > start)
+            sql += useUnion ? " UNION ALL SELECT " : "), (";
+
+         // If the date is older than 1800, don't store it. This is to solve
+         // limitations in SQL Server.
+         DateTime date = rowData->GetDate();
+         bool hasDate = date.GetStatus() != DateTime::invalid && date.GetYear() >= 1800;
+
+         std::vector<String> stringValues;
+         if (hasDate)
+            stringValues.push_back(Time::GetTimeStampFromDateTime(date));
+         stringValues.push_back(rowData->GetFrom().Mid(0, 100));
+         stringValues.push_back(rowData->GetSubject().Mid(0, 100));
+         stringValues.push_back(rowData->GetTo().Mid(0, 100));
+         stringValues.push_back(rowData->GetCC().Mid(0, 100));
+
+         sql += Formatter::Format("{0}, {1}, {2}, ", rowData->GetAccountID(), rowData->GetFolderID(), rowData->GetMessageID());
+
+         if (!hasDate)
+            sql += "NULL, ";
+
+         for (size_t column = 0; column < stringValues.size(); column++)
+         {
+            if (column > 0)
+               sql += ", ";
+
+            if (useParameters)
+            {
+               // All names have the same length, so that no name is a prefix of another.
+               String parameterName;
+               parameterName.Format(_T("@R%05dC%d"), (int) (row - start), (int) column);
+
+               sql += parameterName;
+               command.AddParameter(parameterName, stringValues[column]);
+            }
+            else
+            {
+               sql += "'" + SQLStatement::Escape(stringValues[column]) + "'";
+            }
+         }
+      }
+
+      if (!useUnion)
+         sql += ")";
+
+      command.SetQueryString(sql);
+
+      return command;
+   }
+
    /*
       Delete metadata info for messages no longer in the system.
    */
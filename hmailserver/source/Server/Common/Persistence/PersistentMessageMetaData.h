@@ -31,8 +31,20 @@ namespace HM
       bool DeleteForMessage(std::shared_ptr<Message> message);
       void GetMetaData(int accountID, int folderID, const String &headerField, std::map<__int64, String > &result);
       bool SaveObject(std::shared_ptr<MessageMetaData> metaData);
+      bool SaveObjects(const std::vector<std::shared_ptr<MessageMetaData> > &metaData);
       bool DeleteOrphanedItems();
       int GetTotalMessageCount();
       void Clear();
+
+   private:
+
+      enum Settings
+      {
+         // Keeps the number of parameters per statement well below the
+         // 2100 parameters supported by SQL Server.
+         MaxRowsPerInsert = 100
+      };
+
+      SQLCommand CreateInsertCommand_(const std::vector<std::shared_ptr<MessageMetaData> > &metaData, size_t start, size_t end, bool useParameters);
    };
 }
\ No newline at end of file
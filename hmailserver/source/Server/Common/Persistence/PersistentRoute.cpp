@@ -6,10 +6,13 @@
 
 #include "../BO/Route.h"
 #include "../BO/RouteAddresses.h"
+#include "../BO/Routes.h"
 #include "../Util/Crypt.h"
 #include "PersistentRouteAddress.h"
 #include "PreSaveLimitationsCheck.h"
 
+#include "../../SMTP/SMTPConfiguration.h"
+
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
@@ -39,7 +42,11 @@ namespace HM
       // Delete the route object itself.
       SQLCommand command("delete from hm_routes where routeid = @ROUTEID");
       command.AddParameter("@ROUTEID", pRoute->GetID());
-      return Application::Instance()->GetDBManager()->Execute(command);
+      bool bResult = Application::Instance()->GetDBManager()->Execute(command);
+
+      ResetMatchTable_();
+
+      return bResult;
    }
 
    bool 
@@ -96,9 +103,24 @@ namespace HM
       if (bRetVal && bNewObject)
          pRoute->SetID((int) iDBID);
 
+      // The domain name may have been changed.
+      ResetMatchTable_();
+
       return true;
    }
 
+   void
+   PersistentRoute::ResetMatchTable_()
+   {
+      std::shared_ptr<SMTPConfiguration> smtpConfiguration = Configuration::Instance()->GetSMTPConfiguration();
+      if (!smtpConfiguration)
+         return;
+
+      std::shared_ptr<Routes> routes = smtpConfiguration->GetRoutes();
+      if (routes)
+         routes->ResetMatchTable();
+   }
+
    bool
    PersistentRoute::ReadObject(std::shared_ptr<Route> pRoute, long lID)
    {
@@ -20,6 +20,10 @@ namespace HM
       static bool SaveObject(std::shared_ptr<Route> pRoute, String &sErrorMessage, PersistenceMode mode);
       static bool ReadObject(std::shared_ptr<Route> pRoute, long lID);
       static bool ReadObject(std::shared_ptr<Route> pRoute, std::shared_ptr<DALRecordset> pRS);
+
+   private:
+
+      static void ResetMatchTable_();
    };
    
 }
@@ -11,6 +11,7 @@
 #include "../Util/Time.h"
 
 #include "../SQL/IPAddressSQLHelper.h"
+#include "../Cache/SecurityRangeCache.h"
 
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
@@ -43,6 +44,9 @@ namespace HM
          bResult = Application::Instance()->GetDBManager()->Execute(command);
       }
 
+      if (bResult)
+         SecurityRangeCache::Instance()->Refresh();
+
       return bResult;
 
    }
@@ -109,6 +113,10 @@ namespace HM
 
       if (!bRetVal)
          result = "Failed to save. Please see the hMailServer error log for details.";
+      else if (bNewObject)
+         SecurityRangeCache::Instance()->AddRange(pSR);
+      else
+         SecurityRangeCache::Instance()->Refresh();
 
       return bRetVal;
    }
@@ -217,13 +225,42 @@ namespace HM
    }
 
 
+   bool
+   PersistentSecurityRange::ReadAll(std::vector<std::shared_ptr<SecurityRange> > &ranges)
+   {
+      // The ranges are returned in priority order.
+      SQLCommand command(_T("select * from hm_securityranges order by rangepriorityid desc, rangeid asc"));
+
+      std::shared_ptr<DALRecordset> recordset = Application::Instance()->GetDBManager()->OpenRecordset(command);
+      if (!recordset)
+         return false;
+
+      while (!recordset->IsEOF())
+      {
+         std::shared_ptr<SecurityRange> securityRange = std::shared_ptr<SecurityRange>(new SecurityRange());
+
+         if (!ReadObject(securityRange, recordset))
+            return false;
+
+         ranges.push_back(securityRange);
+
+         recordset->MoveNext();
+      }
+
+      return true;
+   }
+
    bool 
    PersistentSecurityRange::DeleteExpired()
    {
       SQLCommand command(_T("delete from hm_securityranges where rangeexpires = 1 AND rangeexpirestime < @TIME"));
       command.AddParameter("@TIME", Time::GetCurrentDateTime());
 
-      return Application::Instance()->GetDBManager()->Execute(command);
+      bool result = Application::Instance()->GetDBManager()->Execute(command);
+
+      SecurityRangeCache::Instance()->Refresh();
+
+      return result;
    }
 
    bool
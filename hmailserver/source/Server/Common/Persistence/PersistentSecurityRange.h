@@ -25,6 +25,7 @@ namespace HM
       static bool ReadObject(std::shared_ptr<SecurityRange> pSR, __int64 ObjectID);
 
       static std::shared_ptr<SecurityRange> ReadMatchingIP(const IPAddress &ipaddress);
+      static bool ReadAll(std::vector<std::shared_ptr<SecurityRange> > &ranges);
 
       static bool DeleteExpired();
 
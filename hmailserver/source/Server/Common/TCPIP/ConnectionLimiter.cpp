@@ -0,0 +1,210 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "ConnectionLimiter.h"
+#include "IPAddress.h"
+
+#include "../BO/SecurityRange.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   ConnectionLimiter::ConnectionLimiter() :
+      concurrency_limited_count_(0),
+      rate_limited_count_(0),
+      held_connections_(0)
+   {
+      SlotState empty;
+      empty.fingerprint_ = 0;
+      empty.connections_ = 0;
+      empty.window_ = 0;
+      empty.rate_ = 0;
+
+      for (int i = 0; i < SlotCount; i++)
+      {
+         address_slots_[i] = empty;
+         network_slots_[i] = empty;
+      }
+   }
+
+   ConnectionLimiter::Result
+   ConnectionLimiter::TryAcquire(const IPAddress &address, std::shared_ptr<SecurityRange> securityRange, Lease &lease)
+   {
+      // Webmail and other clients on trusted networks open many connections from the same address.
+      if (address.GetAddress().is_loopback() || (securityRange && !securityRange->GetSpamProtection()))
+         return Allowed;
+
+      IniFileSettings *settings = IniFileSettings::Instance();
+
+      int maxPerAddress = settings->GetMaxConnectionsPerIP();
+      int maxPerNetwork = settings->GetMaxConnectionsPerNetwork();
+      int maxRate = settings->GetMaxConnectionsPerIPPerMinute();
+
+      unsigned __int64 address1 = address.GetAddress1();
+      unsigned __int64 address2 = address.GetAddress2();
+      bool ipv6 = address.GetType() == IPAddress::IPV6;
+
+      unsigned int window = (unsigned int) (boost::chrono::duration_cast<boost::chrono::seconds>(boost::chrono::steady_clock::now().time_since_epoch()).count() / RateWindowSeconds);
+
+      Result result = TryAcquireSlot_(address_slots_, address1, address2, maxPerAddress, maxRate, window, lease.address_slot_);
+
+      if (result == Allowed)
+      {
+         result = ipv6 ? 
+            TryAcquireSlot_(network_slots_, address1, 1, maxPerNetwork, 0, window, lease.network_slot_) :
+            TryAcquireSlot_(network_slots_, address1 >> 8, 0, maxPerNetwork, 0, window, lease.network_slot_);
+
+         if (result != Allowed && lease.address_slot_ >= 0)
+         {
+            ReleaseSlot_(address_slots_[lease.address_slot_]);
+            lease.address_slot_ = -1;
+         }
+      }
+
+      if (result == RefusedByRateLimit)
+         rate_limited_count_++;
+      else if (result == RefusedByConcurrencyLimit)
+         concurrency_limited_count_++;
+
+      return result;
+   }
+
+   void
+   ConnectionLimiter::Release(const Lease &lease)
+   {
+      if (lease.address_slot_ >= 0)
+         ReleaseSlot_(address_slots_[lease.address_slot_]);
+
+      if (lease.network_slot_ >= 0)
+         ReleaseSlot_(network_slots_[lease.network_slot_]);
+   }
+
+   bool
+   ConnectionLimiter::TryStartHold()
+   {
+      if (held_connections_.fetch_add(1) >= MaxHeldConnections)
+      {
+         held_connections_--;
+         return false;
+      }
+
+      return true;
+   }
+
+   ConnectionLimiter::Result
+   ConnectionLimiter::TryAcquireSlot_(Slot *slots, unsigned __int64 key1, unsigned __int64 key2, int maxConnections, int maxRate, unsigned int window, int &slotIndex)
+   {
+      // Mixes the bits so that neighbouring addresses end up in different slots.
+      unsigned __int64 hash = (key1 ^ (key2 * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+      unsigned int fingerprint = (unsigned int) (hash >> 32);
+      hash ^= hash >> 33;
+
+      for (;;)
+      {
+         int index = FindSlot_(slots, hash, fingerprint, window);
+
+         // All the slots the address may use count other addresses.
+         if (index < 0)
+            return Allowed;
+
+         Slot &slot = slots[index];
+         SlotState current = slot.load();
+
+         for (;;)
+         {
+            SlotState next = current;
+
+            if (current.fingerprint_ != fingerprint)
+            {
+               // Taken by another address since it was found. Look again.
+               if (!IsIdle_(current, window))
+                  break;
+
+               next.fingerprint_ = fingerprint;
+               next.connections_ = 0;
+               next.rate_ = 0;
+            }
+
+            if (next.window_ != window)
+            {
+               next.window_ = window;
+               next.rate_ = 0;
+            }
+
+            if (maxRate > 0)
+            {
+               if ((int) next.rate_ >= maxRate)
+                  return RefusedByRateLimit;
+
+               next.rate_++;
+            }
+
+            // Connections refused by the concurrency limit still count towards the rate.
+            Result result = Allowed;
+
+            if (maxConnections > 0 && next.connections_ >= maxConnections)
+               result = RefusedByConcurrencyLimit;
+            else
+               next.connections_++;
+
+            if (slot.compare_exchange_weak(current, next))
+            {
+               if (result == Allowed)
+                  slotIndex = index;
+
+               return result;
+            }
+         }
+      }
+   }
+
+   int
+   ConnectionLimiter::FindSlot_(Slot *slots, unsigned __int64 hash, unsigned int fingerprint, unsigned int window)
+   {
+      // The slot already counting the address is preferred over an idle one,
+      // so that all its connections are counted in the same slot.
+      int idleIndex = -1;
+
+      for (int probe = 0; probe < MaxProbes; probe++)
+      {
+         int index = (int) ((hash + probe) % SlotCount);
+         SlotState state = slots[index].load();
+
+         if (state.fingerprint_ == fingerprint)
+            return index;
+
+         if (idleIndex < 0 && IsIdle_(state, window))
+            idleIndex = index;
+      }
+
+      return idleIndex;
+   }
+
+   bool
+   ConnectionLimiter::IsIdle_(const SlotState &state, unsigned int window)
+   {
+      // The slot may be given to another address once it has no connections
+      // and no connections have been made from its address in this window.
+      return state.connections_ == 0 && (state.window_ != window || state.rate_ == 0);
+   }
+
+   void
+   ConnectionLimiter::ReleaseSlot_(Slot &slot)
+   {
+      SlotState current = slot.load();
+
+      for (;;)
+      {
+         SlotState next = current;
+         next.connections_--;
+
+         if (slot.compare_exchange_weak(current, next))
+            return;
+      }
+   }
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include <boost/atomic.hpp>
+
+namespace HM
+{
+   class IPAddress;
+   class SecurityRange;
+
+   // Limits the number of concurrent connections and the connection rate per
+   // source address and per network (/24 for IPv4, /64 for IPv6). The counters are
+   // kept in fixed-size tables indexed by a hash of the address, so a connection
+   // can be checked without taking a lock. Each slot records a fingerprint of the
+   // address it counts. An address whose slot is taken by another address uses one
+   // of the next few slots, and is not limited if they are all taken.
+   class ConnectionLimiter : public Singleton<ConnectionLimiter>
+   {
+   public:
+
+      enum Result
+      {
+         Allowed = 0,
+         RefusedByConcurrencyLimit = 1,
+         RefusedByRateLimit = 2
+      };
+
+      // The slots a connection has been counted in, or -1 where it was not counted.
+      struct Lease
+      {
+         Lease() : address_slot_(-1), network_slot_(-1) {}
+
+         int address_slot_;
+         int network_slot_;
+      };
+
+      ConnectionLimiter();
+
+      Result TryAcquire(const IPAddress &address, std::shared_ptr<SecurityRange> securityRange, Lease &lease);
+      // If the connection is allowed, Release must be called with the lease when it ends.
+      // Connections from the local computer and from ranges without spam protection are
+      // not limited.
+
+      void Release(const Lease &lease);
+
+      bool TryStartHold();
+      void OnHoldEnded() { held_connections_--; }
+      // Refused connections are held open for BlockedIPHoldSeconds before they are dropped.
+      // At most MaxHeldConnections are held at a time, the rest are dropped at once.
+
+      int GetConcurrencyLimitedCount() const { return concurrency_limited_count_; }
+      int GetRateLimitedCount() const { return rate_limited_count_; }
+      int GetHeldConnections() const { return held_connections_; }
+
+   private:
+
+      enum Settings
+      {
+         SlotCount = 16384,
+         MaxProbes = 4,
+         RateWindowSeconds = 60,
+         MaxHeldConnections = 1000
+      };
+
+      // Updated as a whole, so that the owner of the slot can't change while
+      // a connection is being counted.
+      struct SlotState
+      {
+         unsigned int fingerprint_;
+         int connections_;
+
+         // The rate window and the number of connections made in it.
+         unsigned int window_;
+         unsigned int rate_;
+      };
+
+      typedef boost::atomic<SlotState> Slot;
+
+      static Result TryAcquireSlot_(Slot *slots, unsigned __int64 key1, unsigned __int64 key2, int maxConnections, int maxRate, unsigned int window, int &slotIndex);
+      static int FindSlot_(Slot *slots, unsigned __int64 hash, unsigned int fingerprint, unsigned int window);
+      static bool IsIdle_(const SlotState &state, unsigned int window);
+      static void ReleaseSlot_(Slot &slot);
+
+      Slot address_slots_[SlotCount];
+      Slot network_slots_[SlotCount];
+
+      boost::atomic<int> concurrency_limited_count_;
+      boost::atomic<int> rate_limited_count_;
+      boost::atomic<int> held_connections_;
+   };
+}
@@ -86,7 +86,7 @@ namespace HM
    }
 
    bool
-   DNSResolver::Resolve_(const String &sSearchFor, std::vector<String> &vecFoundNames, WORD wType, int iRecursion)
+   DNSResolver::Resolve_(const String &sSearchFor, std::vector<String> &vecFoundNames, WORD wType, int iRecursion, DWORD *pMinTTL)
    {
       USES_CONVERSION;
 
@@ -201,11 +201,14 @@ namespace HM
          break;
       case DNS_TYPE_TEXT: 
          {
+            if (pMinTTL && pDnsRecords->dwTtl < *pMinTTL)
+               *pMinTTL = pDnsRecords->dwTtl;
+
             if (pDnsRecords->wType == DNS_TYPE_CNAME)
             {
                // we received a CNAME response so we need to recurse over that.
                String sDomainName = pDnsRecords->Data.CNAME.pNameHost;
-               if (!Resolve_(sDomainName, vecFoundNames, DNS_TYPE_TEXT, iRecursion+1))
+               if (!Resolve_(sDomainName, vecFoundNames, DNS_TYPE_TEXT, iRecursion+1, pMinTTL))
                   return false;
             }   
             else if (pDnsRecords->wType == DNS_TYPE_TEXT)
@@ -335,6 +338,18 @@ namespace HM
       return Resolve_(sDomain, foundResult, DNS_TYPE_TEXT, 0);
    }
 
+   bool 
+   DNSResolver::GetTXTRecords(const String &sDomain, std::vector<String> &foundResult, int &ttlSeconds)
+   {
+      DWORD minTTL = INT_MAX;
+
+      if (!Resolve_(sDomain, foundResult, DNS_TYPE_TEXT, 0, &minTTL))
+         return false;
+
+      ttlSeconds = (int) minTTL;
+      return true;
+   }
+
    bool
    DNSResolver::GetEmailServers(const String &sDomainName, std::vector<HostNameAndIpAddress> &saFoundNames )
    {
@@ -19,10 +19,12 @@ namespace HM
       bool GetMXRecords(const String &sDomain, std::vector<String> &vecFoundNames);
       bool GetARecords(const String &sDomain, std::vector<String> &saFoundNames);
       bool GetTXTRecords(const String &sDomain, std::vector<String> &foundResult);
+      bool GetTXTRecords(const String &sDomain, std::vector<String> &foundResult, int &ttlSeconds);
+      // As above, and returns the lowest TTL of the records in the answer.
       bool GetPTRRecords(const String &sIP, std::vector<String> &vecFoundNames);
    private:
 
-      bool Resolve_(const String &sSearchFor, std::vector<String> &vecFoundNames, WORD ResourceType, int iRecursion);
+      bool Resolve_(const String &sSearchFor, std::vector<String> &vecFoundNames, WORD ResourceType, int iRecursion, DWORD *pMinTTL = 0);
       bool IsDNSError_(int iErrorMessage);
 
       bool IsWSAError_(int iErrorMessage);
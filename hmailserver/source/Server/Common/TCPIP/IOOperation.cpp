@@ -27,10 +27,28 @@ namespace HM
       
    }
 
+   IOOperation::IOOperation(OperationType type, const std::vector<std::shared_ptr<ByteBuffer> > &buffers) :
+      type_(type),
+      buffers_(buffers)
+   {
+
+   }
+
    IOOperation::~IOOperation(void)
    {
 
    }
 
+   size_t
+   IOOperation::GetSize() const
+   {
+      size_t size = buffer_ ? buffer_->GetSize() : 0;
+
+      for (std::shared_ptr<ByteBuffer> buffer : buffers_)
+         size += buffer->GetSize();
+
+      return size;
+   }
+
    
 }
\ No newline at end of file
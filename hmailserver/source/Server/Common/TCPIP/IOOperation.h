@@ -23,10 +23,16 @@ namespace HM
 
       IOOperation(OperationType type, std::shared_ptr<ByteBuffer> buffer);
       IOOperation(OperationType type, const AnsiString &string);
+      IOOperation(OperationType type, const std::vector<std::shared_ptr<ByteBuffer> > &buffers);
       ~IOOperation(void);
 
       OperationType GetType() {return type_; }
       std::shared_ptr<ByteBuffer> GetBuffer() {return buffer_; }
+      const std::vector<std::shared_ptr<ByteBuffer> > &GetBuffers() {return buffers_; }
+      // Set instead of the buffer when several writes have been merged.
+
+      size_t GetSize() const;
+      // The number of bytes to write.
       AnsiString GetString() {return string_; }
 
    private:
@@ -34,6 +40,7 @@ namespace HM
       OperationType type_;
       AnsiString string_;
       std::shared_ptr<ByteBuffer> buffer_;
+      std::vector<std::shared_ptr<ByteBuffer> > buffers_;
 
    };
 }
\ No newline at end of file
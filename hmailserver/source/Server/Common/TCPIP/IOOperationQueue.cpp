@@ -13,7 +13,9 @@
 
 namespace HM
 {
-   IOOperationQueue::IOOperationQueue()
+   IOOperationQueue::IOOperationQueue() :
+      queued_write_bytes_(0),
+      cork_count_(0)
    {
       
    }
@@ -29,6 +31,26 @@ namespace HM
       boost::lock_guard<boost::recursive_mutex> guard(mutex_);
 
       queue_operations_.push_back(operation);
+
+      if (operation->GetType() == IOOperation::BCTWrite)
+         queued_write_bytes_ += operation->GetSize();
+   }
+
+   void
+   IOOperationQueue::Cork()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+
+      cork_count_++;
+   }
+
+   void
+   IOOperationQueue::Uncork()
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+
+      if (cork_count_ > 0)
+         cork_count_--;
    }
 
    void
@@ -92,6 +114,15 @@ namespace HM
 
       std::shared_ptr<IOOperation> nextOperation = queue_operations_.front();
 
+      if (nextOperation->GetType() == IOOperation::BCTWrite && 
+          cork_count_ > 0 && 
+          queued_write_bytes_ < (size_t) MaxCoalescedWriteSize)
+      {
+         // Wait for the rest of the response.
+         std::shared_ptr<IOOperation> empty;
+         return empty;
+      }
+
       if (ongoing_operations_.size() > 0)
       {
          IOOperation::OperationType pendingType = nextOperation->GetType();
@@ -152,12 +183,59 @@ namespace HM
       }
 
 
-      ongoing_operations_.push_back(nextOperation);
-
       queue_operations_.pop_front();
 
+      if (nextOperation->GetType() == IOOperation::BCTWrite)
+         nextOperation = CoalesceWrites_(nextOperation);
+
+      ongoing_operations_.push_back(nextOperation);
+
       return nextOperation;
    }
 
+   std::shared_ptr<IOOperation>
+   IOOperationQueue::CoalesceWrites_(std::shared_ptr<IOOperation> first)
+   {
+      // Merges the writes following first into a single operation, so that a response made 
+      // up of many small writes goes out in one send (and in as few TLS records as possible).
+      size_t totalSize = first->GetSize();
+
+      std::vector<std::shared_ptr<IOOperation> > merged;
+      merged.push_back(first);
+
+      while (!queue_operations_.empty())
+      {
+         std::shared_ptr<IOOperation> operation = queue_operations_.front();
+
+         if (operation->GetType() != IOOperation::BCTWrite)
+            break;
+
+         size_t size = operation->GetSize();
+         if (totalSize + size > (size_t) MaxCoalescedWriteSize)
+            break;
+
+         totalSize += size;
+         merged.push_back(operation);
+         queue_operations_.pop_front();
+      }
+
+      queued_write_bytes_ -= min(queued_write_bytes_, totalSize);
+
+      if (merged.size() == 1)
+         return first;
+
+      std::vector<std::shared_ptr<ByteBuffer> > buffers;
+
+      for (std::shared_ptr<IOOperation> operation : merged)
+      {
+         if (operation->GetBuffer())
+            buffers.push_back(operation->GetBuffer());
+
+         buffers.insert(buffers.end(), operation->GetBuffers().begin(), operation->GetBuffers().end());
+      }
+
+      return std::shared_ptr<IOOperation>(new IOOperation(IOOperation::BCTWrite, buffers));
+   }
+
    
 }
@@ -21,13 +21,29 @@ namespace HM
 
       bool ContainsQueuedSendOperation();
 
+      void Cork();
+      void Uncork();
+      // While corked, writes are held back until the connection is uncorked or 
+      // enough data has been queued to fill a merged write.
+
    private:
 
+      enum Settings
+      {
+         // Consecutive queued writes are merged into a single write of at most this size.
+         MaxCoalescedWriteSize = 64 * 1024
+      };
+
+      std::shared_ptr<IOOperation> CoalesceWrites_(std::shared_ptr<IOOperation> first);
+
       boost::recursive_mutex mutex_;
 
       std::deque<std::shared_ptr<IOOperation> > queue_operations_;
       
       std::vector<std::shared_ptr<IOOperation > > ongoing_operations_;
+
+      size_t queued_write_bytes_;
+      int cork_count_;
    };
 
 }
\ No newline at end of file
@@ -78,6 +78,25 @@ namespace HM
       // Make sure information on which local ports are in use is reset.
       LocalIPAddresses::Instance()->LoadIPAddresses();
 
+      const int iThreadCount = Configuration::Instance()->GetTCPIPThreads();
+
+      std::shared_ptr<IOServicePool> pool;
+
+      if (IniFileSettings::Instance()->GetIOServicePerThread())
+      {
+         // Give every thread an io_service of its own, so that the handlers of a connection
+         // always run on the same thread, instead of all threads sharing one completion queue.
+         IOServicePool::SelectionPolicy policy = IniFileSettings::Instance()->GetIOServiceShardPolicy() == IOServicePool::LeastLoaded ? 
+            IOServicePool::LeastLoaded : IOServicePool::RoundRobin;
+
+         pool = std::shared_ptr<IOServicePool>(new IOServicePool(iThreadCount, policy));
+
+         LOG_DEBUG(Formatter::Format("IOService - Using {0} io_service shards.", pool->GetShards().size()));
+      }
+
+      // Connections may ask for an io_service from other threads at any time.
+      std::atomic_store(&io_service_pool_, pool);
+
       // Create one socket for each IP address specified in the multi-homing settings.
       std::vector<std::shared_ptr<TCPIPPort> > vecTCPIPPorts = Configuration::Instance()->GetTCPIPPorts()->GetVector();
 
@@ -126,7 +145,7 @@ namespace HM
             break;
          }
 
-         pTCPServer = std::shared_ptr<TCPServer>(new TCPServer(io_service_, address, iPort, st, pSSLCertificate, pConnectionFactory, connection_security));
+         pTCPServer = std::shared_ptr<TCPServer>(new TCPServer(io_service_, pool, address, iPort, st, pSSLCertificate, pConnectionFactory, connection_security));
 
          pTCPServer->Run();
 
@@ -134,21 +153,38 @@ namespace HM
       }
 
 
-      const int iThreadCount = Configuration::Instance()->GetTCPIPThreads();
-
       if (iThreadCount <= 0)
          ErrorManager::Instance()->ReportError(ErrorManager::Medium, 4325, "IOService::DoWork()", "The number of TCP/IP threads has been set to zero.");
 
-      size_t iQueueID = WorkQueueManager::Instance()->CreateWorkQueue(iThreadCount, "IOCPQueue");
+      if (pool)
+      {
+         // One thread per shard, and one for the listeners.
+         const std::vector<std::shared_ptr<IOServiceShard> > &shards = pool->GetShards();
 
-      std::shared_ptr<WorkQueue> pWorkQueue = WorkQueueManager::Instance()->GetQueue("IOCPQueue");
+         size_t iQueueID = WorkQueueManager::Instance()->CreateWorkQueue((int) shards.size() + 1, "IOCPQueue");
+
+         for (std::shared_ptr<IOServiceShard> shard : shards)
+         {
+            std::shared_ptr<IOCPQueueWorkerTask> pWorkerTask = std::shared_ptr<IOCPQueueWorkerTask>(new IOCPQueueWorkerTask(shard->GetIOService()));
+            WorkQueueManager::Instance()->AddTask(iQueueID, pWorkerTask);
+         }
 
-      // Launch a thread that holds the IOCP objects
-      for (int i = 0; i < iThreadCount; i++)
-      {
          std::shared_ptr<IOCPQueueWorkerTask> pWorkerTask = std::shared_ptr<IOCPQueueWorkerTask>(new IOCPQueueWorkerTask(io_service_));
          WorkQueueManager::Instance()->AddTask(iQueueID, pWorkerTask);
-      }	
+      }
+      else
+      {
+         size_t iQueueID = WorkQueueManager::Instance()->CreateWorkQueue(iThreadCount, "IOCPQueue");
+
+         std::shared_ptr<WorkQueue> pWorkQueue = WorkQueueManager::Instance()->GetQueue("IOCPQueue");
+
+         // Launch a thread that holds the IOCP objects
+         for (int i = 0; i < iThreadCount; i++)
+         {
+            std::shared_ptr<IOCPQueueWorkerTask> pWorkerTask = std::shared_ptr<IOCPQueueWorkerTask>(new IOCPQueueWorkerTask(io_service_));
+            WorkQueueManager::Instance()->AddTask(iQueueID, pWorkerTask);
+         }	
+      }
 
       try
       {
@@ -164,6 +200,9 @@ namespace HM
          LOG_DEBUG("IOService::Stop()");
          io_service_.stop();
 
+         if (pool)
+            pool->Stop();
+
          auto iterServer = tcp_servers_.begin();
          auto iterEnd = tcp_servers_.end();
          for (; iterServer != iterEnd; iterServer++)
@@ -194,5 +233,17 @@ namespace HM
       return io_service_;
    }
 
+   std::shared_ptr<IOServiceShard>
+   IOService::GetIOServiceShard()
+   {
+      std::shared_ptr<IOServicePool> pool = std::atomic_load(&io_service_pool_);
+
+      if (pool)
+         return pool->GetNextShard();
+
+      std::shared_ptr<IOServiceShard> empty;
+      return empty;
+   }
+
 
 }
\ No newline at end of file
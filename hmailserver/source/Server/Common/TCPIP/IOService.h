@@ -9,6 +9,7 @@
 #include "..\Util\Event.h"
 
 #include "SocketConstants.h"
+#include "IOServicePool.h"
 
 
 
@@ -30,6 +31,13 @@ namespace HM
       bool RegisterSessionType(SessionType st);
 
       boost::asio::io_service &GetIOService();
+      // The io_service of the listeners. Outside io_service-per-thread mode, all
+      // connections use it.
+
+      std::shared_ptr<IOServiceShard> GetIOServiceShard();
+      // In io_service-per-thread mode, the shard which a new connection should use. Empty
+      // otherwise. The connection must keep the shard, see TCPConnection::SetIOServiceShard.
+
       boost::asio::ssl::context &GetClientContext();
    private:
 
@@ -38,6 +46,11 @@ namespace HM
       std::set<SessionType> session_types_;
       boost::asio::io_service io_service_;
 
+      // Only used in io_service-per-thread mode. The listeners remain on
+      // io_service_, while the connections are spread over the shards.
+      // Always accessed through std::atomic_load and std::atomic_store.
+      std::shared_ptr<IOServicePool> io_service_pool_;
+
       std::vector<std::shared_ptr<TCPServer> > tcp_servers_;
 
       boost::condition_variable do_work_dummy;
@@ -0,0 +1,66 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "StdAfx.h"
+
+#include "IOServicePool.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   IOServiceShard::IOServiceShard(int index) :
+      index_(index),
+      work_(new boost::asio::io_service::work(io_service_)),
+      connection_count_(0)
+   {
+
+   }
+
+   void
+   IOServiceShard::Stop()
+   {
+      work_.reset();
+      io_service_.stop();
+   }
+
+   IOServicePool::IOServicePool(int shardCount, SelectionPolicy policy) :
+      policy_(policy),
+      next_shard_(0)
+   {
+      for (int i = 0; i < max(shardCount, 1); i++)
+         shards_.push_back(std::shared_ptr<IOServiceShard>(new IOServiceShard(i)));
+   }
+
+   std::shared_ptr<IOServiceShard>
+   IOServicePool::GetNextShard()
+   {
+      if (policy_ == LeastLoaded)
+      {
+         // The counts may change while we look at them, but an approximate 
+         // answer is good enough to spread the connections.
+         std::shared_ptr<IOServiceShard> leastLoaded = shards_[0];
+
+         for (std::shared_ptr<IOServiceShard> shard : shards_)
+         {
+            if (shard->GetConnectionCount() < leastLoaded->GetConnectionCount())
+               leastLoaded = shard;
+         }
+
+         return leastLoaded;
+      }
+
+      unsigned int next = next_shard_++;
+      return shards_[next % shards_.size()];
+   }
+
+   void
+   IOServicePool::Stop()
+   {
+      for (std::shared_ptr<IOServiceShard> shard : shards_)
+         shard->Stop();
+   }
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include <boost/atomic.hpp>
+
+namespace HM
+{
+   // An io_service which is run by a single thread. All handlers of the 
+   // connections assigned to the shard are executed on that thread.
+   class IOServiceShard
+   {
+   public:
+      IOServiceShard(int index);
+
+      boost::asio::io_service &GetIOService() { return io_service_; }
+      int GetIndex() const { return index_; }
+
+      int GetConnectionCount() const { return connection_count_; }
+      void OnConnectionStarted() { connection_count_++; }
+      void OnConnectionEnded() { connection_count_--; }
+
+      void Stop();
+
+   private:
+
+      IOServiceShard(const IOServiceShard &);
+      IOServiceShard &operator=(const IOServiceShard &);
+
+      int index_;
+
+      boost::asio::io_service io_service_;
+
+      // Keeps run() from returning while the shard has no connections.
+      std::shared_ptr<boost::asio::io_service::work> work_;
+
+      boost::atomic<int> connection_count_;
+   };
+
+   class IOServicePool
+   {
+   public:
+
+      enum SelectionPolicy
+      {
+         RoundRobin = 0,
+         LeastLoaded = 1
+      };
+
+      IOServicePool(int shardCount, SelectionPolicy policy);
+
+      std::shared_ptr<IOServiceShard> GetNextShard();
+      // Returns the shard which the next connection should be assigned to.
+
+      const std::vector<std::shared_ptr<IOServiceShard> > &GetShards() const { return shards_; }
+
+      void Stop();
+
+   private:
+
+      std::vector<std::shared_ptr<IOServiceShard> > shards_;
+      SelectionPolicy policy_;
+
+      boost::atomic<unsigned int> next_shard_;
+   };
+}
@@ -8,13 +8,16 @@
 
 #include "../Util/ByteBuffer.h"
 #include "../BO/TCPIPPorts.h"
-#include "../Persistence/PersistentSecurityRange.h"
+#include "../Cache/SecurityRangeCache.h"
 
 #include "LocalIPAddresses.h"
 #include "IPAddress.h"
 #include "IOOperation.h"
 #include "CertificateVerifier.h"
 #include "CipherInfo.h"
+#include "IOServicePool.h"
+#include "TimingWheel.h"
+#include "ConnectionLimiter.h"
 
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
@@ -34,7 +37,6 @@ namespace HM
       socket_(io_service),
       ssl_socket_(socket_, context),
       resolver_(io_service),
-      timer_(io_service),
       receive_binary_(false),
       remote_port_(0),
       receive_buffer_(250000),
@@ -44,7 +46,11 @@ namespace HM
       expected_remote_hostname_(expected_remote_hostname),
       is_client_(false),
       timeout_(0),
-      connection_state_(StatePendingConnect)
+      last_activity_(0),
+      timeout_scheduled_(false),
+      timeout_generation_(0),
+      connection_state_(StatePendingConnect),
+      has_connection_limiter_lease_(false)
    {
       session_id_ = Application::Instance()->GetUniqueID();
 
@@ -58,6 +64,12 @@ namespace HM
       {
          LOG_DEBUG("Ending session " + StringParser::IntToString(session_id_));
 
+         if (io_service_shard_)
+            io_service_shard_->OnConnectionEnded();
+
+         if (has_connection_limiter_lease_)
+            ConnectionLimiter::Instance()->Release(connection_limiter_lease_);
+
          if (disconnected_)
             disconnected_->Set();
       }
@@ -211,8 +223,7 @@ namespace HM
         }
       case IOOperation::BCTWrite:
          {
-               std::shared_ptr<ByteBuffer> pBuf = operation->GetBuffer();
-            AsyncWrite(pBuf);
+            AsyncWrite(operation);
             break;
          }
       case IOOperation::BCTRead:
@@ -588,7 +599,20 @@ namespace HM
    }
 
    void 
-   TCPConnection::AsyncWrite(std::shared_ptr<ByteBuffer> buffer)
+   TCPConnection::CorkWrites()
+   {
+      operation_queue_.Cork();
+   }
+
+   void 
+   TCPConnection::UncorkWrites()
+   {
+      operation_queue_.Uncork();
+      ProcessOperationQueue_(0);
+   }
+
+   void 
+   TCPConnection::AsyncWrite(std::shared_ptr<IOOperation> operation)
    {
       UpdateAutoLogoutTimer();
 
@@ -597,14 +621,50 @@ namespace HM
          std::placeholders::_1,
          std::placeholders::_2);
 
-      if (is_ssl_)
-         boost::asio::async_write
-         (ssl_socket_, boost::asio::buffer(buffer->GetCharBuffer(), buffer->GetSize()), AsyncWriteCompletedFunction);
-      else
-         boost::asio::async_write
-         (socket_, boost::asio::buffer(buffer->GetCharBuffer(), buffer->GetSize()), AsyncWriteCompletedFunction);
+      std::shared_ptr<ByteBuffer> buffer = operation->GetBuffer();
 
-      
+      if (!buffer && is_ssl_)
+      {
+         // The SSL stream only encrypts one buffer per call, so the merged writes are 
+         // copied into one buffer to have them sent in full-sized TLS records.
+         const std::vector<std::shared_ptr<ByteBuffer> > &buffers = operation->GetBuffers();
+
+         buffer = std::shared_ptr<ByteBuffer>(new ByteBuffer());
+         buffer->Allocate(operation->GetSize());
+
+         BYTE *position = (BYTE*) buffer->GetBuffer();
+         for (std::shared_ptr<ByteBuffer> part : buffers)
+         {
+            memcpy(position, part->GetBuffer(), part->GetSize());
+            position += part->GetSize();
+         }
+
+         // Keep the copy alive until the write has completed.
+         std::shared_ptr<TCPConnection> self = shared_from_this();
+         AsyncWriteCompletedFunction = [self, buffer](const boost::system::error_code& error, size_t bytes_transferred)
+            {
+               self->AsyncWriteCompleted(error, bytes_transferred);
+            };
+      }
+
+      if (buffer)
+      {
+         if (is_ssl_)
+            boost::asio::async_write
+            (ssl_socket_, boost::asio::buffer(buffer->GetCharBuffer(), buffer->GetSize()), AsyncWriteCompletedFunction);
+         else
+            boost::asio::async_write
+            (socket_, boost::asio::buffer(buffer->GetCharBuffer(), buffer->GetSize()), AsyncWriteCompletedFunction);
+
+         return;
+      }
+
+      // Send the merged writes in a single gather-write.
+      std::vector<boost::asio::const_buffer> buffers;
+      for (std::shared_ptr<ByteBuffer> part : operation->GetBuffers())
+         buffers.push_back(boost::asio::buffer(part->GetCharBuffer(), part->GetSize()));
+
+      boost::asio::async_write(socket_, buffers, AsyncWriteCompletedFunction);
    }
 
    void 
@@ -684,6 +744,21 @@ namespace HM
       return is_client_;
    }
 
+   void
+   TCPConnection::SetIOServiceShard(std::shared_ptr<IOServiceShard> shard)
+   {
+      // Lets the shard keep track of how many connections it serves.
+      io_service_shard_ = shard;
+      io_service_shard_->OnConnectionStarted();
+   }
+
+   void
+   TCPConnection::SetConnectionLimiterLease(const ConnectionLimiter::Lease &lease)
+   {
+      connection_limiter_lease_ = lease;
+      has_connection_limiter_lease_ = true;
+   }
+
    void  
    TCPConnection::SetSecurityRange(std::shared_ptr<SecurityRange> securityRange)
    {
@@ -697,7 +772,7 @@ namespace HM
       {
          IPAddress address(socket_.remote_endpoint().address());
 
-         security_range_ = PersistentSecurityRange::ReadMatchingIP(address);
+         security_range_ = SecurityRangeCache::Instance()->GetMatchingRange(address);
       }
 
       return security_range_;
@@ -736,6 +811,10 @@ namespace HM
    TCPConnection::SetTimeout(int seconds)
    {
       timeout_ = seconds;
+
+      // The wheel entry may be placed according to a longer timeout.
+      if (timeout_scheduled_)
+         ScheduleTimeout_();
    }
 
 
@@ -743,49 +822,43 @@ namespace HM
    TCPConnection::UpdateAutoLogoutTimer()
    {
       /*
-         The timer instance is not thread safe for multiple concurrent callers.
-
-         We may have multiple IO operations starting and stopping at the same time, so we need to synchronize
-         lock to the timer from preventing multiple threads from accessing at the same time.
+         This is called whenever an IO operation starts or completes, so it needs to be cheap. We 
+         only record the time of the activity. The timing wheel of the io_service checks it when 
+         the connection is due, and moves the connection forward if it has been active since.
       */
 
-      boost::mutex::scoped_lock lock(autologout_timer_);
+      last_activity_ = (int) GetTickCount();
 
-      boost::system::error_code error_code;
+      if (!timeout_scheduled_.exchange(true))
+         ScheduleTimeout_();
+   }
 
-      // Put a timeout...
-      timer_.expires_from_now(boost::posix_time::seconds(timeout_), error_code);
+   void
+   TCPConnection::ScheduleTimeout_()
+   {
+      boost::asio::use_service<TimingWheel>(socket_.get_io_service()).Schedule(shared_from_this(), ++timeout_generation_);
+   }
 
-      if (error_code)
-      {
-         ReportError(ErrorManager::Low, 5333, "TCPConnection::UpdateLogoutTimer", "An unknown error occurred while updating logout timer.", error_code);
-         return;
-      }
+   int
+   TCPConnection::GetMillisecondsUntilTimeout_() const
+   {
+      int idleMilliseconds = (int) GetTickCount() - last_activity_;
 
-         
-      timer_.async_wait(std::bind(&TCPConnection::OnTimeout, std::weak_ptr<TCPConnection>(shared_from_this()), std::placeholders::_1));
+      return timeout_ * 1000 - idleMilliseconds;
    }
 
    void
-   TCPConnection::OnTimeout(std::weak_ptr<TCPConnection> connection, boost::system::error_code const& err)
+   TCPConnection::OnIdleTimeout_()
    {
-         std::shared_ptr<TCPConnection> conn = connection.lock();
-      if (!conn)
-      {
-         return;
-      }
-
-         if (err == boost::asio::error::operation_aborted) 
-      {
-         // the timeout operation was cancelled.
-         return;
-      }
+      // Called by the timing wheel. The wheel has dropped the connection, so 
+      // the next activity will schedule it again.
+      timeout_scheduled_ = false;
 
       String message;
-      message.Format(_T("The client has timed out. Session: %d"), conn->GetSessionID());
+      message.Format(_T("The client has timed out. Session: %d"), GetSessionID());
       LOG_DEBUG(message);
 
-      conn->Timeout();
+      Timeout();
    }
 
    void 
@@ -7,6 +7,7 @@
 
 #include "SocketConstants.h"
 #include "IOOperationQueue.h"
+#include "ConnectionLimiter.h"
 
 
 #include <boost/atomic.hpp>
@@ -20,6 +21,8 @@ namespace HM
    class ByteBuffer;
    class SecurityRange;
    class CipherInfo;
+   class IOServiceShard;
+   class TimingWheel;
 
    class TCPConnection :
       public std::enable_shared_from_this<TCPConnection>
@@ -49,12 +52,24 @@ namespace HM
       void EnqueueShutdownSend();
       void EnqueueDisconnect();
       void EnqueueHandshake();
+
+      void CorkWrites();
+      void UncorkWrites();
+      // Holds back writes while a response made up of many small writes is being 
+      // produced, so that it's sent in as few writes as possible. Please use WriteCork.
       
       IPAddress GetRemoteEndpointAddress();
       unsigned long GetLocalEndpointPort();
 
       void UpdateAutoLogoutTimer();
 
+      void SetIOServiceShard(std::shared_ptr<IOServiceShard> shard);
+      // Should be called right after construction by anyone who creates the connection
+      // on a shard, so that the shard is kept alive for as long as the connection.
+
+      void SetConnectionLimiterLease(const ConnectionLimiter::Lease &lease);
+      // The lease is released in the ConnectionLimiter when the connection ends.
+
       void SetSecurityRange(std::shared_ptr<SecurityRange> securityRange);
       std::shared_ptr<SecurityRange> GetSecurityRange();
 
@@ -100,7 +115,12 @@ namespace HM
       void HandshakeFailed_(const boost::system::error_code& error);
       void StartAsyncConnect_(const String &ip_adress, int port);
 
-      static void OnTimeout(std::weak_ptr<TCPConnection> connection, boost::system::error_code const& err);
+      friend class TimingWheel;
+
+      int GetMillisecondsUntilTimeout_() const;
+      unsigned int GetTimeoutGeneration_() const { return timeout_generation_; }
+      void OnIdleTimeout_();
+      void ScheduleTimeout_();
 
       String SafeGetIPAddress();
 
@@ -111,7 +131,7 @@ namespace HM
       void Disconnect();
       void Shutdown(boost::asio::socket_base::shutdown_type);
       
-      void AsyncWrite(std::shared_ptr<ByteBuffer> buffer);
+      void AsyncWrite(std::shared_ptr<IOOperation> operation);
       void AsyncRead(const AnsiString &delimitor);
       void AsyncHandshake();
 
@@ -124,11 +144,14 @@ namespace HM
       void ReportError(ErrorManager::eSeverity sev, int code, const String &context, const String &message, const boost::system::system_error &error);
       void ReportError(ErrorManager::eSeverity sev, int code, const String &context, const String &message);
 
+      // In io_service-per-thread mode, the shard whose io_service the socket uses. It's
+      // declared before the socket, so that the io_service is destroyed after it.
+      std::shared_ptr<IOServiceShard> io_service_shard_;
+
       boost::asio::ip::tcp::socket socket_;
       ssl_socket ssl_socket_;
 
       boost::asio::ip::tcp::resolver resolver_;
-      boost::asio::deadline_timer timer_;
       boost::asio::streambuf receive_buffer_;
       boost::asio::ssl::context& context_;
 
@@ -141,8 +164,19 @@ namespace HM
 
       std::shared_ptr<SecurityRange> security_range_;
 
+      bool has_connection_limiter_lease_;
+      ConnectionLimiter::Lease connection_limiter_lease_;
+
       int session_id_;
-      int timeout_;
+
+      // Seconds of inactivity after which the connection times out.
+      boost::atomic<int> timeout_;
+
+      // Updated on every read and write. The timing wheel of the io_service compares
+      // it to the timeout, so no timer needs to be re-armed per operation.
+      boost::atomic<int> last_activity_;
+      boost::atomic<bool> timeout_scheduled_;
+      boost::atomic<unsigned int> timeout_generation_;
 
       AnsiString expected_remote_hostname_;
       std::shared_ptr<Event> disconnected_;
@@ -150,7 +184,35 @@ namespace HM
       bool is_client_;
 
       boost::atomic<ConnectionState> connection_state_;
-      boost::mutex autologout_timer_;
    };
 
+   // Corks the connection for the lifetime of the object.
+   class WriteCork
+   {
+   public:
+      WriteCork(std::shared_ptr<TCPConnection> connection) :
+         connection_(connection)
+      {
+         connection_->CorkWrites();
+      }
+
+      ~WriteCork()
+      {
+         try
+         {
+            connection_->UncorkWrites();
+         }
+         catch (...)
+         {
+
+         }
+      }
+
+   private:
+
+      WriteCork(const WriteCork &);
+      WriteCork &operator=(const WriteCork &);
+
+      std::shared_ptr<TCPConnection> connection_;
+   };
 }
\ No newline at end of file
@@ -13,13 +13,14 @@
 #include "../Scripting/ScriptObjectContainer.h"
 #include "../Scripting/Result.h"
 #include "../Scripting/ClientInfo.h"
-#include "../Persistence/PersistentSecurityRange.h"
+#include "../Cache/SecurityRangeCache.h"
 
 #include "../Application/SessionManager.h"
 
 #include "../Util/Encoding/Base64.h"
 
 #include "SslContextInitializer.h"
+#include "ConnectionLimiter.h"
 
 using boost::asio::ip::tcp;
 
@@ -30,8 +31,9 @@ using boost::asio::ip::tcp;
 
 namespace HM
 {
-   TCPServer::TCPServer(boost::asio::io_service& io_service, const IPAddress &ipaddress, int port, SessionType sessionType, std::shared_ptr<SSLCertificate> certificate, std::shared_ptr<TCPConnectionFactory> connectionFactory, ConnectionSecurity connection_security) :
+   TCPServer::TCPServer(boost::asio::io_service& io_service, std::shared_ptr<IOServicePool> io_service_pool, const IPAddress &ipaddress, int port, SessionType sessionType, std::shared_ptr<SSLCertificate> certificate, std::shared_ptr<TCPConnectionFactory> connectionFactory, ConnectionSecurity connection_security) :
       acceptor_(io_service),
+      io_service_pool_(io_service_pool),
       context_(io_service, boost::asio::ssl::context::sslv23),
       ipaddress_(ipaddress),
       port_(port),
@@ -133,8 +135,18 @@ namespace HM
    {
       if (acceptor_.is_open())
       {
-        
-         std::shared_ptr<TCPConnection> pNewConnection = connectionFactory_->Create(connection_security_, acceptor_.get_io_service(), context_);
+         // In io_service-per-thread mode, the connection is created on one of the shards, 
+         // so that all its handlers run on the thread of that shard.
+         std::shared_ptr<IOServiceShard> shard;
+         if (io_service_pool_)
+            shard = io_service_pool_->GetNextShard();
+
+         boost::asio::io_service &connectionIOService = shard ? shard->GetIOService() : acceptor_.get_io_service();
+
+         std::shared_ptr<TCPConnection> pNewConnection = connectionFactory_->Create(connection_security_, connectionIOService, context_);
+
+         if (shard)
+            pNewConnection->SetIOServiceShard(shard);
 
          acceptor_.async_accept(pNewConnection->GetSocket(),
             std::bind(&TCPServer::HandleAccept, this, pNewConnection,
@@ -186,7 +198,7 @@ namespace HM
          String sMessage = Formatter::Format("TCP - {0} connected to {1}:{2}.", remoteAddress.ToString(), localAddress.ToString(), port_);
          LOG_TCPIP(sMessage);
 
-         std::shared_ptr<SecurityRange> securityRange = PersistentSecurityRange::ReadMatchingIP(remoteAddress);
+         std::shared_ptr<SecurityRange> securityRange = SecurityRangeCache::Instance()->GetMatchingRange(remoteAddress);
 
          bool allow = SessionManager::Instance()->CreateSession(sessionType_, securityRange);
         
@@ -197,20 +209,29 @@ namespace HM
             message.Format(_T("Client connection from %s was not accepted. Blocked either by IP range or by connection limit."), String(remoteAddress.ToString()).c_str());
             LOG_DEBUG(message);
 
-            // Give option to hold connection for anti-pounding & hopefully minimize DoS
-            // NOTE: We really need max connections per IP as well
-            int iBlockedIPHoldSeconds = IniFileSettings::Instance()->GetBlockedIPHoldSeconds();
+            HoldConnection_(connection, remoteAddress);
+            return;
+         }
+
+         ConnectionLimiter::Lease limiterLease;
+         ConnectionLimiter::Result limiterResult = ConnectionLimiter::Instance()->TryAcquire(remoteAddress, securityRange, limiterLease);
+
+         if (limiterResult != ConnectionLimiter::Allowed)
+         {
+            SessionManager::Instance()->OnSessionEnded(sessionType_);
 
-            if (iBlockedIPHoldSeconds > 0)
-            {
-               Sleep(iBlockedIPHoldSeconds * 1000);
-               message.Format(_T("Held connection from %s for %i seconds before dropping."), String(remoteAddress.ToString()).c_str(), iBlockedIPHoldSeconds);
-               LOG_DEBUG(message);
-            }
+            String message;
+            message.Format(_T("Client connection from %s was not accepted. Blocked by the %s limit for the address."), String(remoteAddress.ToString()).c_str(), 
+               limiterResult == ConnectionLimiter::RefusedByRateLimit ? _T("connection rate") : _T("concurrent connection"));
+            LOG_DEBUG(message);
 
+            HoldConnection_(connection, remoteAddress);
             return;
          }
 
+         // From here on, the connection releases the lease in the limiter when it ends.
+         connection->SetConnectionLimiterLease(limiterLease);
+
          if (!FireOnAcceptEvent(remoteAddress, localEndpoint.port()))
          {
             // Session has been created, but is now terminated by a custom script. Since we haven't started the
@@ -220,6 +241,7 @@ namespace HM
          }
 
          connection->SetSecurityRange(securityRange);
+
          connection->Start();
 
          // Now TCPConnection is responsible for decreasing the session count when the connection ends.
@@ -239,6 +261,43 @@ namespace HM
       }
    }
 
+   void
+   TCPServer::HoldConnection_(std::shared_ptr<TCPConnection> connection, const IPAddress &remoteAddress)
+   {
+      // Give option to hold connection for anti-pounding & hopefully minimize DoS. The timer
+      // keeps the connection alive until it fires, so no thread is tied up meanwhile.
+      int iBlockedIPHoldSeconds = IniFileSettings::Instance()->GetBlockedIPHoldSeconds();
+
+      if (iBlockedIPHoldSeconds <= 0)
+         return;
+
+      if (!ConnectionLimiter::Instance()->TryStartHold())
+      {
+         String message;
+         message.Format(_T("Too many connections are being held. Dropping connection from %s at once."), String(remoteAddress.ToString()).c_str());
+         LOG_DEBUG(message);
+         return;
+      }
+
+      std::shared_ptr<boost::asio::deadline_timer> timer = 
+         std::make_shared<boost::asio::deadline_timer>(connection->GetSocket().get_io_service());
+
+      timer->expires_from_now(boost::posix_time::seconds(iBlockedIPHoldSeconds));
+      timer->async_wait(std::bind(&TCPServer::OnHoldEnded_, connection, timer, remoteAddress, iBlockedIPHoldSeconds));
+   }
+
+   void
+   TCPServer::OnHoldEnded_(std::shared_ptr<TCPConnection> connection, std::shared_ptr<boost::asio::deadline_timer> timer, const IPAddress &remoteAddress, int seconds)
+   {
+      ConnectionLimiter::Instance()->OnHoldEnded();
+
+      String message;
+      message.Format(_T("Held connection from %s for %i seconds before dropping."), String(remoteAddress.ToString()).c_str(), seconds);
+      LOG_DEBUG(message);
+
+      // The socket is closed when the last reference to the connection goes away.
+   }
+
    bool
    TCPServer::FireOnAcceptEvent(const IPAddress &remoteAddress, int port)
    {
@@ -12,6 +12,7 @@
 #include "../BO/SSLCertificate.h"
 
 #include "TCPConnectionFactory.h"
+#include "IOServicePool.h"
 
 using boost::asio::ip::tcp;
 
@@ -22,7 +23,7 @@ namespace HM
    class TCPServer
    {
    public:
-      TCPServer(boost::asio::io_service& io_service, const IPAddress &ipaddress, int port, SessionType sessionType, std::shared_ptr<SSLCertificate> certificate, std::shared_ptr<TCPConnectionFactory> connectionFactory, ConnectionSecurity connection_security);
+      TCPServer(boost::asio::io_service& io_service, std::shared_ptr<IOServicePool> io_service_pool, const IPAddress &ipaddress, int port, SessionType sessionType, std::shared_ptr<SSLCertificate> certificate, std::shared_ptr<TCPConnectionFactory> connectionFactory, ConnectionSecurity connection_security);
       ~TCPServer(void);
 
       void Run();
@@ -39,10 +40,14 @@ namespace HM
       void HandleAccept(std::shared_ptr<TCPConnection> connection, const boost::system::error_code& error);
 
       bool FireOnAcceptEvent(const IPAddress &remoteAddress, int port);
+
+      void HoldConnection_(std::shared_ptr<TCPConnection> connection, const IPAddress &remoteAddress);
+      static void OnHoldEnded_(std::shared_ptr<TCPConnection> connection, std::shared_ptr<boost::asio::deadline_timer> timer, const IPAddress &remoteAddress, int seconds);
       
       std::shared_ptr<TCPConnectionFactory> connectionFactory_;
 
       boost::asio::ip::tcp::acceptor acceptor_;
+      std::shared_ptr<IOServicePool> io_service_pool_;
       boost::asio::ssl::context context_;
       SessionType sessionType_;
       std::shared_ptr<SSLCertificate> certificate_;
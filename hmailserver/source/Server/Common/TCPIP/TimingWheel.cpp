@@ -0,0 +1,172 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "StdAfx.h"
+
+#include "TimingWheel.h"
+#include "TCPConnection.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   boost::asio::io_service::id TimingWheel::id;
+
+   TimingWheel::TimingWheel(boost::asio::io_service &io_service) :
+      boost::asio::io_service::service(io_service),
+      timer_(io_service),
+      inner_(InnerSlots),
+      outer_(OuterSlots),
+      current_tick_(0),
+      entry_count_(0),
+      ticking_(false),
+      shut_down_(false)
+   {
+
+   }
+
+   TimingWheel::~TimingWheel()
+   {
+
+   }
+
+   void
+   TimingWheel::shutdown_service()
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      shut_down_ = true;
+
+      boost::system::error_code error;
+      timer_.cancel(error);
+
+      for (std::vector<Entry> &slot : inner_)
+         slot.clear();
+
+      for (std::vector<Entry> &slot : outer_)
+         slot.clear();
+
+      entry_count_ = 0;
+   }
+
+   void
+   TimingWheel::Schedule(std::shared_ptr<TCPConnection> connection, unsigned int generation)
+   {
+      Entry entry;
+      entry.connection_ = connection;
+      entry.generation_ = generation;
+
+      int remaining = connection->GetMillisecondsUntilTimeout_();
+
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      if (shut_down_)
+         return;
+
+      Insert_(entry, remaining);
+      entry_count_++;
+
+      if (!ticking_)
+         StartTicking_();
+   }
+
+   void
+   TimingWheel::Insert_(const Entry &entry, int remainingMilliseconds)
+   {
+      // Round up, so that we never time out a connection early.
+      unsigned int ticks = remainingMilliseconds <= 0 ? 1 : (unsigned int) ((remainingMilliseconds + TickMilliseconds - 1) / TickMilliseconds);
+
+      if (ticks < (unsigned int) InnerSlots)
+      {
+         inner_[(current_tick_ + ticks) % InnerSlots].push_back(entry);
+         return;
+      }
+
+      // Never place an entry in the outer slot which is currently being served, since
+      // it would not be looked at until the outer wheel has made a full turn.
+      ticks = min(ticks, (unsigned int) ((OuterSlots - 1) * InnerSlots));
+
+      outer_[((current_tick_ + ticks) / InnerSlots) % OuterSlots].push_back(entry);
+   }
+
+   void
+   TimingWheel::StartTicking_()
+   {
+      ticking_ = true;
+
+      boost::system::error_code error;
+      timer_.expires_from_now(boost::posix_time::milliseconds(TickMilliseconds), error);
+
+      if (error)
+      {
+         ticking_ = false;
+         ErrorManager::Instance()->ReportError(ErrorManager::Low, 5333, "TimingWheel::StartTicking_", "An unknown error occurred while updating logout timer.");
+         return;
+      }
+
+      timer_.async_wait(std::bind(&TimingWheel::OnTick_, this, std::placeholders::_1));
+   }
+
+   void
+   TimingWheel::OnTick_(const boost::system::error_code &error)
+   {
+      std::vector<std::shared_ptr<TCPConnection> > expired;
+
+      {
+         boost::lock_guard<boost::mutex> guard(mutex_);
+
+         if (error == boost::asio::error::operation_aborted || shut_down_)
+            return;
+
+         current_tick_++;
+
+         std::vector<Entry> due;
+
+         // Move the entries of the next outer slot into the inner wheel before
+         // the inner slot is served, since some of them may be due already.
+         if (current_tick_ % InnerSlots == 0)
+            due.swap(outer_[(current_tick_ / InnerSlots) % OuterSlots]);
+
+         std::vector<Entry> &innerSlot = inner_[current_tick_ % InnerSlots];
+         due.insert(due.end(), innerSlot.begin(), innerSlot.end());
+         innerSlot.clear();
+
+         for (const Entry &entry : due)
+         {
+            std::shared_ptr<TCPConnection> connection = entry.connection_.lock();
+
+            if (!connection || connection->GetTimeoutGeneration_() != entry.generation_)
+            {
+               // The connection has ended, or has been re-scheduled with a new timeout.
+               entry_count_--;
+               continue;
+            }
+
+            int remaining = connection->GetMillisecondsUntilTimeout_();
+
+            if (remaining > 0)
+            {
+               Insert_(entry, remaining);
+               continue;
+            }
+
+            entry_count_--;
+            expired.push_back(connection);
+         }
+
+         // Stop ticking when there's nothing left to time out. The next call to
+         // Schedule will start the timer again.
+         if (entry_count_ > 0)
+            StartTicking_();
+         else
+            ticking_ = false;
+      }
+
+      // The connections will schedule themselves again, so the lock must not be held here.
+      for (std::shared_ptr<TCPConnection> connection : expired)
+         connection->OnIdleTimeout_();
+   }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   class TCPConnection;
+
+   // Keeps track of the idle timeouts of the connections running on an io_service. There is
+   // one wheel per io_service (use_service<TimingWheel>), so in io_service-per-thread mode
+   // every shard has a wheel of its own.
+   //
+   // Connections only store the time of their last activity. Entries are placed in the slot
+   // where the connection would time out had there been no further activity, and when the
+   // slot is reached the actual deadline is checked. Connections which have been active in
+   // the meantime are moved to a later slot instead of being timed out.
+   class TimingWheel : public boost::asio::io_service::service
+   {
+   public:
+      static boost::asio::io_service::id id;
+
+      explicit TimingWheel(boost::asio::io_service &io_service);
+      ~TimingWheel();
+
+      void Schedule(std::shared_ptr<TCPConnection> connection, unsigned int generation);
+      // Adds the connection to the wheel. Entries with an older generation than the
+      // connection's current one are dropped when their slot is reached.
+
+   private:
+
+      enum Settings
+      {
+         TickMilliseconds = 1000,
+
+         // The inner wheel covers the first 256 seconds with one slot per tick. The
+         // outer wheel covers up to about four and a half hours, 256 ticks per slot.
+         // Entries further away than that are re-checked when the outer slot is reached.
+         InnerSlots = 256,
+         OuterSlots = 64
+      };
+
+      struct Entry
+      {
+         std::weak_ptr<TCPConnection> connection_;
+         unsigned int generation_;
+      };
+
+      virtual void shutdown_service();
+
+      void Insert_(const Entry &entry, int remainingMilliseconds);
+      void StartTicking_();
+      void OnTick_(const boost::system::error_code &error);
+
+      boost::mutex mutex_;
+      boost::asio::deadline_timer timer_;
+
+      std::vector<std::vector<Entry> > inner_;
+      std::vector<std::vector<Entry> > outer_;
+
+      unsigned int current_tick_;
+      size_t entry_count_;
+      bool ticking_;
+      bool shut_down_;
+   };
+}
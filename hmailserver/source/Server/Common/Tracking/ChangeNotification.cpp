@@ -79,4 +79,16 @@ namespace HM
       return affected_messages_;
    }
 
+   const std::vector<unsigned int>&
+   ChangeNotification::GetAffectedUIDs() const
+   {
+      return affected_uids_;
+   }
+
+   void
+   ChangeNotification::SetAffectedUIDs(const std::vector<unsigned int>& affectedUIDs)
+   {
+      affected_uids_ = affectedUIDs;
+   }
+
 }
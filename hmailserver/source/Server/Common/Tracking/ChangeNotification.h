@@ -30,12 +30,17 @@ namespace HM
       NotificationType GetType() const;
       __int64 GetData() const;
 
+      const std::vector<unsigned int>& GetAffectedUIDs() const;
+      void SetAffectedUIDs(const std::vector<unsigned int>& affectedUIDs);
+      // The UIDs of expunged messages, for clients which want VANISHED responses.
+
    private:
 
       __int64 account_id_;
       __int64 folder_id_;
       __int64 data_;
       std::vector<__int64> affected_messages_;
+      std::vector<unsigned int> affected_uids_;
       NotificationType type_;
 
    };
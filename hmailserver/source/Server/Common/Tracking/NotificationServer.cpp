@@ -17,7 +17,19 @@ namespace HM
    NotificationServer::NotificationServer() :
       subscription_counter_(0)
    {
+      for (int i = 0; i < ShardCount; i++)
+      {
+         std::shared_ptr<Shard> shard = std::shared_ptr<Shard>(new Shard());
+         shard->subscriptions_ = std::shared_ptr<const SubscriptionMap>(new SubscriptionMap());
+         shards_.push_back(shard);
+      }
+   }
 
+   NotificationServer::Shard &
+   NotificationServer::GetShard_(const FolderKey &folder)
+   {
+      unsigned __int64 hash = (unsigned __int64) folder.first * 31 + (unsigned __int64) folder.second;
+      return *shards_[(size_t) (hash % ShardCount)];
    }
 
    void 
@@ -30,7 +42,7 @@ namespace HM
    void 
    NotificationServer::SendNotification(std::shared_ptr<NotificationClient> source, std::shared_ptr<ChangeNotification> pChangeNotification)
    {
-      std::set<std::shared_ptr<NotificationClient> > clientsToNotify = GetClientsToNotify_(source, pChangeNotification);
+      std::vector<std::shared_ptr<NotificationClient> > clientsToNotify = GetClientsToNotify_(source, pChangeNotification);
 
       for(std::shared_ptr<NotificationClient> client : clientsToNotify)
       {
@@ -38,12 +50,10 @@ namespace HM
       }
    }
 
-   std::set<std::shared_ptr<NotificationClient> >
+   std::vector<std::shared_ptr<NotificationClient> >
    NotificationServer::GetClientsToNotify_(std::shared_ptr<NotificationClient> source, std::shared_ptr<ChangeNotification> changeNotification)
    {
-      std::set<std::shared_ptr<NotificationClient> > clientsToNotify;
-
-      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+      std::vector<std::shared_ptr<NotificationClient> > clientsToNotify;
 
       switch (changeNotification->GetType())
       {
@@ -52,40 +62,47 @@ namespace HM
       case ChangeNotification::NotificationMessageFlagsChanged:
          {
             // This is a message change notification.
-            std::pair<__int64, __int64> folderSpecifier = std::make_pair(changeNotification->GetAccountID(), changeNotification->GetFolderID());
+            FolderKey folderSpecifier = std::make_pair(changeNotification->GetAccountID(), changeNotification->GetFolderID());
+
+            std::shared_ptr<const SubscriptionMap> subscriptions = std::atomic_load(&GetShard_(folderSpecifier).subscriptions_);
 
-            // Locate subscribed client.
-            auto iter = message_change_subscribers_.find(folderSpecifier);
-            if (iter == message_change_subscribers_.end())
+            // Locate subscribed clients.
+            auto iter = subscriptions->find(folderSpecifier);
+            if (iter == subscriptions->end())
                return clientsToNotify;
 
-            auto iterLast = message_change_subscribers_.upper_bound(folderSpecifier);
+            std::shared_ptr<const SubscriptionList> subscribers = (*iter).second;
+            clientsToNotify.reserve(subscribers->size());
 
-            while (iter != iterLast)
-            {
-               // Notify this client.
-               std::shared_ptr<NotificationClientSubscription> subscription = (*iter).second;
-               std::weak_ptr<NotificationClient> client = subscription->GetSubscribedClient();
+            bool hasStaleSubscriptions = false;
 
-               std::shared_ptr<NotificationClient> safeClient = client.lock();
+            for (std::shared_ptr<NotificationClientSubscription> subscription : *subscribers)
+            {
+               std::shared_ptr<NotificationClient> safeClient = subscription->GetSubscribedClient().lock();
 
                if (!safeClient)
                {
-                  iter = message_change_subscribers_.erase(iter);
-                  ErrorManager::Instance()->ReportError(ErrorManager::Low, 5341, "MailboxChangeNotifier::ReportChange", "A previous folder subscription unsubscription failed. Cleaning up.");
+                  hasStaleSubscriptions = true;
                   continue;
                }
 
                if (source == safeClient)
                {
                   // let's not notify ourselves.
-                  iter++;
                   continue;
                }
 
-               clientsToNotify.insert(safeClient);
+               clientsToNotify.push_back(safeClient);
+            }
+
+            if (hasStaleSubscriptions)
+            {
+               ErrorManager::Instance()->ReportError(ErrorManager::Low, 5341, "MailboxChangeNotifier::ReportChange", "A previous folder subscription unsubscription failed. Cleaning up.");
 
-               iter++;
+               RemoveSubscriptions_(folderSpecifier, [](std::shared_ptr<NotificationClientSubscription> subscription)
+               {
+                  return subscription->GetSubscribedClient().expired();
+               });
             }
          }
          break;
@@ -95,23 +112,77 @@ namespace HM
 
    }
 
+   void
+   NotificationServer::RemoveSubscriptions_(const FolderKey &folder, std::function<bool(std::shared_ptr<NotificationClientSubscription>)> filter)
+   {
+      Shard &shard = GetShard_(folder);
+
+      boost::lock_guard<boost::mutex> guard(shard.mutex_);
+
+      std::shared_ptr<const SubscriptionMap> subscriptions = std::atomic_load(&shard.subscriptions_);
+
+      auto iter = subscriptions->find(folder);
+      if (iter == subscriptions->end())
+         return;
+
+      std::shared_ptr<SubscriptionList> subscribers = std::shared_ptr<SubscriptionList>(new SubscriptionList());
+      subscribers->reserve((*iter).second->size());
+
+      for (std::shared_ptr<NotificationClientSubscription> subscription : *(*iter).second)
+      {
+         if (!filter(subscription))
+            subscribers->push_back(subscription);
+      }
+
+      if (subscribers->size() == (*iter).second->size())
+         return;
+
+      // Only the list of the folder is copied. The other folders in the shard keep theirs.
+      std::shared_ptr<SubscriptionMap> newSubscriptions = std::shared_ptr<SubscriptionMap>(new SubscriptionMap(*subscriptions));
+
+      if (subscribers->empty())
+         newSubscriptions->erase(folder);
+      else
+         (*newSubscriptions)[folder] = subscribers;
+
+      std::atomic_store(&shard.subscriptions_, std::shared_ptr<const SubscriptionMap>(newSubscriptions));
+   }
+
    __int64
    NotificationServer::SubscribeMessageChanges(__int64 accountID, __int64 folderID, std::shared_ptr<NotificationClient> pChangeClient)
    {
       try
       {
-         std::pair<__int64, __int64> folderSpecifier = std::make_pair(accountID, folderID);
+         FolderKey folderSpecifier = std::make_pair(accountID, folderID);
 
-         boost::lock_guard<boost::recursive_mutex> guard(mutex_);
-
-         subscription_counter_++;
+         __int64 subscriptionKey = ++subscription_counter_;
          std::shared_ptr<NotificationClientSubscription> subscription = 
-            std::shared_ptr<NotificationClientSubscription>(new NotificationClientSubscription(subscription_counter_, pChangeClient));
+            std::shared_ptr<NotificationClientSubscription>(new NotificationClientSubscription(subscriptionKey, pChangeClient));
+
+         Shard &shard = GetShard_(folderSpecifier);
+
+         boost::lock_guard<boost::mutex> guard(shard.mutex_);
+
+         std::shared_ptr<const SubscriptionMap> subscriptions = std::atomic_load(&shard.subscriptions_);
+
+         std::shared_ptr<SubscriptionList> subscribers = std::shared_ptr<SubscriptionList>(new SubscriptionList());
+
+         auto iter = subscriptions->find(folderSpecifier);
+         if (iter != subscriptions->end())
+         {
+            subscribers->reserve((*iter).second->size() + 1);
+            subscribers->insert(subscribers->end(), (*iter).second->begin(), (*iter).second->end());
+         }
 
          // Add subscription
-         message_change_subscribers_.insert(std::make_pair(folderSpecifier, subscription));
+         subscribers->push_back(subscription);
+
+         std::shared_ptr<SubscriptionMap> newSubscriptions = std::shared_ptr<SubscriptionMap>(new SubscriptionMap(*subscriptions));
+         (*newSubscriptions)[folderSpecifier] = subscribers;
+
+         std::atomic_store(&shard.subscriptions_, std::shared_ptr<const SubscriptionMap>(newSubscriptions));
 
-         return subscription_counter_;
+         return subscriptionKey;
       }
       catch (...)
       {
@@ -127,28 +198,12 @@ namespace HM
    {
       try
       {
-         std::pair<__int64, __int64> folderSpecifier = std::make_pair(iAccountID, iFolderID);
-
-         boost::lock_guard<boost::recursive_mutex> guard(mutex_);
-
-         auto iter = message_change_subscribers_.find(folderSpecifier);
-         if (iter == message_change_subscribers_.end())
-            return;
-
-         auto iterLast = message_change_subscribers_.upper_bound(folderSpecifier);
+         FolderKey folderSpecifier = std::make_pair(iAccountID, iFolderID);
 
-         for(; iter != iterLast; iter++)
+         RemoveSubscriptions_(folderSpecifier, [subscriptionKey](std::shared_ptr<NotificationClientSubscription> subscription)
          {
-            std::shared_ptr<NotificationClientSubscription> subscription = (*iter).second;
-
-            if (subscription->GetSubscriptionKey() == subscriptionKey)
-            {
-               // Unsubscribe
-               iter =  message_change_subscribers_.erase(iter);
-               return;
-            }
-         }
-
+            return subscription->GetSubscriptionKey() == subscriptionKey;
+         });
       }
       catch (...)
       {
@@ -162,16 +217,17 @@ namespace HM
    {
       try
       {
+         __int64 subscriptionKey = ++subscription_counter_;
+
          boost::lock_guard<boost::recursive_mutex> guard(mutex_);
 
-         subscription_counter_++;
          std::shared_ptr<NotificationClientSubscription> subscription = 
-            std::shared_ptr<NotificationClientSubscription>(new NotificationClientSubscription(subscription_counter_, pChangeClient));
+            std::shared_ptr<NotificationClientSubscription>(new NotificationClientSubscription(subscriptionKey, pChangeClient));
 
          // Add subscription
          folder_list_change_subscribers_.insert(std::make_pair(accountID, subscription));
 
-         return subscription_counter_;
+         return subscriptionKey;
       }
       catch (...)
       {
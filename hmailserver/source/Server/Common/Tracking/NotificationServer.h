@@ -3,12 +3,17 @@
 
 #pragma once
 
+#include <boost/atomic.hpp>
+
 namespace HM
 {
    class NotificationClient;
    class ChangeNotification;
    class NotificationClientSubscription;
 
+   // Message change subscriptions are spread over shards by folder. Each shard holds
+   // an immutable map of subscriber lists which is replaced when someone subscribes
+   // or unsubscribes, so sending a notification never waits for a lock.
    class NotificationServer
    {
    public:
@@ -25,13 +30,34 @@ namespace HM
 
    private:
 
-      std::set<std::shared_ptr<NotificationClient> > GetClientsToNotify_(std::shared_ptr<NotificationClient> source, std::shared_ptr<ChangeNotification> pChangeNotification);
+      enum Settings
+      {
+         ShardCount = 64
+      };
+
+      typedef std::pair<__int64, __int64> FolderKey;
+      typedef std::vector<std::shared_ptr<NotificationClientSubscription> > SubscriptionList;
+      typedef std::map<FolderKey, std::shared_ptr<const SubscriptionList> > SubscriptionMap;
+
+      struct Shard
+      {
+         // Only held while replacing the subscriptions.
+         boost::mutex mutex_;
+
+         // Read and replaced using atomic_load and atomic_store.
+         std::shared_ptr<const SubscriptionMap> subscriptions_;
+      };
+
+      Shard &GetShard_(const FolderKey &folder);
+      void RemoveSubscriptions_(const FolderKey &folder, std::function<bool(std::shared_ptr<NotificationClientSubscription>)> filter);
+
+      std::vector<std::shared_ptr<NotificationClient> > GetClientsToNotify_(std::shared_ptr<NotificationClient> source, std::shared_ptr<ChangeNotification> pChangeNotification);
 
-      std::multimap<std::pair<__int64, __int64>, std::shared_ptr<NotificationClientSubscription> > message_change_subscribers_;
+      std::vector<std::shared_ptr<Shard> > shards_;
       std::multimap<__int64, std::shared_ptr<NotificationClientSubscription> > folder_list_change_subscribers_;
 
       boost::recursive_mutex mutex_;
 
-      __int64 subscription_counter_;
+      boost::atomic<__int64> subscription_counter_;
    };
 }
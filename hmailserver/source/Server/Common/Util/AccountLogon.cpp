@@ -5,9 +5,8 @@
 
 #include "AccountLogon.h"
 #include "PasswordValidator.h"
-#include "../Persistence/PersistentLogonFailure.h"
-#include "../Persistence/PersistentAccount.h"
 #include "../Persistence/PersistentSecurityRange.h"
+#include "../Application/LastLogonTimeWriter.h"
 
 #include "../BO/SecurityRange.h"
 #include "../BO/Account.h"
@@ -15,6 +14,7 @@
 #include "Time.h"
 #include "GUIDCreator.h"
 #include "PasswordGenerator.h"
+#include "LogonFailureTracker.h"
 
 
 #ifdef _DEBUG
@@ -42,7 +42,7 @@ namespace HM
       std::shared_ptr<const Account> account = PasswordValidator::ValidatePassword(username, password);
       if (account)
       {
-         PersistentAccount::UpdateLastLogonTime(account);
+         LastLogonTimeWriter::Instance()->SetLastLogonTime(account->GetID());
          return account;
       }
 
@@ -56,12 +56,11 @@ namespace HM
       }
 
       // Log on has failed.
-      PersistentLogonFailure logonFailure;
-      int failureCount = logonFailure.GetCurrrentFailureCount(ipaddress) + 1; // +1 because we count the current failure as well.
+      int failureCount = LogonFailureTracker::Instance()->AddFailure(ipaddress, Configuration::Instance()->GetMaxLogonAttemptsWithin());
 
       if (failureCount >= maxInvalidLogonAttempts)
       {
-         logonFailure.ClearFailuresByIP(ipaddress);
+         LogonFailureTracker::Instance()->ClearFailures(ipaddress);
 
          int minutes = Configuration::Instance()->GetAutoBanMinutes();
          if (minutes == 0)
@@ -81,9 +80,6 @@ namespace HM
          return empty;
       }
 
-      // logon failed, add new failure.
-      logonFailure.AddFailure(ipaddress);
-
       std::shared_ptr<Account> empty;
       return empty;
    }
@@ -109,11 +105,17 @@ namespace HM
       dt = dt + span;
 
 
+      // IPv6 clients are banned together with the rest of their /64 network, 
+      // since that's what their failures were counted for.
+      IPAddress lowerIP;
+      IPAddress upperIP;
+      LogonFailureTracker::GetBanRange(ipaddress, lowerIP, upperIP);
+
       std::shared_ptr<SecurityRange> pSecurityRange = std::shared_ptr<SecurityRange>(new SecurityRange);
       pSecurityRange->SetName(GetIPRangeName_(username));
       pSecurityRange->SetPriority(100);
-      pSecurityRange->SetLowerIP(ipaddress);
-      pSecurityRange->SetUpperIP(ipaddress);
+      pSecurityRange->SetLowerIP(lowerIP);
+      pSecurityRange->SetUpperIP(upperIP);
       pSecurityRange->SetExpires(true);
       pSecurityRange->SetExpiresTime(dt);
       PersistentSecurityRange::SaveObject(pSecurityRange);
@@ -6,6 +6,8 @@
 #include "Base64.h"
 #include "../../MIME/MimeCode.h"
 
+#include <openssl/evp.h>
+
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
@@ -18,19 +20,17 @@ namespace HM
    {
       // base64 encode the signature.
       MimeCodeBase64 encoder;
-      encoder.SetInput(input, inputLength, true);
 
-      AnsiString sEncodedValue;
-      encoder.GetOutput(sEncodedValue);
-
-      // the MIME encoder will insert newlines. We don't want this
+      // the MIME encoder would insert newlines. We don't want this
       // here since this is a generic base64 encoder which may be
       // used in none-mime environments (key encoding anyone?)
-      AnsiString result = sEncodedValue;
-      result.Replace("\r\n", "");
+      encoder.AddLineBreak(false);
+      encoder.SetInput(input, inputLength, true);
 
-      return result;
+      AnsiString result;
+      encoder.GetOutput(result);
 
+      return result;
    }
 
    AnsiString 
@@ -82,5 +82,109 @@ namespace HM
       s = Base64::Decode(input, input.GetLength());
       if (s.Compare(_T("hMailServer is a free e-mail server for Microsoft Windows. It's used by Internet service providers, companies, governments, schools and enthusiasts in all parts of the world. It supports the common e-mail protocols (IMAP, SMTP and POP3) and can easily be integrated with many existing web mail systems. It has flexible score-based spam protection and can attach to your virus scanner to scan all incoming and outgoing email.")) != 0)
          throw;
+
+      TestRandomInput_();
+   }
+
+   void
+   Base64Tester::TestRandomInput_()
+   {
+      // The same sequence is used on every run, so that a failure can be reproduced.
+      unsigned int seed = 1;
+
+      for (int i = 0; i < 2000; i++)
+      {
+         AnsiString input;
+
+         int length = i % 300;
+         for (int pos = 0; pos < length; pos++)
+         {
+            seed = seed * 1103515245 + 12345;
+            input.append(1, (char) (seed >> 16));
+         }
+
+         // Encoded with line breaks, as in a MIME body.
+         MimeCodeBase64 mimeEncoder;
+         mimeEncoder.SetInput(input, input.GetLength(), true);
+
+         AnsiString mimeEncoded;
+         mimeEncoder.GetOutput(mimeEncoded);
+
+         // Every line, including the last one, should end with a line break.
+         int lineStart = 0;
+         while (lineStart < mimeEncoded.GetLength())
+         {
+            int lineEnd = mimeEncoded.Find("\r\n", lineStart);
+            if (lineEnd < 0 || lineEnd - lineStart > MAX_MIME_LINE_LEN)
+               throw;
+
+            lineStart = lineEnd + 2;
+         }
+
+         MimeCodeBase64 mimeDecoder;
+         mimeDecoder.SetInput(mimeEncoded, mimeEncoded.GetLength(), false);
+
+         AnsiString mimeDecoded;
+         mimeDecoder.GetOutput(mimeDecoded);
+
+         if (mimeDecoded != input)
+            throw;
+
+         // Encoded without line breaks, as in AUTH and DKIM.
+         AnsiString encoded = Base64::Encode(input, input.GetLength());
+
+         AnsiString expected = mimeEncoded;
+         expected.Replace("\r\n", "");
+
+         if (encoded != expected)
+            throw;
+
+         if (Base64::Decode(encoded, encoded.GetLength()) != input)
+            throw;
+
+         // Compare with an independent encoder.
+         std::vector<unsigned char> reference(4 * ((input.GetLength() + 2) / 3) + 1);
+         int referenceLength = EVP_EncodeBlock(&reference[0], (const unsigned char*) input.c_str(), input.GetLength());
+
+         if (encoded != AnsiString((const char*) &reference[0], referenceLength))
+            throw;
+
+         TestQuotedPrintable_(input, false);
+         TestQuotedPrintable_(input, true);
+      }
+   }
+
+   void
+   Base64Tester::TestQuotedPrintable_(const AnsiString &input, bool addLineBreak)
+   {
+      MimeCodeQP qpEncoder;
+      qpEncoder.AddLineBreak(addLineBreak);
+      qpEncoder.SetInput(input, input.GetLength(), true);
+
+      AnsiString qpEncoded;
+      qpEncoder.GetOutput(qpEncoded);
+
+      if (addLineBreak)
+      {
+         // Line breaks in the input are kept, so lines are counted from any CR or LF.
+         int lineLength = 0;
+         for (int pos = 0; pos < qpEncoded.GetLength(); pos++)
+         {
+            char c = qpEncoded[pos];
+            lineLength = c == '\r' || c == '\n' ? 0 : lineLength + 1;
+
+            if (lineLength > MAX_MIME_LINE_LEN)
+               throw;
+         }
+      }
+
+      MimeCodeQP qpDecoder;
+      qpDecoder.SetInput(qpEncoded, qpEncoded.GetLength(), false);
+
+      AnsiString qpDecoded;
+      qpDecoder.GetOutput(qpDecoded);
+
+      if (qpDecoded != input)
+         throw;
    }
 }
\ No newline at end of file
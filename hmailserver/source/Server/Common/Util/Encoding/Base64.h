@@ -17,6 +17,10 @@ namespace HM
    {
    public:
       void Test();
+
+   private:
+      void TestRandomInput_();
+      void TestQuotedPrintable_(const AnsiString &input, bool addLineBreak);
    };
 
 }
\ No newline at end of file
@@ -176,11 +176,11 @@ namespace HM
    {
       try
       {
-         std::shared_ptr<ByteBuffer> pFileContents = ReadFile();
+         // The terminating null is reserved when the buffer is allocated. Adding
+         // it afterwards would copy the entire file to a new buffer.
+         int iFileSize = GetSize();
 
-         const BYTE pByte = '\0';
-         pFileContents->Add(&pByte, 1);
-         return pFileContents;
+         return ReadChunk_(iFileSize, 1);
       }
       catch (...)
       {
@@ -194,14 +194,20 @@ namespace HM
  
    std::shared_ptr<ByteBuffer> 
    File::ReadChunk(int iMaxSize)
+   {  
+      return ReadChunk_(iMaxSize, 0);
+   }
+
+   std::shared_ptr<ByteBuffer> 
+   File::ReadChunk_(int iMaxSize, int iReservedBytes)
    {  
       std::shared_ptr<ByteBuffer> pFileContents = std::shared_ptr<ByteBuffer>(new ByteBuffer);
 
       if (file_ == nullptr)
          throw std::logic_error("Attempt to read from file which has not been opened.");
          
-      // Create a buffer to hold the file
-      pFileContents->Allocate(iMaxSize);
+      // Create a buffer to hold the file. Allocate clears it.
+      pFileContents->Allocate(iMaxSize + iReservedBytes);
 
       // fread fails reading large files. If the file is too large, fread will read zero bytes and the
       // errno will be set to invalid argument. The below code therefore reads the file in chunks.
@@ -54,6 +54,8 @@ namespace HM
    private:
 
       void ThrowRuntimeError_(const AnsiString &message);
+      std::shared_ptr<ByteBuffer> ReadChunk_(int iMaxSize, int iReservedBytes);
+      // The returned buffer ends with iReservedBytes zero bytes, after the data read.
 
       FILE * file_;
       String name_;
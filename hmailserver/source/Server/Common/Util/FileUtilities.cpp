@@ -156,6 +156,34 @@ namespace HM
       throw std::logic_error("Move file logic error.");
    }
 
+   bool
+   FileUtilities::Replace(const String &sFrom, const String &sTo)
+   {
+      // Unlike Move, the target isn't deleted first. If it can't be replaced,
+      // it's left as it was.
+      const int iMaxNumberOfTries = 5;
+
+      for (int i = 1; i <= iMaxNumberOfTries; i++)
+      {
+         if (::MoveFileEx(sFrom.c_str(), sTo.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+            return true;
+
+         if (i == iMaxNumberOfTries)
+         {
+            String sErrorMessage;
+            sErrorMessage.Format(_T("Could not replace the file %s with %s. Tried 5 times without success. Error code: %d"), sTo.c_str(), sFrom.c_str(), ::GetLastError());
+            ErrorManager::Instance()->ReportError(ErrorManager::High, 5058, "FileUtilities::Replace", sErrorMessage);
+
+            return false;
+         }
+
+         // Some other process must have locked the file.
+         Sleep(250);
+      }
+
+      throw std::logic_error("Replace file logic error.");
+   }
+
    bool
    FileUtilities::Exists(const String &sFilename)
    {
@@ -352,6 +380,21 @@ namespace HM
       return result;
    }
 
+   __int64
+   FileUtilities::LastWriteTime(const String &sFileName)
+   {
+      // In 100-nanosecond intervals, which is enough to tell two writes apart.
+      WIN32_FILE_ATTRIBUTE_DATA file_info;
+      if (!GetFileAttributesExW(sFileName.c_str(), GetFileExInfoStandard, &file_info))
+         return 0;
+
+      ULARGE_INTEGER last_write_time;
+      last_write_time.LowPart = file_info.ftLastWriteTime.dwLowDateTime;
+      last_write_time.HighPart = file_info.ftLastWriteTime.dwHighDateTime;
+
+      return (__int64) last_write_time.QuadPart;
+   }
+
    String
    FileUtilities::GetTempFileName()
    {
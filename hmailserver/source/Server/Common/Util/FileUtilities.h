@@ -23,6 +23,7 @@ namespace HM
       //static bool ReadLine(HANDLE hFile, String &sLine);
       static bool Copy(const String &sFrom, const String &sTo, bool bCreateMissingDirectories = false);
       static bool Move(const String &sFrom, const String &sTo, bool overwrite = false);
+      static bool Replace(const String &sFrom, const String &sTo);
       static bool Exists(const String &sFilename);
 
       static void ReadFileToBuf(const String &sFilename, BYTE *Buf, int iStart = -1, int iCount = -1);
@@ -32,6 +33,7 @@ namespace HM
       static bool WriteToFile(const String &sFilename, const AnsiString &sData);
 
       static long FileSize(const String &sFileName);
+      static __int64 LastWriteTime(const String &sFileName);
 
       static String GetTempFileName();
       static bool CreateDirectory(const String &sName);
@@ -0,0 +1,120 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "LogonFailureTracker.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   LogonFailureTracker::LogonFailureTracker()
+   {
+
+   }
+
+   int
+   LogonFailureTracker::AddFailure(const IPAddress &address, int windowMinutes)
+   {
+      Key key = GetKey_(address);
+      Shard &shard = GetShard_(key);
+
+      unsigned int now = GetTickCount();
+
+      boost::lock_guard<boost::mutex> guard(shard.mutex_);
+
+      std::deque<unsigned int> &failures = shard.failures_[key];
+
+      RemoveOlderThan_(failures, now, (unsigned int) windowMinutes * 60 * 1000);
+      failures.push_back(now);
+
+      return (int) failures.size();
+   }
+
+   void
+   LogonFailureTracker::ClearFailures(const IPAddress &address)
+   {
+      Key key = GetKey_(address);
+      Shard &shard = GetShard_(key);
+
+      boost::lock_guard<boost::mutex> guard(shard.mutex_);
+      shard.failures_.erase(key);
+   }
+
+   void
+   LogonFailureTracker::RemoveExpired(int windowMinutes)
+   {
+      unsigned int now = GetTickCount();
+      unsigned int window = (unsigned int) windowMinutes * 60 * 1000;
+
+      for (int i = 0; i < ShardCount; i++)
+      {
+         Shard &shard = shards_[i];
+
+         boost::lock_guard<boost::mutex> guard(shard.mutex_);
+
+         auto iter = shard.failures_.begin();
+         while (iter != shard.failures_.end())
+         {
+            RemoveOlderThan_((*iter).second, now, window);
+
+            if ((*iter).second.empty())
+               iter = shard.failures_.erase(iter);
+            else
+               iter++;
+         }
+      }
+   }
+
+   void
+   LogonFailureTracker::Clear()
+   {
+      for (int i = 0; i < ShardCount; i++)
+      {
+         boost::lock_guard<boost::mutex> guard(shards_[i].mutex_);
+         shards_[i].failures_.clear();
+      }
+   }
+
+   void
+   LogonFailureTracker::GetBanRange(const IPAddress &address, IPAddress &lower, IPAddress &upper)
+   {
+      if (address.GetType() != IPAddress::IPV6)
+      {
+         lower = address;
+         upper = address;
+         return;
+      }
+
+      lower = IPAddress(address.GetAddress1(), 0);
+      upper = IPAddress(address.GetAddress1(), (__int64) 0xFFFFFFFFFFFFFFFFULL);
+   }
+
+   LogonFailureTracker::Key
+   LogonFailureTracker::GetKey_(const IPAddress &address)
+   {
+      if (address.GetType() == IPAddress::IPV6)
+         return std::make_pair(address.GetAddress1(), (unsigned __int64) 1);
+
+      return std::make_pair((unsigned __int64) address.GetAddress1(), (unsigned __int64) 0);
+   }
+
+   void
+   LogonFailureTracker::RemoveOlderThan_(std::deque<unsigned int> &failures, unsigned int now, unsigned int window)
+   {
+      // The tick count wraps after 49 days, which the unsigned subtraction takes care of.
+      while (!failures.empty() && now - failures.front() >= window)
+         failures.pop_front();
+   }
+
+   LogonFailureTracker::Shard &
+   LogonFailureTracker::GetShard_(const Key &key)
+   {
+      unsigned __int64 hash = (key.first ^ key.second) * 0x9E3779B97F4A7C15ULL;
+
+      return shards_[(hash >> 32) % ShardCount];
+   }
+}
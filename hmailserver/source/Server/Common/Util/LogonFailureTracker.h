@@ -0,0 +1,57 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   // Counts failed logons per client within a sliding window, so that auto-ban
+   // doesn't need to ask the database on every failure. IPv4 clients are counted
+   // per address and IPv6 clients per /64 network, since a single IPv6 client 
+   // normally has a whole /64 to choose addresses from. The failures are kept
+   // in shards, each with its own lock.
+   class LogonFailureTracker : public Singleton<LogonFailureTracker>
+   {
+   public:
+
+      LogonFailureTracker();
+
+      int AddFailure(const IPAddress &address, int windowMinutes);
+      // Records a failed logon and returns the number of failures from the 
+      // client within the window, including this one.
+
+      void ClearFailures(const IPAddress &address);
+      
+      void RemoveExpired(int windowMinutes);
+      // Forgets clients which have not failed to log on within the window.
+
+      void Clear();
+
+      static void GetBanRange(const IPAddress &address, IPAddress &lower, IPAddress &upper);
+      // Returns the range of addresses which the failures of the address are counted for.
+
+   private:
+
+      enum Settings
+      {
+         ShardCount = 64
+      };
+
+      typedef std::pair<unsigned __int64, unsigned __int64> Key;
+
+      struct Shard
+      {
+         boost::mutex mutex_;
+
+         // The tick counts of the failures, oldest first.
+         std::map<Key, std::deque<unsigned int> > failures_;
+      };
+
+      static Key GetKey_(const IPAddress &address);
+      static void RemoveOlderThan_(std::deque<unsigned int> &failures, unsigned int now, unsigned int window);
+
+      Shard &GetShard_(const Key &key);
+
+      Shard shards_[ShardCount];
+   };
+}
@@ -7,6 +7,7 @@
 #include "../Application/ObjectCache.h"
 #include "../Application/DefaultDomain.h"
 #include "../Cache/CacheContainer.h"
+#include "../Cache/CredentialCache.h"
 #include "../BO/Account.h"
 #include "../BO/Domain.h"
 #include "../BO/DomainAliases.h"
@@ -115,11 +116,16 @@ namespace HM
       else if (iPasswordEncryption == Crypt::ETMD5 ||
                iPasswordEncryption == Crypt::ETSHA256)
       {
+         if (CredentialCache::Instance()->GetIsVerified(pAccount, sPassword))
+            return true;
+
          // Compare hashs
          bool result = Crypt::Instance()->Validate(sPassword, sComparePassword, iPasswordEncryption);
 
          if (!result)
             return false;
+
+         CredentialCache::Instance()->AddVerified(pAccount, sPassword);
       }
       else if (iPasswordEncryption == Crypt::ETBlowFish)
       {
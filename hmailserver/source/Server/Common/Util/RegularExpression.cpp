@@ -14,6 +14,21 @@ using namespace boost;
 
 namespace HM
 {
+   class RegularExpression::CompiledExpression
+   {
+   public:
+      CompiledExpression(const String &sExpression) :
+         expression_(sExpression)
+      {
+
+      }
+
+      wregex expression_;
+   };
+
+   boost::mutex RegularExpression::cache_mutex_;
+   std::map<String, std::shared_ptr<const RegularExpression::CompiledExpression> > RegularExpression::cache_;
+
    RegularExpression::RegularExpression(void)
    {
    }
@@ -25,11 +40,13 @@ namespace HM
    bool 
    RegularExpression::TestExactMatch(const String &sExpression, const String &sValue)
    {
+      std::shared_ptr<const CompiledExpression> compiledExpression = GetCompiledExpression_(sExpression);
+      if (!compiledExpression)
+         return false;
+
       try
       {
-         wregex expression(sExpression); 
-         
-         if(regex_match(sValue, expression)) 
+         if(regex_match(sValue, compiledExpression->expression_)) 
             return true;
       }
       catch (std::runtime_error &) // regex_match will throw runtime_error if regexp is too complex.
@@ -40,6 +57,39 @@ namespace HM
       return false;
    }
 
+   std::shared_ptr<const RegularExpression::CompiledExpression>
+   RegularExpression::GetCompiledExpression_(const String &sExpression)
+   {
+      {
+         boost::lock_guard<boost::mutex> guard(cache_mutex_);
+
+         auto iter = cache_.find(sExpression);
+         if (iter != cache_.end())
+            return (*iter).second;
+      }
+
+      std::shared_ptr<const CompiledExpression> compiledExpression;
+
+      try
+      {
+         compiledExpression = std::shared_ptr<const CompiledExpression>(new CompiledExpression(sExpression));
+      }
+      catch (std::runtime_error &) // the expression is invalid or too complex.
+      {
+         
+      }
+
+      boost::lock_guard<boost::mutex> guard(cache_mutex_);
+
+      // Expressions may be built from message contents, so don't let the cache grow forever.
+      if (cache_.size() >= MaxCachedExpressions)
+         cache_.clear();
+
+      cache_[sExpression] = compiledExpression;
+
+      return compiledExpression;
+   }
+
    void
    RegularExpressionTester::Test()
    {
@@ -12,8 +12,23 @@ namespace HM
       ~RegularExpression(void);
 
       static bool TestExactMatch(const String &sExpression, const String &sValue);
+      // The expression is compiled the first time it's used, and then kept.
 
-      
+   private:
+
+      enum Settings
+      {
+         MaxCachedExpressions = 2000
+      };
+
+      class CompiledExpression;
+
+      static std::shared_ptr<const CompiledExpression> GetCompiledExpression_(const String &sExpression);
+
+      static boost::mutex cache_mutex_;
+
+      // Expressions which could not be compiled are kept as well, with an empty pointer.
+      static std::map<String, std::shared_ptr<const CompiledExpression> > cache_;
    };
 
    class RegularExpressionTester
@@ -40,16 +40,21 @@ namespace HM
       LOG_DEBUG(Formatter::Format("Retrieving messages from external account {0}", pFA->GetName()));
       
       std::shared_ptr<IOService> pIOService = Application::Instance()->GetIOService();
+      std::shared_ptr<IOServiceShard> shard = pIOService->GetIOServiceShard();
+      boost::asio::io_service &connectionIOService = shard ? shard->GetIOService() : pIOService->GetIOService();
 
       std::shared_ptr<Event> disconnectEvent = std::shared_ptr<Event>(new Event()) ;
       std::shared_ptr<POP3ClientConnection> pClientConnection = std::shared_ptr<POP3ClientConnection> 
          (new POP3ClientConnection(pFA, 
                                    pFA->GetConnectionSecurity(), 
-                                   pIOService->GetIOService(), 
+                                   connectionIOService, 
                                    pIOService->GetClientContext(), 
                                    disconnectEvent,
                                    pFA->GetServerAddress()));
 
+      if (shard)
+         pClientConnection->SetIOServiceShard(shard);
+
       DNSResolver resolver;
 
       std::vector<String> ip_addresses;
@@ -36,7 +36,7 @@ namespace HM
           pConnection->GetConnectionSecurity() == CSSTARTTLSRequired)
          sResponse += " STARTTLS";
 
-      sResponse += " NAMESPACE RIGHTS=texk";
+      sResponse += " NAMESPACE RIGHTS=texk ENABLE CONDSTORE QRESYNC";
 
       sResponse += "\r\n";
       sResponse += pArgument->Tag() + " OK CAPABILITY completed\r\n";
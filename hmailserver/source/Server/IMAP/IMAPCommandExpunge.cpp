@@ -6,6 +6,7 @@
 #include "IMAPConnection.h"
 
 #include "MessagesContainer.h"
+#include "IMAPCondStore.h"
 
 #include "../Common/BO/IMAPFolder.h"
 
@@ -42,13 +43,15 @@ namespace HM
 
       std::vector<__int64> expunged_messages_uid;
       std::vector<__int64> expunged_messages_index;
+      std::vector<unsigned int> expunged_messages_imap_uid;
 
-      std::function<bool(int, std::shared_ptr<Message>)> filter = [&expunged_messages_index, &expunged_messages_uid](int index, std::shared_ptr<Message> message)
+      std::function<bool(int, std::shared_ptr<Message>)> filter = [&expunged_messages_index, &expunged_messages_uid, &expunged_messages_imap_uid](int index, std::shared_ptr<Message> message)
       {
          if (message->GetFlagDeleted())
          {
             expunged_messages_index.push_back(index);
             expunged_messages_uid.push_back(message->GetID());
+            expunged_messages_imap_uid.push_back(message->GetUID());
             return true;
          }
 
@@ -58,15 +61,25 @@ namespace HM
       auto messages = MessagesContainer::Instance()->GetMessages(pCurFolder->GetAccountID(), pCurFolder->GetID());
       messages->DeleteMessages(filter);
 
-      auto iterExpunged = expunged_messages_index.begin();
-
       String sResponse;
-      while (iterExpunged != expunged_messages_index.end())
+
+      // A client which has enabled QRESYNC gets VANISHED instead of EXPUNGE.
+      if (pConnection->GetQResyncEnabled())
+      {
+         if (!expunged_messages_imap_uid.empty())
+            sResponse = "* VANISHED " + IMAPCondStore::FormatUIDSet(expunged_messages_imap_uid) + "\r\n";
+      }
+      else
       {
-         String sTemp;
-         sTemp.Format(_T("* %d EXPUNGE\r\n"), (*iterExpunged));
-         sResponse += sTemp;
-         iterExpunged++;
+         auto iterExpunged = expunged_messages_index.begin();
+
+         while (iterExpunged != expunged_messages_index.end())
+         {
+            String sTemp;
+            sTemp.Format(_T("* %d EXPUNGE\r\n"), (*iterExpunged));
+            sResponse += sTemp;
+            iterExpunged++;
+         }
       }
 
       pConnection->SendAsciiData(sResponse);
@@ -87,6 +100,7 @@ namespace HM
          // Notify the mailbox notifier that the mailbox contents have changed.
          std::shared_ptr<ChangeNotification> pNotification = 
             std::shared_ptr<ChangeNotification>(new ChangeNotification(pCurFolder->GetAccountID(), pCurFolder->GetID(), ChangeNotification::NotificationMessageDeleted, expunged_messages_index));
+         pNotification->SetAffectedUIDs(expunged_messages_imap_uid);
 
          Application::Instance()->GetNotificationServer()->SendNotification(pConnection->GetNotificationClient(), pNotification);
       }
@@ -6,6 +6,7 @@
 #include "IMAPConnection.h"
 #include "../Common/BO/Messages.h"
 #include "../Common/BO/Message.h"
+#include "../Common/BO/FolderSnapshot.h"
 #include "../Common/BO/IMAPFolder.h"
 #include "../Common/Persistence/PersistentMessage.h"
 
@@ -43,126 +44,97 @@ namespace HM
    IMAPResult
    IMAPCommandRangeAction::DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, std::shared_ptr<IMAPCommandArgument> pArgument)
    {
-      long lColonPos = -1;
+      std::shared_ptr<Messages> messages = pConnection->GetCurrentFolder()->GetMessages();
 
-      std::vector<String> sSplitted = StringParser::SplitString(sMailNos, ",");
+      // The sequence set is resolved against the snapshot, so only the matching
+      // messages are copied instead of the entire folder.
+      std::shared_ptr<const FolderSnapshot> snapshot = messages->GetSnapshot();
+
+      std::vector<size_t> indexes;
+      GetMessageIndexes_(snapshot, sMailNos, indexes);
+
+      std::vector<std::shared_ptr<Message>> matchingMessages = messages->GetCopy(snapshot, indexes);
 
-      if (is_uid_)
+      for (size_t i = 0; i < indexes.size(); i++)
       {
-         for(String sCur : sSplitted)
+         std::shared_ptr<Message> pMessage = matchingMessages[i];
+
+         // The message has been expunged since the snapshot was taken.
+         if (!pMessage)
+            continue;
+
+         IMAPResult result = DoAction(pConnection, (int) indexes[i] + 1, pMessage, pArgument);
+         if (result.GetResult() != IMAPResult::ResultOK)
          {
-            lColonPos = sCur.Find(_T(":"));
+            return result;
+         }
+      }
+
+      return IMAPResult();
+   }
+
+   void
+   IMAPCommandRangeAction::GetMessageIndexes_(std::shared_ptr<const FolderSnapshot> snapshot, const String &sMailNos, std::vector<size_t> &indexes)
+   {
+      size_t count = snapshot->GetCount();
+
+      std::vector<String> sSplitted = StringParser::SplitString(sMailNos, ",");
 
+      for(String sCur : sSplitted)
+      {
+         long lColonPos = sCur.Find(_T(":"));
+
+         if (is_uid_)
+         {
             if (lColonPos >= 0)
             {
-               String sFirstPart = sCur.Mid(0, lColonPos);
-               String sSecondPart = sCur.Mid(lColonPos + 1);
-
-               unsigned int lStartDBID = _ttoi(sFirstPart);
+               unsigned int lStartDBID = _ttoi(sCur.Mid(0, lColonPos));
                unsigned int lEndDBID = -1;
+
+               String sSecondPart = sCur.Mid(lColonPos + 1);
                if (sSecondPart != _T("*"))
                   lEndDBID = _ttoi(sSecondPart);
 
-               std::vector<std::shared_ptr<Message>> messages = pConnection->GetCurrentFolder()->GetMessages()->GetCopy();
-
-               int index = 0;
-               for(std::shared_ptr<Message> pMessage: messages)
+               for (size_t index = snapshot->GetFirstIndexWithUID(lStartDBID); index < count; index++)
                {
-                  index++;
-                  unsigned int uid = pMessage->GetUID();
-
-                  if (uid >= lStartDBID)
-                  {
-                     if (lEndDBID == -1 || uid <= lEndDBID)
-                     {
-                        // UID doesn't fail just because the message is missing.
-                        // This is why we don't check the return value.
-                        IMAPResult result = DoAction(pConnection, index, pMessage, pArgument);
-                        if (result.GetResult() != IMAPResult::ResultOK)
-                        {
-                           return result;
-                        }
-                     }
-                  }
-               }
+                  unsigned int uid = snapshot->GetUID(index);
+
+                  if (uid > lEndDBID && snapshot->GetUIDsAscending())
+                     break;
 
+                  if (uid >= lStartDBID && uid <= lEndDBID)
+                     indexes.push_back(index);
+               }
             }
-            else 
+            else
             {
-               unsigned int uid = _ttoi(sCur);
-
-               unsigned int foundIndex = 0;
-               std::shared_ptr<Messages> messages = pConnection->GetCurrentFolder()->GetMessages();
-               std::shared_ptr<Message> message = messages->GetItemByUID(uid, foundIndex);
-               if (!message)
-                  continue;
-               
-               IMAPResult result = DoAction(pConnection, foundIndex, message, pArgument);
-               if (result.GetResult() != IMAPResult::ResultOK)
-               {
-                  return result;
-               }
+               size_t index = 0;
+               if (snapshot->FindUID(_ttoi(sCur), index))
+                  indexes.push_back(index);
             }
-         }            
-
-      }
-      else
-      {
-         for(String sCur: sSplitted)
+         }
+         else
          {
-            lColonPos = sCur.Find(_T(":"));
-
             if (lColonPos >= 0)
             {
-               String sFirstPart = sCur.Mid(0, lColonPos);
-               String sSecondPart = sCur.Mid(lColonPos + 1);
+               int lStartIndex = max(_ttoi(sCur.Mid(0, lColonPos)), 1);
+               int lEndIndex = (int) count;
 
-               int lStartIndex = _ttoi(sFirstPart);
-               int lEndIndex = -1;
+               String sSecondPart = sCur.Mid(lColonPos + 1);
                if (sSecondPart != _T("*"))
-                  lEndIndex = _ttoi(sSecondPart);
-
-               auto vecMessages = pConnection->GetCurrentFolder()->GetMessages()->GetCopy();
-               
-               int index = 0;
-               for(std::shared_ptr<Message> message : vecMessages)
-               {
-                  index++;
-
-                  if (index >= lStartIndex)
-                  {
-                     if (lEndIndex == -1 || index <= lEndIndex)
-                     {
-                        IMAPResult result = DoAction(pConnection, index, message, pArgument);
-                        if (result.GetResult() != IMAPResult::ResultOK)
-                        {
-                           return result;
-                        }
-                     }
-                  }
-               }
+                  lEndIndex = min(_ttoi(sSecondPart), (int) count);
 
+               for (int messageIndex = lStartIndex; messageIndex <= lEndIndex; messageIndex++)
+                  indexes.push_back(messageIndex - 1);
             }
-            else 
+            else
             {
                int messageIndex = _ttoi(sCur);
-               std::shared_ptr<Message> pMessage = pConnection->GetCurrentFolder()->GetMessages()->GetItem(messageIndex-1);
-
-               if (!pMessage)
-                  continue;
-
-               IMAPResult result = DoAction(pConnection, messageIndex, pMessage, pArgument);
-               if (result.GetResult() != IMAPResult::ResultOK)
-               {
-                  return result;
-               }
+               if (messageIndex >= 1 && messageIndex <= (int) count)
+                  indexes.push_back(messageIndex - 1);
             }
-         }   
-
+         }
       }
-
-      return IMAPResult();
-
    }
 
 }
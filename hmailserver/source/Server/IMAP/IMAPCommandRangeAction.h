@@ -7,6 +7,8 @@
 
 namespace HM
 {
+   class FolderSnapshot;
+
    class IMAPCommandRangeAction : public IMAPCommand  
    {
    public:
@@ -16,11 +18,15 @@ namespace HM
       void SetIsUID(bool bIsUID);
       
       IMAPResult ExecuteCommand(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<IMAPCommandArgument> pArgument) {return IMAPResult();}
-      IMAPResult DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, const std::shared_ptr<IMAPCommandArgument> pArgument);
+      virtual IMAPResult DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, const std::shared_ptr<IMAPCommandArgument> pArgument);
 
    protected:
 
       bool GetIsUID();
+
+      void GetMessageIndexes_(std::shared_ptr<const FolderSnapshot> snapshot, const String &sMailNos, std::vector<size_t> &indexes);
+      // Resolves the sequence set to zero-based positions in the snapshot. UID ranges
+      // are located using binary search when the UIDs are ascending.
       virtual IMAPResult DoAction(std::shared_ptr<IMAPConnection> pConnection, int messageIndex, std::shared_ptr<Message> pMessage, const std::shared_ptr<IMAPCommandArgument> pArgument) = 0;
 
    private:
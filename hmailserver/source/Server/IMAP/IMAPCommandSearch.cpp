@@ -13,6 +13,7 @@
 #include "../Common/Persistence/PersistentMessage.h"
 #include "../Common/BO/Message.h"
 #include "../Common/BO/Messages.h"
+#include "../Common/BO/FolderSnapshot.h"
 #include "../Common/BO/MessageData.h"
 #include "../Common/Mime/Mime.h"
 #include "../Common/Util/Time.h"
@@ -83,49 +84,57 @@ namespace HM
       if (!pCurFolder)
          return IMAPResult(IMAPResult::ResultBad, "No selected folder");
 
-      std::vector<std::shared_ptr<Message>> messages = pCurFolder->GetMessages()->GetCopy();
-
       std::vector<String> sMatchingVec;
-      if (messages.size() > 0)
+
+      if (!is_sort_ && !GetCriteriaNeedsMessage_(pParser->GetCriteria()))
+      {
+         SearchSnapshot_(pConnection, pCurFolder->GetMessages()->GetSnapshot(), pParser->GetCriteria(), sMatchingVec);
+      }
+      else
       {
-         // Iterate through the messages and see which ones match.
-         std::vector<std::pair<int, std::shared_ptr<Message> > > vecMatchingMessages;
+         std::vector<std::shared_ptr<Message>> messages = pCurFolder->GetMessages()->GetCopy();
 
-         int index = 0;
-         for(std::shared_ptr<Message> pMessage : messages)
+         if (messages.size() > 0)
          {
-            const String fileName = PersistentMessage::GetFileName(pConnection->GetAccount(), pMessage);
+            // Iterate through the messages and see which ones match.
+            std::vector<std::pair<int, std::shared_ptr<Message> > > vecMatchingMessages;
 
-            index++;
-            if (pMessage && DoesMessageMatch_(pConnection, pParser->GetCriteria(), fileName, pMessage, index))
+            int index = 0;
+            for(std::shared_ptr<Message> pMessage : messages)
             {
-               // Yup we got a match.
-               vecMatchingMessages.push_back(make_pair(index, pMessage));
+               const String fileName = PersistentMessage::GetFileName(pConnection->GetAccount(), pMessage);
+
+               index++;
+               if (pMessage && DoesMessageMatch_(pConnection, pParser->GetCriteria(), fileName, pMessage, index))
+               {
+                  // Yup we got a match.
+                  vecMatchingMessages.push_back(make_pair(index, pMessage));
+               }
             }
-         }
 
-         if (is_sort_)
-         {
-            IMAPSort oSorter;
-            oSorter.Sort(pConnection, vecMatchingMessages, pParser->GetCharsetName(), pParser->GetSortParser());
-            // Sort the message vector
-         }
+            if (is_sort_)
+            {
+               IMAPSort oSorter;
+               oSorter.Sort(pConnection, vecMatchingMessages, pParser->GetCharsetName(), pParser->GetSortParser());
+               // Sort the message vector
+            }
 
-         typedef std::pair<int, std::shared_ptr<Message> > MessagePair;
-         for(MessagePair messagePair : vecMatchingMessages)
-         {
-            int index = messagePair.first;
-            std::shared_ptr<Message> pMessage = messagePair.second;
+            typedef std::pair<int, std::shared_ptr<Message> > MessagePair;
+            for(MessagePair messagePair : vecMatchingMessages)
+            {
+               int index = messagePair.first;
+               std::shared_ptr<Message> pMessage = messagePair.second;
 
-            String sID;
-            if (is_uid_)
-               sID.Format(_T("%u"), pMessage->GetUID());
-            else
-               sID.Format(_T("%d"), index);
+               String sID;
+               if (is_uid_)
+                  sID.Format(_T("%u"), pMessage->GetUID());
+               else
+                  sID.Format(_T("%d"), index);
 
-            sMatchingVec.push_back(sID);
-         }
+               sMatchingVec.push_back(sID);
+            }
 
+         }
       }
 
       // Send response
@@ -152,6 +161,80 @@ namespace HM
       return IMAPResult();
    }
 
+   bool
+   IMAPCommandSEARCH::GetCriteriaNeedsMessage_(std::shared_ptr<IMAPSearchCriteria> pParentCriteria)
+   {
+      for (std::shared_ptr<IMAPSearchCriteria> pCriteria : pParentCriteria->GetSubCriterias())
+      {
+         switch (pCriteria->GetType())
+         {
+         case IMAPSearchCriteria::CTSubCriteria:
+            if (GetCriteriaNeedsMessage_(pCriteria))
+               return true;
+            break;
+         case IMAPSearchCriteria::CTAll:
+         case IMAPSearchCriteria::CTUID:
+         case IMAPSearchCriteria::CTSequenceSet:
+         case IMAPSearchCriteria::CTSeen:
+         case IMAPSearchCriteria::CTUnseen:
+         case IMAPSearchCriteria::CTDeleted:
+         case IMAPSearchCriteria::CTUndeleted:
+         case IMAPSearchCriteria::CTAnswered:
+         case IMAPSearchCriteria::CTUnanswered:
+         case IMAPSearchCriteria::CTDraft:
+         case IMAPSearchCriteria::CTUndraft:
+         case IMAPSearchCriteria::CTFlagged:
+         case IMAPSearchCriteria::CTUnflagged:
+         case IMAPSearchCriteria::CTRecent:
+         case IMAPSearchCriteria::CTNew:
+         case IMAPSearchCriteria::CTOld:
+         case IMAPSearchCriteria::CTLarger:
+         case IMAPSearchCriteria::CTSmaller:
+         case IMAPSearchCriteria::CTOn:
+         case IMAPSearchCriteria::CTSince:
+         case IMAPSearchCriteria::CTBefore:
+         case IMAPSearchCriteria::CTCharset:
+            break;
+         default:
+            // Headers, body text and sent dates are read from the message file.
+            return true;
+         }
+      }
+
+      return false;
+   }
+
+   void
+   IMAPCommandSEARCH::SearchSnapshot_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<const FolderSnapshot> snapshot, std::shared_ptr<IMAPSearchCriteria> pCriteria, std::vector<String> &sMatchingVec)
+   {
+      // The criteria only looks at values which are stored in the snapshot, so a single
+      // message is filled in with the values of each row instead of copying the folder.
+      std::shared_ptr<Message> pRow = std::shared_ptr<Message>(new Message(false));
+
+      size_t count = snapshot->GetCount();
+      for (size_t i = 0; i < count; i++)
+      {
+         pRow->SetID(snapshot->GetMessageID(i));
+         pRow->SetUID(snapshot->GetUID(i));
+         pRow->SetFlags(snapshot->GetFlags(i));
+         pRow->SetSize(snapshot->GetSize(i));
+         pRow->SetCreateTime(snapshot->GetCreateTime(i));
+
+         int index = (int) i + 1;
+
+         if (!DoesMessageMatch_(pConnection, pCriteria, "", pRow, index))
+            continue;
+
+         String sID;
+         if (is_uid_)
+            sID.Format(_T("%u"), snapshot->GetUID(i));
+         else
+            sID.Format(_T("%d"), index);
+
+         sMatchingVec.push_back(sID);
+      }
+   }
+
    bool
    IMAPCommandSEARCH::DoesMessageMatch_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<IMAPSearchCriteria> pParentCriteria, const String &fileName, std::shared_ptr<Message> pMessage, int index)
    {
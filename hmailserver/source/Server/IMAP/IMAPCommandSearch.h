@@ -13,6 +13,7 @@ namespace HM
    class IMAPConnection;
    class MessageData;
    class MimeHeader;
+   class FolderSnapshot;
 
    class IMAPCommandSEARCH : public IMAPCommand
    {
@@ -44,6 +45,9 @@ namespace HM
       String GetHeaderValue_(const String &fileName, std::shared_ptr<Message> pMessage, const String &sHeaderField);
       
       
+      static bool GetCriteriaNeedsMessage_(std::shared_ptr<IMAPSearchCriteria> pParentCriteria);
+      void SearchSnapshot_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<const FolderSnapshot> snapshot, std::shared_ptr<IMAPSearchCriteria> pCriteria, std::vector<String> &sMatchingVec);
+
       bool DoesMessageMatch_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<IMAPSearchCriteria> pParentCriteria, const String &fileName, std::shared_ptr<Message> pMessage, int index);
       bool IsMessageRecent_(std::shared_ptr<IMAPConnection> pConnection, __int64 message_uid);
 
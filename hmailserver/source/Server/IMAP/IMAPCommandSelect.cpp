@@ -7,11 +7,13 @@
 #include "IMAPSimpleCommandParser.h"
 #include "IMAPConfiguration.h"
 #include "MessagesContainer.h"
+#include "IMAPCondStore.h"
 
 #include "../Common/BO/ACLPermission.h"
 #include "../Common/BO/IMAPFolders.h"
 #include "../Common/BO/IMAPFolder.h"
 #include "../Common/BO/Message.h"
+#include "../Common/BO/FolderSnapshot.h"
 
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
@@ -50,6 +52,19 @@ namespace HM
       if (!readAccess)
          return IMAPResult(IMAPResult::ResultBad, "ACL: Read permission denied (Required for SELECT command).");
 
+      // SELECT and EXAMINE may be given (CONDSTORE) or (QRESYNC (...)) after the folder name.
+      IMAPCondStore::SelectParameters selectParameters;
+      if (pParser->ParamCount() >= 2 && pParser->Word(2)->Paranthezied())
+      {
+         if (!IMAPCondStore::ParseSelectParameters(pParser->Word(2)->Value(), selectParameters))
+            return IMAPResult(IMAPResult::ResultBad, "SELECT Invalid select parameters.");
+
+         if (selectParameters.qresync_ && !pConnection->GetQResyncEnabled())
+            return IMAPResult(IMAPResult::ResultBad, "SELECT QRESYNC has not been enabled.");
+
+         pConnection->SetCondStoreEnabled();
+      }
+
       pConnection->SetCurrentFolder(pSelectedFolder, false);
 
       std::set<__int64> recent_messages;
@@ -57,8 +72,11 @@ namespace HM
 
       pConnection->SetRecentMessages(recent_messages);
 
-      long lCount = messages->GetCount();
-      __int64 lFirstUnseenID = messages->GetFirstUnseenUID();
+      // Count and first unseen are read from the same snapshot, so they're consistent.
+      std::shared_ptr<const FolderSnapshot> snapshot = messages->GetSnapshot();
+
+      long lCount = (long) snapshot->GetCount();
+      __int64 lFirstUnseenID = snapshot->GetFirstUnseenUID();
       long lRecentCount = (int) recent_messages.size();
 
       String sRespTemp;
@@ -85,6 +103,8 @@ namespace HM
 
       sResponse += _T("* OK [PERMANENTFLAGS (\\Deleted \\Seen \\Draft \\Answered \\Flagged)] limited\r\n");
 
+      sResponse += IMAPCondStore::GetSelectResponse(pSelectedFolder, snapshot, selectParameters);
+
       if (writeAccess)
          sResponse += pArgument->Tag() + _T(" OK [READ-WRITE] SELECT completed\r\n");
       else
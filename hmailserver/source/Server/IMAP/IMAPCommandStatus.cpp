@@ -8,6 +8,8 @@
 #include "IMAPSimpleCommandParser.h"
 #include "../Common/BO/IMAPFolders.h"
 #include "../Common/BO/Message.h"
+#include "../Common/BO/Messages.h"
+#include "../Common/BO/FolderSnapshot.h"
 #include "../Common/BO/ACLPermission.h"
 #include "../Common/BO/IMAPFolder.h"
 #include "../Common/BO/ACLPermission.h"
@@ -49,7 +51,7 @@ namespace HM
       if (!pConnection->CheckPermission(pTheFolder, ACLPermission::PermissionRead))
          return IMAPResult(IMAPResult::ResultBad, "ACL: Read permission denied.");
 
-      std::shared_ptr<Messages> pMessages = pTheFolder->GetMessages();
+      std::shared_ptr<const FolderSnapshot> snapshot = pTheFolder->GetMessages()->GetSnapshot();
       
       String sResponse = "";
 
@@ -61,7 +63,7 @@ namespace HM
       if (sFlags.FindNoCase(_T("MESSAGES")) >= 0)
       {
          String sTemp;
-         sTemp.Format(_T("MESSAGES %d"), pMessages->GetCount());
+         sTemp.Format(_T("MESSAGES %d"), (long) snapshot->GetCount());
          
          if (bAddSpace)
             sResponse += " ";
@@ -75,8 +77,8 @@ namespace HM
       if (sFlags.FindNoCase(_T("UNSEEN")) >= 0)
       {
          String sTemp;
-         long lMsgCount = pMessages->GetCount();
-         long lSeen = pMessages->GetNoOfSeen();
+         long lMsgCount = (long) snapshot->GetCount();
+         long lSeen = snapshot->GetNoOfSeen();
          long lUnseen = lMsgCount - lSeen;
          sTemp.Format(_T("UNSEEN %d"), lUnseen);
 
@@ -130,6 +132,21 @@ namespace HM
          sResponse +=sTemp;
       }
 
+      if (sFlags.FindNoCase(_T("HIGHESTMODSEQ")) >= 0)
+      {
+         String sTemp;
+         sTemp.Format(_T("HIGHESTMODSEQ %I64d"), pTheFolder->GetHighestModSeq());
+
+         if (bAddSpace)
+            sResponse += " ";
+         else
+            bAddSpace = true;
+
+         sResponse +=sTemp;
+
+         pConnection->SetCondStoreEnabled();
+      }
+
 
       sResponse+= ")\r\n";
 
@@ -52,7 +52,13 @@ namespace HM
 
       IMAPResult result = pStore->DoForMails(pConnection, sMailNo, pArgument);
 
-      if (result.GetResult() == IMAPResult::ResultOK)
+      if (result.GetResult() != IMAPResult::ResultOK)
+         return result;
+
+      String sModified = pStore->GetModifiedSet();
+      if (!sModified.IsEmpty())
+         pConnection->SendAsciiData(pArgument->Tag() + " OK [MODIFIED " + sModified + "] Conditional STORE failed\r\n");
+      else
          pConnection->SendAsciiData(pArgument->Tag() + " OK STORE completed\r\n");
 
       return result;
@@ -124,7 +124,16 @@ namespace HM
       // of the command is correct. If we fail now, we should return NO. 
       IMAPResult result = command_->DoForMails(pConnection, sMailNo, pArgument);
 
-      if (result.GetResult() == IMAPResult::ResultOK)
+      if (result.GetResult() != IMAPResult::ResultOK)
+         return result;
+
+      // A UID STORE with UNCHANGEDSINCE reports the messages it did not change.
+      std::shared_ptr<IMAPStore> pStore = std::dynamic_pointer_cast<IMAPStore>(command_);
+      String sModified = pStore ? pStore->GetModifiedSet() : String(_T(""));
+
+      if (!sModified.IsEmpty())
+         pConnection->SendAsciiData(pArgument->Tag() + " OK [MODIFIED " + sModified + "] Conditional STORE failed\r\n");
+      else
          pConnection->SendAsciiData(pArgument->Tag() + " OK UID completed\r\n");
 
       return result;
@@ -0,0 +1,225 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+#include "IMAPCondStore.h"
+#include "IMAPFetch.h"
+
+#include "../Common/BO/IMAPFolder.h"
+#include "../Common/BO/FolderSnapshot.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   IMAPCondStore::SelectParameters::SelectParameters() :
+      condstore_(false),
+      qresync_(false),
+      uid_validity_(0),
+      modseq_(0)
+   {
+
+   }
+
+   bool
+   IMAPCondStore::ParseSelectParameters(const String &parameters, SelectParameters &result)
+   {
+      String sParameters = parameters;
+      sParameters.Trim();
+
+      if (sParameters.CompareNoCase(_T("CONDSTORE")) == 0)
+      {
+         result.condstore_ = true;
+         return true;
+      }
+
+      if (sParameters.Left(7).CompareNoCase(_T("QRESYNC")) != 0)
+         return false;
+
+      int iStart = sParameters.Find(_T("("));
+      int iEnd = sParameters.ReverseFind(')');
+
+      if (iStart < 0 || iEnd < iStart)
+         return false;
+
+      String sValues = sParameters.Mid(iStart + 1, iEnd - iStart - 1);
+
+      // The optional sequence match data is not needed, since the UIDs are compared directly.
+      int iSequenceMatchData = sValues.Find(_T("("));
+      if (iSequenceMatchData >= 0)
+         sValues = sValues.Left(iSequenceMatchData);
+
+      std::vector<String> vecValues;
+      for (String sValue : StringParser::SplitString(sValues, " "))
+      {
+         if (!sValue.IsEmpty())
+            vecValues.push_back(sValue);
+      }
+
+      if (vecValues.size() < 2 ||
+          !StringParser::IsNumeric(vecValues[0]) ||
+          !StringParser::IsNumeric(vecValues[1]))
+         return false;
+
+      result.condstore_ = true;
+      result.qresync_ = true;
+      result.uid_validity_ = (unsigned int) _ttoi64(vecValues[0]);
+      result.modseq_ = _ttoi64(vecValues[1]);
+
+      if (vecValues.size() > 2)
+      {
+         if (!StringParser::ValidateString(vecValues[2], "01234567890,:*"))
+            return false;
+
+         result.known_uids_ = vecValues[2];
+      }
+
+      return true;
+   }
+
+   String
+   IMAPCondStore::GetSelectResponse(std::shared_ptr<IMAPFolder> folder, std::shared_ptr<const FolderSnapshot> snapshot, const SelectParameters &parameters)
+   {
+      String sResponse;
+      sResponse.Format(_T("* OK [HIGHESTMODSEQ %I64d] highest mod-sequence\r\n"), folder->GetHighestModSeq());
+
+      // If the folder has been re-created, the client has to start over.
+      if (!parameters.qresync_ || parameters.uid_validity_ != folder->GetCreationTime().ToInt())
+         return sResponse;
+
+      String sKnownUIDs = parameters.known_uids_.IsEmpty() ? _T("1:*") : parameters.known_uids_;
+      String sVanished = GetVanishedUIDs(snapshot, sKnownUIDs, folder->GetCurrentUID());
+
+      if (!sVanished.IsEmpty())
+         sResponse += "* VANISHED (EARLIER) " + sVanished + "\r\n";
+
+      size_t count = snapshot->GetCount();
+      for (size_t index = 0; index < count; index++)
+      {
+         if (snapshot->GetModSeq(index) <= parameters.modseq_)
+            continue;
+
+         String sLine;
+         sLine.Format(_T("* %d FETCH (UID %u FLAGS (%s) MODSEQ (%I64d))\r\n"),
+            (int) index + 1, snapshot->GetUID(index), IMAPFetch::GetFlagList(snapshot->GetFlags(index)).c_str(), snapshot->GetModSeq(index));
+
+         sResponse += sLine;
+      }
+
+      return sResponse;
+   }
+
+   String
+   IMAPCondStore::GetVanishedUIDs(std::shared_ptr<const FolderSnapshot> snapshot, const String &uidSet, unsigned int lastUID)
+   {
+      std::vector<std::pair<unsigned int, unsigned int> > vanished;
+
+      for (String sRange : StringParser::SplitString(uidSet, ","))
+      {
+         int iColonPos = sRange.Find(_T(":"));
+
+         String sFirst = iColonPos >= 0 ? sRange.Mid(0, iColonPos) : sRange;
+         String sLast = iColonPos >= 0 ? sRange.Mid(iColonPos + 1) : sRange;
+
+         unsigned int first = sFirst == _T("*") ? lastUID : (unsigned int) _ttoi64(sFirst);
+         unsigned int last = sLast == _T("*") ? lastUID : (unsigned int) _ttoi64(sLast);
+
+         if (first > last)
+            std::swap(first, last);
+
+         // UIDs above the last one assigned have never been used.
+         first = max(first, (unsigned int) 1);
+         last = min(last, lastUID);
+
+         if (first > last)
+            continue;
+
+         std::vector<unsigned int> existing;
+         GetUIDsInRange_(snapshot, first, last, existing);
+
+         unsigned int next = first;
+         for (unsigned int uid : existing)
+         {
+            if (uid > next)
+               vanished.push_back(std::make_pair(next, uid - 1));
+
+            next = uid + 1;
+         }
+
+         if (next <= last)
+            vanished.push_back(std::make_pair(next, last));
+      }
+
+      return FormatRanges_(vanished);
+   }
+
+   void
+   IMAPCondStore::GetUIDsInRange_(std::shared_ptr<const FolderSnapshot> snapshot, unsigned int first, unsigned int last, std::vector<unsigned int> &uids)
+   {
+      size_t count = snapshot->GetCount();
+
+      for (size_t index = snapshot->GetFirstIndexWithUID(first); index < count; index++)
+      {
+         unsigned int uid = snapshot->GetUID(index);
+
+         if (uid > last && snapshot->GetUIDsAscending())
+            break;
+
+         if (uid >= first && uid <= last)
+            uids.push_back(uid);
+      }
+
+      if (!snapshot->GetUIDsAscending())
+         std::sort(uids.begin(), uids.end());
+   }
+
+   String
+   IMAPCondStore::FormatUIDSet(std::vector<unsigned int> uids)
+   {
+      std::sort(uids.begin(), uids.end());
+
+      std::vector<std::pair<unsigned int, unsigned int> > ranges;
+
+      for (unsigned int uid : uids)
+      {
+         if (!ranges.empty() && ranges.back().second + 1 >= uid)
+            ranges.back().second = max(ranges.back().second, uid);
+         else
+            ranges.push_back(std::make_pair(uid, uid));
+      }
+
+      return FormatRanges_(ranges);
+   }
+
+   String
+   IMAPCondStore::FormatRanges_(std::vector<std::pair<unsigned int, unsigned int> > &ranges)
+   {
+      std::sort(ranges.begin(), ranges.end());
+
+      String sResult;
+
+      size_t i = 0;
+      while (i < ranges.size())
+      {
+         unsigned int first = ranges[i].first;
+         unsigned int last = ranges[i].second;
+
+         // Merge ranges which overlap or follow each other.
+         for (i++; i < ranges.size() && ranges[i].first <= last + 1; i++)
+            last = max(last, ranges[i].second);
+
+         if (!sResult.IsEmpty())
+            sResult += ",";
+
+         if (first == last)
+            sResult.AppendFormat(_T("%u"), first);
+         else
+            sResult.AppendFormat(_T("%u:%u"), first, last);
+      }
+
+      return sResult;
+   }
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   class IMAPFolder;
+   class FolderSnapshot;
+
+   // Helpers for the CONDSTORE and QRESYNC extensions (RFC 7162). Expunged messages
+   // are not recorded anywhere, so VANISHED responses are built from the UIDs which
+   // are missing from the folder snapshot.
+   class IMAPCondStore
+   {
+   public:
+
+      class SelectParameters
+      {
+      public:
+         SelectParameters();
+
+         bool condstore_;
+         bool qresync_;
+
+         unsigned int uid_validity_;
+         __int64 modseq_;
+         String known_uids_;
+      };
+
+      static bool ParseSelectParameters(const String &parameters, SelectParameters &result);
+      // Parses (CONDSTORE) or (QRESYNC (uidvalidity modseq [known-uids])) given to SELECT or EXAMINE.
+
+      static String GetSelectResponse(std::shared_ptr<IMAPFolder> folder, std::shared_ptr<const FolderSnapshot> snapshot, const SelectParameters &parameters);
+      // Returns HIGHESTMODSEQ and, if the client is resynchronizing, the messages
+      // which have vanished or changed since the given modification sequence.
+
+      static String GetVanishedUIDs(std::shared_ptr<const FolderSnapshot> snapshot, const String &uidSet, unsigned int lastUID);
+      // Returns the UIDs in uidSet which are not in the snapshot, as a UID set.
+
+      static String FormatUIDSet(std::vector<unsigned int> uids);
+
+   private:
+
+      static String FormatRanges_(std::vector<std::pair<unsigned int, unsigned int> > &ranges);
+      static void GetUIDsInRange_(std::shared_ptr<const FolderSnapshot> snapshot, unsigned int first, unsigned int last, std::vector<unsigned int> &uids);
+   };
+}
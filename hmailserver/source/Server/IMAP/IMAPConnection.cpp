@@ -56,6 +56,8 @@ namespace HM
       literal_data_to_receive_(0),
       pending_disconnect_(false),
       current_folder_read_only_(false),
+      condstore_enabled_(false),
+      qresync_enabled_(false),
       log_level_(0)
    {
       imap_folders_.reset();
@@ -564,6 +566,8 @@ namespace HM
          return IMAP_LISTRIGHTS;
       else if (sCommand == _T("STARTTLS"))
          return IMAP_STARTTLS;
+      else if (sCommand == _T("ENABLE"))
+         return IMAP_ENABLE;
 
       return IMAP_UNKNOWN;
    }
@@ -644,6 +648,10 @@ namespace HM
       }
       
       bool postReceive = false;
+
+      // Send the untagged responses and the tagged result together, instead of
+      // one write per response line.
+      WriteCork cork(shared_from_this());
       
       // Report updates on the current folder.
       if (current_folder_)
@@ -78,7 +78,8 @@ namespace HM
          IMAP_SETACL = 132,
          IMAP_DELETEACL = 133,
          IMAP_LISTRIGHTS = 134,
-         IMAP_STARTTLS = 135
+         IMAP_STARTTLS = 135,
+         IMAP_ENABLE = 136
       };
 
       void ParseData(const AnsiString &Request);
@@ -123,6 +124,13 @@ namespace HM
 
       void SetRecentMessages(const std::set<__int64> &messages);
       std::set<__int64>& GetRecentMessages();
+
+      // CONDSTORE is enabled by ENABLE, or by the first command which uses it. QRESYNC
+      // can only be enabled by ENABLE, and implies CONDSTORE.
+      bool GetCondStoreEnabled() const { return condstore_enabled_; }
+      void SetCondStoreEnabled() { condstore_enabled_ = true; }
+      bool GetQResyncEnabled() const { return qresync_enabled_; }
+      void SetQResyncEnabled() { qresync_enabled_ = true; condstore_enabled_ = true; }
    protected:
 
       virtual void OnConnected();
@@ -168,6 +176,9 @@ namespace HM
       std::shared_ptr<IMAPFolder> current_folder_;
       bool current_folder_read_only_;
 
+      bool condstore_enabled_;
+      bool qresync_enabled_;
+
       String command_buffer_;
       bool is_idling_;
 
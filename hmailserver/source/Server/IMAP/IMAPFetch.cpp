@@ -5,15 +5,21 @@
 #include "IMAPFetch.h"
 #include "IMAPFetchParser.h"
 #include "IMAPConnection.h"
+#include "MimeStructureContainer.h"
+#include "IMAPCondStore.h"
 
 #include "../Common/Application/FolderManager.h"
 #include "../Common/BO/IMAPFolder.h"
 #include "../Common/BO/Message.h"
+#include "../Common/BO/Messages.h"
+#include "../Common/BO/FolderSnapshot.h"
 #include "../Common/Util/Charset.h"
 #include "../Common/Mime/MimeCode.h"
+#include "../Common/Mime/MessagePartMap.h"
 #include "../Common/Util/Time.h"
 #include "../Common/Util/Parsing/AddressListParser.h"
 #include "../Common/Util/ByteBuffer.h"
+#include "../Common/Util/File.h"
 #include "../Common/BO/ACLPermission.h"
 
 #include "../Common/Persistence/PersistentMessage.h"
@@ -38,48 +44,158 @@ namespace HM
    }
 
    IMAPResult
-   IMAPFetch::DoAction(std::shared_ptr<IMAPConnection> pConnection, int messageIndex, std::shared_ptr<Message> pMessage, const std::shared_ptr<IMAPCommandArgument> pArgument)
+   IMAPFetch::ParseCommand_(const std::shared_ptr<IMAPCommandArgument> pArgument)
    {
-      if (!pArgument || !pMessage)
+      if (parser_)
+         return IMAPResult();
+
+      parser_ = std::shared_ptr<IMAPFetchParser>(new IMAPFetchParser());
+      String sTemp = pArgument->Command();
+      return parser_->ParseCommand(sTemp);
+   }
+
+   bool
+   IMAPFetch::GetCanUseSnapshot_()
+   {
+      // The snapshot only contains what's stored in the database. Anything which
+      // requires the message file, or changes the message, goes through DoAction.
+      return !parser_->GetShowEnvelope() &&
+             !parser_->GetShowBodyStructure() &&
+             !parser_->GetShowBodyStructureNonExtensible() &&
+             parser_->GetPartsToLookAt().size() == 0 &&
+             !parser_->GetSetSeenFlag();
+   }
+
+   IMAPResult
+   IMAPFetch::DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, const std::shared_ptr<IMAPCommandArgument> pArgument)
+   {
+      if (!pArgument)
          return IMAPResult(IMAPResult::ResultBad, "Invalid parameters");
 
-      const String messageFileName = PersistentMessage::GetFileName(pConnection->GetAccount(), pMessage);
+      IMAPResult result = ParseCommand_(pArgument);
+      if (result.GetResult() != IMAPResult::ResultOK)
+         return result;
 
-      append_space_ = false;
+      // A client which asks for mod-sequences has enabled CONDSTORE.
+      if (parser_->GetShowModSeq())
+         pConnection->SetCondStoreEnabled();
 
-      // Parse the command
-      if (!parser_)
+      std::shared_ptr<const FolderSnapshot> snapshot = pConnection->GetCurrentFolder()->GetMessages()->GetSnapshot();
+
+      if (parser_->GetVanished())
       {
-         parser_ = std::shared_ptr<IMAPFetchParser>(new IMAPFetchParser());
-         String sTemp = pArgument->Command();
-         parser_->ParseCommand(sTemp);
+         result = SendVanished_(pConnection, snapshot, sMailNos);
+         if (result.GetResult() != IMAPResult::ResultOK)
+            return result;
       }
 
-      // If we're going to touch the file, make sure it's there.
-      bool willReadMessageFile =
-         parser_->GetShowEnvelope() ||
-         parser_->GetShowBodyStructure() ||
-         parser_->GetShowBodyStructureNonExtensible()||
-         parser_->GetPartsToLookAt().size() > 0;
-
-      if (willReadMessageFile)
+      if (!GetCanUseSnapshot_())
       {
-         // Ensure that the data file exists.
-         PersistentMessage::EnsureFileExistance(pConnection->GetAccount(), pMessage);
+         seen_flags_.clear();
+
+         result = IMAPCommandRangeAction::DoForMails(pConnection, sMailNos, pArgument);
+
+         if (!seen_flags_.empty())
+         {
+            // All messages get the same mod-sequence.
+            __int64 modSeq = 0;
+            Application::Instance()->GetFolderManager()->UpdateMessageFlags(
+               (int) pConnection->GetCurrentFolder()->GetAccountID(), 
+               (int) pConnection->GetCurrentFolder()->GetID(),
+               seen_flags_, modSeq);
+
+            seen_flags_.clear();
+         }
+
+         return result;
       }
 
-      MimeHeader oMimeHeader;
+      std::vector<size_t> indexes;
+      GetMessageIndexes_(snapshot, sMailNos, indexes);
 
-      // Time to output this...
       String sOutput;
-   
-      sOutput.Format(_T("* %d FETCH ("), messageIndex);
+      __int64 changedSince = parser_->GetChangedSince();
+
+      for (size_t index : indexes)
+      {
+         if (changedSince > 0 && snapshot->GetModSeq(index) <= changedSince)
+            continue;
+
+         String sLine;
+         sLine.Format(_T("* %d FETCH ("), (int) index + 1);
+
+         append_space_ = false;
+         AppendMessageAttributes_(sLine, snapshot->GetUID(index), snapshot->GetSize(index), snapshot->GetFlags(index), snapshot->GetCreateTime(index), snapshot->GetModSeq(index));
+
+         sLine += ")\r\n";
+         sOutput += sLine;
+
+         if (sOutput.GetLength() >= SnapshotResponseChunkSize)
+            SendAndReset_(pConnection, sOutput);
+      }
+
+      if (!sOutput.IsEmpty())
+         SendAndReset_(pConnection, sOutput);
+
+      return IMAPResult();
+   }
+
+   IMAPResult
+   IMAPFetch::SendVanished_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<const FolderSnapshot> snapshot, const String &sMailNos)
+   {
+      if (!GetIsUID() || !pConnection->GetQResyncEnabled())
+         return IMAPResult(IMAPResult::ResultBad, "VANISHED requires UID FETCH and QRESYNC.");
+
+      // Expunged messages are not recorded, so all UIDs in the range which are
+      // no longer in the folder are reported, no matter when they were expunged.
+      String sVanished = IMAPCondStore::GetVanishedUIDs(snapshot, sMailNos, pConnection->GetCurrentFolder()->GetCurrentUID());
+
+      if (!sVanished.IsEmpty())
+         pConnection->SendAsciiData("* VANISHED (EARLIER) " + sVanished + "\r\n");
+
+      return IMAPResult();
+   }
+
+   String
+   IMAPFetch::GetFlagList(short flags)
+   {
+      std::set<String> setFlags;
+
+      if (flags & Message::FlagSeen)
+         setFlags.insert("Seen");
+      if (flags & Message::FlagDeleted)
+         setFlags.insert("Deleted");
+      if (flags & Message::FlagFlagged)
+         setFlags.insert("Flagged");
+      if (flags & Message::FlagDraft)
+         setFlags.insert("Draft");
+      if (flags & Message::FlagAnswered)
+         setFlags.insert("Answered");
+
+      String sResult;
+
+      auto iter = setFlags.begin();
+      auto iterEnd = setFlags.end();
 
+      for (; iter != iterEnd; iter++)
+      {
+         if (iter != setFlags.begin())
+            sResult += " ";
+
+         sResult += "\\" + (*iter);
+      }
+
+      return sResult;
+   }
+
+   void
+   IMAPFetch::AppendMessageAttributes_(String &sOutput, unsigned int uid, int size, short flags, const String &createTime, __int64 modSeq)
+   {
       // We should always show UID when client is issuing UID fetch..
       if (parser_->GetShowUID() || GetIsUID()) 
       {
          String sUIDTag;
-         sUIDTag.Format(_T("UID %u"), pMessage->GetUID());
+         sUIDTag.Format(_T("UID %u"), uid);
          
          AppendOutput_(sOutput, sUIDTag);
       }
@@ -87,40 +203,14 @@ namespace HM
       if (parser_->GetShowRFCSize())
       {
          String sTemp;
-         sTemp.Format(_T("RFC822.SIZE %d"), pMessage->GetSize());
+         sTemp.Format(_T("RFC822.SIZE %d"), size);
 
          AppendOutput_(sOutput, sTemp);
       }
 
       if (parser_->GetShowFlags())
       {
-         String sTemp = "FLAGS (";
-
-         std::set<String> setFlags;
-         
-         if (pMessage->GetFlagSeen())
-            setFlags.insert("Seen");
-         if (pMessage->GetFlagDeleted())
-            setFlags.insert("Deleted");
-         if (pMessage->GetFlagFlagged())
-            setFlags.insert("Flagged");
-         if (pMessage->GetFlagDraft())
-            setFlags.insert("Draft");
-         if (pMessage->GetFlagAnswered())
-            setFlags.insert("Answered");
-            
-         auto iter = setFlags.begin();
-         auto iterEnd = setFlags.end();
-
-         for (; iter != iterEnd; iter++)
-         {
-            if (iter != setFlags.begin())
-               sTemp += " ";
-
-            sTemp += "\\" + (*iter);
-         }
-
-         sTemp += ")";
+         String sTemp = "FLAGS (" + GetFlagList(flags) + ")";
 
          AppendOutput_(sOutput, sTemp);
       }
@@ -130,7 +220,7 @@ namespace HM
       {
          String sTemp = "INTERNALDATE \"";
 
-         String sCreateTime = pMessage->GetCreateTime();
+         String sCreateTime = createTime;
          
          if (!Time::SeemsToBeValidYear(sCreateTime))
             sCreateTime = Time::GetCurrentDateTime();
@@ -142,46 +232,141 @@ namespace HM
          AppendOutput_(sOutput, sTemp);
       }
 
+      if (parser_->GetShowModSeq())
+      {
+         String sTemp;
+         sTemp.Format(_T("MODSEQ (%I64d)"), modSeq);
+
+         AppendOutput_(sOutput, sTemp);
+      }
+   }
+
+   IMAPResult
+   IMAPFetch::DoAction(std::shared_ptr<IMAPConnection> pConnection, int messageIndex, std::shared_ptr<Message> pMessage, const std::shared_ptr<IMAPCommandArgument> pArgument)
+   {
+      if (!pArgument || !pMessage)
+         return IMAPResult(IMAPResult::ResultBad, "Invalid parameters");
+
+      const String messageFileName = PersistentMessage::GetFileName(pConnection->GetAccount(), pMessage);
+
+      append_space_ = false;
+
+      // Parse the command
+      ParseCommand_(pArgument);
+
+      if (parser_->GetChangedSince() > 0 && pMessage->GetModSeq() <= parser_->GetChangedSince())
+         return IMAPResult();
+
+      // If we're going to touch the file, make sure it's there.
+      bool willReadMessageFile =
+         parser_->GetShowEnvelope() ||
+         parser_->GetShowBodyStructure() ||
+         parser_->GetShowBodyStructureNonExtensible()||
+         parser_->GetPartsToLookAt().size() > 0;
+
+      if (willReadMessageFile)
+      {
+         // Ensure that the data file exists.
+         PersistentMessage::EnsureFileExistance(pConnection->GetAccount(), pMessage);
+      }
+
+      MimeHeader oMimeHeader;
+
+      // Time to output this...
+      String sOutput;
+   
+      sOutput.Format(_T("* %d FETCH ("), messageIndex);
+
+      AppendMessageAttributes_(sOutput, pMessage->GetUID(), pMessage->GetSize(), pMessage->GetFlags(), pMessage->GetCreateTime(), pMessage->GetModSeq());
+
       
+      // The structures of a message are cached, keyed on the message and the size and
+      // last write time of its file.
+      long fileSize = willReadMessageFile ? FileUtilities::FileSize(messageFileName) : 0;
+      __int64 fileTime = willReadMessageFile ? FileUtilities::LastWriteTime(messageFileName) : 0;
+
       AnsiString sMessageHeader;
 
       if (parser_->GetShowEnvelope())
       {
-         // Parse the MIME header
-         if (sMessageHeader.IsEmpty())
+         String sEnvelope;
+
+         if (!MimeStructureContainer::Instance()->GetEnvelope(pMessage->GetID(), fileSize, fileTime, sEnvelope))
          {
-            sMessageHeader = PersistentMessage::LoadHeader(messageFileName);
+            // Parse the MIME header
+            if (sMessageHeader.IsEmpty())
+            {
+               sMessageHeader = PersistentMessage::LoadHeader(messageFileName);
+
+               oMimeHeader.Load(sMessageHeader, sMessageHeader.length());
+            }
 
-            oMimeHeader.Load(sMessageHeader, sMessageHeader.length());
+            sEnvelope = CreateEnvelopeStructure_(oMimeHeader);
+            MimeStructureContainer::Instance()->SetEnvelope(pMessage->GetID(), fileSize, fileTime, sEnvelope);
          }
 
          String sTemp;
-         sTemp = "ENVELOPE " + CreateEnvelopeStructure_(oMimeHeader);
+         sTemp = "ENVELOPE " + sEnvelope;
          AppendOutput_(sOutput, sTemp);
          
       }
 
+      bool bShowBodyStructure = parser_->GetShowBodyStructure() || parser_->GetShowBodyStructureNonExtensible();
+      bool bIncludeExtensionData = parser_->GetShowBodyStructure();
+
+      String sBodyStructure;
+      bool bBodyStructureCached = bShowBodyStructure &&
+         MimeStructureContainer::Instance()->GetBodyStructure(pMessage->GetID(), fileSize, fileTime, bIncludeExtensionData, sBodyStructure);
+
+      // Parts which are stored as-is in the message file are read directly from
+      // the file, so that a partial fetch only reads the requested bytes.
+      std::vector<IMAPFetchParser::BodyPart> vecPartsToPeekAt = parser_->GetPartsToLookAt();
+      std::vector<std::pair<int, int> > vecFileParts;
+      std::shared_ptr<const MessagePartMap> pPartMap;
+
+      bool bMimeBodyNeeded = bShowBodyStructure && !bBodyStructureCached;
+
+      for (IMAPFetchParser::BodyPart oPart : vecPartsToPeekAt)
+      {
+         int iFileStart = 0;
+         int iFileLength = 0;
+
+         if (!GetFilePart_(pMessage, messageFileName, fileSize, fileTime, oPart, pPartMap, iFileStart, iFileLength))
+         {
+            iFileStart = -1;
+            bMimeBodyNeeded = true;
+         }
 
+         vecFileParts.push_back(std::make_pair(iFileStart, iFileLength));
+      }
 
       // Sometimes we need to load the entire mail into memory.
       // If the user want's to download a specific attachment or
       // if he wants to look at the structure of the mime message.
-      std::shared_ptr<MimeBody> pMimeBody = LoadMimeBody_(parser_, messageFileName);
+      std::shared_ptr<MimeBody> pMimeBody;
       
-      if (parser_->GetShowBodyStructure() ||
-          parser_->GetShowBodyStructureNonExtensible())
+      if (bMimeBodyNeeded)
+         pMimeBody = LoadMimeBody_(parser_, messageFileName);
+      
+      if (bShowBodyStructure)
       {
+         if (!bBodyStructureCached)
+         {
+            sBodyStructure = IteratePartRecursive_(pMimeBody, bIncludeExtensionData, 0);
+
+            if (pMimeBody)
+               MimeStructureContainer::Instance()->SetBodyStructure(pMessage->GetID(), fileSize, fileTime, bIncludeExtensionData, sBodyStructure);
+         }
+
          String sResult = "";
-         if (parser_->GetShowBodyStructure())
-            sResult = "BODYSTRUCTURE " + IteratePartRecursive_(pMimeBody, true, 0);
+         if (bIncludeExtensionData)
+            sResult = "BODYSTRUCTURE " + sBodyStructure;
          else
-            sResult = "BODY " + IteratePartRecursive_(pMimeBody, false, 0);
+            sResult = "BODY " + sBodyStructure;
 
          AppendOutput_(sOutput, sResult);
       }
 
-      std::vector<IMAPFetchParser::BodyPart> vecPartsToPeekAt = parser_->GetPartsToLookAt();
-      
       if (vecPartsToPeekAt.size() > 0)
       {
          auto iter = vecPartsToPeekAt.begin();
@@ -194,8 +379,13 @@ namespace HM
             int iOctetStart = oPart.octet_start_;
             int iOctetCount = oPart.octet_count_;
            
-            const String messageFileName = PersistentMessage::GetFileName(pConnection->GetAccount(), pMessage);
-            std::shared_ptr<ByteBuffer> pBuffer = GetByteBufferByBodyPart_(messageFileName, pMimeBody, oPart);
+            const std::pair<int, int> &filePart = vecFileParts[iter - vecPartsToPeekAt.begin()];
+
+            std::shared_ptr<ByteBuffer> pBuffer;
+            if (filePart.first >= 0)
+               pBuffer = ReadFilePart_(messageFileName, oPart, filePart.first, filePart.second);
+            else
+               pBuffer = GetByteBufferByBodyPart_(messageFileName, pMimeBody, oPart);
             
             String sPartIdentifier;
             if (iOctetStart == -1 && iOctetCount == -1)
@@ -236,13 +426,11 @@ namespace HM
          // Since the user has looked at the email, we should set the Seen flag.
          if (bMayChangeSeen && !pMessage->GetFlagSeen())
          {  
-            // Update seen flag in the cached copy of the message...
+            // Update seen flag in the copy of the message. The cached message and
+            // the database are updated when all messages have been fetched.
             pMessage->SetFlagSeen(true);
 
-            Application::Instance()->GetFolderManager()->UpdateMessageFlags(
-               (int) pConnection->GetCurrentFolder()->GetAccountID(), 
-               (int) pConnection->GetCurrentFolder()->GetID(),
-               pMessage->GetID(), pMessage->GetFlags());
+            seen_flags_[pMessage->GetID()] = pMessage->GetFlags();
          }
       }
 
@@ -283,6 +471,90 @@ namespace HM
       iOutCount = iOctetCount;
    }
 
+   bool
+   IMAPFetch::GetFilePart_(std::shared_ptr<Message> pMessage, const String &messageFileName, long fileSize, __int64 fileTime, IMAPFetchParser::BodyPart &oPart, std::shared_ptr<const MessagePartMap> &pPartMap, int &iOutStart, int &iOutLength)
+   //---------------------------------------------------------------------------()
+   // DESCRIPTION:
+   // Checks whether the content of a part is a range of the message file, which
+   // is the case for the entire message, its text and leaf parts which are not
+   // encoded. Other parts have to be loaded into a MimeBody.
+   //---------------------------------------------------------------------------()
+   {
+      if (oPart.GetShowBodyFull() && oPart.GetName().IsEmpty())
+      {
+         iOutStart = 0;
+         iOutLength = fileSize;
+         return true;
+      }
+
+      if (!oPart.GetShowBodyText() ||
+          oPart.GetShowBodyHeader() ||
+          oPart.GetShowBodyHeaderFields() ||
+          oPart.GetShowBodyHeaderFieldsNOT())
+      {
+         return false;
+      }
+
+      if (!pPartMap)
+      {
+         pPartMap = MimeStructureContainer::Instance()->GetPartMap(pMessage->GetID(), fileSize, fileTime, messageFileName);
+
+         if (!pPartMap)
+            return false;
+      }
+
+      AnsiString sName = oPart.GetName();
+
+      MessagePartMap::Part filePart;
+      if (!pPartMap->GetPart(sName, filePart))
+         return false;
+
+      if (!sName.IsEmpty() && (filePart.multipart_ || filePart.encapsulated_ || !filePart.identity_encoding_))
+         return false;
+
+      // The file is read using 32-bit positions.
+      if (filePart.body_end_ > INT_MAX)
+         return false;
+
+      iOutStart = (int) filePart.body_start_;
+      iOutLength = (int) (filePart.body_end_ - filePart.body_start_);
+      return true;
+   }
+
+   std::shared_ptr<ByteBuffer>
+   IMAPFetch::ReadFilePart_(const String &messageFileName, IMAPFetchParser::BodyPart &oPart, int iFileStart, int iFileLength)
+   //---------------------------------------------------------------------------()
+   // DESCRIPTION:
+   // Reads the requested window of a part from the message file.
+   //---------------------------------------------------------------------------()
+   {
+      int iByteStart = 0;
+      int iByteCount = 0;
+
+      GetBytesToSend_(iFileLength, oPart, iByteStart, iByteCount);
+
+      if (iByteCount <= 0)
+      {
+         // The window is outside the part.
+         return std::shared_ptr<ByteBuffer>(new ByteBuffer);
+      }
+
+      try
+      {
+         File file;
+         file.Open(messageFileName, File::OTReadOnly);
+         file.SetPosition(iFileStart + iByteStart);
+
+         return file.ReadChunk(iByteCount);
+      }
+      catch (...)
+      {
+         ReportCriticalError_(messageFileName, "ERROR HM10002 - IMAP FETCH: Error when reading part from message file.");
+      }
+
+      return std::shared_ptr<ByteBuffer>(new ByteBuffer);
+   }
+
    std::shared_ptr<MimeBody> 
    IMAPFetch::GetBodyPartByRecursiveIdentifier_(std::shared_ptr<MimeBody> pBody, const String &sName)
    //---------------------------------------------------------------------------()
@@ -14,6 +14,7 @@ namespace HM
    class Message;
    class ByteBuffer; 
    class IMAPFetchParser;
+   class MessagePartMap;
    
 
    class IMAPFetch : public IMAPCommandRangeAction
@@ -22,10 +23,24 @@ namespace HM
 	   IMAPFetch();
 	   virtual ~IMAPFetch();
 
+      virtual IMAPResult DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, const std::shared_ptr<IMAPCommandArgument> pArgument);
       virtual IMAPResult DoAction(std::shared_ptr<IMAPConnection> pConnection, int messageIndex, std::shared_ptr<Message> pMessage, const std::shared_ptr<IMAPCommandArgument> pArgument);
 
+      static String GetFlagList(short flags);
+      // Returns the system flags, such as \Seen \Flagged, without parenthesis.
       
    private:
+
+      enum Settings
+      {
+         // Responses built from the folder snapshot are sent in chunks of about this many characters.
+         SnapshotResponseChunkSize = 64 * 1024
+      };
+
+      IMAPResult ParseCommand_(const std::shared_ptr<IMAPCommandArgument> pArgument);
+      bool GetCanUseSnapshot_();
+      void AppendMessageAttributes_(String &sOutput, unsigned int uid, int size, short flags, const String &createTime, __int64 modSeq);
+      IMAPResult SendVanished_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<const FolderSnapshot> snapshot, const String &sMailNos);
       
       String CreateEnvelopeStructure_(MimeHeader& oHeader);
       String GetPartStructure_(std::shared_ptr<MimeBody> oPart, bool includeExtensionData, int iRecursion);
@@ -33,6 +48,9 @@ namespace HM
       String CreateEmailStructure_(const String &sField);
       std::shared_ptr<MimeBody>GetMessagePartByPartNo_(std::shared_ptr<MimeBody>pBody, long iPartNo);
 
+      bool GetFilePart_(std::shared_ptr<Message> pMessage, const String &messageFileName, long fileSize, __int64 fileTime, IMAPFetchParser::BodyPart &oPart, std::shared_ptr<const MessagePartMap> &pPartMap, int &iOutStart, int &iOutLength);
+      std::shared_ptr<ByteBuffer> ReadFilePart_(const String &messageFileName, IMAPFetchParser::BodyPart &oPart, int iFileStart, int iFileLength);
+
       std::shared_ptr<ByteBuffer> GetByteBufferByBodyPart_(const String &messageFileName, std::shared_ptr<MimeBody> pBodyPart, IMAPFetchParser::BodyPart &oPart);
       std::shared_ptr<MimeBody> GetBodyPartByRecursiveIdentifier_(std::shared_ptr<MimeBody> pBody, const String &sName);
 
@@ -51,6 +69,10 @@ namespace HM
 
       std::shared_ptr<IMAPFetchParser> parser_;
 
+      // Messages which get the \Seen flag set implicitly. They are saved together
+      // when the command has been processed.
+      std::map<__int64, short> seen_flags_;
+
    };
 
 }
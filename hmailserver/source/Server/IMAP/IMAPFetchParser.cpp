@@ -33,6 +33,9 @@ namespace HM
       show_body_structure_ = false;
       set_seen_ = false;
       show_body_structure_NonExtensible = false;
+      show_modseq_ = false;
+      changed_since_ = 0;
+      vanished_ = false;
    }
 
    IMAPFetchParser::~IMAPFetchParser()
@@ -74,6 +77,76 @@ namespace HM
     
    }
 
+   IMAPResult
+   IMAPFetchParser::ParseModifiers_(String &sString)
+   {
+      // The modifiers are a parenthesized list following the fetch items, as in
+      // 1:* (FLAGS) (VANISHED CHANGEDSINCE 12345). Find the start of the last
+      // parenthesized list which isn't inside a section specifier.
+      sString.TrimRight();
+      if (sString.Right(1) != _T(")"))
+         return IMAPResult();
+
+      int iDepth = 0;
+      int iModifiersStart = -1;
+      for (int i = sString.GetLength() - 1; i >= 0; i--)
+      {
+         wchar_t c = sString.GetAt(i);
+
+         if (c == ')' || c == ']')
+            iDepth++;
+         else if (c == '(' || c == '[')
+            iDepth--;
+
+         if (iDepth == 0)
+         {
+            iModifiersStart = i;
+            break;
+         }
+      }
+
+      // If nothing precedes the list, it's the list of fetch items.
+      if (iModifiersStart <= 0 || sString.GetAt(iModifiersStart) != '(')
+         return IMAPResult();
+
+      String sModifiers = sString.Mid(iModifiersStart);
+      sString = sString.Left(iModifiersStart);
+      sString.TrimRight();
+
+      CleanFetchString_(sModifiers);
+
+      bool bChangedSince = false;
+
+      std::vector<String> vecModifiers = StringParser::SplitString(sModifiers, " ");
+      for (size_t i = 0; i < vecModifiers.size(); i++)
+      {
+         String sModifier = vecModifiers[i];
+
+         if (sModifier.CompareNoCase(_T("CHANGEDSINCE")) == 0 && i + 1 < vecModifiers.size())
+         {
+            String sModSeq = vecModifiers[++i];
+            if (!StringParser::IsNumeric(sModSeq))
+               return IMAPResult(IMAPResult::ResultBad, "CHANGEDSINCE requires a mod-sequence.");
+
+            changed_since_ = _ttoi64(sModSeq);
+            bChangedSince = true;
+         }
+         else if (sModifier.CompareNoCase(_T("VANISHED")) == 0)
+            vanished_ = true;
+         else if (!sModifier.IsEmpty())
+            return IMAPResult(IMAPResult::ResultBad, "Unknown fetch modifier.");
+      }
+
+      if (vanished_ && !bChangedSince)
+         return IMAPResult(IMAPResult::ResultBad, "VANISHED requires CHANGEDSINCE.");
+
+      // Messages returned because of CHANGEDSINCE always include the MODSEQ.
+      if (bChangedSince)
+         show_modseq_ = true;
+
+      return IMAPResult();
+   }
+
    std::vector<String>
    IMAPFetchParser::ParseString_(String &sString)
    {
@@ -144,6 +217,10 @@ namespace HM
       IMAPResult result = ValidateSyntax_(sStringToParse);
       if (result.GetResult() != IMAPResult::ResultOK)
          return result;
+
+      result = ParseModifiers_(sStringToParse);
+      if (result.GetResult() != IMAPResult::ResultOK)
+         return result;
       
       std::vector<String> vecResult = ParseString_(sStringToParse);
       auto iter = vecResult.begin();
@@ -205,6 +282,12 @@ namespace HM
                break;
             }
 
+            case MODSEQ:
+            {
+               show_modseq_ = true;
+               break;
+            }
+
             case BODY:
             {
                IMAPFetchParser::BodyPart oPart = ParseBODY_(sPart);
@@ -482,6 +565,9 @@ namespace HM
       if (sPart.CompareNoCase(_T("RFC822.TEXT")) == 0)
          return RFC822TEXT;  
 
+      if (sPart.CompareNoCase(_T("MODSEQ")) == 0)
+         return MODSEQ;
+
       return PARTUNKNOWN;
    }
 
@@ -29,7 +29,8 @@ namespace HM
          FULL = 212,
          RFC822HEADER = 213,
          RFC822TEXT = 214,
-         BODYSTRUCTURENONEXTENSIBLE = 215
+         BODYSTRUCTURENONEXTENSIBLE = 215,
+         MODSEQ = 216
             
       };
 
@@ -96,6 +97,11 @@ namespace HM
       
       bool GetShowBodyStructure() { return show_body_structure_; }
       bool GetShowBodyStructureNonExtensible() { return show_body_structure_NonExtensible; }
+      bool GetShowModSeq() { return show_modseq_; }
+
+      // The CHANGEDSINCE and VANISHED fetch modifiers (RFC 7162).
+      __int64 GetChangedSince() { return changed_since_; }
+      bool GetVanished() { return vanished_; }
       
 
       bool GetSetSeenFlag() { return set_seen_; }
@@ -110,6 +116,7 @@ namespace HM
       void CleanFetchString_(String &sString);
       std::vector<String> ParseString_(String &sString);
       IMAPResult ValidateSyntax_(const String &sString);
+      IMAPResult ParseModifiers_(String &sString);
       
       // Additional parsing of commands that create more complex 
       // structure than just single words.
@@ -123,8 +130,12 @@ namespace HM
       bool show_internal_date_;
       bool show_body_structure_;
       bool show_body_structure_NonExtensible;
+      bool show_modseq_;
 
       bool set_seen_;
+
+      __int64 changed_since_;
+      bool vanished_;
       
       std::vector<BodyPart> parts_to_look_at_;
    };
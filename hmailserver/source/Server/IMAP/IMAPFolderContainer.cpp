@@ -128,17 +128,28 @@ namespace HM
    void
    IMAPFolderContainer::UpdateCurrentUID(__int64 accountID, __int64 folderID, unsigned int currentUID)
    {
-      if (accountID == 0)
-      {
-         std::shared_ptr<IMAPFolder> folder = GetPublicFolders()->GetItemByDBIDRecursive(folderID);
-         if (!folder)
-         {
-            assert(0);
-            return;
-         }
-
+      std::shared_ptr<IMAPFolder> folder = GetCachedFolder_(accountID, folderID);
+      if (folder)
          folder->SetCurrentUID(currentUID);
+   }
 
+   void
+   IMAPFolderContainer::UpdateHighestModSeq(__int64 accountID, __int64 folderID, __int64 highestModSeq)
+   {
+      std::shared_ptr<IMAPFolder> folder = GetCachedFolder_(accountID, folderID);
+      if (folder)
+         folder->SetHighestModSeq(highestModSeq);
+   }
+
+   std::shared_ptr<IMAPFolder>
+   IMAPFolderContainer::GetCachedFolder_(__int64 accountID, __int64 folderID)
+   {
+      std::shared_ptr<IMAPFolder> folder;
+
+      if (accountID == 0)
+      {
+         folder = GetPublicFolders()->GetItemByDBIDRecursive(folderID);
+         assert(folder);
       }
       else
       {
@@ -146,19 +157,15 @@ namespace HM
 
          auto iter = folders_.find(accountID);
 
+         // The folders of the account aren't cached.
          if (iter == folders_.end())
-            return;
-
-         std::shared_ptr<IMAPFolder> folder = (*iter).second->GetItemByDBIDRecursive(folderID);
-         if (!folder)
-         {
-            assert(0);
-            return;
-         }
+            return folder;
 
-         folder->SetCurrentUID(currentUID);;
+         folder = (*iter).second->GetItemByDBIDRecursive(folderID);
+         assert(folder);
       }
 
+      return folder;
    }
 
 
@@ -23,6 +23,7 @@ namespace HM
       void UncacheAccount(__int64 iAccountID);
 
       void UpdateCurrentUID(__int64 accountID, __int64 folderID, unsigned int currentUID);
+      void UpdateHighestModSeq(__int64 accountID, __int64 folderID, __int64 highestModSeq);
 
       bool Clear();
 
@@ -32,6 +33,8 @@ namespace HM
 
    private:
 
+      std::shared_ptr<IMAPFolder> GetCachedFolder_(__int64 accountID, __int64 folderID);
+
       std::map<__int64, std::shared_ptr<IMAPFolders> > folders_;
       
       static boost::recursive_mutex fetch_list_mutex_;
@@ -6,6 +6,7 @@
 #include "IMAPNotificationClient.h"
 #include "IMAPConnection.h"
 #include "IMAPStore.h"
+#include "IMAPCondStore.h"
 
 #include "../Common/Tracking/ChangeNotification.h"
 #include "../common/Tracking/NotificationServer.h"
@@ -26,7 +27,8 @@ namespace HM
       message_change_subscription_id_(0),
       folder_list_change_subscription_id_(0),
       account_id_(0),
-      folder_id_(0)
+      folder_id_(0),
+      flush_scheduled_(false)
    {
 
    }
@@ -101,20 +103,65 @@ namespace HM
       if (!parentConnection)
          return;
 
+      CacheChangeNotification_(notification);
+
+      // A burst of changes, such as many messages being delivered to a shared folder,
+      // is sent to an idling client as a single update once the burst is over.
       if (parentConnection->GetIsIdling())
+         ScheduleFlush_(parentConnection);
+   }
+
+   void
+   IMAPNotificationClient::ScheduleFlush_(std::shared_ptr<IMAPConnection> connection)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+
+      if (flush_scheduled_)
+         return;
+
+      if (!flush_timer_)
+         flush_timer_ = std::shared_ptr<boost::asio::deadline_timer>(new boost::asio::deadline_timer(connection->GetSocket().get_io_service()));
+
+      flush_scheduled_ = true;
+
+      std::weak_ptr<IMAPNotificationClient> weakSelf = shared_from_this();
+
+      flush_timer_->expires_from_now(boost::posix_time::milliseconds(CoalesceMilliseconds));
+      flush_timer_->async_wait([weakSelf](const boost::system::error_code &error)
       {
-         try
-         {
-            SendChangeNotification_(notification);
-         }
-         catch (DisconnectedException&)
-         {
-            // We were unable to send the notifications to the client, because he has disconnected.
-            // This is normal behavior, and not an error we want to log.
-         }
+         std::shared_ptr<IMAPNotificationClient> self = weakSelf.lock();
+         if (self)
+            self->OnFlushTimer_(error);
+      });
+   }
+
+   void
+   IMAPNotificationClient::OnFlushTimer_(const boost::system::error_code &error)
+   {
+      boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+
+      flush_scheduled_ = false;
+
+      if (error)
+         return;
+
+      std::shared_ptr<IMAPConnection> parentConnection = parent_connection_.lock();
+
+      // If the client has left IDLE, the changes are sent after its next command instead.
+      if (!parentConnection || !parentConnection->GetIsIdling())
+         return;
+
+      try
+      {
+         WriteCork cork(parentConnection);
+
+         SendCachedNotifications(true);
+      }
+      catch (DisconnectedException&)
+      {
+         // We were unable to send the notifications to the client, because he has disconnected.
+         // This is normal behavior, and not an error we want to log.
       }
-      else
-         CacheChangeNotification_(notification);
    }
 
    //---------------------------------------------------------------------------()
@@ -164,7 +211,7 @@ namespace HM
                if (send_expunge)
                {
                   // Send EXPUNGE
-                  SendEXPUNGE_(changeNotification->GetAffectedMessages());
+                  SendEXPUNGE_(changeNotification);
 
                   // Send EXISTS
                   std::shared_ptr<Messages> pMessages = connection->GetCurrentFolder()->GetMessages();
@@ -195,7 +242,7 @@ namespace HM
          SendEXISTS_(lastExists);
 
       if (lastRecent >= 0)
-         SendRECENT_(lastExists);
+         SendRECENT_(lastRecent);
 
       std::vector<std::shared_ptr<ChangeNotification> >::iterator iter = cached_changes_.begin();
       
@@ -218,60 +265,22 @@ namespace HM
    }
 
    void 
-   IMAPNotificationClient::SendChangeNotification_(std::shared_ptr<ChangeNotification> pChangeNotification)
+   IMAPNotificationClient::SendEXPUNGE_(std::shared_ptr<ChangeNotification> pChangeNotification)
    {
       std::shared_ptr<IMAPConnection> connection = parent_connection_.lock();
       if (!connection)
          return;
 
-      switch (pChangeNotification->GetType())
-      {
-      case ChangeNotification::NotificationMessageAdded:
-         {
-               std::shared_ptr<Messages> pMessages = connection->GetCurrentFolder()->GetMessages();
-            SendEXISTS_(pMessages->GetCount());
-            SendRECENT_((int)connection->GetRecentMessages().size());
-            break;
-         }
-      case ChangeNotification::NotificationMessageDeleted:
-         {
-            // Send EXPUNGE
-            SendEXPUNGE_(pChangeNotification->GetAffectedMessages());
-
-            // Send EXISTS
-               std::shared_ptr<Messages> pMessages = connection->GetCurrentFolder()->GetMessages();
-            SendEXISTS_(pMessages->GetCount());
-            SendRECENT_((int)connection->GetRecentMessages().size());
-
-            break;
-         }
-      case ChangeNotification::NotificationMessageFlagsChanged:
-         {
-            // Send flag notification
-            std::set<__int64> affectedMessages;
-               for(__int64 messageID : pChangeNotification->GetAffectedMessages())
-            {
-               affectedMessages.insert(messageID);
-            }
-           
-            SendFLAGS_(affectedMessages);
-
-            break;
-         }
-      }
-   }
-
-   void 
-
-   IMAPNotificationClient::SendEXPUNGE_(const std::vector<__int64> & vecMessages)
-   {
-      std::shared_ptr<IMAPConnection> connection = parent_connection_.lock();
-      if (!connection)
-         return;
+      const std::vector<unsigned int> &vecUIDs = pChangeNotification->GetAffectedUIDs();
 
       String sResponse;
-      for(__int64 messageIndex : vecMessages)
-         sResponse.AppendFormat(_T("* %I64d EXPUNGE\r\n"), messageIndex);
+      if (connection->GetQResyncEnabled() && !vecUIDs.empty())
+         sResponse = "* VANISHED " + IMAPCondStore::FormatUIDSet(vecUIDs) + "\r\n";
+      else
+      {
+         for(__int64 messageIndex : pChangeNotification->GetAffectedMessages())
+            sResponse.AppendFormat(_T("* %I64d EXPUNGE\r\n"), messageIndex);
+      }
 
       connection->SendAsciiData(sResponse);
 
@@ -294,7 +303,8 @@ namespace HM
          if (!pMessage)
             return;
 
-         connection->SendAsciiData(IMAPStore::GetMessageFlags(pMessage, foundIndex));
+         __int64 modSeq = connection->GetCondStoreEnabled() ? pMessage->GetModSeq() : 0;
+         connection->SendAsciiData(IMAPStore::GetMessageFlags(pMessage, foundIndex, modSeq));
       }
 
 
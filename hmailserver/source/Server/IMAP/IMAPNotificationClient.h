@@ -32,16 +32,26 @@ namespace HM
 
    private:
 
+      enum Settings
+      {
+         // Changes arriving within this time are sent to an idling client as one update.
+         CoalesceMilliseconds = 50
+      };
+
       void CacheChangeNotification_(std::shared_ptr<ChangeNotification> pChangeNotification);
-      void SendChangeNotification_(std::shared_ptr<ChangeNotification> pChangeNotification);
+      void ScheduleFlush_(std::shared_ptr<IMAPConnection> connection);
+      void OnFlushTimer_(const boost::system::error_code &error);
 
       void SendEXISTS_(int iExists);
       void SendRECENT_(int recent);
-      void SendEXPUNGE_(const std::vector<__int64> & vecMessages);
+      void SendEXPUNGE_(std::shared_ptr<ChangeNotification> pChangeNotification);
       void SendFLAGS_(const std::set<__int64> & vecMessages);
 
       boost::recursive_mutex mutex_;
       std::vector<std::shared_ptr<ChangeNotification> > cached_changes_;
+
+      std::shared_ptr<boost::asio::deadline_timer> flush_timer_;
+      bool flush_scheduled_;
       
       std::weak_ptr<IMAPConnection> parent_connection_;
 
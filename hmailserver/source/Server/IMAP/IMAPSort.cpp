@@ -14,6 +14,7 @@
 #include "..\Common\Util\Time.h"
 #include "..\Common\Util\VariantDateTime.h"
 #include "../Common/Persistence/PersistentMessage.h"
+#include "../Common/Util/Parsing/AddresslistParser.h"
 
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
@@ -22,6 +23,62 @@
 
 namespace HM
 {
+   // Orders sort records on the precomputed keys, criterion by criterion. The
+   // keys of a message are stored consecutively, one per sort criterion.
+   class IMAPSort::SortRecordComparer
+   {
+   public:
+      SortRecordComparer(const std::vector<SortKey> &keys, const std::vector<SortCriterion> &criteria) :
+         keys_(keys),
+         criteria_(criteria)
+      {
+
+      }
+
+      //Return true if r1 < r2; otherwise, return false.
+      bool operator()(const SortRecord &r1, const SortRecord &r2) const
+      {
+         size_t criteriaCount = criteria_.size();
+
+         const SortKey *keys1 = &keys_[r1.message_index_ * criteriaCount];
+         const SortKey *keys2 = &keys_[r2.message_index_ * criteriaCount];
+
+         for (size_t i = 0; i < criteriaCount; i++)
+         {
+            int compareResult = 0;
+
+            switch (criteria_[i].field_)
+            {
+            case Date:
+            case Arrival:
+            case Size:
+               if (keys1[i].numeric_ < keys2[i].numeric_)
+                  compareResult = -1;
+               else if (keys1[i].numeric_ > keys2[i].numeric_)
+                  compareResult = 1;
+               break;
+            default:
+               compareResult = keys1[i].collation_.compare(keys2[i].collation_);
+               break;
+            }
+
+            if (compareResult != 0)
+               return criteria_[i].ascending_ ? compareResult < 0 : compareResult > 0;
+         }
+
+         // RFC 5256: Messages which are equal according to all the sort criteria
+         // are returned in the order they appear in the mailbox, also when REVERSE
+         // is used. This also makes the order total, so an unstable sort gives the
+         // same result as a stable one.
+         return r1.sequence_ < r2.sequence_;
+      }
+
+   private:
+
+      const std::vector<SortKey> &keys_;
+      const std::vector<SortCriterion> &criteria_;
+   };
+
    IMAPSort::IMAPSort(void) 
    {
    }
@@ -29,208 +86,455 @@ namespace HM
    IMAPSort::~IMAPSort(void)
    {
    }
- 
-   class IMAPSortSize {
-   public:
-      //Return true if s1 < s2; otherwise, return false.
-      bool operator()(const std::pair<int, std::shared_ptr<Message> > p1, const std::pair<int, std::shared_ptr<Message> >  p2)
-      {
-         return p1.second->GetSize() < p2.second->GetSize();
-      }
-   };   
 
-   class IMAPSortCachedDateTime {
-   public:
-      IMAPSortCachedDateTime(std::map<__int64, DateTime> &map) :
-         date_time_info_(map)
+   void 
+   IMAPSort::Sort(std::shared_ptr<IMAPConnection> pConnection, std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages, String character_set, std::shared_ptr<IMAPSortParser> pParser)
+   {
+      // Sort messages according to the sort criteria. The first criterion is the
+      // primary one, and the following are used to order messages which are equal
+      // according to the preceding ones.
+      std::vector<std::pair<bool,String> > vecSortTypes = pParser->GetSortTypes();
+
+      std::vector<SortCriterion> criteria;
+      for (std::pair<bool, String> sortType : vecSortTypes)
       {
+         SortField sortField = GetSortField_(sortType.second);
+         if (sortField == Unknown)
+            continue;
+
+         SortCriterion criterion;
+         criterion.field_ = sortField;
+         criterion.ascending_ = sortType.first;
+         criteria.push_back(criterion);
       }
 
-      //Return true if s1 < s2; otherwise, return false.
-      bool operator()(const std::pair<int, std::shared_ptr<Message> > p1, const std::pair<int, std::shared_ptr<Message> >  p2)
+      if (criteria.empty() || vecMessages.size() < 2)
+         return;
+
+      bool usAscii = character_set.CompareNoCase(_T("US-ASCII")) == 0;
+
+      // Compute the keys once per message rather than once per comparison.
+      std::vector<SortKey> keys;
+      CreateSortKeys_(pConnection, vecMessages, criteria, usAscii, keys);
+
+      std::vector<SortRecord> records;
+      records.reserve(vecMessages.size());
+
+      for (size_t i = 0; i < vecMessages.size(); i++)
       {
-         DateTime dt1 = date_time_info_[p1.second->GetID()];
-         DateTime dt2 = date_time_info_[p2.second->GetID()];
-         return (dt1 < dt2) == TRUE;
+         SortRecord record;
+         record.message_index_ = i;
+         record.sequence_ = vecMessages[i].first;
+         records.push_back(record);
       }
 
-   private:
-      std::map<__int64, DateTime> &date_time_info_;
-   };   
+      SortRecords_(records, SortRecordComparer(keys, criteria));
+
+      std::vector<std::pair<int, std::shared_ptr<Message> > > sortedMessages;
+      sortedMessages.reserve(vecMessages.size());
+
+      for (const SortRecord &record : records)
+         sortedMessages.push_back(vecMessages[record.message_index_]);
 
-   class IMAPSortHeaderField 
+      vecMessages.swap(sortedMessages);
+   }
+
+   void
+   IMAPSort::SortRecords_(std::vector<SortRecord> &records, const SortRecordComparer &comparer)
    {
-   public:
-      IMAPSortHeaderField(std::map<__int64, String> &mapHeaderFields, String character_set) :
-         _mapHeaderFields(mapHeaderFields),
-         character_set_(character_set)
+      size_t threadCount = 1;
+
+      if (records.size() >= (size_t) ParallelSortThreshold)
+         threadCount = min(boost::thread::hardware_concurrency(), (unsigned int) MaxSortThreads);
+
+      if (threadCount < 2)
       {
-         
+         std::sort(records.begin(), records.end(), comparer);
+         return;
       }
 
-      //Return true if s1 < s2; otherwise, return false.
-      bool operator()(const std::pair<int, std::shared_ptr<Message> > p1, const std::pair<int, std::shared_ptr<Message> >  p2)
+      // Sort one chunk per thread and merge the sorted chunks pairwise.
+      size_t chunkSize = (records.size() + threadCount - 1) / threadCount;
+
+      std::vector<size_t> bounds;
+      for (size_t i = 0; i < threadCount; i++)
+         bounds.push_back(min(i * chunkSize, records.size()));
+      bounds.push_back(records.size());
+
+      boost::thread_group threads;
+      for (size_t i = 0; i < threadCount; i++)
       {
-         String sHeader1 = _mapHeaderFields[p1.second->GetID()];
-         String sHeader2 = _mapHeaderFields[p2.second->GetID()];
-         
-         int compare_result = 0;
+         size_t chunkStart = bounds[i];
+         size_t chunkEnd = bounds[i + 1];
 
-         if (character_set_.CompareNoCase(_T("US-ASCII")) == 0)
+         threads.create_thread([&records, &comparer, chunkStart, chunkEnd]()
          {
-            AnsiString ansi_1 = sHeader1;
-            AnsiString ansi_2 = sHeader2;
+            std::sort(records.begin() + chunkStart, records.begin() + chunkEnd, comparer);
+         });
+      }
 
-            return ansi_1 < ansi_2;
-         }
-         else
+      threads.join_all();
+
+      for (size_t width = 1; width < threadCount; width *= 2)
+      {
+         for (size_t i = 0; i + width < threadCount; i += 2 * width)
          {
-            // Use UTF8 as default.
-            compare_result = CompareStringW(LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE, sHeader1, -1, sHeader2, -1);
+            size_t mergeEnd = bounds[min(i + 2 * width, threadCount)];
+
+            std::inplace_merge(records.begin() + bounds[i], records.begin() + bounds[i + width], records.begin() + mergeEnd, comparer);
          }
+      }
+   }
 
-         if (compare_result == 0)
-            ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5019, "IMAPSortHeaderField::operator()", "An error occurred while sorting. Check system locale settings.");
+   void
+   IMAPSort::CreateSortKeys_(std::shared_ptr<IMAPConnection> pConnection,
+                             const std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages,
+                             const std::vector<SortCriterion> &criteria,
+                             bool usAscii,
+                             std::vector<SortKey> &keys)
+   {
+      size_t criteriaCount = criteria.size();
 
-         if (compare_result == CSTR_LESS_THAN)
-            return true;
-         else
-            return false;  
+      keys.clear();
+      keys.resize(vecMessages.size() * criteriaCount);
+
+      // Header values which are available in the message index don't have to be
+      // read from the message files.
+      std::vector<std::map<__int64, String> > databaseMetaData(criteriaCount);
+
+      if (Configuration::Instance()->GetMessageIndexing())
+      {
+         int accountID = (int) vecMessages[0].second->GetAccountID();
+         int folderID = (int) vecMessages[0].second->GetFolderID();
+
+         PersistentMessageMetaData messageMetaData;
+
+         for (size_t i = 0; i < criteriaCount; i++)
+         {
+            String headerName = GetHeaderName_(criteria[i].field_);
+
+            if (!headerName.IsEmpty())
+               messageMetaData.GetMetaData(accountID, folderID, headerName, databaseMetaData[i]);
+         }
       }
-   private:
 
-      std::map<__int64, String> &_mapHeaderFields;
-      String character_set_;
-   };   
-  
+      for (size_t messageIndex = 0; messageIndex < vecMessages.size(); messageIndex++)
+      {
+         std::shared_ptr<Message> message = vecMessages[messageIndex].second;
 
+         // Loaded on first use, and then shared by all criteria.
+         std::shared_ptr<MimeHeader> header;
 
-   void 
-   IMAPSort::Sort(std::shared_ptr<IMAPConnection> pConnection, std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages, String character_set, std::shared_ptr<IMAPSortParser> pParser)
-   {
-      // Sort messages according to the sort criteria
+         for (size_t i = 0; i < criteriaCount; i++)
+         {
+            SortKey &key = keys[messageIndex * criteriaCount + i];
 
-      std::vector<std::pair<bool,String> > vecSortTypes = pParser->GetSortTypes();
+            switch (criteria[i].field_)
+            {
+            case Size:
+               key.numeric_ = (double) message->GetSize();
+               break;
+            case Arrival:
+               // We can't assume that the order in the database is the same as the
+               // arrival date. For example, if a message is copied from one folder
+               // to another, the message receives a higher db id, but the arrival 
+               // date is still the same.
+               key.numeric_ = Time::GetDateFromSystemDate(message->GetCreateTime()).dt_;
+               break;
+            case Date:
+               {
+                  String sentDate = GetHeaderFieldValue_(pConnection, message, Date, databaseMetaData[i], header);
+
+                  if (sentDate.IsEmpty())
+                  {
+                     /*
+                      * RFC 5256 "2.2. Sent Date" chapter. If the sent date cannot be determined (a Date: header is missing or cannot be parsed), 
+                      * the INTERNALDATE for that message is used as the sent date.
+                      */
+                     sentDate = message->GetCreateTime();
+                  }
+
+                  key.numeric_ = Time::GetDateFromSystemDate(sentDate).dt_;
+                  break;
+               }
+            case Subject:
+               key.collation_ = GetCollationKey_(GetBaseSubject(GetHeaderFieldValue_(pConnection, message, Subject, databaseMetaData[i], header)), usAscii);
+               break;
+            case From:
+            case To:
+            case CC:
+               key.collation_ = GetCollationKey_(GetAddressMailbox_(GetHeaderFieldValue_(pConnection, message, criteria[i].field_, databaseMetaData[i], header)), usAscii);
+               break;
+            default:
+               break;
+            }
+         }
+      }
+   }
 
-      auto iterSortType = vecSortTypes.begin();
-      // Skip to the last.
-      while (iterSortType + 1 != vecSortTypes.end())
-         iterSortType++;
+   String
+   IMAPSort::GetHeaderFieldValue_(std::shared_ptr<IMAPConnection> pConnection, 
+                                  std::shared_ptr<Message> message, 
+                                  SortField sortField, 
+                                  const std::map<__int64, String> &databaseMetaData, 
+                                  std::shared_ptr<MimeHeader> &header)
+   {
+      std::map<__int64, String >::const_iterator dbMetaIter = databaseMetaData.find(message->GetID());
+      if (dbMetaIter != databaseMetaData.end())
+         return (*dbMetaIter).second;
 
-      if (iterSortType != vecSortTypes.end())
+      if (!header)
       {
-         std::pair<bool,String> st = (*iterSortType);
+         // Read message and parse out the value from the header.
+         String fileName = PersistentMessage::GetFileName(pConnection->GetAccount(), message);
 
-         String sHeaderField = st.second;
-         SortField sortField = GetSortField_(sHeaderField);
+         AnsiString sHeader = PersistentMessage::LoadHeader(fileName);
 
-         PersistentMessageMetaData messageMetaData;
+         header = std::shared_ptr<MimeHeader>(new MimeHeader());
+         header->Load(sHeader, sHeader.GetLength());
+      }
 
-         std::map<__int64, String > databaseMetaData;
+      String sFieldValue = header->GetUnicodeFieldValue(GetHeaderName_(sortField));
 
-         bool loadDBCache =  
-            (sortField == From ||
-            sortField == Subject ||
-            sortField == To ||
-            sortField == CC ||
-            sortField == Date) && 
-            Configuration::Instance()->GetMessageIndexing();
+      if (sortField == Date)
+      {
+         DateTime dt = Time::GetDateTimeFromMimeHeader(sFieldValue);
+         sFieldValue = Time::GetTimeStampFromDateTime(dt);
+      }
+
+      return sFieldValue;
+   }
+
+   std::string
+   IMAPSort::GetCollationKey_(const String &value, bool usAscii)
+   {
+      if (!usAscii)
+      {
+         // Use UTF8 as default. The sort key is a byte string which compares
+         // the same way as CompareStringW would compare the source strings.
+         int keySize = LCMapStringW(LOCALE_SYSTEM_DEFAULT, LCMAP_SORTKEY | NORM_IGNORECASE, value.c_str(), -1, NULL, 0);
 
-         if (loadDBCache && vecMessages.size() > 0)
+         if (keySize > 0)
          {
-            int accountID = (int) vecMessages[0].second->GetAccountID();
-            int folderID = (int) vecMessages[0].second->GetFolderID();
+            std::vector<BYTE> sortKey(keySize);
 
-            messageMetaData.GetMetaData(accountID, folderID, sHeaderField, databaseMetaData);
+            if (LCMapStringW(LOCALE_SYSTEM_DEFAULT, LCMAP_SORTKEY | NORM_IGNORECASE, value.c_str(), -1, (LPWSTR) &sortKey[0], keySize) > 0)
+            {
+               // Drop the terminating zero.
+               return std::string((const char*) &sortKey[0], keySize - 1);
+            }
          }
 
-         std::map<__int64, String> mapHeaderFields;
-         
-         if (sortField == Subject ||
-             sortField == CC ||
-             sortField == From ||
-             sortField == To ||
-             sortField == Date)
+         ErrorManager::Instance()->ReportError(ErrorManager::Medium, 5019, "IMAPSort::GetCollationKey_", "An error occurred while sorting. Check system locale settings.");
+      }
+
+      // Convert the string to upper case. The sorting should be
+      // case insensitive. Otherwise b will come before A.
+      AnsiString upperCaseValue = value;
+      upperCaseValue.MakeUpper();
+
+      return upperCaseValue;
+   }
+
+   String
+   IMAPSort::GetAddressMailbox_(const String &addressList)
+   {
+      // RFC 5256: Sorting on an address header uses the mailbox part of the
+      // first address in the header.
+      String firstAddress = addressList;
+
+      bool insideQuote = false;
+      for (int i = 0; i < addressList.GetLength(); i++)
+      {
+         wchar_t c = addressList[i];
+
+         if (c == '\\')
+            i++;
+         else if (c == '"')
+            insideQuote = !insideQuote;
+         else if (c == ',' && !insideQuote)
          {
-            CacheHeaderFields_(pConnection, vecMessages, databaseMetaData, sortField, mapHeaderFields);
+            firstAddress = addressList.Left(i);
+            break;
          }
-         
-         if (sortField == Arrival) 
-         {
-            // The message are already sorted on arrival date, since we're doing
-            // a sort by messageid when we read the message list from the database.
-            // Hence no reason to resort ...
-            // Or may be not.
-            // We can't assume that the order in the database is the same as the
-            // arrival date. For example, if a message is copied from one folder
-            // to another, the message receives a higher db id, but the arrival 
-            // date is still the same.
-
-            // Cache dates for all messages.
-            std::map<__int64, DateTime> mapDateTimeInfo;
-            auto iterMessage = vecMessages.begin();
-            while (iterMessage != vecMessages.end())
-            {
-               // Fetch message.
-               std::shared_ptr<Message> p1 = (*iterMessage).second;
+      }
 
-               // Retrieve the message date and convert it to a DateTime.
-               DateTime dt1 = Time::GetDateFromSystemDate(p1->GetCreateTime());
+      firstAddress.Trim();
 
-               // Cache the date connected to the message.
-               mapDateTimeInfo[p1->GetID()] = dt1;
+      String fullName;
+      String mailbox;
+      String domain;
 
-               // Continue with the next message.
-               iterMessage++;
-            }
-         
-            std::sort(vecMessages.begin(), vecMessages.end(), IMAPSortCachedDateTime(mapDateTimeInfo));
+      AddresslistParser parser;
+      parser.ExtractParts(firstAddress, fullName, mailbox, domain);
 
-         }
-         else if (sortField == Size)
+      mailbox.Replace(_T("<"), _T(""));
+
+      if (!mailbox.IsEmpty())
+         return mailbox;
+
+      // Not an email address. Remove leading ". If we sort on From, "Test" 
+      // should come in same position as Test. (quotes / no quotes)
+      firstAddress.TrimLeft(_T("\""));
+      firstAddress.TrimLeft(_T("<"));
+
+      return firstAddress;
+   }
+
+   String
+   IMAPSort::GetBaseSubject(const String &subject)
+   {
+      // (1) Collapse all whitespace into single spaces. Encoded words have
+      // already been decoded when the header was parsed.
+      String baseSubject;
+      bool previousWasSpace = false;
+
+      for (int i = 0; i < subject.GetLength(); i++)
+      {
+         wchar_t c = subject[i];
+
+         if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
          {
-            std::sort(vecMessages.begin(), vecMessages.end(), IMAPSortSize());
+            if (!previousWasSpace)
+               baseSubject += _T(' ');
+
+            previousWasSpace = true;
          }
-         else if (sortField == Subject ||
-                  sortField == CC ||
-                  sortField == From ||
-                  sortField == To)
+         else
          {
-            std::sort(vecMessages.begin(), vecMessages.end(), IMAPSortHeaderField(mapHeaderFields, character_set));
+            baseSubject += c;
+            previousWasSpace = false;
          }
-         else if (sortField == Date)
+      }
+
+      baseSubject.Trim();
+
+      // Returns the position after a subj-blob ("[...]" and trailing space) starting
+      // at position, or -1 if there isn't one.
+      auto skipBlob = [](const String &text, int position) -> int
+      {
+         if (position >= text.GetLength() || text[position] != '[')
+            return -1;
+
+         for (int i = position + 1; i < text.GetLength(); i++)
          {
-            // Cache dates for all messages. This is faster than sorting the strings.
-            std::map<__int64, DateTime> mapDateTimeInfo;
-            auto iterMessage = vecMessages.begin();
-            
-            while (iterMessage != vecMessages.end())
+            if (text[i] == '[')
+               return -1;
+
+            if (text[i] == ']')
             {
-               // Fetch message.
-               std::shared_ptr<Message> p1 = (*iterMessage).second;
-               String headerValue = mapHeaderFields[p1->GetID()];
-               
-               DateTime dt1 = Time::GetDateFromSystemDate(headerValue);
+               i++;
 
-               // Cache the date connected to the message.
-               mapDateTimeInfo[p1->GetID()] = dt1;
+               while (i < text.GetLength() && text[i] == ' ')
+                  i++;
 
-               // Continue with the next message.
-               iterMessage++;
+               return i;
             }
+         }
+
+         return -1;
+      };
 
-            std::sort(vecMessages.begin(), vecMessages.end(), IMAPSortCachedDateTime(mapDateTimeInfo));
+      // Returns the position after a subj-refwd ("re:", "fw:", "fwd:", optionally with
+      // a subj-blob before the colon) starting at position, or -1 if there isn't one.
+      auto skipReplyOrForward = [&skipBlob](const String &text, int position) -> int
+      {
+         String rest = text.Mid(position);
+
+         int i = 0;
+         if (rest.Left(3).CompareNoCase(_T("fwd")) == 0)
+            i = 3;
+         else if (rest.Left(2).CompareNoCase(_T("fw")) == 0 || rest.Left(2).CompareNoCase(_T("re")) == 0)
+            i = 2;
+         else
+            return -1;
+
+         while (i < rest.GetLength() && rest[i] == ' ')
+            i++;
+
+         int afterBlob = skipBlob(rest, i);
+         if (afterBlob >= 0)
+            i = afterBlob;
+
+         if (i >= rest.GetLength() || rest[i] != ':')
+            return -1;
+
+         return position + i + 1;
+      };
+
+      for (;;)
+      {
+         // (2) Remove trailing "(fwd)" and whitespace.
+         for (;;)
+         {
+            baseSubject.TrimRight();
+
+            if (baseSubject.GetLength() < 5 || baseSubject.Right(5).CompareNoCase(_T("(fwd)")) != 0)
+               break;
+
+            baseSubject = baseSubject.Left(baseSubject.GetLength() - 5);
          }
 
+         // (3) Remove leading blobs followed by "re:", "fw:" or "fwd:", and (4) a 
+         // leading blob, as long as something remains after it.
+         bool changed = true;
+         while (changed)
+         {
+            changed = false;
+            baseSubject.TrimLeft();
+
+            int position = 0;
+            int afterBlob = 0;
+            while ((afterBlob = skipBlob(baseSubject, position)) >= 0)
+               position = afterBlob;
+
+            int afterReplyOrForward = skipReplyOrForward(baseSubject, position);
+            if (afterReplyOrForward >= 0)
+            {
+               baseSubject = baseSubject.Mid(afterReplyOrForward);
+               changed = true;
+               continue;
+            }
+
+            afterBlob = skipBlob(baseSubject, 0);
+            if (afterBlob > 0 && afterBlob < baseSubject.GetLength())
+            {
+               baseSubject = baseSubject.Mid(afterBlob);
+               changed = true;
+            }
+         }
 
-         if (st.first == false && sortField != Unknown)
+         // (5) Remove a "[fwd: ... ]" wrapper and start over.
+         if (baseSubject.GetLength() >= 6 &&
+             baseSubject.Left(5).CompareNoCase(_T("[fwd:")) == 0 &&
+             baseSubject.Right(1) == _T("]"))
          {
-            // Reversed order:
-            std::reverse(vecMessages.begin(), vecMessages.end());
+            baseSubject = baseSubject.Mid(5, baseSubject.GetLength() - 6);
+            baseSubject.Trim();
+            continue;
          }
-         
 
-         iterSortType++;
+         return baseSubject;
+      }
+   }
+
+   String
+   IMAPSort::GetHeaderName_(SortField sortField)
+   {
+      switch (sortField)
+      {
+      case From:
+         return "From";
+      case Subject:
+         return "Subject";
+      case To:
+         return "To";
+      case CC:
+         return "CC";
+      case Date:
+         return "Date";
+      default:
+         return "";
       }
    }
 
@@ -260,97 +564,4 @@ namespace HM
 
       return sortField;
    }
-
-
-   void 
-   IMAPSort::CacheHeaderFields_(std::shared_ptr<IMAPConnection> pConnection,
-                                const std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages, 
-                                const std::map<__int64, String > &databaseMetaData, 
-                                SortField &sortField,
-                                std::map<__int64, String> &mapHeaderFields)
-   {
-      mapHeaderFields.clear();
-
-      String sHeaderField;
-
-      switch (sortField)
-      {
-      case From:
-         sHeaderField = "From";
-         break;
-      case Subject:
-         sHeaderField = "Subject";
-         break;
-      case To:
-         sHeaderField = "To";
-         break;
-      case CC:
-         sHeaderField = "CC";
-         break;
-      case Date:
-         sHeaderField = "Date";
-         break;      
-      }
-
-      // Cache the header field for all messages.
-      bool bTrimLeadingSpecialCharacters = (sortField == From || sortField == To || sortField == CC);
-
-      std::vector<std::pair<int, std::shared_ptr<Message> > >::const_iterator iter = vecMessages.begin();
-      std::vector<std::pair<int, std::shared_ptr<Message> > >::const_iterator iterEnd = vecMessages.end();
-
-      for (; iter != iterEnd; iter++)
-      {
-         // Fetch message.
-         const std::shared_ptr<Message> p1 = (*iter).second;
-
-         String sFieldValue = "";
-
-         // Read message and parse out the value from the header.
-         std::map<__int64, String >::const_iterator dbMetaIter = databaseMetaData.find(p1->GetID());
-         
-         if (dbMetaIter == databaseMetaData.end())
-         {
-            String fileName = PersistentMessage::GetFileName(pConnection->GetAccount(), p1);
-
-            AnsiString sHeader = PersistentMessage::LoadHeader(fileName);
-
-            MimeHeader oHeader;oHeader.Load(sHeader, sHeader.GetLength());
-            sFieldValue = oHeader.GetUnicodeFieldValue(sHeaderField);
-
-            if (sortField == Date)
-            {
-               DateTime dt = Time::GetDateTimeFromMimeHeader(sFieldValue);
-               sFieldValue = Time::GetTimeStampFromDateTime(dt);
-            }
-         }
-         else
-         {
-            sFieldValue = (*dbMetaIter).second;
-         }
-
-         if (sortField == Date && sFieldValue.IsEmpty())
-         {
-             /*
-              * RFC 5256 "2.2. Sent Date" chapter. If the sent date cannot be determined (a Date: header is missing or cannot be parsed), 
-              * the INTERNALDATE for that message is used as the sent date.
-              */
-            sFieldValue = p1->GetCreateTime();
-         }
-
-         // Convert the string to upper case. The sorting should be
-         // case insensitive. Otherwise b will come before A.
-         sFieldValue.ToUpper();
-
-         // Remove leading ". If we sort on From, "Test" should come in 
-         // same position as Test. (quotes / no quotes)
-         if (bTrimLeadingSpecialCharacters)
-         {
-            sFieldValue.TrimLeft(_T("\""));
-            sFieldValue.TrimLeft(_T("<"));
-         }
-
-         // Cache the header
-         mapHeaderFields[p1->GetID()] = sFieldValue;
-      }
-   }
 }
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace HM
    class Message;
    class MessageMetaData;
    class IMAPConnection;
+   class MimeHeader;
 
    class IMAPSort
    {
@@ -31,9 +32,51 @@ namespace HM
 
       void Sort(std::shared_ptr<IMAPConnection> pConnection, std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages, String character_set, std::shared_ptr<IMAPSortParser> pParser);
 
+      static String GetBaseSubject(const String &subject);
+      // Extracts the base subject as defined in RFC 5256, section 2.1.
+
    private:
 
-      void CacheHeaderFields_(std::shared_ptr<IMAPConnection> pConnection, const std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages, const std::map<__int64, String > &databaseMetaData, SortField &sortField, std::map<__int64, String> &mapHeaderFields);
+      enum Settings
+      {
+         // Below this number of messages, sorting on a single thread is faster
+         // than splitting the work.
+         ParallelSortThreshold = 20000,
+         MaxSortThreads = 4
+      };
+
+      struct SortCriterion
+      {
+         SortField field_;
+         bool ascending_;
+      };
+
+      struct SortKey
+      {
+         SortKey() : numeric_(0) {}
+
+         // Date, arrival and size are sorted on numeric_, the header
+         // fields on the collation key.
+         double numeric_;
+         std::string collation_;
+      };
+
+      struct SortRecord
+      {
+         size_t message_index_;
+         int sequence_;
+      };
+
+      class SortRecordComparer;
+
+      void CreateSortKeys_(std::shared_ptr<IMAPConnection> pConnection, const std::vector<std::pair<int, std::shared_ptr<Message> > > &vecMessages, const std::vector<SortCriterion> &criteria, bool usAscii, std::vector<SortKey> &keys);
+      String GetHeaderFieldValue_(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<Message> message, SortField sortField, const std::map<__int64, String> &databaseMetaData, std::shared_ptr<MimeHeader> &header);
+
+      static void SortRecords_(std::vector<SortRecord> &records, const SortRecordComparer &comparer);
+
+      static String GetAddressMailbox_(const String &addressList);
+      static std::string GetCollationKey_(const String &value, bool usAscii);
+      static String GetHeaderName_(SortField sortField);
 
       SortField GetSortField_(AnsiString sHeaderField);
    };
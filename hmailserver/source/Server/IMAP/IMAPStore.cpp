@@ -4,6 +4,7 @@
 #include "stdafx.h"
 #include "IMAPStore.h"
 #include "IMAPConnection.h"
+#include "IMAPCondStore.h"
 
 #include "../Common/Application/FolderManager.h"
 #include "../Common/BO/Account.h"
@@ -22,7 +23,8 @@
 namespace HM
 {
 
-   IMAPStore::IMAPStore()
+   IMAPStore::IMAPStore() :
+      unchanged_since_(-1)
    {
 
    }
@@ -33,6 +35,89 @@ namespace HM
    }
 
 
+   IMAPResult
+   IMAPStore::DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, const std::shared_ptr<IMAPCommandArgument> pArgument)
+   {
+      pending_flags_.clear();
+      pending_messages_.clear();
+      pending_responses_.clear();
+      pending_numbers_.clear();
+      modified_.clear();
+      unchanged_since_ = -1;
+
+      // The modifier comes before the flags, as in 1:* (UNCHANGEDSINCE 12345) +FLAGS (\Seen)
+      String sCommand = pArgument->Command();
+      int iModifierStart = sCommand.FindNoCase(_T("(UNCHANGEDSINCE "));
+      if (iModifierStart >= 0)
+      {
+         int iValueStart = iModifierStart + 16;
+         int iModifierEnd = sCommand.Find(_T(")"), iValueStart);
+
+         String sModSeq = iModifierEnd > iValueStart ? sCommand.Mid(iValueStart, iModifierEnd - iValueStart) : String(_T(""));
+         sModSeq.Trim();
+
+         if (!StringParser::IsNumeric(sModSeq))
+            return IMAPResult(IMAPResult::ResultBad, "UNCHANGEDSINCE requires a mod-sequence.");
+
+         unchanged_since_ = _ttoi64(sModSeq);
+         pConnection->SetCondStoreEnabled();
+      }
+
+      IMAPResult result = IMAPCommandRangeAction::DoForMails(pConnection, sMailNos, pArgument);
+
+      if (pending_flags_.empty())
+         return result;
+
+      // Changes made before an error are still saved, as they were when every message was saved separately.
+      __int64 modSeq = 0;
+      std::set<__int64> modifiedMessageIDs;
+      bool saved = Application::Instance()->GetFolderManager()->UpdateMessageFlags(
+         (int) pConnection->GetCurrentFolder()->GetAccountID(), 
+         (int) pConnection->GetCurrentFolder()->GetID(),
+         pending_flags_, unchanged_since_, modSeq, modifiedMessageIDs);
+
+      if (!saved)
+         return IMAPResult(IMAPResult::ResultNo, "Unable to store message flags.");
+
+      if (!modifiedMessageIDs.empty())
+      {
+         for (__int64 messageID : modifiedMessageIDs)
+            modified_.push_back(pending_numbers_[messageID]);
+
+         auto isModified = [&modifiedMessageIDs](__int64 messageID) { return modifiedMessageIDs.find(messageID) != modifiedMessageIDs.end(); };
+
+         pending_messages_.erase(std::remove_if(pending_messages_.begin(), pending_messages_.end(), isModified), pending_messages_.end());
+         pending_responses_.erase(std::remove_if(pending_responses_.begin(), pending_responses_.end(), 
+            [&isModified](const std::pair<int, std::shared_ptr<Message> > &response) { return isModified(response.second->GetID()); }), pending_responses_.end());
+
+         if (pending_messages_.empty())
+            return result;
+      }
+
+      // The responses are built after saving, so that they contain the new mod-sequence.
+      if (!pending_responses_.empty())
+      {
+         __int64 responseModSeq = pConnection->GetCondStoreEnabled() ? modSeq : 0;
+
+         String sResponses;
+         for (auto response : pending_responses_)
+            sResponses += GetMessageFlags(response.second, response.first, responseModSeq);
+
+         pConnection->SendAsciiData(sResponses);
+      }
+
+      // BEGIN IMAP IDLE
+
+      // Notify the mailbox notifier that the mailbox contents have changed.
+      std::shared_ptr<ChangeNotification> pNotification = 
+         std::shared_ptr<ChangeNotification>(new ChangeNotification(pConnection->GetCurrentFolder()->GetAccountID(), pConnection->GetCurrentFolder()->GetID(),  ChangeNotification::NotificationMessageFlagsChanged, pending_messages_));
+
+      Application::Instance()->GetNotificationServer()->SendNotification(pConnection->GetNotificationClient(), pNotification);
+      // END IMAP IDLE
+
+      return result;
+   }
+
    IMAPResult
    IMAPStore::DoAction(std::shared_ptr<IMAPConnection> pConnection, int messageIndex,  std::shared_ptr<Message> pMessage, const std::shared_ptr<IMAPCommandArgument> pArgument)
    {
@@ -78,6 +163,13 @@ namespace HM
             return IMAPResult(IMAPResult::ResultNo, "ACL: WriteOthers permission denied (Required for STORE command).");
       }
 
+      // Messages changed by someone else since the client last looked are left alone.
+      if (unchanged_since_ >= 0 && pMessage->GetModSeq() > unchanged_since_)
+      {
+         modified_.push_back(GetIsUID() ? pMessage->GetUID() : (unsigned int) messageIndex);
+         return IMAPResult();
+      }
+
 
       if (sCommand.FindNoCase(_T("-FLAGS")) >= 0)
       {
@@ -121,38 +213,30 @@ namespace HM
          pMessage->SetFlagFlagged(bFlagged);
       }
 
-      bool result = Application::Instance()->GetFolderManager()->UpdateMessageFlags(
-         (int) pConnection->GetCurrentFolder()->GetAccountID(), 
-         (int) pConnection->GetCurrentFolder()->GetID(),
-         pMessage->GetID(), pMessage->GetFlags());
+      if (pending_flags_.find(pMessage->GetID()) == pending_flags_.end())
+         pending_messages_.push_back(pMessage->GetID());
 
-      if (!result)
-      {
-         return IMAPResult(IMAPResult::ResultNo, "Unable to store message flags.");
-      }
+      pending_flags_[pMessage->GetID()] = pMessage->GetFlags();
+
+      if (unchanged_since_ >= 0)
+         pending_numbers_[pMessage->GetID()] = GetIsUID() ? pMessage->GetUID() : (unsigned int) messageIndex;
 
       if (!bSilent)
       {
-         pConnection->SendAsciiData(GetMessageFlags(pMessage, messageIndex));
+         pending_responses_.push_back(std::make_pair(messageIndex, pMessage));
       }
 
-      // BEGIN IMAP IDLE
-
-      // Notify the mailbox notifier that the mailbox contents have changed.
-      std::vector<__int64> effectedMessages;
-      effectedMessages.push_back(pMessage->GetID());
-
-      std::shared_ptr<ChangeNotification> pNotification = 
-         std::shared_ptr<ChangeNotification>(new ChangeNotification(pConnection->GetCurrentFolder()->GetAccountID(), pConnection->GetCurrentFolder()->GetID(),  ChangeNotification::NotificationMessageFlagsChanged, effectedMessages));
-
-      Application::Instance()->GetNotificationServer()->SendNotification(pConnection->GetNotificationClient(), pNotification);
-      // END IMAP IDLE
-
       return IMAPResult();
    }
 
+   String
+   IMAPStore::GetModifiedSet()
+   {
+      return IMAPCondStore::FormatUIDSet(modified_);
+   }
+
    String 
-   IMAPStore::GetMessageFlags(std::shared_ptr<Message> pMessage, int messageIndex)
+   IMAPStore::GetMessageFlags(std::shared_ptr<Message> pMessage, int messageIndex, __int64 modSeq)
    {
       // Build a flags string.
       String sFlags;
@@ -200,7 +284,10 @@ namespace HM
 
       // It really should be FETCH below...
       String sRet;
-      sRet.Format(_T("* %d FETCH (FLAGS (%s) UID %u)\r\n"), messageIndex, sFlags.c_str(), pMessage->GetUID());
+      if (modSeq > 0)
+         sRet.Format(_T("* %d FETCH (FLAGS (%s) UID %u MODSEQ (%I64d))\r\n"), messageIndex, sFlags.c_str(), pMessage->GetUID(), modSeq);
+      else
+         sRet.Format(_T("* %d FETCH (FLAGS (%s) UID %u)\r\n"), messageIndex, sFlags.c_str(), pMessage->GetUID());
       return sRet;
    }
       
@@ -14,8 +14,28 @@ namespace HM
 	   IMAPStore();
 	   virtual ~IMAPStore();
 
+      virtual IMAPResult DoForMails(std::shared_ptr<IMAPConnection> pConnection, const String &sMailNos, const std::shared_ptr<IMAPCommandArgument> pArgument);
       IMAPResult DoAction(std::shared_ptr<IMAPConnection> pConnection, int messageIndex, std::shared_ptr<Message> pMessage, const std::shared_ptr<IMAPCommandArgument> pArgument);
-      static String GetMessageFlags(std::shared_ptr<Message> pMessage, int messageIndex);
+      static String GetMessageFlags(std::shared_ptr<Message> pMessage, int messageIndex, __int64 modSeq);
+      // If modSeq is above zero, it's included in the response.
+
+      String GetModifiedSet();
+      // Returns the messages which were not changed because of UNCHANGEDSINCE.
+
+   private:
+
+      // DoAction only updates the messages. The flags are saved, and the untagged
+      // responses are sent, once all messages in the sequence set have been visited.
+      std::map<__int64, short> pending_flags_;
+      std::vector<__int64> pending_messages_;
+      std::vector<std::pair<int, std::shared_ptr<Message> > > pending_responses_;
+
+      // The UNCHANGEDSINCE store modifier (RFC 7162), or -1 if not given. The database
+      // update is conditional on it, so messages changed by another session after the
+      // check in DoAction are also reported, using the number in pending_numbers_.
+      __int64 unchanged_since_;
+      std::vector<unsigned int> modified_;
+      std::map<__int64, unsigned int> pending_numbers_;
    };
 
 }
@@ -6,6 +6,7 @@
 #include "MessagesContainer.h"
 
 #include "../Common/BO/Messages.h"
+#include "../Common/BO/FolderSnapshot.h"
 #include "../Common/Cache/CachedMessages.h"
 
 #ifdef _DEBUG
@@ -56,6 +57,10 @@ namespace HM
       // this will cause message to be refreshed from db, if needed:
       auto messages = cached_messages->GetMessages(update_recent_messages);
 
+      // Builds the snapshot if needed, so it's included in the size below.
+      recent_messages.clear();
+      messages->GetSnapshot()->GetMessageIDsWithFlag(Message::FlagRecent, recent_messages);
+
       size_t estimated_size_after = cached_messages->GetEstimatedCachingSize();
 
       bool increased_size = false;
@@ -74,14 +79,6 @@ namespace HM
       
       messages_cache_.AdjustEstimatedSize(increased_size, size_change);
 
-      recent_messages.clear();
-            
-      for (std::shared_ptr<Message> message : messages->GetVector())
-      {
-         if (message->GetFlagRecent())
-            recent_messages.insert(message->GetID());
-      }
-
       if (update_recent_messages)
          messages->RemoveRecentFlags();
 
@@ -107,6 +104,16 @@ namespace HM
       cached_messages->SetRefreshNeeded();
    }
 
+   void
+   MessagesContainer::SetFolderSnapshotOutdated(__int64 folder_id)
+   {
+      auto cached_messages = messages_cache_.GetObject(folder_id);
+      if (cached_messages == nullptr)
+         return;
+
+      cached_messages->InvalidateSnapshot();
+   }
+
    void
    MessagesContainer::Clear()
    {
@@ -0,0 +1,122 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+
+#include "MimeStructureContainer.h"
+
+#include "../Common/Cache/CachedMimeStructure.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   MimeStructureContainer::MimeStructureContainer()
+   {
+      structure_cache_.SetEnabled(true);
+      structure_cache_.SetTTL(30 * 60);
+      structure_cache_.SetMaxSize(64 * 1024 * 1024); // 64MB
+
+      // When the server is stopped, the cache should be cleared.
+      Application::Instance()->OnServerStopped.connect
+         (
+            [this]() { Clear(); }
+         );
+   }
+
+   bool
+   MimeStructureContainer::GetEnvelope(__int64 message_id, long file_size, __int64 file_time, String &envelope)
+   {
+      std::shared_ptr<CachedMimeStructure> entry = GetEntry_(message_id, file_size, file_time);
+      if (!entry || entry->GetEnvelope().IsEmpty())
+         return false;
+
+      envelope = entry->GetEnvelope();
+      return true;
+   }
+
+   void
+   MimeStructureContainer::SetEnvelope(__int64 message_id, long file_size, __int64 file_time, const String &envelope)
+   {
+      Update_(message_id, file_size, file_time, [&envelope](std::shared_ptr<CachedMimeStructure> entry) { entry->SetEnvelope(envelope); });
+   }
+
+   bool
+   MimeStructureContainer::GetBodyStructure(__int64 message_id, long file_size, __int64 file_time, bool include_extension_data, String &body_structure)
+   {
+      std::shared_ptr<CachedMimeStructure> entry = GetEntry_(message_id, file_size, file_time);
+      if (!entry || entry->GetBodyStructure(include_extension_data).IsEmpty())
+         return false;
+
+      body_structure = entry->GetBodyStructure(include_extension_data);
+      return true;
+   }
+
+   void
+   MimeStructureContainer::SetBodyStructure(__int64 message_id, long file_size, __int64 file_time, bool include_extension_data, const String &body_structure)
+   {
+      Update_(message_id, file_size, file_time, [include_extension_data, &body_structure](std::shared_ptr<CachedMimeStructure> entry) { entry->SetBodyStructure(include_extension_data, body_structure); });
+   }
+
+   std::shared_ptr<const MessagePartMap>
+   MimeStructureContainer::GetPartMap(__int64 message_id, long file_size, __int64 file_time, const String &file_name)
+   {
+      std::shared_ptr<CachedMimeStructure> entry = GetEntry_(message_id, file_size, file_time);
+      if (entry && entry->GetPartMap())
+         return entry->GetPartMap();
+
+      std::shared_ptr<MessagePartMap> part_map = std::shared_ptr<MessagePartMap>(new MessagePartMap());
+      if (!part_map->Load(file_name))
+      {
+         std::shared_ptr<const MessagePartMap> empty;
+         return empty;
+      }
+
+      Update_(message_id, file_size, file_time, [part_map](std::shared_ptr<CachedMimeStructure> entry) { entry->SetPartMap(part_map); });
+
+      return part_map;
+   }
+
+   std::shared_ptr<CachedMimeStructure>
+   MimeStructureContainer::GetEntry_(__int64 message_id, long file_size, __int64 file_time)
+   {
+      std::shared_ptr<CachedMimeStructure> entry = structure_cache_.GetObject(message_id);
+
+      if (entry && (entry->GetFileSize() != file_size || entry->GetFileTime() != file_time))
+      {
+         // The message file has been replaced.
+         structure_cache_.RemoveObject(message_id);
+         entry.reset();
+      }
+
+      return entry;
+   }
+
+   void
+   MimeStructureContainer::Update_(__int64 message_id, long file_size, __int64 file_time, std::function<void(std::shared_ptr<CachedMimeStructure>)> update)
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      std::shared_ptr<CachedMimeStructure> entry;
+
+      std::shared_ptr<CachedMimeStructure> existing = GetEntry_(message_id, file_size, file_time);
+      if (existing)
+         entry = std::shared_ptr<CachedMimeStructure>(new CachedMimeStructure(*existing));
+      else
+         entry = std::shared_ptr<CachedMimeStructure>(new CachedMimeStructure(message_id, file_size, file_time));
+
+      update(entry);
+
+      structure_cache_.RemoveObject(message_id);
+      structure_cache_.Add(entry);
+   }
+
+   void
+   MimeStructureContainer::Clear()
+   {
+      structure_cache_.Clear();
+   }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+#include "../Common/Cache/Cache.h"
+
+namespace HM
+{
+   class CachedMimeStructure;
+   class MessagePartMap;
+
+   // Keeps the ENVELOPE and BODYSTRUCTURE responses of recently fetched messages,
+   // and the location of their parts, so that clients which ask for them repeatedly
+   // don't cause the message file to be parsed every time. The entries are keyed
+   // on the size and last write time of the file, so an entry is not used once
+   // the file has been rewritten.
+   class MimeStructureContainer : public Singleton<MimeStructureContainer>
+   {
+   public:
+
+      MimeStructureContainer();
+
+      bool GetEnvelope(__int64 message_id, long file_size, __int64 file_time, String &envelope);
+      void SetEnvelope(__int64 message_id, long file_size, __int64 file_time, const String &envelope);
+
+      bool GetBodyStructure(__int64 message_id, long file_size, __int64 file_time, bool include_extension_data, String &body_structure);
+      void SetBodyStructure(__int64 message_id, long file_size, __int64 file_time, bool include_extension_data, const String &body_structure);
+
+      std::shared_ptr<const MessagePartMap> GetPartMap(__int64 message_id, long file_size, __int64 file_time, const String &file_name);
+      // Returns the location of the parts in the message file. The file is scanned
+      // the first time, and the result is kept with the other structures.
+
+      void Clear();
+
+   private:
+
+      std::shared_ptr<CachedMimeStructure> GetEntry_(__int64 message_id, long file_size, __int64 file_time);
+      void Update_(__int64 message_id, long file_size, __int64 file_time, std::function<void(std::shared_ptr<CachedMimeStructure>)> update);
+
+      // Entries in the cache are never modified. Updates replace the entry with a copy.
+      boost::mutex mutex_;
+
+      Cache<CachedMimeStructure> structure_cache_;
+   };
+}
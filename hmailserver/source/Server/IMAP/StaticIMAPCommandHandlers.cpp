@@ -31,6 +31,7 @@
 #include "IMAPCommandSetAcl.h"
 #include "IMAPCommandListRights.h"
 #include "IMAPCommandStartTls.h"
+#include "IMAPSimpleCommandParser.h"
 
 // IMAP QUOTA EXTENSION
 #include "IMAPCommandGetQuota.h"
@@ -78,6 +79,7 @@ namespace HM
       mapCommandHandlers[IMAPConnection::IMAP_SETACL] = std::shared_ptr<IMAPCommandSetAcl>(new IMAPCommandSetAcl());
       mapCommandHandlers[IMAPConnection::IMAP_LISTRIGHTS] = std::shared_ptr<IMAPCommandListRights>(new IMAPCommandListRights());
       mapCommandHandlers[IMAPConnection::IMAP_STARTTLS] = std::shared_ptr<IMAPCommandStartTls>(new IMAPCommandStartTls());
+      mapCommandHandlers[IMAPConnection::IMAP_ENABLE] = std::shared_ptr<IMAPCommandENABLE>(new IMAPCommandENABLE());
    }
 
 
@@ -101,4 +103,40 @@ namespace HM
    
    }
 
+   IMAPResult
+   IMAPCommandENABLE::ExecuteCommand(std::shared_ptr<IMAPConnection> pConnection, std::shared_ptr<IMAPCommandArgument> pArgument)
+   {
+      if (!pConnection->IsAuthenticated())
+         return IMAPResult(IMAPResult::ResultNo, "Authenticate first");
+
+      std::shared_ptr<IMAPSimpleCommandParser> pParser = std::shared_ptr<IMAPSimpleCommandParser>(new IMAPSimpleCommandParser());
+      pParser->Parse(pArgument);
+
+      if (pParser->ParamCount() < 1)
+         return IMAPResult(IMAPResult::ResultBad, "ENABLE Command requires at least 1 parameter.");
+
+      // Only extensions which weren't enabled before are listed in the response.
+      String sEnabled;
+
+      for (size_t i = 1; i < pParser->WordCount(); i++)
+      {
+         String sExtension = pParser->Word(i)->Value();
+
+         if (sExtension.CompareNoCase(_T("CONDSTORE")) == 0 && !pConnection->GetCondStoreEnabled())
+         {
+            pConnection->SetCondStoreEnabled();
+            sEnabled += " CONDSTORE";
+         }
+         else if (sExtension.CompareNoCase(_T("QRESYNC")) == 0 && !pConnection->GetQResyncEnabled())
+         {
+            pConnection->SetQResyncEnabled();
+            sEnabled += " QRESYNC";
+         }
+      }
+
+      pConnection->SendAsciiData("* ENABLED" + sEnabled + "\r\n" + pArgument->Tag() + " OK ENABLE completed\r\n");
+
+      return IMAPResult();
+   }
+
 }
@@ -35,6 +35,11 @@ namespace HM
       virtual IMAPResult ExecuteCommand(std::shared_ptr<HM::IMAPConnection> pConnection, std::shared_ptr<IMAPCommandArgument> pArgument);
    };
 
+   class IMAPCommandENABLE : public IMAPCommand
+   {
+      virtual IMAPResult ExecuteCommand(std::shared_ptr<HM::IMAPConnection> pConnection, std::shared_ptr<IMAPCommandArgument> pArgument);
+   };
+
 
 
 }
\ No newline at end of file
@@ -397,10 +397,15 @@ namespace HM
          serverInfo->GetUsername()));
 
       std::shared_ptr<IOService> pIOService = Application::Instance()->GetIOService();
+      std::shared_ptr<IOServiceShard> shard = pIOService->GetIOServiceShard();
+      boost::asio::io_service &connectionIOService = shard ? shard->GetIOService() : pIOService->GetIOService();
 
       std::shared_ptr<Event> disconnectEvent = std::shared_ptr<Event>(new Event()) ;
       std::shared_ptr<SMTPClientConnection> pClientConnection 
-         = std::shared_ptr<SMTPClientConnection> (new SMTPClientConnection(serverInfo->GetConnectionSecurity(), pIOService->GetIOService(), pIOService->GetClientContext(), disconnectEvent, serverInfo->GetHostName()));
+         = std::shared_ptr<SMTPClientConnection> (new SMTPClientConnection(serverInfo->GetConnectionSecurity(), connectionIOService, pIOService->GetClientContext(), disconnectEvent, serverInfo->GetHostName()));
+
+      if (shard)
+         pClientConnection->SetIOServiceShard(shard);
 
       pClientConnection->SetDelivery(original_message_, vecRecipients);
 
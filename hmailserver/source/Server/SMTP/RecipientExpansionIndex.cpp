@@ -0,0 +1,176 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#include "stdafx.h"
+
+#include "RecipientExpansionIndex.h"
+#include "PlusAddressing.h"
+
+#include "../Common/Application/ObjectCache.h"
+#include "../Common/Cache/CacheContainer.h"
+
+#include "../Common/BO/Domain.h"
+#include "../Common/BO/DomainAliases.h"
+#include "../Common/BO/DistributionList.h"
+#include "../Common/BO/DistributionListRecipients.h"
+#include "../Common/BO/DistributionListRecipient.h"
+
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+
+namespace HM
+{
+   RecipientExpansionIndex::RecipientExpansionIndex() :
+      version_(0)
+   {
+
+   }
+
+   std::shared_ptr<const RecipientExpansionIndex::ExpandedList>
+   RecipientExpansionIndex::GetExpandedList(std::shared_ptr<const DistributionList> list)
+   {
+      unsigned int version = 0;
+
+      {
+         boost::lock_guard<boost::mutex> guard(mutex_);
+
+         auto iter = lists_.find(list->GetID());
+         if (iter != lists_.end())
+            return (*iter).second;
+
+         version = version_;
+      }
+
+      // The lists are loaded from the database, so don't hold the lock while doing so.
+      std::shared_ptr<ExpandedList> expanded = Expand_(list);
+
+      {
+         boost::lock_guard<boost::mutex> guard(mutex_);
+
+         if (version == version_)
+         {
+            lists_[list->GetID()] = expanded;
+
+            for (__int64 listID : expanded->list_ids_)
+               dependents_[listID].insert(list->GetID());
+         }
+      }
+
+      return expanded;
+   }
+
+   void
+   RecipientExpansionIndex::OnMembersChanged(__int64 listID)
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      version_++;
+
+      auto iter = dependents_.find(listID);
+      if (iter == dependents_.end())
+         return;
+
+      for (__int64 dependentListID : (*iter).second)
+         lists_.erase(dependentListID);
+
+      dependents_.erase(iter);
+   }
+
+   void
+   RecipientExpansionIndex::Clear()
+   {
+      boost::lock_guard<boost::mutex> guard(mutex_);
+
+      version_++;
+
+      lists_.clear();
+      dependents_.clear();
+   }
+
+   std::shared_ptr<RecipientExpansionIndex::ExpandedList>
+   RecipientExpansionIndex::Expand_(std::shared_ptr<const DistributionList> list)
+   {
+      std::shared_ptr<ExpandedList> expanded = std::shared_ptr<ExpandedList>(new ExpandedList);
+      expanded->list_ids_.insert(list->GetID());
+
+      GetMembers_(list, expanded->members_);
+
+      std::shared_ptr<DomainAliases> domainAliases = ObjectCache::Instance()->GetDomainAliases();
+      std::set<String> addedLeaves;
+
+      ExpandMembers_(expanded->members_, 1, domainAliases, *expanded, addedLeaves);
+
+      return expanded;
+   }
+
+   void
+   RecipientExpansionIndex::ExpandMembers_(const std::vector<String> &members, int depth, std::shared_ptr<DomainAliases> domainAliases, ExpandedList &expanded, std::set<String> &addedLeaves)
+   {
+      for (const String &member : members)
+      {
+         // Lists nested deeper than this are left to RecipientParser, which stops
+         // when the recursion gets too deep.
+         std::shared_ptr<const DistributionList> nestedList;
+         if (depth < MaxDepth)
+            nestedList = GetNestedList_(member, domainAliases);
+
+         if (nestedList)
+         {
+            // A list which has already been expanded has already added its members. This
+            // also stops lists which contain themselves.
+            if (!expanded.list_ids_.insert(nestedList->GetID()).second)
+               continue;
+
+            std::vector<String> nestedMembers;
+            GetMembers_(nestedList, nestedMembers);
+
+            ExpandMembers_(nestedMembers, depth + 1, domainAliases, expanded, addedLeaves);
+            continue;
+         }
+
+         String lowerMember = member;
+         lowerMember.ToLower();
+
+         if (addedLeaves.insert(lowerMember).second)
+            expanded.leaves_.push_back(member);
+      }
+   }
+
+   void
+   RecipientExpansionIndex::GetMembers_(std::shared_ptr<const DistributionList> list, std::vector<String> &members)
+   {
+      std::shared_ptr<DistributionListRecipients> listRecipients = list->GetMembers();
+
+      const std::vector<std::shared_ptr<DistributionListRecipient> > &vecRecipients = listRecipients->GetConstVector();
+      members.reserve(vecRecipients.size());
+
+      for (std::shared_ptr<DistributionListRecipient> recipient : vecRecipients)
+         members.push_back(recipient->GetAddress());
+   }
+
+   std::shared_ptr<const DistributionList>
+   RecipientExpansionIndex::GetNestedList_(const String &address, std::shared_ptr<DomainAliases> domainAliases)
+   {
+      // The address is resolved the same way as in RecipientParser, where
+      // accounts and aliases take precedence over lists.
+      String primaryAddress = domainAliases->ApplyAliasesOnAddress(address);
+
+      std::shared_ptr<const Domain> pDomain = CacheContainer::Instance()->GetDomain(StringParser::ExtractDomain(primaryAddress));
+      if (!pDomain || !pDomain->GetIsActive())
+         return std::shared_ptr<const DistributionList>();
+
+      primaryAddress = PlusAddressing::ExtractAccountAddress(primaryAddress, pDomain);
+
+      if (CacheContainer::Instance()->GetAccount(primaryAddress) ||
+          CacheContainer::Instance()->GetAlias(primaryAddress))
+         return std::shared_ptr<const DistributionList>();
+
+      std::shared_ptr<const DistributionList> list = CacheContainer::Instance()->GetDistributionList(primaryAddress);
+      if (!list || !list->GetActive())
+         return std::shared_ptr<const DistributionList>();
+
+      return list;
+   }
+}
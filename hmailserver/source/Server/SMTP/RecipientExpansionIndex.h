@@ -0,0 +1,69 @@
+// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+#pragma once
+
+namespace HM
+{
+   class DistributionList;
+   class DomainAliases;
+
+   // Keeps the members of distribution lists in memory, with the members of
+   // lists nested in them already flattened, so that a message to a large list
+   // doesn't cause the list members to be loaded from the database again.
+   // When the members of a list are changed, the expanded lists which include
+   // it are dropped. Other changes which affect how addresses are resolved
+   // (accounts, aliases, lists and domains) drop all of them.
+   class RecipientExpansionIndex : public Singleton<RecipientExpansionIndex>
+   {
+   public:
+
+      class ExpandedList
+      {
+      public:
+
+         // The members of the list itself.
+         std::vector<String> members_;
+
+         // The members of the list and the lists nested in it, except for the
+         // nested lists themselves, in the order they were found. An address
+         // is only included once.
+         std::vector<String> leaves_;
+
+         // The IDs of the lists which were expanded, including this one.
+         std::set<__int64> list_ids_;
+      };
+
+      RecipientExpansionIndex();
+
+      std::shared_ptr<const ExpandedList> GetExpandedList(std::shared_ptr<const DistributionList> list);
+
+      void OnMembersChanged(__int64 listID);
+      // Drops the expanded lists which include the given list.
+
+      void Clear();
+
+   private:
+
+      enum Settings
+      {
+         MaxDepth = 25
+      };
+
+      std::shared_ptr<ExpandedList> Expand_(std::shared_ptr<const DistributionList> list);
+      void ExpandMembers_(const std::vector<String> &members, int depth, std::shared_ptr<DomainAliases> domainAliases, ExpandedList &expanded, std::set<String> &addedLeaves);
+      static void GetMembers_(std::shared_ptr<const DistributionList> list, std::vector<String> &members);
+      static std::shared_ptr<const DistributionList> GetNestedList_(const String &address, std::shared_ptr<DomainAliases> domainAliases);
+
+      boost::mutex mutex_;
+
+      // Increased on every change, so that a list which was expanded while
+      // the members were being changed isn't kept.
+      unsigned int version_;
+
+      std::map<__int64, std::shared_ptr<const ExpandedList> > lists_;
+
+      // List ID -> IDs of the expanded lists which include it.
+      std::map<__int64, std::set<__int64> > dependents_;
+   };
+}
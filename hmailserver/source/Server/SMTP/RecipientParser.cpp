@@ -8,6 +8,7 @@
 #include "SMTPConfiguration.h"
 
 #include "PlusAddressing.h"
+#include "RecipientExpansionIndex.h"
 
 #include "../Common/Application/ObjectCache.h"
 #include "../common/Cache/CacheContainer.h"
@@ -286,16 +287,12 @@ namespace HM
             if (!pListADO->GetActive())
                return;
 
-            std::shared_ptr<const DistributionListRecipients> listRecipients = pListADO->GetMembers();
-            const std::vector<std::shared_ptr<DistributionListRecipient> > vecRecipients = listRecipients->GetConstVector();
-            std::vector<std::shared_ptr<DistributionListRecipient> >::const_iterator iterRecipient = vecRecipients.begin();
+            // Nested lists have already been expanded, so the members are
+            // accounts, aliases or external addresses.
+            std::shared_ptr<const RecipientExpansionIndex::ExpandedList> expandedList = RecipientExpansionIndex::Instance()->GetExpandedList(pListADO);
 
-            while (iterRecipient != vecRecipients.end())
-            {
-               CreateMessageRecipientList_((*iterRecipient)->GetAddress(), sOriginalAddress,lRecurse, pRecipients, recipientOK);
-
-               iterRecipient++;
-            }
+            for (const String &member : expandedList->leaves_)
+               CreateMessageRecipientList_(member, sOriginalAddress, lRecurse, pRecipients, recipientOK);
 
             return;
          }
@@ -371,6 +368,8 @@ namespace HM
          return DP_PermissionDenied;
       }
 
+      std::shared_ptr<const RecipientExpansionIndex::ExpandedList> expandedList = RecipientExpansionIndex::Instance()->GetExpandedList(pList);
+
       DistributionList::ListMode lm = pList->GetListMode();
 
       if (lm == DistributionList::LMAnnouncement)
@@ -401,15 +400,14 @@ namespace HM
       {
          // Only members of the list can send messages. 
          // Check if the sender is a member of the list.
-         std::vector<std::shared_ptr<DistributionListRecipient> > vecRecipients = pList->GetMembers()->GetVector();
-         auto iterRecipient = vecRecipients.begin();
+         const std::vector<String> &vecMembers = expandedList->members_;
+         auto iterMember = vecMembers.begin();
 
          Logger::Instance()->LogDebug("DistributionList::LMMembership");
 
-         for (; iterRecipient != vecRecipients.end(); iterRecipient++)
+         for (; iterMember != vecMembers.end(); iterMember++)
          {
-            String sRecipient = (*iterRecipient)->GetAddress();
-            sRecipient = pDA->ApplyAliasesOnAddress(sRecipient);
+            String sRecipient = pDA->ApplyAliasesOnAddress(*iterMember);
 
             if (sRecipient.CompareNoCase(sSender) == 0)
             {
@@ -420,7 +418,7 @@ namespace HM
 
          // If we reached the end of the list, it means that we
          // didn't find the recipient.
-         if (iterRecipient == vecRecipients.end())
+         if (iterMember == vecMembers.end())
          {
 	         // Let's adjust reason to better explain sender is not seen as allowed SENDER
             sErrMsg = "550 Not authorized sender.";
@@ -432,16 +430,11 @@ namespace HM
       // Check that the user is allowed to send to all recipient
       // of the list. This is a bit CPU intensive, but we need
       // to recursively look up all the recipients.
-      std::shared_ptr<DistributionListRecipients> pListMembers = pList->GetMembers();
-
-      std::vector<std::shared_ptr<DistributionListRecipient> > vecRecipients = pListMembers->GetVector();
-      std::vector<std::shared_ptr<DistributionListRecipient> >::const_iterator iterRecipient = vecRecipients.begin();
-
-      while (iterRecipient != vecRecipients.end())
+      for (const String &member : expandedList->members_)
       {
          bool bTreatSecurityAsLocal = true;
 
-         DeliveryPossibility dp = CheckDeliveryPossibility(bSenderIsAuthenticated, sSender, (*iterRecipient)->GetAddress(), sErrMsg, bTreatSecurityAsLocal, iRecursionLevel);
+         DeliveryPossibility dp = CheckDeliveryPossibility(bSenderIsAuthenticated, sSender, member, sErrMsg, bTreatSecurityAsLocal, iRecursionLevel);
          if (dp == DP_PermissionDenied)
          {
             // Log the reason the message to the list is rejected which helps a ton with lists on lists
@@ -449,7 +442,6 @@ namespace HM
 
             return DP_PermissionDenied;
          }
-         iterRecipient++;
       }
 
       return DP_Possible;
@@ -458,22 +450,6 @@ namespace HM
    void
    RecipientParser::AddRecipient_(std::shared_ptr<MessageRecipients> pRecipients, std::shared_ptr<MessageRecipient> pRecipient)
    {
-      String address = pRecipient->GetAddress().ToLower();
-
-      if (address.IsEmpty())
-         return;
-      
-      std::vector<std::shared_ptr<MessageRecipient> > vecResult = pRecipients->GetVector();
-      auto iterRecip = vecResult.begin();
-
-      while (iterRecip != vecResult.end())
-      {
-         if ((*iterRecip)->GetAddress().ToLower() == address)
-            return;
-
-         iterRecip++;
-      }
-
-      pRecipients->Add(pRecipient);
+      pRecipients->AddUnique(pRecipient);
    }
 }
@@ -60,50 +60,54 @@ namespace HM
          return;
       }
 
-      std::shared_ptr<MessageData> pMessageData = std::shared_ptr<MessageData>(new MessageData());
-      pMessageData->LoadFromMessage(account, pMessage);
+      std::shared_ptr<const RulePlan> pPlan = pRules->GetPlan();
+
+      message_data_.reset();
       
       rule_account_id_ = pRules->GetAccountID();
 
-      for (int i = 0; i < pRules->GetCount(); i++)
+      for (const RulePlan::PlannedRule &plannedRule : pPlan->GetRules())
       {
-         std::shared_ptr<Rule> pRule = pRules->GetItem(i);
-
-         if (pRule && pRule->GetActive())
+         bool bContinueRuleProcessing = true;
+         if (ApplyRule_(plannedRule, account, pMessage, bContinueRuleProcessing, ruleResult))
          {
-            bool bContinueRuleProcessing = true;
-            if (ApplyRule_(pRule, account, pMessageData, bContinueRuleProcessing, ruleResult))
-            {
-               // The rule matched. We should return here.
-               return;
-            }
+            // The rule matched. We should return here.
+            return;
+         }
 
-            if (!bContinueRuleProcessing)
-            {
-               break;
-            }
+         if (!bContinueRuleProcessing)
+         {
+            break;
          }
       }
    }
 
+   std::shared_ptr<MessageData>
+   RuleApplier::GetMessageData_(std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage)
+   {
+      if (!message_data_)
+      {
+         message_data_ = std::shared_ptr<MessageData>(new MessageData());
+         message_data_->LoadHeaderFromMessage(account, pMessage);
+      }
+
+      return message_data_;
+   }
+
    bool
-   RuleApplier::ApplyRule_(std::shared_ptr<Rule> pRule, std::shared_ptr<const Account> account, std::shared_ptr<MessageData> pMsgData, bool &bContinueRuleProcessing, RuleResult &ruleResult)
+   RuleApplier::ApplyRule_(const RulePlan::PlannedRule &plannedRule, std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage, bool &bContinueRuleProcessing, RuleResult &ruleResult)
    {
+      std::shared_ptr<Rule> pRule = plannedRule.rule_;
+
 		if (Logger::Instance()->GetLogDebug())
 			LOG_DEBUG(_T("Applying rule " + pRule->GetName()));
 
       bool bAllRequired = pRule->GetUseAND();
       bool bDoActions = false;
 
-      std::shared_ptr<RuleCriterias> pCriterias = pRule->GetCriterias();
-      for (int i = 0; i < pCriterias->GetCount(); i++)
+      for (const RulePlan::PlannedCriteria &plannedCriteria : plannedRule.criterias_)
       {
-         std::shared_ptr<RuleCriteria> pCriteria = pCriterias->GetItem(i);
-
-         if (!pCriteria)
-            continue;
-
-         bool bMatch = MessageMatchesCriteria_(pCriteria, pMsgData);
+         bool bMatch = MessageMatchesCriteria_(plannedCriteria.criteria_, account, pMessage);
          
          if (bAllRequired)
          {
@@ -126,7 +130,7 @@ namespace HM
 
       if (bDoActions)
       {
-         ApplyActions_(pRule, account, pMsgData, bContinueRuleProcessing, ruleResult);
+         ApplyActions_(pRule, account, GetMessageData_(account, pMessage), bContinueRuleProcessing, ruleResult);
       }
 
       return false;
@@ -357,7 +361,7 @@ namespace HM
       // The script may have modified the message. We need to reload it. We could
       // do a CRC check or something similar to determine whether it has changed,
       // but performance-wise we can probably just as well reload it.
-      pMsgData->LoadFromMessage(account, pMsgData->GetMessage());
+      pMsgData->LoadHeaderFromMessage(account, pMsgData->GetMessage());
    }
 
    void 
@@ -425,37 +429,41 @@ namespace HM
    }
 
    bool
-   RuleApplier::MessageMatchesCriteria_(std::shared_ptr<RuleCriteria> pCriteria, std::shared_ptr<MessageData> pMsgData) const
+   RuleApplier::MessageMatchesCriteria_(std::shared_ptr<RuleCriteria> pCriteria, std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage)
    {
+      // The envelope values are taken from the message object, so
+      // that the message file doesn't have to be loaded for them.
       String sFieldValue;
       if (pCriteria->GetUsePredefined())
       {
          switch (pCriteria->GetPredefinedField())
          {
          case RuleCriteria::FTFrom:
-            sFieldValue = pMsgData->GetFrom();
+            sFieldValue = GetMessageData_(account, pMessage)->GetFrom();
             break;
          case RuleCriteria::FTTo:
-            sFieldValue = pMsgData->GetTo();
+            sFieldValue = GetMessageData_(account, pMessage)->GetTo();
             break;
          case RuleCriteria::FTCC:
-            sFieldValue = pMsgData->GetCC();
+            sFieldValue = GetMessageData_(account, pMessage)->GetCC();
             break;
          case RuleCriteria::FTSubject:
-            sFieldValue = pMsgData->GetSubject();
+            sFieldValue = GetMessageData_(account, pMessage)->GetSubject();
             break;
          case RuleCriteria::FTBody:
-            sFieldValue = pMsgData->GetBody() + pMsgData->GetHTMLBody();
-            break;
+            {
+               std::shared_ptr<MessageData> pMsgData = GetMessageData_(account, pMessage);
+               sFieldValue = pMsgData->GetBody() + pMsgData->GetHTMLBody();
+               break;
+            }
          case RuleCriteria::FTMessageSize:
-            sFieldValue.Format(_T("%d"), pMsgData->GetSize());
+            sFieldValue.Format(_T("%d"), pMessage->GetSize());
             break;
          case RuleCriteria::FTDeliveryAttempts:
-            sFieldValue.Format(_T("%u"), pMsgData->GetMessage()->GetNoOfRetries() + 1);
+            sFieldValue.Format(_T("%u"), pMessage->GetNoOfRetries() + 1);
             break;
          case RuleCriteria::FTRecipientList:
             {
-               std::shared_ptr<Message> pMessage = pMsgData->GetMessage();
                std::vector<std::shared_ptr<MessageRecipient> > vecRecipients = pMessage->GetRecipients()->GetVector();
                auto iterRecipient = vecRecipients.begin();
 
@@ -474,7 +482,7 @@ namespace HM
       }
       else
       {
-         sFieldValue = pMsgData->GetFieldValue(pCriteria->GetHeaderField());
+         sFieldValue = GetMessageData_(account, pMessage)->GetFieldValue(pCriteria->GetHeaderField());
       }
 
       String matchValue = pCriteria->GetMatchValue();
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../Common/BO/RuleCriteria.h"
+#include "../Common/BO/RulePlan.h"
 #include "RuleResult.h"
 
 namespace HM
@@ -32,7 +33,7 @@ namespace HM
    private:
 
       // Apply one rule to the message.
-      bool ApplyRule_(std::shared_ptr<Rule> pRule, std::shared_ptr<const Account> account, std::shared_ptr<MessageData> pMsgData, bool &bContinueRuleProcessing, RuleResult &ruleResult);
+      bool ApplyRule_(const RulePlan::PlannedRule &plannedRule, std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage, bool &bContinueRuleProcessing, RuleResult &ruleResult);
 
       // Do the actions for the message.
       void ApplyActions_(std::shared_ptr<Rule> pRule, std::shared_ptr<const Account> account, std::shared_ptr<MessageData> pMsgData, bool &bContinueRuleProcessing, RuleResult &ruleResult);
@@ -41,7 +42,11 @@ namespace HM
       void ApplyAction_(std::shared_ptr<Rule> pRule, std::shared_ptr<RuleAction> pAction, std::shared_ptr<const Account> account, std::shared_ptr<MessageData> pMsgData, bool &bContinueRuleProcessing, RuleResult &ruleResult);
 
       // Check wether pMessage matches pCriteria.
-      bool MessageMatchesCriteria_(std::shared_ptr<RuleCriteria> pCriteria, std::shared_ptr<MessageData> pMsgData) const;
+      bool MessageMatchesCriteria_(std::shared_ptr<RuleCriteria> pCriteria, std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage);
+
+      // Loads the message header the first time a criteria or an action needs it.
+      // The body is only loaded if a body criteria or an action needs it.
+      std::shared_ptr<MessageData> GetMessageData_(std::shared_ptr<const Account> account, std::shared_ptr<Message> pMessage);
       
       // Actions
       void ApplyAction_Forward(std::shared_ptr<RuleAction> pAction, std::shared_ptr<const Account> account, std::shared_ptr<MessageData> pMsgData) const;
@@ -55,6 +60,8 @@ namespace HM
    private:
 
       __int64 rule_account_id_;
+
+      std::shared_ptr<MessageData> message_data_;
       
    };
 }
\ No newline at end of file
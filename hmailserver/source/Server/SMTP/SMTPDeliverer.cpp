@@ -252,7 +252,7 @@ namespace HM
       const String fileName = PersistentMessage::GetFileName(pOrigMessage);
 
       std::shared_ptr<MessageData> pMsgData = std::shared_ptr<MessageData> (new MessageData());
-      pMsgData->LoadFromMessage(fileName, pOrigMessage);
+      pMsgData->LoadHeaderFromMessage(fileName, pOrigMessage);
 
       // true because we don't want to send bounces if AutoSubmitted header
       if (!RuleApplier::IsGeneratedResponseAllowed(pMsgData, true))
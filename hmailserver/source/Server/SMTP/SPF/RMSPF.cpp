@@ -35,7 +35,7 @@
 // #define SPFFILECACHE
 
 // define this if the cache in the memory should be implemented
-//#define SPFMEMCACHE
+#define SPFMEMCACHE
 
 // define one of following for the case where there is no SPF record
 #define SPFZONECUT 0 // return SPF_None
@@ -1473,7 +1473,9 @@ writecacheerror(const char* key, unsigned keylen, int error, time_t currtime)
  {
   dnsrec data;
 
-  if (withcache && keylen!=0 && error!=SPF_NoMemory)
+  // temporary errors (DNS timeout or SERVFAIL) are not cached, otherwise
+  // a single failed lookup would disable SPF for the domain for SPFDEFTTL
+  if (withcache && keylen!=0 && error!=SPF_NoMemory && error!=SPF_TempError)
    {
     data.dns_expire=SPFDEFTTL;
     data.dns_data[0]=(char)error;
@@ -4266,6 +4268,22 @@ SPFCleanupCache(long ttl)
  }
 
 
+// replace the function used for DNS queries (for testing)
+void
+SPFSetDnsQuery(void* query)
+ {
+#ifndef DNSAPI_SUPP
+  if (initialized<=0)
+    return;
+
+  if (query!=NULL)
+    pDnsQuery=(typDnsQuery_A*)query;
+  else
+    pDnsQuery=(typDnsQuery_A*)GetProcAddress(hmodDnsApi,"DnsQuery_A");
+#endif //DNSAPI_SUPP
+ }
+
+
 // look up A record of the domain
 unsigned long
 SPFGetAddress(const char* domain)
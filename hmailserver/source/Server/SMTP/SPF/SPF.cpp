@@ -16,7 +16,7 @@ namespace HM
    SPF::SPF(void)
    {
       // Initialize. This is only done once.
-      SPFInit(NULL,0, SPF_Multithread);
+      SPFInit(NULL, CacheSize, SPF_Multithread);
    }
 
    SPF::~SPF(void)
@@ -66,8 +66,13 @@ namespace HM
       return Neutral;
    }
 
+   LONG SPFTester::dns_query_result_ = 0;
+   int SPFTester::dns_query_count_ = 0;
+
    void SPFTester::Test()
    {
+      TestCache_();
+
       String sExplanation;
 
       if (SPF::Instance()->Test("140.211.11.3", "users-return-12950-webmaster=domain1.de@httpd.apache.org", sExplanation) != SPF::Pass)
@@ -95,12 +100,54 @@ namespace HM
          // Should not be allowed. advantagepayroll.com has SPF records.
          throw;
       }
+   }
+
+   void
+   SPFTester::TestCache_()
+   {
+      // Make sure the SPF library has been initialized before DNS is replaced.
+      SPF::Instance();
+
+      // A domain which hasn't been looked up before, so nothing is cached for it.
+      String sSender;
+      sSender.Format(_T("test@spf-cache-%u.invalid"), ::GetTickCount());
+
+      String sExplanation;
+
+      SPFSetDnsQuery(&DnsQueryStub_);
 
- 
-     
+      // Temporary DNS errors should not be cached, so the next check asks DNS again.
+      dns_query_result_ = DNS_ERROR_RCODE_SERVER_FAILURE;
+      dns_query_count_ = 0;
 
+      SPF::Instance()->Test("1.2.3.4", sSender, sExplanation);
+      int tempErrorQueries = dns_query_count_;
 
+      SPF::Instance()->Test("1.2.3.4", sSender, sExplanation);
+      bool tempErrorCached = dns_query_count_ == tempErrorQueries;
+
+      // A domain without SPF record should be cached.
+      dns_query_result_ = DNS_INFO_NO_RECORDS;
+
+      SPF::Instance()->Test("1.2.3.4", sSender, sExplanation);
+      int noRecordsQueries = dns_query_count_;
+
+      SPF::Instance()->Test("1.2.3.4", sSender, sExplanation);
+      bool noRecordsCached = dns_query_count_ == noRecordsQueries;
+
+      SPFSetDnsQuery(NULL);
+
+      if (tempErrorQueries == 0 || tempErrorCached || !noRecordsCached)
+         throw;
+   }
+
+   LONG WINAPI
+   SPFTester::DnsQueryStub_(const char *name, WORD type, DWORD options, void *servers, void **results, void **reserved)
+   {
+      dns_query_count_++;
 
+      *results = NULL;
+      return dns_query_result_;
    }
 
 
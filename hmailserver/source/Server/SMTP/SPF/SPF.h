@@ -21,7 +21,13 @@ namespace HM
       Result Test(const String &sSenderIP, const String &sSenderEmail, String &sExplanation);
 
    private:
-      
+
+      enum Settings
+      {
+         // Size of the in-memory record cache. SPF, include: and mx lookups for
+         // the same sending domains are served from here until their DNS TTL expires.
+         CacheSize = 1024 * 1024 * 4
+      };
    };
 
    class SPFTester
@@ -31,5 +37,14 @@ namespace HM
       ~SPFTester () {};      
 
       void Test();
+
+   private:
+
+      void TestCache_();
+
+      static LONG WINAPI DnsQueryStub_(const char *name, WORD type, DWORD options, void *servers, void **results, void **reserved);
+
+      static LONG dns_query_result_;
+      static int dns_query_count_;
    };
 }
\ No newline at end of file
@@ -162,6 +162,7 @@ namespace DBUpdater
          _upgradeScripts.Add(new UpgradeScript(5501, 5502));
          _upgradeScripts.Add(new UpgradeScript(5502, 5600));
          _upgradeScripts.Add(new UpgradeScript(5600, 5601));
+         _upgradeScripts.Add(new UpgradeScript(5601, 5602));
       }
 
       private void buttonClose_Click(object sender, EventArgs e)
@@ -265,6 +266,8 @@ namespace DBUpdater
                return "hMailServer 5.6 (Alpha 1)";
             case 5601:
                return "hMailServer 5.6";
+            case 5602:
+               return "hMailServer 5.6.1";
             default:
                return "Unknown version";
          }
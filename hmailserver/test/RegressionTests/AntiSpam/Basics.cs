@@ -541,6 +541,37 @@ namespace RegressionTests.AntiSpam
          oSURBLServer.Save();
       }
 
+      [Test]
+      public void TestSURBLWithUppercaseScheme()
+      {
+         Account oAccount1 = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "surbltest@test.com", "test");
+
+         _antiSpam.SpamMarkThreshold = 1;
+         _antiSpam.SpamDeleteThreshold = 100;
+         _antiSpam.AddHeaderReason = true;
+         _antiSpam.AddHeaderSpam = true;
+         _antiSpam.PrependSubject = true;
+         _antiSpam.PrependSubjectText = "ThisIsSpam";
+
+         // Enable SURBL.
+         SURBLServer oSURBLServer = _antiSpam.SURBLServers[0];
+         oSURBLServer.Active = true;
+         oSURBLServer.Score = 5;
+         oSURBLServer.Save();
+
+         // Send a messages to this account.
+         var smtpClientSimulator = new SmtpClientSimulator();
+
+         smtpClientSimulator.Send("surbltest@test.com", "surbltest@test.com", "SURBL-Match",
+                    "Uppercase URL - <a href=\"HTTP://SURBL-ORG-PERMANENT-TEST-POINT.COM:80/\">Test</a>");
+
+         string sMessageContents = Pop3ClientSimulator.AssertGetFirstMessageText(oAccount1.Address, "test");
+         Assert.IsTrue(sMessageContents.Contains("X-hMailServer-Spam"), "Spam message not detected as spam");
+
+         oSURBLServer.Active = false;
+         oSURBLServer.Save();
+      }
+
       [Test]
       public void TestSingleLineUrlFollowedByNewline()
       {
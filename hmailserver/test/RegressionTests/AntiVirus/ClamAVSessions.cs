@@ -0,0 +1,46 @@
+﻿using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+using hMailServer;
+
+namespace RegressionTests.AntiVirus
+{
+   /// <summary>
+   /// ClamAV session handling, tested against a simulated clamd so no real clamd is needed.
+   /// </summary>
+   [TestFixture]
+   public class ClamAVSessions : TestFixtureBase
+   {
+      [Test]
+      public void TestSessionIsReused()
+      {
+         int port = TestSetup.GetNextFreePort();
+
+         hMailServer.AntiVirus antiVirus = _settings.AntiVirus;
+         antiVirus.ClamAVHost = "localhost";
+         antiVirus.ClamAVPort = port;
+         antiVirus.ClamAVEnabled = true;
+
+         LogHandler.DeleteCurrentDefaultLog();
+
+         Account account1 = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         using (var clamd = new ClamdServerSimulator(1, port))
+         {
+            clamd.StartListen();
+
+            SmtpClientSimulator.StaticSend(account1.Address, account1.Address, "Mail 1", "Mail 1");
+            Pop3ClientSimulator.AssertMessageCount(account1.Address, "test", 1);
+
+            SmtpClientSimulator.StaticSend(account1.Address, account1.Address, "Mail 2", "Mail 2");
+            Pop3ClientSimulator.AssertMessageCount(account1.Address, "test", 2);
+
+            Assert.AreEqual(2, clamd.ScanCount);
+            Assert.AreEqual(1, clamd.ConnectionCount);
+         }
+
+         string defaultLog = LogHandler.ReadCurrentDefaultLog();
+         Assert.IsTrue(defaultLog.Contains("Reusing idle ClamAV session."));
+      }
+   }
+}
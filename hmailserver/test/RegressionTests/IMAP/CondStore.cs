@@ -0,0 +1,205 @@
+﻿using System.Text.RegularExpressions;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+using hMailServer;
+
+namespace RegressionTests.IMAP
+{
+   [TestFixture]
+   public class CondStore : TestFixtureBase
+   {
+      private Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+      }
+
+      [Test]
+      public void TestEnable()
+      {
+         var simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+
+         string result = simulator.SendSingleCommand("A01 ENABLE CONDSTORE QRESYNC");
+         Assert.IsTrue(result.Contains("* ENABLED CONDSTORE QRESYNC\r\n"), result);
+         Assert.IsTrue(result.Contains("A01 OK"), result);
+
+         // Extensions which are already enabled are not listed again.
+         result = simulator.SendSingleCommand("A02 ENABLE CONDSTORE");
+         Assert.IsTrue(result.Contains("* ENABLED\r\n"), result);
+         Assert.IsTrue(result.Contains("A02 OK"), result);
+
+         simulator.Disconnect();
+      }
+
+      [Test]
+      public void TestFetchChangedSince()
+      {
+         SendMessages(2);
+
+         var simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+
+         string result = simulator.SendSingleCommand("A01 SELECT INBOX (CONDSTORE)");
+         long highestModSeq = GetHighestModSeq(result);
+
+         Assert.IsTrue(simulator.SetSeenFlag(2));
+
+         result = simulator.SendSingleCommand("A02 FETCH 1:* (FLAGS) (CHANGEDSINCE " + highestModSeq + ")");
+         Assert.IsTrue(result.Contains("A02 OK"), result);
+         Assert.IsFalse(result.Contains("* 1 FETCH"), result);
+         Assert.IsTrue(result.Contains("* 2 FETCH"), result);
+         Assert.IsTrue(result.Contains("MODSEQ ("), result);
+
+         // Nothing has changed since the flag was set.
+         result = simulator.SendSingleCommand("A03 SELECT INBOX (CONDSTORE)");
+         long newHighestModSeq = GetHighestModSeq(result);
+         Assert.Greater(newHighestModSeq, highestModSeq);
+
+         result = simulator.SendSingleCommand("A04 FETCH 1:* (FLAGS) (CHANGEDSINCE " + newHighestModSeq + ")");
+         Assert.IsTrue(result.Contains("A04 OK"), result);
+         Assert.IsFalse(result.Contains(" FETCH ("), result);
+
+         simulator.Disconnect();
+      }
+
+      [Test]
+      public void TestFetchModifiersInAnyOrder()
+      {
+         SendMessages(2);
+
+         var simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+         simulator.SendSingleCommand("A01 ENABLE QRESYNC");
+
+         string result = simulator.SendSingleCommand("A02 SELECT INBOX");
+         long highestModSeq = GetHighestModSeq(result);
+
+         Assert.IsTrue(simulator.SetSeenFlag(2));
+
+         result = simulator.SendSingleCommand("A03 UID FETCH 1:* (FLAGS) (VANISHED CHANGEDSINCE " + highestModSeq + ")");
+         Assert.IsTrue(result.Contains("A03 OK"), result);
+         Assert.IsTrue(result.Contains("* 2 FETCH"), result);
+         Assert.IsTrue(result.Contains("MODSEQ ("), result);
+
+         result = simulator.SendSingleCommand("A04 UID FETCH 1:* (FLAGS) (CHANGEDSINCE " + highestModSeq + " VANISHED)");
+         Assert.IsTrue(result.Contains("A04 OK"), result);
+         Assert.IsTrue(result.Contains("* 2 FETCH"), result);
+
+         simulator.Disconnect();
+      }
+
+      [Test]
+      public void TestStoreUnchangedSince()
+      {
+         SendMessages(2);
+
+         var simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+
+         string result = simulator.SendSingleCommand("A01 SELECT INBOX (CONDSTORE)");
+         long highestModSeq = GetHighestModSeq(result);
+
+         // Someone changes the first message after the client looked at the folder.
+         result = simulator.SendSingleCommand("A02 STORE 1 +FLAGS (\\Flagged)");
+         Assert.IsTrue(result.Contains("A02 OK"), result);
+
+         result = simulator.SendSingleCommand("A03 STORE 1:2 (UNCHANGEDSINCE " + highestModSeq + ") +FLAGS (\\Seen)");
+         Assert.IsTrue(result.Contains("A03 OK [MODIFIED 1]"), result);
+
+         result = simulator.GetFlags(1);
+         Assert.IsFalse(result.Contains("\\Seen"), result);
+
+         result = simulator.GetFlags(2);
+         Assert.IsTrue(result.Contains("\\Seen"), result);
+
+         simulator.Disconnect();
+      }
+
+      [Test]
+      public void TestSelectQResyncReturnsVanished()
+      {
+         SendMessages(3);
+
+         var simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+
+         string result = simulator.SendSingleCommand("A01 SELECT INBOX (CONDSTORE)");
+         long highestModSeq = GetHighestModSeq(result);
+         long uidValidity = GetResponseCode(result, "UIDVALIDITY");
+
+         result = simulator.Fetch("1:3 (UID)");
+         string knownUids = GetUid(result, 1) + ":" + GetUid(result, 3);
+         long expungedUid = GetUid(result, 2);
+
+         Assert.IsTrue(simulator.SetDeletedFlag(2));
+         Assert.IsTrue(simulator.Expunge());
+         simulator.Disconnect();
+
+         // A client which was offline resynchronizes.
+         simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+         simulator.SendSingleCommand("A02 ENABLE QRESYNC");
+
+         result = simulator.SendSingleCommand(string.Format("A03 SELECT INBOX (QRESYNC ({0} {1} {2}))", uidValidity, highestModSeq, knownUids));
+         Assert.IsTrue(result.Contains("A03 OK"), result);
+         Assert.IsTrue(result.Contains("* VANISHED (EARLIER) " + expungedUid + "\r\n"), result);
+
+         simulator.Disconnect();
+      }
+
+      [Test]
+      public void TestExpungeReportedAsVanished()
+      {
+         SendMessages(2);
+
+         var simulator = new ImapClientSimulator();
+         simulator.ConnectAndLogon(_account.Address, "test");
+         simulator.SendSingleCommand("A01 ENABLE QRESYNC");
+         simulator.SendSingleCommand("A02 SELECT INBOX");
+
+         string result = simulator.Fetch("1 (UID)");
+         long expungedUid = GetUid(result, 1);
+
+         Assert.IsTrue(simulator.SetDeletedFlag(1));
+
+         simulator.Expunge(out result);
+         Assert.IsTrue(result.Contains("* VANISHED " + expungedUid + "\r\n"), result);
+         Assert.IsFalse(result.Contains("EXPUNGE\r\n"), result);
+
+         simulator.Disconnect();
+      }
+
+      private void SendMessages(int count)
+      {
+         for (int i = 0; i < count; i++)
+            SmtpClientSimulator.StaticSend("test@test.com", _account.Address, "Test " + i, "Body " + i);
+
+         ImapClientSimulator.AssertMessageCount(_account.Address, "test", "Inbox", count);
+      }
+
+      private static long GetHighestModSeq(string response)
+      {
+         return GetResponseCode(response, "HIGHESTMODSEQ");
+      }
+
+      private static long GetResponseCode(string response, string code)
+      {
+         var match = Regex.Match(response, @"\[" + code + @" (\d+)\]");
+         Assert.IsTrue(match.Success, response);
+
+         return long.Parse(match.Groups[1].Value);
+      }
+
+      private static long GetUid(string response, int index)
+      {
+         var match = Regex.Match(response, @"\* " + index + @" FETCH \(.*UID (\d+)");
+         Assert.IsTrue(match.Success, response);
+
+         return long.Parse(match.Groups[1].Value);
+      }
+   }
+}
@@ -274,5 +274,212 @@ namespace RegressionTests.IMAP
          result = sim.Fetch("-100 BODY[1]");
          Assert.IsTrue(result.StartsWith("A17 BAD"));
       }
+
+      [Test]
+      public void TestFetchNestedMultipartParts()
+      {
+         Account account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         string body = "preamble\r\n" +
+                       "--outer\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "First part\r\n" +
+                       "--outer\r\n" +
+                       "Content-Type: multipart/alternative; boundary=\"inner\"\r\n" +
+                       "\r\n" +
+                       "--inner\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "Inner plain\r\n" +
+                       "--inner\r\n" +
+                       "Content-Type: text/html\r\n" +
+                       "\r\n" +
+                       "<p>Inner html</p>\r\n" +
+                       "--inner--\r\n" +
+                       "--outer\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "Last part\r\n" +
+                       "\r\n" +
+                       "--outer--\r\n" +
+                       "epilogue";
+
+         SendMultipart(account.Address, "multipart/mixed; boundary=\"outer\"", body);
+
+         var sim = new ImapClientSimulator();
+         sim.ConnectAndLogon(account.Address, "test");
+         sim.SelectFolder("INBOX");
+
+         Assert.AreEqual("First part", GetLiteral(sim.Fetch("1 BODY.PEEK[1]")));
+         Assert.AreEqual("Inner plain", GetLiteral(sim.Fetch("1 BODY.PEEK[2.1]")));
+         Assert.AreEqual("<p>Inner html</p>", GetLiteral(sim.Fetch("1 BODY.PEEK[2.2]")));
+
+         // The line break before the boundary belongs to the boundary, so only the empty line remains.
+         Assert.AreEqual("Last part\r\n", GetLiteral(sim.Fetch("1 BODY.PEEK[3]")));
+
+         Assert.AreEqual(body + "\r\n", GetLiteral(sim.Fetch("1 BODY.PEEK[TEXT]")));
+
+         sim.Disconnect();
+      }
+
+      [Test]
+      public void TestFetchPartsWithoutTrailingLineBreak()
+      {
+         Account account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         // The last part is never closed, so it ends where the message ends.
+         string body = "--boundary\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "No line break--boundary\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "Still the first part\r\n" +
+                       "--boundary\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "Unterminated";
+
+         SendMultipart(account.Address, "multipart/mixed; boundary=\"boundary\"", body);
+
+         var sim = new ImapClientSimulator();
+         sim.ConnectAndLogon(account.Address, "test");
+         sim.SelectFolder("INBOX");
+
+         // A boundary which does not start a line is part of the content.
+         Assert.AreEqual("No line break--boundary\r\nContent-Type: text/plain\r\n\r\nStill the first part",
+                         GetLiteral(sim.Fetch("1 BODY.PEEK[1]")));
+         Assert.AreEqual("Unterminated\r\n", GetLiteral(sim.Fetch("1 BODY.PEEK[2]")));
+
+         sim.Disconnect();
+      }
+
+      [Test]
+      public void TestPartialFetchCrossingPartBoundaries()
+      {
+         Account account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         string body = "--boundary\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "First part\r\n" +
+                       "--boundary\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "Second part\r\n" +
+                       "--boundary--\r\n";
+
+         SendMultipart(account.Address, "multipart/mixed; boundary=\"boundary\"", body);
+
+         var sim = new ImapClientSimulator();
+         sim.ConnectAndLogon(account.Address, "test");
+         sim.SelectFolder("INBOX");
+
+         // A window which starts in the first part and ends in the second.
+         string text = body + "\r\n";
+         int start = text.IndexOf("part\r\n--boundary");
+         int length = text.IndexOf("Second") + 3 - start;
+
+         Assert.AreEqual(text.Substring(start, length),
+                         GetLiteral(sim.Fetch(string.Format("1 BODY.PEEK[TEXT]<{0}.{1}>", start, length))));
+
+         // A window which starts in the header and ends in the first part.
+         string message = GetLiteral(sim.Fetch("1 BODY.PEEK[]"));
+         start = message.IndexOf("Subject:");
+         length = message.IndexOf("First part") + 5 - start;
+
+         Assert.AreEqual(message.Substring(start, length),
+                         GetLiteral(sim.Fetch(string.Format("1 BODY.PEEK[]<{0}.{1}>", start, length))));
+
+         // A window which goes beyond the end of a part is cut where the part ends.
+         Assert.AreEqual("part", GetLiteral(sim.Fetch("1 BODY.PEEK[1]<6.100>")));
+         Assert.AreEqual("Second", GetLiteral(sim.Fetch("1 BODY.PEEK[2]<0.6>")));
+
+         sim.Disconnect();
+      }
+
+      [Test]
+      public void TestFetchPartsWithTransportPaddedBoundaries()
+      {
+         Account account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         string body = "--boundary \t \r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "First part\r\n" +
+                       "--boundary  \r\n" +
+                       "Content-Type: text/html\r\n" +
+                       "\r\n" +
+                       "<p>Second part</p>\r\n" +
+                       "--boundary--\t\r\n" +
+                       "epilogue";
+
+         SendMultipart(account.Address, "multipart/mixed; boundary=\"boundary\"", body);
+
+         var sim = new ImapClientSimulator();
+         sim.ConnectAndLogon(account.Address, "test");
+         sim.SelectFolder("INBOX");
+
+         Assert.AreEqual("First part", GetLiteral(sim.Fetch("1 BODY.PEEK[1]")));
+         Assert.AreEqual("<p>Second part</p>", GetLiteral(sim.Fetch("1 BODY.PEEK[2]")));
+
+         string bodyStructure = sim.Fetch("1 BODYSTRUCTURE");
+         Assert.IsTrue(bodyStructure.Contains("\"html\""), bodyStructure);
+
+         sim.Disconnect();
+      }
+
+      [Test]
+      public void FetchAfterMessageIsResavedWithSameSizeShouldReturnNewContent()
+      {
+         Account account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         SmtpClientSimulator.StaticSend(account.Address, account.Address, "Test", "SampleBody1");
+         ImapClientSimulator.AssertMessageCount(account.Address, "test", "Inbox", 1);
+
+         var sim = new ImapClientSimulator();
+         sim.ConnectAndLogon(account.Address, "test");
+         sim.SelectFolder("INBOX");
+
+         // Let the server cache the structure of the message.
+         string result = sim.Fetch("1 (BODYSTRUCTURE BODY.PEEK[1])");
+         Assert.IsTrue(result.Contains("SampleBody1"), result);
+
+         // Replace the body with one of the same length.
+         hMailServer.Message message = account.IMAPFolders.get_ItemByName("INBOX").Messages[0];
+         message.Body = "SampleBody2";
+         message.Save();
+
+         result = sim.Fetch("1 BODY.PEEK[1]");
+         Assert.IsTrue(result.Contains("SampleBody2"), result);
+
+         sim.Disconnect();
+      }
+
+      private static void SendMultipart(string address, string contentType, string body)
+      {
+         string message = "From: " + address + "\r\n" +
+                          "To: " + address + "\r\n" +
+                          "Subject: Parts\r\n" +
+                          "MIME-Version: 1.0\r\n" +
+                          "Content-Type: " + contentType + "\r\n" +
+                          "\r\n" +
+                          body;
+
+         SmtpClientSimulator.StaticSendRaw(address, address, message);
+         ImapClientSimulator.AssertMessageCount(address, "test", "Inbox", 1);
+      }
+
+      private static string GetLiteral(string response)
+      {
+         int start = response.IndexOf('{');
+         Assert.IsTrue(start >= 0, response);
+
+         int end = response.IndexOf("}\r\n", start);
+         int length = int.Parse(response.Substring(start + 1, end - start - 1));
+
+         return response.Substring(end + 3, length);
+      }
    }
 }
\ No newline at end of file
@@ -57,6 +57,23 @@ namespace RegressionTests.IMAP
          message.Save();
       }
 
+      [Test]
+      public void TestIndexingStatus()
+      {
+         Account account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "meta'data@test.com", "test");
+
+         for (int i = 0; i < 5; i++)
+            SendMessage("Test " + i, "Body", "", "");
+
+         ImapClientSimulator.AssertMessageCount(account.Address, "test", "Inbox", 5);
+
+         AssertAllMessagesIndexed();
+
+         Assert.AreEqual(0, _indexing.Backlog);
+         Assert.AreEqual(0, _indexing.EstimatedSecondsRemaining);
+         Assert.GreaterOrEqual(_indexing.IndexingRate, 0);
+      }
+
       [Test]
       [Description("Test message metadata date")]
       public void TestMetaDataSortCC()
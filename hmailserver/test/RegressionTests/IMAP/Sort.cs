@@ -241,6 +241,59 @@ namespace RegressionTests.IMAP
          Assert.AreEqual("1 2", oSimulator.Sort("(REVERSE SIZE) UTF-8 ALL"));
       }
 
+      [Test]
+      public void TestSortMultipleCriteria()
+      {
+         Account oAccount = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "imapsort@test.com", "test");
+         var oSimulator = new ImapClientSimulator();
+
+         oSimulator.Connect();
+         oSimulator.LogonWithLiteral("imapsort@test.com", "test");
+         Assert.IsTrue(oSimulator.SelectFolder("Inbox"));
+
+         AppendMessage(oSimulator, "Subject: b\r\n\r\nShort", 1);
+         AppendMessage(oSimulator, "Subject: a\r\n\r\nBody", 2);
+         AppendMessage(oSimulator, "Subject: b\r\n\r\nA longer body", 3);
+
+         // Messages with the same subject are ordered on the second criterion.
+         Assert.AreEqual("2 1 3", oSimulator.Sort("(SUBJECT SIZE) US-ASCII ALL"));
+         Assert.AreEqual("2 3 1", oSimulator.Sort("(SUBJECT REVERSE SIZE) US-ASCII ALL"));
+         Assert.AreEqual("3 1 2", oSimulator.Sort("(REVERSE SUBJECT REVERSE SIZE) UTF-8 ALL"));
+
+         oSimulator.Disconnect();
+      }
+
+      [Test]
+      public void TestSortOnBaseSubject()
+      {
+         Account oAccount = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "imapsort@test.com", "test");
+         var oSimulator = new ImapClientSimulator();
+
+         oSimulator.Connect();
+         oSimulator.LogonWithLiteral("imapsort@test.com", "test");
+         Assert.IsTrue(oSimulator.SelectFolder("Inbox"));
+
+         AppendMessage(oSimulator, "Subject: Re: [list] Re: c\r\n\r\nBody", 1);
+         AppendMessage(oSimulator, "Subject: b\r\n\r\nBody", 2);
+         AppendMessage(oSimulator, "Subject: [Fwd: a]\r\n\r\nBody", 3);
+         AppendMessage(oSimulator, "Subject: Fwd: a (fwd)\r\n\r\nBody", 4);
+
+         // RFC 5256: Reply and forward markers are ignored, and messages with equal
+         // base subjects are returned in mailbox order, also when sorting in reverse.
+         Assert.AreEqual("3 4 2 1", oSimulator.Sort("(SUBJECT) US-ASCII ALL"));
+         Assert.AreEqual("1 2 3 4", oSimulator.Sort("(REVERSE SUBJECT) US-ASCII ALL"));
+
+         oSimulator.Disconnect();
+      }
+
+      private static void AppendMessage(ImapClientSimulator simulator, string message, int expectedMessageCount)
+      {
+         string response = simulator.SendSingleCommandWithLiteral(
+            string.Format("A04 APPEND INBOX {{{0}}}", message.Length), message);
+
+         Assert.IsTrue(response.Contains(string.Format("* {0} EXISTS", expectedMessageCount)), response);
+      }
+
       [Test]
       public void TestSortSubject()
       {
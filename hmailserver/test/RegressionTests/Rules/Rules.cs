@@ -637,6 +637,59 @@ namespace RegressionTests.Rules
             throw new Exception("Message header not set");
       }
 
+      [Test]
+      public void ActionSetHeaderShouldKeepBody()
+      {
+         Account oAccount = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "ruletest@test.com", "test");
+
+         Rule oRule = oAccount.Rules.Add();
+         oRule.Name = "Criteria test";
+         oRule.Active = true;
+
+         RuleCriteria oRuleCriteria = oRule.Criterias.Add();
+         oRuleCriteria.UsePredefined = false;
+         oRuleCriteria.HeaderField = "Subject";
+         oRuleCriteria.MatchType = eRuleMatchType.eMTContains;
+         oRuleCriteria.MatchValue = "TestString";
+         oRuleCriteria.Save();
+
+         RuleAction oRuleAction = oRule.Actions.Add();
+         oRuleAction.Type = eRuleActionType.eRASetHeaderValue;
+         oRuleAction.HeaderName = "SomeHeader";
+         oRuleAction.Value = "SomeValue";
+         oRuleAction.Save();
+
+         oRule.Save();
+
+         // Only the header is needed by the rule, so the body should be written back as it was sent.
+         string body = "--boundary\r\n" +
+                       "Content-Type: text/plain\r\n" +
+                       "\r\n" +
+                       "Text part\r\n" +
+                       "--boundary\r\n" +
+                       "Content-Type: application/octet-stream\r\n" +
+                       "Content-Transfer-Encoding: base64\r\n" +
+                       "Content-Disposition: attachment; filename=\"test.bin\"\r\n" +
+                       "\r\n" +
+                       "AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8=\r\n" +
+                       "--boundary--\r\n";
+
+         string message = "From: ruletest@test.com\r\n" +
+                          "To: ruletest@test.com\r\n" +
+                          "Subject: TestString\r\n" +
+                          "MIME-Version: 1.0\r\n" +
+                          "Content-Type: multipart/mixed; boundary=\"boundary\"\r\n" +
+                          "\r\n" +
+                          body;
+
+         SmtpClientSimulator.StaticSendRaw("ruletest@test.com", "ruletest@test.com", message);
+
+         string sContents = Pop3ClientSimulator.AssertGetFirstMessageText("ruletest@test.com", "test");
+
+         Assert.IsTrue(sContents.Contains("SomeHeader: SomeValue"), sContents);
+         Assert.IsTrue(sContents.Contains(body), sContents);
+      }
+
       [Test]
       public void CriteriaContains()
       {
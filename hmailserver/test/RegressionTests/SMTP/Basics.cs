@@ -55,9 +55,13 @@ namespace RegressionTests.SMTP
          sock.Send(EncodeBase64("test") + "\r\n");
          Assert.IsTrue(sock.Receive().StartsWith("235"));
 
-         DateTime lastLogonTimeAfter =
-            Convert.ToDateTime(SingletonProvider<TestSetup>.Instance.GetApp().Domains[0].Accounts[0].LastLogonTime);
-         Assert.AreNotEqual(lastLogonTimeBefore, lastLogonTimeAfter);
+         // The last logon time is written to the database a few seconds after the logon.
+         RetryHelper.TryAction(TimeSpan.FromSeconds(10), () =>
+            {
+               DateTime lastLogonTimeAfter =
+                  Convert.ToDateTime(SingletonProvider<TestSetup>.Instance.GetApp().Domains[0].Accounts[0].LastLogonTime);
+               Assert.AreNotEqual(lastLogonTimeBefore, lastLogonTimeAfter);
+            });
       }
 
 
@@ -293,5 +293,87 @@ namespace RegressionTests.SMTP
          ImapClientSimulator.AssertMessageCount("outsider1@test.com", "test", "Inbox", 1); // Included in To list
          ImapClientSimulator.AssertMessageCount("outsider2@test.com", "test", "Inbox", 1); // Included in To list
       }
+
+      [Test]
+      public void TestSelfNestedListsDeliverOncePerMember()
+      {
+         var test = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+         SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "acc1@test.com", "test");
+         SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "acc2@test.com", "test");
+
+         // list1 contains itself, and also list2 which points back at list1.
+         DistributionList list1 = SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, "list1@test.com",
+            new List<string> { "acc1@test.com", "list1@test.com", "list2@test.com" });
+         list1.Mode = eDistributionListMode.eLMPublic;
+         list1.Save();
+
+         DistributionList list2 = SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, "list2@test.com",
+            new List<string> { "acc2@test.com", "list1@test.com", "acc1@test.com" });
+         list2.Mode = eDistributionListMode.eLMPublic;
+         list2.Save();
+
+         // Each list and one of the members is given in a separate RCPT TO.
+         var recipients = new List<string> { "list1@test.com", "acc1@test.com", "list2@test.com" };
+
+         var smtpClient = new SmtpClientSimulator();
+         smtpClient.Send(test.Address, recipients, "test", "test");
+
+         CustomAsserts.AssertRecipientsInDeliveryQueue(0);
+
+         ImapClientSimulator.AssertMessageCount("acc1@test.com", "test", "Inbox", 1);
+         ImapClientSimulator.AssertMessageCount("acc2@test.com", "test", "Inbox", 1);
+      }
+
+      [Test]
+      public void TestDiamondNestedListsDeliverOncePerMember()
+      {
+         var test = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+         SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "acc1@test.com", "test");
+         SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "acc2@test.com", "test");
+         SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "acc3@test.com", "test");
+         SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "acc4@test.com", "test");
+
+         // top contains left and right, which share acc2.
+         DistributionList top = SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, "top@test.com",
+            new List<string> { "left@test.com", "right@test.com" });
+         top.Mode = eDistributionListMode.eLMPublic;
+         top.Save();
+
+         DistributionList left = SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, "left@test.com",
+            new List<string> { "acc1@test.com", "acc2@test.com" });
+         left.Mode = eDistributionListMode.eLMPublic;
+         left.Save();
+
+         DistributionList right = SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, "right@test.com",
+            new List<string> { "acc2@test.com", "acc3@test.com" });
+         right.Mode = eDistributionListMode.eLMPublic;
+         right.Save();
+
+         var smtpClient = new SmtpClientSimulator();
+         smtpClient.Send(test.Address, new List<string> { "top@test.com", "left@test.com" }, "Mail 1", "Mail 1");
+
+         CustomAsserts.AssertRecipientsInDeliveryQueue(0);
+
+         ImapClientSimulator.AssertMessageCount("acc1@test.com", "test", "Inbox", 1);
+         ImapClientSimulator.AssertMessageCount("acc2@test.com", "test", "Inbox", 1);
+         ImapClientSimulator.AssertMessageCount("acc3@test.com", "test", "Inbox", 1);
+
+         // Move acc3 out of right and add acc4 to left. The next message should
+         // be sent to the new members.
+         right.Recipients.Delete(1);
+
+         DistributionListRecipient recipient = left.Recipients.Add();
+         recipient.RecipientAddress = "acc4@test.com";
+         recipient.Save();
+
+         smtpClient.Send(test.Address, new List<string> { "top@test.com", "left@test.com" }, "Mail 2", "Mail 2");
+
+         CustomAsserts.AssertRecipientsInDeliveryQueue(0);
+
+         ImapClientSimulator.AssertMessageCount("acc1@test.com", "test", "Inbox", 2);
+         ImapClientSimulator.AssertMessageCount("acc2@test.com", "test", "Inbox", 2);
+         ImapClientSimulator.AssertMessageCount("acc3@test.com", "test", "Inbox", 1);
+         ImapClientSimulator.AssertMessageCount("acc4@test.com", "test", "Inbox", 1);
+      }
    }
 }
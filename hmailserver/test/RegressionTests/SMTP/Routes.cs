@@ -191,6 +191,50 @@ namespace RegressionTests.SMTP
          }
       }
 
+      [Test]
+      public void RouteShouldMatchNewDomainNameAfterChange()
+      {
+         var deliveryResultsFirst = new Dictionary<string, int>();
+         deliveryResultsFirst["user@other.example.com"] = 250;
+
+         var deliveryResultsSecond = new Dictionary<string, int>();
+         deliveryResultsSecond["user@stuff.example.com"] = 250;
+
+         int smtpServerPort = TestSetup.GetNextFreePort();
+         using (var server = new SmtpServerSimulator(2, smtpServerPort))
+         {
+            server.AddRecipientResult(deliveryResultsFirst);
+            server.AddRecipientResult(deliveryResultsSecond);
+            server.StartListen();
+
+            Route route = _settings.Routes.Add();
+            route.DomainName = "other.example.com";
+            route.TargetSMTPHost = "localhost";
+            route.TargetSMTPPort = smtpServerPort;
+            route.NumberOfTries = 1;
+            route.MinutesBetweenTry = 5;
+            route.TreatRecipientAsLocalDomain = true;
+            route.TreatSenderAsLocalDomain = true;
+            route.AllAddresses = true;
+            route.Save();
+
+            // Look up the route once, so that the routes are compiled before the change.
+            var smtpClient = new SmtpClientSimulator();
+            smtpClient.Send("example@example.com", "user@other.example.com", "Test", "Test message");
+            CustomAsserts.AssertRecipientsInDeliveryQueue(0);
+
+            route.DomainName = "*.example.com";
+            route.Save();
+
+            smtpClient.Send("example@example.com", "user@stuff.example.com", "Test", "Second message");
+            CustomAsserts.AssertRecipientsInDeliveryQueue(0);
+
+            server.WaitForCompletion();
+
+            Assert.IsTrue(server.MessageData.Contains("Second message"));
+         }
+      }
+
       [Test]
       [Description("If a client attempts to deliver to a route, but the recipient is not in the route list an error should be returned.")]
       public void RecipientNotInListShouldReturnError()
@@ -243,5 +287,68 @@ namespace RegressionTests.SMTP
             Assert.IsTrue(server.MessageData.Contains("Test message"));
          }
       }
+
+      [Test]
+      [Description("Exact, wildcard domain and other wildcard routes in different orders. The first matching route in the collection should be used.")]
+      public void FirstMatchingRouteShouldBeUsed()
+      {
+         AssertFirstMatchingRouteIsUsed(new[] { "mail.example.com", "*.example.com", "*" }, 0);
+         AssertFirstMatchingRouteIsUsed(new[] { "*.example.com", "mail.example.com", "*" }, 0);
+         AssertFirstMatchingRouteIsUsed(new[] { "*", "*.example.com", "mail.example.com" }, 0);
+         AssertFirstMatchingRouteIsUsed(new[] { "other.example.com", "mail.ex*.com", "*.example.com" }, 1);
+         AssertFirstMatchingRouteIsUsed(new[] { "*.other.com", "ex*.com", "mail.example.com", "*" }, 2);
+         AssertFirstMatchingRouteIsUsed(new[] { "ex*.com", "*.other.com", "m*.com", "*.example.com", "mail.example.com" }, 2);
+      }
+
+      private void AssertFirstMatchingRouteIsUsed(string[] domainNames, int expectedRoute)
+      {
+         SingletonProvider<TestSetup>.Instance.RemoveAllRoutes();
+
+         // One server per route, so that we can tell which route was used.
+         var servers = new List<SmtpServerSimulator>();
+
+         try
+         {
+            foreach (string domainName in domainNames)
+            {
+               var deliveryResults = new Dictionary<string, int>();
+               deliveryResults["user@mail.example.com"] = 250;
+
+               int smtpServerPort = TestSetup.GetNextFreePort();
+
+               var server = new SmtpServerSimulator(1, smtpServerPort);
+               server.AddRecipientResult(deliveryResults);
+               server.StartListen();
+               servers.Add(server);
+
+               Route route = _settings.Routes.Add();
+               route.DomainName = domainName;
+               route.TargetSMTPHost = "localhost";
+               route.TargetSMTPPort = smtpServerPort;
+               route.NumberOfTries = 1;
+               route.MinutesBetweenTry = 5;
+               route.TreatRecipientAsLocalDomain = true;
+               route.TreatSenderAsLocalDomain = true;
+               route.AllAddresses = true;
+               route.Save();
+            }
+
+            var smtpClient = new SmtpClientSimulator();
+            smtpClient.Send("example@example.com", "user@mail.example.com", "Test", "Test message");
+            CustomAsserts.AssertRecipientsInDeliveryQueue(0);
+
+            servers[expectedRoute].WaitForCompletion();
+
+            string routes = string.Join(", ", domainNames);
+
+            for (int i = 0; i < servers.Count; i++)
+               Assert.AreEqual(i == expectedRoute, servers[i].MessageData.Contains("Test message"), routes);
+         }
+         finally
+         {
+            foreach (var server in servers)
+               server.Dispose();
+         }
+      }
    }
 }
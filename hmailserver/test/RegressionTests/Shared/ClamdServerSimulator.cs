@@ -0,0 +1,129 @@
+﻿// Copyright (c) 2010 Martin Knafve / hMailServer.com.  
+// http://www.hmailserver.com
+
+using System;
+using System.IO;
+using System.Text;
+using System.Threading;
+using hMailServer;
+
+namespace RegressionTests.Shared
+{
+   /// <summary>
+   /// Minimal clamd speaking the IDSESSION / INSTREAM subset used by hMailServer.
+   /// Every stream is reported clean.
+   /// </summary>
+   internal class ClamdServerSimulator : TcpServer
+   {
+      private int _connectionCount;
+      private int _scanCount;
+
+      public ClamdServerSimulator(int maxNumberOfConnections, int port) :
+         base(maxNumberOfConnections, port, eConnectionSecurity.eCSNone)
+      {
+      }
+
+      public int ConnectionCount
+      {
+         get { return _connectionCount; }
+      }
+
+      public int ScanCount
+      {
+         get { return _scanCount; }
+      }
+
+      protected override void HandleClient()
+      {
+         Interlocked.Increment(ref _connectionCount);
+
+         try
+         {
+            Run();
+         }
+         catch (IOException)
+         {
+            // Client disconnected or the simulator was disposed.
+         }
+         catch (ObjectDisposedException)
+         {
+         }
+      }
+
+      private void Run()
+      {
+         if (ReadCommand() != "nIDSESSION")
+            return;
+
+         // Replies within a session are prefixed with the number of the command.
+         int commandNumber = 0;
+
+         while (true)
+         {
+            string command = ReadCommand();
+            if (command == null)
+               return;
+
+            commandNumber++;
+
+            if (command == "nPING")
+            {
+               _tcpConnection.Send(string.Format("{0}: PONG\n", commandNumber));
+            }
+            else if (command == "nINSTREAM")
+            {
+               if (!ReadStream())
+                  return;
+
+               Interlocked.Increment(ref _scanCount);
+               _tcpConnection.Send(string.Format("{0}: stream: OK\n", commandNumber));
+            }
+            else if (command == "nEND")
+            {
+               return;
+            }
+            else
+            {
+               _tcpConnection.Send(string.Format("{0}: UNKNOWN COMMAND ERROR\n", commandNumber));
+               return;
+            }
+         }
+      }
+
+      private string ReadCommand()
+      {
+         var command = new StringBuilder();
+
+         while (true)
+         {
+            byte[] data = _tcpConnection.ReceiveBytes(1);
+            if (data == null)
+               return null;
+
+            if (data[0] == '\n')
+               return command.ToString();
+
+            command.Append((char) data[0]);
+         }
+      }
+
+      private bool ReadStream()
+      {
+         // Chunks are prefixed with their length as a 4 byte unsigned integer in network
+         // byte order. A zero length chunk terminates the stream.
+         while (true)
+         {
+            byte[] length = _tcpConnection.ReceiveBytes(4);
+            if (length == null)
+               return false;
+
+            int chunkLength = (length[0] << 24) | (length[1] << 16) | (length[2] << 8) | length[3];
+            if (chunkLength == 0)
+               return true;
+
+            if (_tcpConnection.ReceiveBytes(chunkLength) == null)
+               return false;
+         }
+      }
+   }
+}
@@ -3,6 +3,7 @@
 
 using System;
 using System.Collections.Generic;
+using System.IO;
 using System.Net;
 using System.Net.Security;
 using System.Net.Sockets;
@@ -270,6 +271,28 @@ namespace RegressionTests.Shared
 
       }
 
+      /// <summary>
+      /// Reads exactly count bytes. Returns null if the remote end closes the connection first.
+      /// </summary>
+      public byte[] ReceiveBytes(int count)
+      {
+         Stream stream = _useSslSocket ? (Stream) _sslStream : _tcpClient.GetStream();
+
+         var buffer = new byte[count];
+         int offset = 0;
+
+         while (offset < count)
+         {
+            int bytesRead = stream.Read(buffer, offset, count - offset);
+            if (bytesRead == 0)
+               return null;
+
+            offset += bytesRead;
+         }
+
+         return buffer;
+      }
+
       public bool Peek()
       {
          return _tcpClient.Available > 0;
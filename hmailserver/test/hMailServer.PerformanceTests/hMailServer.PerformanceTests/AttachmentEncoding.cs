@@ -0,0 +1,142 @@
+﻿using System;
+using System.IO;
+using System.Text;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   [TestFixture]
+   public class AttachmentEncoding : PerformanceTestFixtureBase
+   {
+      private const int MessageCount = 20;
+      private const int AttachmentCount = 5;
+      private const int AttachmentSize = 1024 * 1024;
+
+      private hMailServer.Account _account;
+      private string _tempDirectory;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         _tempDirectory = Path.Combine(Path.GetTempPath(), Guid.NewGuid().ToString());
+         Directory.CreateDirectory(_tempDirectory);
+      }
+
+      [TearDown]
+      public new void TearDown()
+      {
+         Directory.Delete(_tempDirectory, true);
+      }
+
+      [Test]
+      public void Encode20MessagesWith5AttachmentsEach()
+      {
+         var random = new Random(0);
+
+         var attachments = new string[AttachmentCount];
+         for (int i = 0; i < AttachmentCount; i++)
+         {
+            var content = new byte[AttachmentSize];
+            random.NextBytes(content);
+
+            attachments[i] = Path.Combine(_tempDirectory, string.Format("attachment{0}.bin", i));
+            File.WriteAllBytes(attachments[i], content);
+         }
+
+         MeasureTime("Encode attachments", () =>
+            {
+               for (int i = 0; i < MessageCount; i++)
+               {
+                  var message = new hMailServer.Message();
+                  message.AddRecipient("test", _account.Address);
+                  message.FromAddress = _account.Address;
+                  message.Subject = "Message " + i;
+                  message.Body = "Message body";
+
+                  foreach (var attachment in attachments)
+                     message.Attachments.Add(attachment);
+
+                  message.Save();
+               }
+            });
+
+         CustomAsserts.AssertFolderMessageCount(_account.IMAPFolders.get_ItemByName("INBOX"), MessageCount);
+      }
+
+      [Test]
+      public void Decode20MessagesWith5AttachmentsEach()
+      {
+         // Every message has base64 encoded attachments and a long quoted-printable body.
+         for (int i = 0; i < MessageCount; i++)
+            SmtpClientSimulator.StaticSendRaw("test@test.com", "test@test.com", CreateMessage(i));
+
+         Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", MessageCount);
+
+         var messages = _account.IMAPFolders.get_ItemByName("INBOX").Messages;
+
+         MeasureTime("Decode attachments", () =>
+            {
+               for (int i = 0; i < MessageCount; i++)
+               {
+                  var message = messages[i];
+
+                  for (int attachment = 0; attachment < AttachmentCount; attachment++)
+                     message.Attachments[attachment].SaveAs(Path.Combine(_tempDirectory, string.Format("{0}-{1}.bin", i, attachment)));
+               }
+            });
+
+         MeasureTime("Decode quoted-printable bodies", () =>
+            {
+               for (int i = 0; i < MessageCount; i++)
+                  Assert.IsTrue(messages[i].Body.Contains("Message body"));
+            });
+
+         var saved = new FileInfo(Path.Combine(_tempDirectory, "0-0.bin"));
+         Assert.AreEqual(AttachmentSize, saved.Length);
+      }
+
+      private static string CreateMessage(int index)
+      {
+         var random = new Random(index);
+
+         var message = new StringBuilder();
+         message.Append("From: test@test.com\r\n");
+         message.Append("To: test@test.com\r\n");
+         message.AppendFormat("Subject: Message {0}\r\n", index);
+         message.Append("MIME-Version: 1.0\r\n");
+         message.Append("Content-Type: multipart/mixed; boundary=\"mixed-boundary\"\r\n");
+         message.Append("\r\n");
+         message.Append("This is a multi-part message.\r\n");
+         message.Append("--mixed-boundary\r\n");
+         message.Append("Content-Type: text/plain; charset=\"utf-8\"\r\n");
+         message.Append("Content-Transfer-Encoding: quoted-printable\r\n");
+         message.Append("\r\n");
+         message.Append("Message body\r\n");
+
+         for (int line = 0; line < 10000; line++)
+            message.Append("R=C3=A4ksm=C3=B6rg=C3=A5s and some plain text which makes up most of the=\r\n line\r\n");
+
+         for (int attachment = 0; attachment < AttachmentCount; attachment++)
+         {
+            var content = new byte[AttachmentSize];
+            random.NextBytes(content);
+
+            message.Append("--mixed-boundary\r\n");
+            message.Append("Content-Type: application/octet-stream\r\n");
+            message.Append("Content-Transfer-Encoding: base64\r\n");
+            message.AppendFormat("Content-Disposition: attachment; filename=\"attachment{0}.bin\"\r\n", attachment);
+            message.Append("\r\n");
+            message.Append(Convert.ToBase64String(content, Base64FormattingOptions.InsertLineBreaks));
+            message.Append("\r\n");
+         }
+
+         message.Append("--mixed-boundary--\r\n");
+
+         return message.ToString();
+      }
+   }
+}
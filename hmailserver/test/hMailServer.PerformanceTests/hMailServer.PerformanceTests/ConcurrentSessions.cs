@@ -0,0 +1,68 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Threading.Tasks;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   /// <summary>
+   /// Run once with IOServicePerThread=0 and once with IOServicePerThread=1 in hMailServer.ini
+   /// to compare the shared io_service with one io_service per thread.
+   /// </summary>
+   [TestFixture]
+   public class ConcurrentSessions : PerformanceTestFixtureBase
+   {
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         _settings.MaxIMAPConnections = 0;
+      }
+
+      [Test]
+      public void Send1000MessagesWith10000IdleImapSessions()
+      {
+         var idleSessions = new List<ImapClientSimulator>();
+
+         try
+         {
+            MeasureTime("Open 10000 IMAP sessions", () =>
+               {
+                  for (int i = 0; i < 10000; i++)
+                  {
+                     var simulator = new ImapClientSimulator();
+                     simulator.ConnectAndLogon("test@test.com", "test");
+                     simulator.SelectFolder("INBOX");
+                     idleSessions.Add(simulator);
+                  }
+               });
+
+            MeasureTime("Send 1000 messages on 5 threads", () =>
+               {
+                  var parallellOptions = new ParallelOptions() { MaxDegreeOfParallelism = 5 };
+
+                  Parallel.For(0, 1000, parallellOptions, i =>
+                     SmtpClientSimulator.StaticSend("test@test.com", "test@test.com", "Test", "Test message"));
+
+                  Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", 1000);
+               });
+
+            MeasureTime("NOOP on 10000 IMAP sessions", () =>
+               {
+                  foreach (var simulator in idleSessions)
+                     simulator.SendSingleCommand("A01 NOOP");
+               });
+         }
+         finally
+         {
+            foreach (var simulator in idleSessions)
+               simulator.Disconnect();
+         }
+      }
+   }
+}
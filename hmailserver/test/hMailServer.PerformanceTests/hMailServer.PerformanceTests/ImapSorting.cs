@@ -0,0 +1,45 @@
+﻿using System;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   [TestFixture]
+   public class ImapSorting : PerformanceTestFixtureBase
+   {
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+      }
+
+      [Test]
+      public void Sort100000Messages()
+      {
+         var random = new Random(1);
+
+         IMAPFolder folder = _account.IMAPFolders.get_ItemByName("INBOX");
+
+         for (int i = 0; i < 100000; i++)
+         {
+            hMailServer.Message message = folder.Messages.Add();
+            message.Subject = string.Format("Re: Subject {0}", random.Next(1000));
+            message.FromAddress = string.Format("sender{0}@example.com", random.Next(1000));
+            message.Body = new string('a', random.Next(100, 5000));
+            message.Save();
+         }
+
+         var simulator = new ImapClientSimulator("test@test.com", "test", "INBOX");
+
+         MeasureTime("(SUBJECT)", () => simulator.Sort("(SUBJECT) UTF-8 ALL"));
+         MeasureTime("(FROM SIZE)", () => simulator.Sort("(FROM SIZE) UTF-8 ALL"));
+         MeasureTime("(REVERSE DATE SUBJECT)", () => simulator.Sort("(REVERSE DATE SUBJECT) US-ASCII ALL"));
+         MeasureTime("(ARRIVAL)", () => simulator.Sort("(ARRIVAL) US-ASCII ALL"));
+
+         simulator.Disconnect();
+      }
+   }
+}
@@ -0,0 +1,59 @@
+﻿using System;
+using System.Collections.Generic;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   [TestFixture]
+   public class LargeDistributionLists : PerformanceTestFixtureBase
+   {
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+
+         // The list members don't exist, so every one of them ends up with the postmaster.
+         _domain.Postmaster = _account.Address;
+         _domain.Save();
+      }
+
+      [Test]
+      public void Send100MessagesToListWith10000NestedMembers()
+      {
+         var nestedLists = new List<string>();
+
+         for (int list = 0; list < 100; list++)
+         {
+            var members = new List<string>();
+
+            for (int member = 0; member < 100; member++)
+               members.Add(string.Format("member-{0}-{1}@test.com", list, member));
+
+            string listAddress = string.Format("nested-{0}@test.com", list);
+
+            SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, listAddress, members);
+            nestedLists.Add(listAddress);
+         }
+
+         SingletonProvider<TestSetup>.Instance.AddDistributionList(_domain, "list@test.com", nestedLists);
+
+         MeasureTime("Send first message", () =>
+            {
+               SmtpClientSimulator.StaticSend("test@test.com", "list@test.com", "Test", "Test message");
+               Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", 1);
+            });
+
+         MeasureTime("Send 100 messages", () =>
+            {
+               for (int i = 0; i < 100; i++)
+                  SmtpClientSimulator.StaticSend("test@test.com", "list@test.com", "Test", "Test message");
+
+               Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", 101);
+            });
+      }
+   }
+}
@@ -0,0 +1,97 @@
+﻿using System;
+using System.Diagnostics;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   /// <summary>
+   /// Measures time and throughput of FETCH commands which produce many small response lines.
+   /// Run with Performance Monitor (TCPv4\Segments Sent/sec) to see the number of sends.
+   /// </summary>
+   [TestFixture]
+   public class LargeFetchResponses : PerformanceTestFixtureBase
+   {
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+      }
+
+      [Test]
+      public void Fetch5000Messages()
+      {
+         IMAPFolder folder = _account.IMAPFolders.get_ItemByName("INBOX");
+
+         for (int i = 0; i < 5000; i++)
+         {
+            hMailServer.Message message = folder.Messages.Add();
+            message.Subject = string.Format("Subject {0}", i);
+            message.FromAddress = "sender@example.com";
+            message.Body = new string('a', 2000);
+            message.Save();
+         }
+
+         var simulator = new ImapClientSimulator("test@test.com", "test", "INBOX");
+
+         MeasureThroughput("FETCH 1:5000 (FLAGS UID)", () => simulator.SendSingleCommand("A01 FETCH 1:5000 (FLAGS UID)"));
+         MeasureThroughput("FETCH 1:5000 (ENVELOPE)", () => simulator.SendSingleCommand("A02 FETCH 1:5000 (ENVELOPE)"));
+         MeasureThroughput("FETCH 1:5000 (BODY.PEEK[])", () => simulator.SendSingleCommand("A03 FETCH 1:5000 (BODY.PEEK[])"));
+
+         // The second run is answered from the structure cache.
+         MeasureThroughput("FETCH 1:5000 (ENVELOPE BODYSTRUCTURE), first", () => simulator.SendSingleCommand("A04 FETCH 1:5000 (ENVELOPE BODYSTRUCTURE)"));
+         MeasureThroughput("FETCH 1:5000 (ENVELOPE BODYSTRUCTURE), second", () => simulator.SendSingleCommand("A05 FETCH 1:5000 (ENVELOPE BODYSTRUCTURE)"));
+
+         simulator.Disconnect();
+      }
+
+      [Test]
+      public void FetchLargeMessageInPartials()
+      {
+         IMAPFolder folder = _account.IMAPFolders.get_ItemByName("INBOX");
+
+         hMailServer.Message message = folder.Messages.Add();
+         message.Subject = "Large message";
+         message.FromAddress = "sender@example.com";
+         message.Body = new string('a', 20 * 1024 * 1024);
+         message.Save();
+
+         var simulator = new ImapClientSimulator("test@test.com", "test", "INBOX");
+
+         // Each partial should only read the requested window from the message file.
+         foreach (string section in new[] { "", "TEXT", "1" })
+         {
+            string command = string.Format("FETCH 1 (BODY.PEEK[{0}]<offset.65536>) x 100", section);
+
+            MeasureThroughput(command, () =>
+               {
+                  string response = string.Empty;
+
+                  for (int i = 0; i < 100; i++)
+                     response += simulator.SendSingleCommand(string.Format("A{0} FETCH 1 (BODY.PEEK[{1}]<{2}.65536>)", i, section, i * 65536));
+
+                  return response;
+               });
+         }
+
+         simulator.Disconnect();
+      }
+
+      private void MeasureThroughput(string command, Func<string> action)
+      {
+         var stopwatch = new Stopwatch();
+         stopwatch.Start();
+
+         string response = action();
+
+         stopwatch.Stop();
+
+         double kilobytesPerSecond = response.Length / 1024.0 / Math.Max(stopwatch.Elapsed.TotalSeconds, 0.001);
+
+         Console.WriteLine("{0};{1};{2};{3};{4};{5:0} KB/s", _application.Version, TestContext.CurrentContext.Test.FullName, command, DateTime.UtcNow.ToString("yyyyMMdd HH:mm:ss"), stopwatch.Elapsed, kilobytesPerSecond);
+      }
+   }
+}
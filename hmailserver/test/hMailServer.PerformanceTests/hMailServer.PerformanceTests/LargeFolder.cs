@@ -0,0 +1,65 @@
+﻿using System;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   /// <summary>
+   /// Measures commands which only need the cached message list of a large folder, such as
+   /// SELECT, STATUS, flag fetches and flag searches. None of these should read message files.
+   /// </summary>
+   [TestFixture]
+   public class LargeFolder : PerformanceTestFixtureBase
+   {
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+      }
+
+      [Test]
+      public void FolderWith20000Messages()
+      {
+         IMAPFolder folder = _account.IMAPFolders.get_ItemByName("INBOX");
+
+         for (int i = 0; i < 20000; i++)
+         {
+            hMailServer.Message message = folder.Messages.Add();
+            message.Subject = string.Format("Subject {0}", i);
+            message.FromAddress = "sender@example.com";
+            message.Body = "Body";
+            message.set_Flag(eMessageFlag.eMFSeen, i % 10 != 0);
+            message.Save();
+         }
+
+         // Saving the messages cached the folder. Drop it so that the memory used by the
+         // Message objects and the snapshot is measured when the folder is loaded again.
+         _settings.Cache.Clear();
+
+         ImapClientSimulator simulator = null;
+         MeasureMemory("Load INBOX message list and snapshot", () => simulator = new ImapClientSimulator("test@test.com", "test", "INBOX"));
+
+         MeasureTime("SELECT INBOX", () => simulator.SendSingleCommand("A01 SELECT INBOX"));
+         MeasureTime("STATUS INBOX (MESSAGES UNSEEN)", () => simulator.SendSingleCommand("A02 STATUS INBOX (MESSAGES UNSEEN)"));
+         MeasureTime("FETCH 1:* (FLAGS UID)", () => simulator.SendSingleCommand("A03 FETCH 1:* (FLAGS UID)"));
+         MeasureTime("UID FETCH 1:* (FLAGS RFC822.SIZE INTERNALDATE)", () => simulator.SendSingleCommand("A04 UID FETCH 1:* (FLAGS RFC822.SIZE INTERNALDATE)"));
+         MeasureTime("SEARCH UNSEEN", () => simulator.SendSingleCommand("A05 SEARCH UNSEEN"));
+         MeasureTime("STORE 1:100 +FLAGS (\\Flagged), FETCH 1:* (FLAGS)", () =>
+            {
+               simulator.SendSingleCommand("A06 STORE 1:100 +FLAGS (\\Flagged)");
+               simulator.SendSingleCommand("A07 FETCH 1:* (FLAGS)");
+            });
+         MeasureTime("STORE 1:* +FLAGS.SILENT (\\Seen)", () => simulator.SendSingleCommand("A08 STORE 1:* +FLAGS.SILENT (\\Seen)"));
+         MeasureTime("STORE 1:10000 +FLAGS.SILENT (\\Deleted), EXPUNGE", () =>
+            {
+               simulator.SendSingleCommand("A09 STORE 1:10000 +FLAGS.SILENT (\\Deleted)");
+               simulator.SendSingleCommand("A10 EXPUNGE");
+            });
+
+         simulator.Disconnect();
+      }
+   }
+}
@@ -0,0 +1,85 @@
+﻿using System;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   [TestFixture]
+   public class ManyRules : PerformanceTestFixtureBase
+   {
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+      }
+
+      [Test]
+      public void Send100MessagesWith200GlobalAnd200AccountRules()
+      {
+         for (int i = 0; i < 200; i++)
+         {
+            AddRule(_application.Rules.Add(), i);
+            AddRule(_account.Rules.Add(), i);
+         }
+
+         MeasureTime("Send first message", () =>
+            {
+               SmtpClientSimulator.StaticSend("test@test.com", "test@test.com", "Test", "Test message");
+               Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", 1);
+            });
+
+         MeasureTime("Send 100 messages", () =>
+            {
+               for (int i = 0; i < 100; i++)
+                  SmtpClientSimulator.StaticSend("test@test.com", "test@test.com", "Test", "Test message");
+
+               Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", 101);
+            });
+      }
+
+      private static void AddRule(Rule rule, int index)
+      {
+         // None of the rules match. Half of them can be rejected on the message
+         // size alone, the other half need the subject to be checked.
+         rule.Name = string.Format("Rule {0}", index);
+         rule.Active = true;
+         rule.UseAND = true;
+
+         RuleCriteria bodyCriteria = rule.Criterias.Add();
+         bodyCriteria.UsePredefined = true;
+         bodyCriteria.PredefinedField = eRulePredefinedField.eFTBody;
+         bodyCriteria.MatchType = eRuleMatchType.eMTContains;
+         bodyCriteria.MatchValue = string.Format("body-{0}", index);
+         bodyCriteria.Save();
+
+         RuleCriteria otherCriteria = rule.Criterias.Add();
+
+         if (index % 2 == 0)
+         {
+            otherCriteria.UsePredefined = true;
+            otherCriteria.PredefinedField = eRulePredefinedField.eFTMessageSize;
+            otherCriteria.MatchType = eRuleMatchType.eMTGreaterThan;
+            otherCriteria.MatchValue = "100000000";
+         }
+         else
+         {
+            otherCriteria.UsePredefined = false;
+            otherCriteria.HeaderField = "Subject";
+            otherCriteria.MatchType = eRuleMatchType.eMTRegExMatch;
+            otherCriteria.MatchValue = string.Format("subject-{0}-[a-f]+", index);
+         }
+
+         otherCriteria.Save();
+
+         RuleAction action = rule.Actions.Add();
+         action.Type = eRuleActionType.eRAMoveToImapFolder;
+         action.IMAPFolder = "INBOX.Rules";
+         action.Save();
+
+         rule.Save();
+      }
+   }
+}
@@ -0,0 +1,90 @@
+﻿using System;
+using System.Text;
+using NUnit.Framework;
+using RegressionTests.Infrastructure;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   [TestFixture]
+   public class MimeParsing : PerformanceTestFixtureBase
+   {
+      private const int MessageCount = 100;
+      private const int AttachmentCount = 20;
+
+      private hMailServer.Account _account;
+
+      [SetUp]
+      public new void SetUp()
+      {
+         _account = SingletonProvider<TestSetup>.Instance.AddAccount(_domain, "test@test.com", "test");
+      }
+
+      [Test]
+      public void Parse100MessagesWith20AttachmentsEach()
+      {
+         // Every message is around 1MB, most of which is base64 encoded attachments.
+         for (int i = 0; i < MessageCount; i++)
+            SmtpClientSimulator.StaticSendRaw("test@test.com", "test@test.com", CreateMessage(i));
+
+         Pop3ClientSimulator.AssertMessageCount("test@test.com", "test", MessageCount);
+
+         var messages = _account.IMAPFolders.get_ItemByName("INBOX").Messages;
+
+         MeasureTime("Parse messages", () =>
+            {
+               for (int i = 0; i < MessageCount; i++)
+               {
+                  var message = messages[i];
+
+                  Assert.AreEqual(AttachmentCount, message.Attachments.Count);
+                  Assert.IsTrue(message.Body.Contains("Message body"));
+               }
+            });
+      }
+
+      private static string CreateMessage(int index)
+      {
+         var random = new Random(index);
+
+         var message = new StringBuilder();
+         message.Append("From: test@test.com\r\n");
+         message.Append("To: test@test.com\r\n");
+         message.AppendFormat("Subject: Message {0}\r\n", index);
+         message.Append("MIME-Version: 1.0\r\n");
+         message.Append("Content-Type: multipart/mixed; boundary=\"mixed-boundary\"\r\n");
+         message.Append("\r\n");
+         message.Append("This is a multi-part message.\r\n");
+         message.Append("--mixed-boundary\r\n");
+         message.Append("Content-Type: multipart/alternative; boundary=\"alternative-boundary\"\r\n");
+         message.Append("\r\n");
+         message.Append("--alternative-boundary\r\n");
+         message.Append("Content-Type: text/plain; charset=\"utf-8\"\r\n");
+         message.Append("\r\n");
+         message.Append("Message body\r\n");
+         message.Append("--alternative-boundary\r\n");
+         message.Append("Content-Type: text/html; charset=\"utf-8\"\r\n");
+         message.Append("\r\n");
+         message.Append("<html><body>Message body</body></html>\r\n");
+         message.Append("--alternative-boundary--\r\n");
+
+         for (int attachment = 0; attachment < AttachmentCount; attachment++)
+         {
+            var content = new byte[50 * 1024];
+            random.NextBytes(content);
+
+            message.Append("--mixed-boundary\r\n");
+            message.Append("Content-Type: application/octet-stream\r\n");
+            message.Append("Content-Transfer-Encoding: base64\r\n");
+            message.AppendFormat("Content-Disposition: attachment; filename=\"attachment{0}.bin\"\r\n", attachment);
+            message.Append("\r\n");
+            message.Append(Convert.ToBase64String(content, Base64FormattingOptions.InsertLineBreaks));
+            message.Append("\r\n");
+         }
+
+         message.Append("--mixed-boundary--\r\n");
+
+         return message.ToString();
+      }
+   }
+}
@@ -0,0 +1,50 @@
+﻿using System;
+using System.Diagnostics;
+using NUnit.Framework;
+using RegressionTests.Shared;
+
+namespace hMailServer.PerformanceTests
+{
+   public class PerformanceTestFixtureBase : TestFixtureBase
+   {
+      /// <summary>
+      /// Runs action and writes the elapsed time as a semicolon separated line:
+      /// version;test;description;time of measurement;elapsed.
+      /// </summary>
+      protected void MeasureTime(string description, Action action)
+      {
+         var stopwatch = new Stopwatch();
+         stopwatch.Start();
+
+         action();
+
+         stopwatch.Stop();
+
+         Console.WriteLine("{0};{1};{2};{3};{4}", _application.Version, TestContext.CurrentContext.Test.FullName, description, DateTime.UtcNow.ToString("yyyyMMdd HH:mm:ss"), stopwatch.Elapsed);
+      }
+
+      /// <summary>
+      /// Runs action and writes how much the private memory of the server grew, in the
+      /// same format as MeasureTime.
+      /// </summary>
+      protected void MeasureMemory(string description, Action action)
+      {
+         long before = GetServerPrivateMemory();
+
+         action();
+
+         long after = GetServerPrivateMemory();
+
+         Console.WriteLine("{0};{1};{2};{3};{4} KB", _application.Version, TestContext.CurrentContext.Test.FullName, description, DateTime.UtcNow.ToString("yyyyMMdd HH:mm:ss"), (after - before) / 1024);
+      }
+
+      private static long GetServerPrivateMemory()
+      {
+         Process[] processes = Process.GetProcessesByName("hMailServer");
+         if (processes.Length != 1)
+            throw new Exception("hMailServer.exe not running");
+
+         return processes[0].PrivateMemorySize64;
+      }
+   }
+}